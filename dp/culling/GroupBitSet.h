@@ -145,7 +145,6 @@ namespace dp
       {
         m_dirtyMatrices.enableBit( index );
         m_boundingBoxDirty = true;
-        m_obbDirty = true;
       }
     }
 
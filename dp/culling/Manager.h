@@ -94,6 +94,7 @@ namespace dp
     enum class Mode
     {
         CPU
+      , CPU_BVH // CPU culling using a bounding volume hierarchy per group
       , OPENGL_COMPUTE
       , CUDA
       , AUTO // figure out which culling is best automatically
@@ -138,6 +139,16 @@ namespace dp
       **/
       DP_CULLING_API virtual void cull( GroupSharedPtr const & group, ResultSharedPtr const & result, dp::math::Mat44f const & viewProjection ) = 0;
 
+      /** \brief Cull a given group like cull above and additionally cull small features, objects which cover less than a minimum
+                 area on the screen. The area of an object is the area of the screen space bounding rectangle of its projected box.
+                 Objects which intersect the plane through the eye are never culled as small features.
+          \param viewportSize The size of the viewport in pixels.
+          \param minimumPixelArea Objects whose area is less than this number of pixels are invisible. 0 disables small feature culling.
+          \remarks The default implementation ignores viewportSize and minimumPixelArea. Currently only the CPU culling implements it.
+      **/
+      DP_CULLING_API virtual void cull( GroupSharedPtr const & group, ResultSharedPtr const & result, dp::math::Mat44f const & viewProjection
+                                      , dp::math::Vec2ui const & viewportSize, float minimumPixelArea );
+
       /** \brief Compute the bounding box for the given group **/
       DP_CULLING_API virtual dp::math::Box3f getBoundingBox( GroupSharedPtr const & group ) const = 0;
     };
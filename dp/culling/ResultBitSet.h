@@ -53,6 +53,9 @@ namespace dp
 
       bool isVisible( ObjectBitSetSharedPtr const & object );
 
+      /** \brief Get the visibility of the last call to updateChanged, bit i is the visibility of object i. **/
+      dp::util::BitArray const & getVisibility() const;
+
     protected:
       DP_CULLING_API ResultBitSet( GroupBitSetSharedPtr const& parentGroup );
 
@@ -75,6 +78,11 @@ namespace dp
       return (groupIndex < m_results.getSize()) ? m_results.getBit( groupIndex ) : true;
     }
 
+    inline dp::util::BitArray const & ResultBitSet::getVisibility() const
+    {
+      return m_results;
+    }
+
   } // namespace culling
 } // namespace dp
 
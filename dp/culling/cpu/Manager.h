@@ -36,10 +36,113 @@ namespace dp
     namespace cpu
     {
 
+      DEFINE_PTR_TYPES( Occluder );
+      class Occluder
+      {
+      public:
+        virtual ~Occluder() {}
+
+      protected:
+        Occluder() {}
+      };
+
       class Manager : public dp::culling::ManagerBitSet
       {
       public:
-        DP_CULLING_API static Manager* create();
+        /** \brief Algorithm used to determine the visibility of the objects in a group.
+                   FLAT tests each object of the group against the frustum.
+                   BVH builds a bounding volume hierarchy over the objects of a group and culls whole subtrees at once.
+        **/
+        enum class Algorithm
+        {
+            FLAT
+          , BVH
+        };
+
+        /** \brief Instruction set used by the FLAT algorithm. AUTO selects the best instruction set supported by the CPU at runtime.
+                   SSE4_1 and AVX2 are available on x86-64, NEON on ARM. All instruction sets produce the same results.
+        **/
+        enum class InstructionSet
+        {
+            AUTO
+          , SCALAR
+          , SSE4_1
+          , AVX2
+          , NEON
+        };
+
+        DP_CULLING_API static Manager* create( Algorithm algorithm = Algorithm::FLAT );
+
+        /** \brief Check if the given instruction set has been compiled in and is supported by the CPU. **/
+        DP_CULLING_API static bool isInstructionSetSupported( InstructionSet instructionSet );
+
+        DP_CULLING_API virtual void setAlgorithm( Algorithm algorithm ) = 0;
+        DP_CULLING_API virtual Algorithm getAlgorithm() const = 0;
+
+        /** \brief Set the number of threads used by the FLAT algorithm to cull a group.
+            \param threadCount 0 uses one thread per hardware thread, 1 culls on the calling thread only.
+            \remarks The default is 0. Small groups are always culled on the calling thread.
+        **/
+        DP_CULLING_API virtual void setThreadCount( unsigned int threadCount ) = 0;
+        DP_CULLING_API virtual unsigned int getThreadCount() const = 0;
+
+        /** \brief Set the instruction set used by the FLAT algorithm.
+            \remarks Throws std::runtime_error if the instruction set is not supported.
+        **/
+        DP_CULLING_API virtual void setInstructionSet( InstructionSet instructionSet ) = 0;
+        DP_CULLING_API virtual InstructionSet getInstructionSet() const = 0;
+
+        /** \brief Enable the temporal coherence mode of the FLAT algorithm. Each result remembers which frustum plane rejected an object
+                   in the last frame and tests this plane first. Objects which have been deep inside of the frustum are not tested again
+                   as long as the frustum moved less than their distance to it. The results are the same as without temporal coherence.
+            \remarks The default is false. This mode pays off for cameras which move only a little each frame. It uses its own
+                     scalar kernel, the instruction set is ignored.
+        **/
+        DP_CULLING_API virtual void setTemporalCoherence( bool temporalCoherence ) = 0;
+        DP_CULLING_API virtual bool getTemporalCoherence() const = 0;
+
+        /** \brief Statistics of the last call to cullOcclusion. **/
+        struct OcclusionStatistics
+        {
+          size_t rasterizedTriangles; // occluder triangles after clipping at the near plane
+          size_t testedObjects;       // objects which have been visible in the frustum result
+          size_t occludedObjects;     // tested objects which are hidden behind the occluders
+        };
+
+        /** \brief Create an occluder from an indexed triangle mesh in object space. The data is copied.
+            \param indices Three indices per triangle.
+            \remarks Occluders are rasterized into the depth buffer of the occlusion test. Unlike the bounding boxes of the objects
+                     they must not be larger than the opaque geometry they represent. A few large occluders with a small number of
+                     triangles work best.
+        **/
+        DP_CULLING_API virtual OccluderSharedPtr occluderCreate( dp::math::Vec3f const* vertices, size_t vertexCount, uint32_t const* indices, size_t indexCount ) = 0;
+
+        /** \brief Set the index of the matrix of the group which transforms the occluder to world space. The default is 0. **/
+        DP_CULLING_API virtual void occluderSetTransformIndex( OccluderSharedPtr const & occluder, size_t index ) = 0;
+
+        DP_CULLING_API virtual void groupAddOccluder( GroupSharedPtr const & group, OccluderSharedPtr const & occluder ) = 0;
+        DP_CULLING_API virtual void groupRemoveOccluder( GroupSharedPtr const & group, OccluderSharedPtr const & occluder ) = 0;
+
+        /** \brief Set the resolution of the depth buffer used by cullOcclusion. The default is 256x128. **/
+        DP_CULLING_API virtual void setOcclusionBufferSize( unsigned int width, unsigned int height ) = 0;
+        DP_CULLING_API virtual dp::math::Vec2ui getOcclusionBufferSize() const = 0;
+
+        /** \brief Cull the objects of a group which are hidden behind its occluders. This is a second stage after cull.
+                   The occluders are rasterized into a low resolution depth buffer and the objects which are visible in
+                   frustumResult are tested against a hierarchical z pyramid of it.
+            \param group The group which contains the objects and the occluders.
+            \param frustumResult A result of the group which has been culled with the same viewProjection by cull.
+            \param occlusionResult A different result of the group which receives the occlusion visibility. Objects which are
+                   not visible in frustumResult are not tested and reported as visible, so an object is visible if it is visible
+                   in both results.
+            \param viewProjection The camera/projection matrix
+            \remarks Occluders are sampled at the pixel centers of the depth buffer. Objects which peek out from behind an occluder
+                     by less than a pixel of the depth buffer may be culled.
+        **/
+        DP_CULLING_API virtual void cullOcclusion( GroupSharedPtr const & group, ResultSharedPtr const & frustumResult, ResultSharedPtr const & occlusionResult
+                                                 , dp::math::Mat44f const & viewProjection ) = 0;
+
+        DP_CULLING_API virtual OcclusionStatistics const & getOcclusionStatistics() const = 0;
       };
 
     } // namespace cpu
@@ -0,0 +1,95 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <dp/culling/cpu/inc/OBB.h>
+#include <dp/util/BitArray.h>
+#include <vector>
+
+namespace dp
+{
+  namespace culling
+  {
+    namespace cpu
+    {
+
+      /** \brief Bounding volume hierarchy over the world space OBBs of a culling group.
+                 The hierarchy is built once per object incarnation and refitted when matrices change.
+                 Culling walks the tree and rejects or accepts whole subtrees at once. Only objects
+                 in leaves which intersect the frustum planes are tested individually.
+      **/
+      class BoundingVolumeHierarchy
+      {
+      public:
+        BoundingVolumeHierarchy();
+
+        /** \brief Build the hierarchy from scratch for the given OBBs **/
+        void build( OBBArray const & obbs );
+
+        /** \brief Recompute the bounds of all nodes after the OBBs have been changed. The number of OBBs
+                   must not have changed since the last build. The hierarchy is rebuilt automatically
+                   if the refitted hierarchy got too loose.
+        **/
+        void refit( OBBArray const & obbs );
+
+        /** \brief Cull the OBBs against the given viewProjection matrix.
+            \param visible Receives the visibility for the OBB i in bit i. The size must match the number of OBBs.
+        **/
+        void cull( dp::math::Mat44f const & viewProjection, OBBArray const & obbs, dp::util::BitArray & visible ) const;
+
+        size_t getObjectCount() const { return m_objectIndices.size(); }
+        size_t getNodeCount() const { return m_nodes.size(); }
+
+      private:
+        /** \brief Nodes are stored in depth first order. The first child of an inner node is the next node,
+                   the second child is referenced by secondChild. Leafs have secondChild set to 0.
+                   The objects below a node are m_objectIndices[begin] to m_objectIndices[end - 1].
+        **/
+        struct Node
+        {
+          dp::math::Vec3f lower;
+          dp::math::Vec3f upper;
+          uint32_t        begin;
+          uint32_t        end;
+          uint32_t        secondChild;
+        };
+
+        void updateObjectBounds( OBBArray const & obbs );
+        void updateNodeBounds();
+        uint32_t buildNode( uint32_t begin, uint32_t end );
+        float computeLeafArea() const;
+
+        std::vector<Node>            m_nodes;
+        std::vector<uint32_t>        m_objectIndices;
+        std::vector<dp::math::Vec3f> m_objectLower;
+        std::vector<dp::math::Vec3f> m_objectUpper;
+        float                        m_buildLeafArea;
+      };
+
+    } // namespace cpu
+  } // namespace culling
+} // namespace dp
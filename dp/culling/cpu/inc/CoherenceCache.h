@@ -0,0 +1,101 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <dp/culling/cpu/inc/Frustum.h>
+#include <dp/culling/cpu/inc/OBB.h>
+#include <dp/math/Matmnt.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dp
+{
+  namespace culling
+  {
+    namespace cpu
+    {
+
+      /** \brief Per result state of the temporal coherence mode of the FLAT algorithm.
+                 For each object the cache remembers the frustum plane which rejected it in the last frame and a world space
+                 margin, which is the distance of the object to this plane or, for objects completely inside of the frustum,
+                 to the closest plane. Each frame the margin is reduced by a bound of how far the frustum planes have moved.
+                 As long as it stays positive the object keeps its visibility without being tested. Otherwise the cached
+                 plane is tested first and only objects which are not rejected by it get the full test.
+                 The results are exactly the same as the ones of the regular culling kernels.
+      **/
+      class CoherenceCache
+      {
+      public:
+        CoherenceCache();
+
+        /** \brief Prepare the cache for culling a group with the given view projection.
+            \param viewProjection The view projection matrix of this frame.
+            \param stride The padded number of objects of the group, see OBBArray::getStride.
+            \param objectIncarnation The object incarnation of the group. All cached data is discarded if it has changed.
+        **/
+        void update( dp::math::Mat44f const & viewProjection, size_t stride, size_t objectIncarnation );
+
+        /** \brief Compute the visibility of the objects [32 * beginWord, 32 * endWord) like a CullingKernel and update the cache.
+            \param generations The OBB generation of each object. The cached distance of objects whose generation is newer than
+                   the one passed to the last call of finish is discarded.
+            \remarks Different word ranges may be culled concurrently.
+        **/
+        void cull( float const* obbs, size_t stride, uint32_t const* generations, dp::math::Mat44f const & viewProjection
+                 , size_t beginWord, size_t endWord, uint32_t* visibility );
+
+        /** \brief Finish the frame after all words have been culled.
+            \param generation The current OBB generation of the group.
+        **/
+        void finish( uint32_t generation );
+
+      private:
+        /** \brief Determine the visibility of an object whose margin is not valid and update its cache entries. **/
+        bool testObject( size_t index, float const* obbs, size_t stride, dp::math::Mat44f const & viewProjection );
+
+        /** \brief Compute the margin of an object. rejectingPlanes has the bit of each plane which rejects the object
+                   or is 0 for objects completely inside of the frustum. The margin stays invalid if it is too small.
+        **/
+        void updateMargin( size_t index, OBB const & obb, unsigned int rejectingPlanes );
+
+      private:
+        Frustum  m_frustum;
+        Frustum  m_previousFrustum;
+        float    m_normalMotion;    // bound of the movement of the planes per unit distance from the origin
+        float    m_distanceMotion;  // bound of the movement of the planes at the origin
+
+        size_t   m_objectIncarnation;
+        uint32_t m_generation;
+
+        std::vector<uint8_t> m_rejectingPlanes;
+        std::vector<float>   m_margins;
+        std::vector<float>   m_radii;
+      };
+
+    } // namespace cpu
+  } // namespace culling
+} // namespace dp
@@ -0,0 +1,90 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <dp/culling/cpu/Manager.h>
+#include <dp/util/Config.h>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(DP_ARCH_X86_64)
+#define DP_CULLING_CPU_SSE4_1
+#define DP_CULLING_CPU_AVX2
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DP_CULLING_CPU_NEON
+#endif
+
+namespace dp
+{
+  namespace culling
+  {
+    namespace cpu
+    {
+
+      /** \brief Compute the visibility of the objects [32 * beginWord, 32 * endWord) of an OBBArray.
+          \param obbs Pointer to the components of an OBBArray, see OBBArray::getData.
+          \param stride Distance in floats between two components of the same object, see OBBArray::getStride.
+          \param viewProjection The 16 floats of the row major view projection matrix.
+          \param beginWord First visibility word to compute.
+          \param endWord One past the last visibility word to compute. The objects up to 32 * endWord must be within the
+                 padded size of the OBBArray. The zero OBBs of the padding are always classified as invisible.
+          \param visibility Receives one bit per object, 1 if the object is visible.
+          \remarks All kernels evaluate the same operations in the same order as isVisible( Mat44f, OBB ) without fused
+                   multiply adds, so they all produce the same results.
+      **/
+      typedef void (*CullingKernel)( float const* obbs, size_t stride, float const* viewProjection
+                                   , size_t beginWord, size_t endWord, uint32_t* visibility );
+
+      void cullScalar( float const* obbs, size_t stride, float const* viewProjection
+                     , size_t beginWord, size_t endWord, uint32_t* visibility );
+
+#if defined(DP_CULLING_CPU_SSE4_1)
+      void cullSSE4_1( float const* obbs, size_t stride, float const* viewProjection
+                     , size_t beginWord, size_t endWord, uint32_t* visibility );
+#endif
+
+#if defined(DP_CULLING_CPU_AVX2)
+      void cullAVX2( float const* obbs, size_t stride, float const* viewProjection
+                   , size_t beginWord, size_t endWord, uint32_t* visibility );
+#endif
+
+#if defined(DP_CULLING_CPU_NEON)
+      void cullNEON( float const* obbs, size_t stride, float const* viewProjection
+                   , size_t beginWord, size_t endWord, uint32_t* visibility );
+#endif
+
+      /** \brief Resolve AUTO to the best supported instruction set. **/
+      Manager::InstructionSet resolveInstructionSet( Manager::InstructionSet instructionSet );
+
+      /** \brief Get the kernel for a supported instruction set. AUTO is resolved to the best supported instruction set. **/
+      CullingKernel getCullingKernel( Manager::InstructionSet instructionSet );
+
+    } // namespace cpu
+  } // namespace culling
+} // namespace dp
@@ -0,0 +1,67 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <dp/math/Matmnt.h>
+#include <dp/math/Vecnt.h>
+
+namespace dp
+{
+  namespace culling
+  {
+    namespace cpu
+    {
+
+      /** \brief World space planes of the frustum of a view projection matrix, normalized in double precision.
+                 Plane 2 * axis + side belongs to the cull flag 1 << ( 2 * axis + side ) of determineCullFlags. Positive
+                 distances are inside of the frustum. Together with getError these planes allow to decide in world space
+                 whether the clip space test of a box has a certain result, despite its rounding errors.
+      **/
+      class Frustum
+      {
+      public:
+        /** \brief Create an invalid frustum, getError always returns FLT_MAX. **/
+        Frustum();
+        explicit Frustum( dp::math::Mat44f const & viewProjection );
+
+        dp::math::Vec3f const & getNormal( unsigned int plane ) const { return m_normals[plane]; }
+        float getDistance( unsigned int plane ) const { return m_distances[plane]; }
+
+        /** \brief Get a bound of the rounding errors of determineCullFlags for a box, in world space distances to the planes.
+            \param radius The maximum distance of the box from the origin plus the sum of the half lengths of its edges.
+        **/
+        float getError( float radius ) const { return m_errorScale * ( 3.0f * radius + 1.0f ); }
+
+      private:
+        dp::math::Vec3f m_normals[6];
+        float           m_distances[6];
+        float           m_errorScale;
+      };
+
+    } // namespace cpu
+  } // namespace culling
+} // namespace dp
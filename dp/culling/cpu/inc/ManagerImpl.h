@@ -28,6 +28,9 @@
 
 #include <dp/culling/Config.h>
 #include <dp/culling/ManagerBitSet.h>
+#include <dp/culling/cpu/inc/CullingKernels.h>
+#include <dp/culling/cpu/inc/OcclusionBuffer.h>
+#include <dp/util/WorkerPool.h>
 
 namespace dp
 {
@@ -67,13 +70,52 @@ namespace dp
       class ManagerImpl : public Manager
       {
       public:
-        ManagerImpl();
+        ManagerImpl( Algorithm algorithm );
         virtual ~ManagerImpl();
         virtual ObjectSharedPtr objectCreate( PayloadSharedPtr const& userData );
         virtual GroupSharedPtr groupCreate();
         virtual ResultSharedPtr groupCreateResult( GroupSharedPtr const& group );
 
         virtual void cull( const GroupSharedPtr& group, const ResultSharedPtr& result, const dp::math::Mat44f& viewProjection );
+        virtual void cull( GroupSharedPtr const & group, ResultSharedPtr const & result, dp::math::Mat44f const & viewProjection
+                         , dp::math::Vec2ui const & viewportSize, float minimumPixelArea );
+
+        virtual void setAlgorithm( Algorithm algorithm );
+        virtual Algorithm getAlgorithm() const;
+
+        virtual void setThreadCount( unsigned int threadCount );
+        virtual unsigned int getThreadCount() const;
+
+        virtual void setInstructionSet( InstructionSet instructionSet );
+        virtual InstructionSet getInstructionSet() const;
+
+        virtual void setTemporalCoherence( bool temporalCoherence );
+        virtual bool getTemporalCoherence() const;
+
+        virtual OccluderSharedPtr occluderCreate( dp::math::Vec3f const* vertices, size_t vertexCount, uint32_t const* indices, size_t indexCount );
+        virtual void occluderSetTransformIndex( OccluderSharedPtr const & occluder, size_t index );
+        virtual void groupAddOccluder( GroupSharedPtr const & group, OccluderSharedPtr const & occluder );
+        virtual void groupRemoveOccluder( GroupSharedPtr const & group, OccluderSharedPtr const & occluder );
+
+        virtual void setOcclusionBufferSize( unsigned int width, unsigned int height );
+        virtual dp::math::Vec2ui getOcclusionBufferSize() const;
+
+        virtual void cullOcclusion( GroupSharedPtr const & group, ResultSharedPtr const & frustumResult, ResultSharedPtr const & occlusionResult
+                                  , dp::math::Mat44f const & viewProjection );
+        virtual OcclusionStatistics const & getOcclusionStatistics() const;
+
+      private:
+        dp::util::WorkerPoolSharedPtr const & getWorkerPool();
+
+      private:
+        Algorithm                     m_algorithm;
+        unsigned int                  m_threadCount;
+        dp::util::WorkerPoolSharedPtr m_workerPool;
+        InstructionSet                m_instructionSet;
+        CullingKernel                 m_cullingKernel;
+        bool                          m_temporalCoherence;
+        OcclusionBuffer               m_occlusionBuffer;
+        OcclusionStatistics           m_occlusionStatistics;
       };
 #endif
 
@@ -0,0 +1,222 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <dp/math/Vecnt.h>
+#include <dp/math/Matmnt.h>
+#include <dp/Assert.h>
+#include <algorithm>
+#include <vector>
+
+namespace dp
+{
+  namespace culling
+  {
+    namespace cpu
+    {
+
+      /** \brief Oriented bounding box in world space. point is the transformed lower left corner,
+                 ex, ey and ez are the transformed edges of the box.
+      **/
+      struct OBB
+      {
+        dp::math::Vec4f point;
+        dp::math::Vec4f ex;
+        dp::math::Vec4f ey;
+        dp::math::Vec4f ez;
+      };
+
+      inline void determineCullFlags( const dp::math::Vec4f &p, unsigned int & cfo, unsigned int & cfa )
+      {
+        unsigned int cf = 0;
+
+        if ( p[0] <= -p[3] )
+        {
+          cf |= 0x01;
+        }
+        else if ( p[3] <= p[0] )
+        {
+          cf |= 0x02;
+        }
+        if ( p[1] <= -p[3] )
+        {
+          cf |= 0x04;
+        }
+        else if ( p[3] <= p[1] )
+        {
+          cf |= 0x08;
+        }
+        if ( p[2] <= -p[3] )
+        {
+          cf |= 0x10;
+        }
+        else if ( p[3] <= p[2] )
+        {
+          cf |= 0x20;
+        }
+        cfo |= cf;
+        cfa &= cf;
+      }
+
+      /** \brief Compute the cull flags of the 8 corners of a box given by its clip space corner and edges.
+          \param cfo Receives the or'ed cull flags. If cfo is 0 the box is completely inside the frustum.
+          \param cfa Receives the and'ed cull flags. If cfa is not 0 the box is completely outside of the frustum.
+      **/
+      inline void determineCullFlags( dp::math::Vec4f const & v, dp::math::Vec4f const & x, dp::math::Vec4f const & y, dp::math::Vec4f const & z
+                                    , unsigned int & cfo, unsigned int & cfa )
+      {
+        dp::math::Vec4f vectors[8];
+        vectors[0] = v;
+        vectors[1] = vectors[0] + x;
+        vectors[2] = vectors[0] + y;
+        vectors[3] = vectors[1] + y;
+        vectors[4] = vectors[0] + z;
+        vectors[5] = vectors[1] + z;
+        vectors[6] = vectors[2] + z;
+        vectors[7] = vectors[3] + z;
+
+        cfo = 0;
+        cfa = ~0;
+        for ( unsigned int i = 0;i < 8; ++i )
+        {
+          determineCullFlags( vectors[i], cfo, cfa );
+        }
+      }
+
+      inline bool isVisible( const dp::math::Mat44f& projection, OBB const & obb)
+      {
+        unsigned int cfo;
+        unsigned int cfa;
+        determineCullFlags( obb.point * projection, obb.ex * projection, obb.ey * projection, obb.ez * projection, cfo, cfa );
+
+        return !cfo || !cfa;
+      }
+
+      /** \brief Structure of arrays storage for OBBs. Each of the 16 float components of an OBB is stored in its own array.
+                 The arrays are aligned to 64 bytes and padded with zeros to a multiple of Granularity objects, so that
+                 SIMD kernels can always process full vectors. A zero OBB is always classified as invisible.
+      **/
+      class OBBArray
+      {
+      public:
+        enum Component
+        {
+            POINT_X, POINT_Y, POINT_Z, POINT_W
+          , EX_X, EX_Y, EX_Z, EX_W
+          , EY_X, EY_Y, EY_Z, EY_W
+          , EZ_X, EZ_Y, EZ_Z, EZ_W
+          , COMPONENT_COUNT
+        };
+
+        static size_t const Granularity = 512;
+
+        OBBArray()
+          : m_size( 0 )
+          , m_stride( 0 )
+          , m_base( nullptr )
+        {
+        }
+
+        void resize( size_t size )
+        {
+          size_t stride = ( ( size + Granularity - 1 ) / Granularity ) * Granularity;
+          if ( stride != m_stride )
+          {
+            std::vector<float> storage( stride * COMPONENT_COUNT + Alignment / sizeof(float) );
+            float* base = alignBase( storage.data() );
+            for ( unsigned int component = 0; component < COMPONENT_COUNT; ++component )
+            {
+              std::copy( m_base + component * m_stride, m_base + component * m_stride + std::min( m_size, size ), base + component * stride );
+            }
+            m_storage.swap( storage );
+            m_base = base;
+            m_stride = stride;
+          }
+          else if ( size < m_size )
+          {
+            // keep the padding zero
+            for ( unsigned int component = 0; component < COMPONENT_COUNT; ++component )
+            {
+              std::fill( m_base + component * m_stride + size, m_base + component * m_stride + m_size, 0.0f );
+            }
+          }
+          m_size = size;
+        }
+
+        size_t size() const { return m_size; }
+
+        /** \brief Get the distance in floats between two components of the same object. **/
+        size_t getStride() const { return m_stride; }
+
+        float const* getData() const { return m_base; }
+        float const* getComponent( Component component ) const { return m_base + component * m_stride; }
+
+        void set( size_t index, OBB const & obb )
+        {
+          DP_ASSERT( index < m_size );
+          for ( unsigned int i = 0; i < 4; ++i )
+          {
+            m_base[(POINT_X + i) * m_stride + index] = obb.point[i];
+            m_base[(EX_X + i) * m_stride + index] = obb.ex[i];
+            m_base[(EY_X + i) * m_stride + index] = obb.ey[i];
+            m_base[(EZ_X + i) * m_stride + index] = obb.ez[i];
+          }
+        }
+
+        OBB get( size_t index ) const
+        {
+          DP_ASSERT( index < m_size );
+          OBB obb;
+          for ( unsigned int i = 0; i < 4; ++i )
+          {
+            obb.point[i] = m_base[(POINT_X + i) * m_stride + index];
+            obb.ex[i] = m_base[(EX_X + i) * m_stride + index];
+            obb.ey[i] = m_base[(EY_X + i) * m_stride + index];
+            obb.ez[i] = m_base[(EZ_X + i) * m_stride + index];
+          }
+          return obb;
+        }
+
+      private:
+        static size_t const Alignment = 64;
+
+        static float* alignBase( float* data )
+        {
+          size_t address = reinterpret_cast<size_t>( data );
+          return reinterpret_cast<float*>( ( address + Alignment - 1 ) & ~( Alignment - 1 ) );
+        }
+
+      private:
+        size_t             m_size;
+        size_t             m_stride;
+        float*             m_base;
+        std::vector<float> m_storage;
+      };
+
+    } // namespace cpu
+  } // namespace culling
+} // namespace dp
@@ -0,0 +1,108 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <dp/culling/cpu/inc/OBB.h>
+#include <dp/math/Matmnt.h>
+#include <dp/math/Vecnt.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dp
+{
+  namespace culling
+  {
+    namespace cpu
+    {
+
+      /** \brief Low resolution software depth buffer for occlusion culling.
+                 Occluder triangles are rasterized at the pixel centers and each pixel keeps the nearest normalized device
+                 depth. buildHierarchy then computes a hierarchical z pyramid where each texel holds the farthest depth of the
+                 texels below. A box is occluded if its nearest depth is behind the farthest occluder depth in all pixels its
+                 screen space bounds touch. Empty pixels have a depth of FLT_MAX and never occlude anything.
+      **/
+      class OcclusionBuffer
+      {
+      public:
+        OcclusionBuffer();
+
+        /** \brief Set the resolution of the buffer. The content is undefined until the next call to clear. **/
+        void resize( unsigned int width, unsigned int height );
+        unsigned int getWidth() const { return m_width; }
+        unsigned int getHeight() const { return m_height; }
+
+        void clear();
+
+        /** \brief Rasterize an indexed triangle mesh. Triangles are clipped at the near plane and never back face culled.
+            \param modelViewProjection Transforms the vertices to clip space.
+            \param indices Three indices per triangle.
+            \return The number of triangles which have been rasterized after clipping.
+        **/
+        size_t rasterize( dp::math::Mat44f const & modelViewProjection, dp::math::Vec3f const* vertices, size_t vertexCount
+                        , uint32_t const* indices, size_t indexCount );
+
+        /** \brief Compute the hierarchical z pyramid. Call after all occluders have been rasterized. **/
+        void buildHierarchy();
+
+        /** \brief Check if a world space box is completely hidden behind the rasterized occluders.
+                   Boxes which intersect the near plane are never occluded. The screen space bounds of the box are
+                   expanded by half a pixel to account for the occluders being rasterized at the pixel centers.
+        **/
+        bool isOccluded( dp::math::Mat44f const & viewProjection, OBB const & obb ) const;
+
+      private:
+        /** \brief Rasterize a triangle given by its screen space x, y and depth. **/
+        void rasterizeTriangle( dp::math::Vec3f const & v0, dp::math::Vec3f const & v1, dp::math::Vec3f const & v2 );
+
+        /** \brief Clip a triangle in clip space at the near plane, project it to screen space and rasterize it.
+            \return The number of triangles which have been rasterized.
+        **/
+        size_t clipAndRasterize( dp::math::Vec4f const & c0, dp::math::Vec4f const & c1, dp::math::Vec4f const & c2 );
+
+        dp::math::Vec3f toScreen( dp::math::Vec4f const & clip ) const;
+
+      private:
+        struct Level
+        {
+          unsigned int width;
+          unsigned int height;
+          unsigned int stride; // distance between two rows in texels
+          size_t       offset; // of the first texel in m_depths
+        };
+
+        unsigned int       m_width;
+        unsigned int       m_height;
+        std::vector<Level> m_levels;   // the rows of level 0 are padded to a multiple of 4 pixels
+        std::vector<float> m_depths;
+
+        std::vector<dp::math::Vec4f> m_clipVertices;
+      };
+
+    } // namespace cpu
+  } // namespace culling
+} // namespace dp
@@ -0,0 +1,278 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <dp/culling/cpu/inc/BoundingVolumeHierarchy.h>
+#include <dp/culling/cpu/inc/Frustum.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace dp
+{
+  namespace culling
+  {
+    namespace cpu
+    {
+
+      namespace
+      {
+        // maximum number of objects in a leaf
+        const uint32_t LeafSize = 4;
+
+        // rebuild the hierarchy if the sum of the leaf areas grew by this factor due to refits
+        const float RebuildFactor = 2.0f;
+
+        inline float surfaceArea( dp::math::Vec3f const & lower, dp::math::Vec3f const & upper )
+        {
+          dp::math::Vec3f size = upper - lower;
+          return 2.0f * ( size[0] * size[1] + size[1] * size[2] + size[2] * size[0] );
+        }
+
+        inline void merge( dp::math::Vec3f & lower, dp::math::Vec3f & upper, dp::math::Vec3f const & otherLower, dp::math::Vec3f const & otherUpper )
+        {
+          for ( unsigned int i = 0; i < 3; ++i )
+          {
+            lower[i] = std::min( lower[i], otherLower[i] );
+            upper[i] = std::max( upper[i], otherUpper[i] );
+          }
+        }
+      } // namespace anonymous
+
+      BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+        : m_buildLeafArea( 0.0f )
+      {
+      }
+
+      void BoundingVolumeHierarchy::build( OBBArray const & obbs )
+      {
+        m_nodes.clear();
+        m_objectIndices.resize( obbs.size() );
+        for ( size_t index = 0; index < obbs.size(); ++index )
+        {
+          m_objectIndices[index] = dp::checked_cast<uint32_t>(index);
+        }
+
+        updateObjectBounds( obbs );
+
+        if ( obbs.size() )
+        {
+          // a balanced tree with LeafSize objects per leaf has less than 2 * n / LeafSize nodes
+          m_nodes.reserve( 2 * obbs.size() / LeafSize + 1 );
+          buildNode( 0, dp::checked_cast<uint32_t>(obbs.size()) );
+        }
+
+        updateNodeBounds();
+        m_buildLeafArea = computeLeafArea();
+      }
+
+      void BoundingVolumeHierarchy::refit( OBBArray const & obbs )
+      {
+        DP_ASSERT( obbs.size() == m_objectIndices.size() );
+
+        updateObjectBounds( obbs );
+        updateNodeBounds();
+
+        if ( computeLeafArea() > RebuildFactor * m_buildLeafArea )
+        {
+          build( obbs );
+        }
+      }
+
+      void BoundingVolumeHierarchy::updateObjectBounds( OBBArray const & obbs )
+      {
+        m_objectLower.resize( obbs.size() );
+        m_objectUpper.resize( obbs.size() );
+
+        for ( size_t index = 0; index < obbs.size(); ++index )
+        {
+          OBB const obb = obbs.get( index );
+          for ( unsigned int i = 0; i < 3; ++i )
+          {
+            m_objectLower[index][i] = obb.point[i] + std::min( obb.ex[i], 0.0f ) + std::min( obb.ey[i], 0.0f ) + std::min( obb.ez[i], 0.0f );
+            m_objectUpper[index][i] = obb.point[i] + std::max( obb.ex[i], 0.0f ) + std::max( obb.ey[i], 0.0f ) + std::max( obb.ez[i], 0.0f );
+          }
+        }
+      }
+
+      uint32_t BoundingVolumeHierarchy::buildNode( uint32_t begin, uint32_t end )
+      {
+        uint32_t nodeIndex = dp::checked_cast<uint32_t>(m_nodes.size());
+        m_nodes.push_back( Node() );
+        m_nodes[nodeIndex].begin = begin;
+        m_nodes[nodeIndex].end = end;
+        m_nodes[nodeIndex].secondChild = 0;
+
+        if ( end - begin > LeafSize )
+        {
+          // split at the median of the centroids along the axis with the largest centroid extent
+          dp::math::Vec3f centroidLower( std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() );
+          dp::math::Vec3f centroidUpper( -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() );
+          for ( uint32_t index = begin; index < end; ++index )
+          {
+            dp::math::Vec3f centroid = m_objectLower[m_objectIndices[index]] + m_objectUpper[m_objectIndices[index]];
+            merge( centroidLower, centroidUpper, centroid, centroid );
+          }
+
+          dp::math::Vec3f extent = centroidUpper - centroidLower;
+          unsigned int axis = ( extent[0] >= extent[1] && extent[0] >= extent[2] ) ? 0 : ( extent[1] >= extent[2] ? 1 : 2 );
+
+          uint32_t middle = begin + ( end - begin ) / 2;
+          std::nth_element( m_objectIndices.begin() + begin, m_objectIndices.begin() + middle, m_objectIndices.begin() + end
+                          , [this, axis]( uint32_t lhs, uint32_t rhs )
+                          {
+                            return m_objectLower[lhs][axis] + m_objectUpper[lhs][axis] < m_objectLower[rhs][axis] + m_objectUpper[rhs][axis];
+                          } );
+
+          buildNode( begin, middle );
+          uint32_t secondChild = buildNode( middle, end );
+          m_nodes[nodeIndex].secondChild = secondChild;
+        }
+
+        return nodeIndex;
+      }
+
+      void BoundingVolumeHierarchy::updateNodeBounds()
+      {
+        // children are always stored behind their parent, update bottom up
+        for ( size_t nodeIndex = m_nodes.size(); nodeIndex-- > 0; )
+        {
+          Node & node = m_nodes[nodeIndex];
+          if ( node.secondChild )
+          {
+            Node const & first = m_nodes[nodeIndex + 1];
+            Node const & second = m_nodes[node.secondChild];
+            node.lower = first.lower;
+            node.upper = first.upper;
+            merge( node.lower, node.upper, second.lower, second.upper );
+          }
+          else
+          {
+            node.lower = m_objectLower[m_objectIndices[node.begin]];
+            node.upper = m_objectUpper[m_objectIndices[node.begin]];
+            for ( uint32_t index = node.begin + 1; index < node.end; ++index )
+            {
+              merge( node.lower, node.upper, m_objectLower[m_objectIndices[index]], m_objectUpper[m_objectIndices[index]] );
+            }
+          }
+        }
+      }
+
+      float BoundingVolumeHierarchy::computeLeafArea() const
+      {
+        float area = 0.0f;
+        for ( std::vector<Node>::const_iterator it = m_nodes.begin(); it != m_nodes.end(); ++it )
+        {
+          if ( !it->secondChild )
+          {
+            area += surfaceArea( it->lower, it->upper );
+          }
+        }
+        return area;
+      }
+
+      void BoundingVolumeHierarchy::cull( dp::math::Mat44f const & viewProjection, OBBArray const & obbs, dp::util::BitArray & visible ) const
+      {
+        DP_ASSERT( obbs.size() == m_objectIndices.size() && visible.getSize() == obbs.size() );
+
+        visible.clear();
+        if ( m_nodes.empty() )
+        {
+          return;
+        }
+
+        // The nodes are classified in world space. A node is only accepted or rejected as a whole if its distance to the planes
+        // exceeds the rounding errors of the clip space test, so that it agrees with the tests of all objects it contains.
+        Frustum const frustum( viewProjection );
+
+        // the tree is balanced, 64 entries are sufficient for any 32-bit object count
+        uint32_t stack[64];
+        size_t stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while ( stackSize )
+        {
+          uint32_t nodeIndex = stack[--stackSize];
+          Node const & node = m_nodes[nodeIndex];
+
+          dp::math::Vec3f const center = 0.5f * ( node.lower + node.upper );
+          dp::math::Vec3f const halfSize = 0.5f * ( node.upper - node.lower );
+
+          // the objects of the node are at most |center| + |halfSize| away from the origin and have edges of at most 2 |halfSize|
+          float const error = frustum.getError( length( center ) + 4.0f * length( halfSize ) );
+
+          float lower[6];
+          bool inside = true;
+          bool outside = false;
+          for ( unsigned int plane = 0; plane < 6; ++plane )
+          {
+            dp::math::Vec3f const & normal = frustum.getNormal( plane );
+            float const distance = normal * center + frustum.getDistance( plane );
+            float const extent = std::abs( normal[0] ) * halfSize[0] + std::abs( normal[1] ) * halfSize[1] + std::abs( normal[2] ) * halfSize[2];
+            lower[plane] = distance - extent;
+
+            inside = inside && error < lower[plane];
+
+            // a corner gets the flag of an odd plane only if it is not outside of the even plane of the same axis
+            outside = outside || ( error < -( distance + extent ) && ( !( plane & 1 ) || error < lower[plane - 1] ) );
+          }
+
+          if ( outside )
+          {
+            // all corners are outside of one plane, the whole subtree is invisible
+            continue;
+          }
+
+          if ( inside )
+          {
+            // all corners are inside the frustum, the whole subtree is visible
+            for ( uint32_t index = node.begin; index < node.end; ++index )
+            {
+              visible.enableBit( m_objectIndices[index] );
+            }
+          }
+          else if ( node.secondChild )
+          {
+            DP_ASSERT( stackSize + 2 <= sizeof(stack) / sizeof(stack[0]) );
+            stack[stackSize++] = node.secondChild;
+            stack[stackSize++] = nodeIndex + 1;
+          }
+          else
+          {
+            for ( uint32_t index = node.begin; index < node.end; ++index )
+            {
+              uint32_t objectIndex = m_objectIndices[index];
+              if ( isVisible( viewProjection, obbs.get( objectIndex ) ) )
+              {
+                visible.enableBit( objectIndex );
+              }
+            }
+          }
+        }
+      }
+
+    } // namespace cpu
+  } // namespace culling
+} // namespace dp
@@ -0,0 +1,278 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <dp/culling/cpu/inc/CoherenceCache.h>
+#include <dp/culling/cpu/inc/OBB.h>
+#include <dp/util/BitArray.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace dp
+{
+  namespace culling
+  {
+    namespace cpu
+    {
+
+      namespace
+      {
+        // marks objects which have not been rejected by a single plane in the last frame
+        uint8_t const NoPlane = 0xff;
+
+        // the cached margins shrink by this factor each frame, which covers the rounding errors of the margin updates
+        float const MarginDecay = 1.0f - 1e-6f;
+
+        /** \brief Compute the clip space coordinate axis of the vector v the same way Vec4f * Mat44f does. **/
+        inline float transform( dp::math::Vec4f const & v, dp::math::Mat44f const & m, unsigned int axis )
+        {
+          float result = 0;
+          for ( unsigned int j = 0; j < 4; ++j )
+          {
+            result += v[j] * m[j][axis];
+          }
+          return result;
+        }
+
+        /** \brief Check if all corners of the OBB have the cull flag 1 << plane set. The operations are the same as in
+                   determineCullFlags, restricted to the two coordinates the plane depends on.
+        **/
+        inline bool isRejected( dp::math::Mat44f const & vp, OBB const & obb, unsigned int plane )
+        {
+          unsigned int const axis = plane / 2;
+
+          float a[8];
+          float w[8];
+          a[0] = transform( obb.point, vp, axis );
+          w[0] = transform( obb.point, vp, 3 );
+          float const ax = transform( obb.ex, vp, axis );
+          float const wx = transform( obb.ex, vp, 3 );
+          float const ay = transform( obb.ey, vp, axis );
+          float const wy = transform( obb.ey, vp, 3 );
+          float const az = transform( obb.ez, vp, axis );
+          float const wz = transform( obb.ez, vp, 3 );
+
+          a[1] = a[0] + ax; w[1] = w[0] + wx;
+          a[2] = a[0] + ay; w[2] = w[0] + wy;
+          a[3] = a[1] + ay; w[3] = w[1] + wy;
+          a[4] = a[0] + az; w[4] = w[0] + wz;
+          a[5] = a[1] + az; w[5] = w[1] + wz;
+          a[6] = a[2] + az; w[6] = w[2] + wz;
+          a[7] = a[3] + az; w[7] = w[3] + wz;
+
+          for ( unsigned int i = 0; i < 8; ++i )
+          {
+            bool const lower = a[i] <= -w[i];
+            if ( ( plane & 1 ) ? ( lower || !( w[i] <= a[i] ) ) : !lower )
+            {
+              return false;
+            }
+          }
+          return true;
+        }
+      } // namespace anonymous
+
+      CoherenceCache::CoherenceCache()
+        : m_normalMotion( FLT_MAX )
+        , m_distanceMotion( FLT_MAX )
+        , m_objectIncarnation( ~0 )
+        , m_generation( 0 )
+      {
+      }
+
+      void CoherenceCache::update( dp::math::Mat44f const & viewProjection, size_t stride, size_t objectIncarnation )
+      {
+        if ( objectIncarnation != m_objectIncarnation || stride != m_margins.size() )
+        {
+          m_rejectingPlanes.assign( stride, NoPlane );
+          m_margins.assign( stride, -1.0f );
+          m_radii.assign( stride, 0.0f );
+          m_objectIncarnation = objectIncarnation;
+        }
+
+        m_frustum = Frustum( viewProjection );
+
+        // A point x moves relative to a plane by at most |normal - previousNormal| * |x| + |distance - previousDistance|.
+        // The first frame has no valid margins, so the motion relative to the invalid previous frustum does not matter.
+        double normalMotion = 0.0;
+        double distanceMotion = 0.0;
+        for ( unsigned int plane = 0; plane < 6; ++plane )
+        {
+          double normalDelta = 0.0;
+          for ( unsigned int i = 0; i < 3; ++i )
+          {
+            double delta = double( m_frustum.getNormal( plane )[i] ) - double( m_previousFrustum.getNormal( plane )[i] );
+            normalDelta += delta * delta;
+          }
+          normalMotion = std::max( normalMotion, std::sqrt( normalDelta ) );
+          distanceMotion = std::max( distanceMotion, std::abs( double( m_frustum.getDistance( plane ) ) - double( m_previousFrustum.getDistance( plane ) ) ) );
+        }
+
+        // round the bounds up, so that they stay conservative in single precision
+        double const RoundUp = 1.0 + 1e-6;
+        m_normalMotion = float( std::min( normalMotion * RoundUp, double( FLT_MAX ) ) );
+        m_distanceMotion = float( std::min( distanceMotion * RoundUp, double( FLT_MAX ) ) );
+      }
+
+      void CoherenceCache::cull( float const* obbs, size_t stride, uint32_t const* generations, dp::math::Mat44f const & viewProjection
+                               , size_t beginWord, size_t endWord, uint32_t* visibility )
+      {
+        DP_ASSERT( 32 * endWord <= m_margins.size() );
+
+        for ( size_t word = beginWord; word < endWord; ++word )
+        {
+          size_t const beginIndex = word * 32;
+
+          // An object which has been far enough inside of the frustum or outside of its rejecting plane keeps its visibility
+          // as long as the planes did not move too far. This loop does not touch the OBBs and has no branches.
+          uint32_t decided = 0;
+          uint32_t bits = 0;
+          for ( size_t i = 0; i < 32; ++i )
+          {
+            size_t const index = beginIndex + i;
+            float const margin = m_margins[index] * MarginDecay - ( m_normalMotion * m_radii[index] + m_distanceMotion );
+            bool const valid = 0.0f < margin && generations[index] <= m_generation;
+            m_margins[index] = valid ? margin : -1.0f;
+            decided |= uint32_t( valid ) << i;
+            bits |= uint32_t( valid && m_rejectingPlanes[index] == NoPlane ) << i;
+          }
+
+          for ( uint32_t undecided = ~decided; undecided; undecided &= undecided - 1 )
+          {
+            size_t const i = dp::util::ctz( undecided );
+            bits |= uint32_t( testObject( beginIndex + i, obbs, stride, viewProjection ) ) << i;
+          }
+          visibility[word] = bits;
+        }
+      }
+
+      bool CoherenceCache::testObject( size_t index, float const* obbs, size_t stride, dp::math::Mat44f const & viewProjection )
+      {
+        OBB obb;
+        for ( unsigned int i = 0; i < 4; ++i )
+        {
+          obb.point[i] = obbs[(OBBArray::POINT_X + i) * stride + index];
+          obb.ex[i] = obbs[(OBBArray::EX_X + i) * stride + index];
+          obb.ey[i] = obbs[(OBBArray::EY_X + i) * stride + index];
+          obb.ez[i] = obbs[(OBBArray::EZ_X + i) * stride + index];
+        }
+
+        // the plane which rejected the object in the last frame most likely rejects it again
+        uint8_t const rejectingPlane = m_rejectingPlanes[index];
+        if ( rejectingPlane != NoPlane && isRejected( viewProjection, obb, rejectingPlane ) )
+        {
+          updateMargin( index, obb, 1 << rejectingPlane );
+          return false;
+        }
+
+        unsigned int cfo;
+        unsigned int cfa;
+        determineCullFlags( obb.point * viewProjection, obb.ex * viewProjection, obb.ey * viewProjection, obb.ez * viewProjection, cfo, cfa );
+
+        if ( cfa )
+        {
+          m_rejectingPlanes[index] = dp::checked_cast<uint8_t>( dp::util::ctz( uint32_t( cfa ) ) );
+          updateMargin( index, obb, cfa );
+          return false;
+        }
+
+        m_rejectingPlanes[index] = NoPlane;
+        if ( !cfo )
+        {
+          updateMargin( index, obb, 0 );
+        }
+        return true;
+      }
+
+      void CoherenceCache::updateMargin( size_t index, OBB const & obb, unsigned int rejectingPlanes )
+      {
+        // the margins are computed in world space, which requires an affine OBB
+        if ( obb.point[3] != 1.0f || obb.ex[3] != 0.0f || obb.ey[3] != 0.0f || obb.ez[3] != 0.0f )
+        {
+          return;
+        }
+
+        dp::math::Vec3f const ex( obb.ex[0], obb.ex[1], obb.ex[2] );
+        dp::math::Vec3f const ey( obb.ey[0], obb.ey[1], obb.ey[2] );
+        dp::math::Vec3f const ez( obb.ez[0], obb.ez[1], obb.ez[2] );
+        dp::math::Vec3f const center = dp::math::Vec3f( obb.point[0], obb.point[1], obb.point[2] ) + 0.5f * ( ex + ey + ez );
+
+        // signed distances of the box to the planes, positive inside of the frustum
+        float lower[6];
+        float upper[6];
+        for ( unsigned int plane = 0; plane < 6; ++plane )
+        {
+          dp::math::Vec3f const & normal = m_frustum.getNormal( plane );
+          float const distance = normal * center + m_frustum.getDistance( plane );
+          float const extent = 0.5f * ( std::abs( normal * ex ) + std::abs( normal * ey ) + std::abs( normal * ez ) );
+          lower[plane] = distance - extent;
+          upper[plane] = distance + extent;
+        }
+
+        float margin = -FLT_MAX;
+        if ( rejectingPlanes )
+        {
+          // A corner gets the flag of an odd plane only if it is not outside of the even plane of the same axis, so the
+          // box has to stay inside of that plane as well. Keep the plane which rejects the box with the largest margin.
+          for ( unsigned int plane = 0; plane < 6; ++plane )
+          {
+            if ( rejectingPlanes & ( 1 << plane ) )
+            {
+              float planeMargin = ( plane & 1 ) ? std::min( -upper[plane], lower[plane - 1] ) : -upper[plane];
+              if ( margin < planeMargin )
+              {
+                margin = planeMargin;
+                m_rejectingPlanes[index] = dp::checked_cast<uint8_t>( plane );
+              }
+            }
+          }
+        }
+        else
+        {
+          for ( unsigned int plane = 0; plane < 6; ++plane )
+          {
+            margin = ( plane == 0 ) ? lower[plane] : std::min( margin, lower[plane] );
+          }
+        }
+
+        float const radius = length( center ) + 0.5f * ( length( ex ) + length( ey ) + length( ez ) );
+        float const error = m_frustum.getError( radius );
+        if ( error < margin )
+        {
+          m_margins[index] = margin - error;
+          m_radii[index] = radius;
+        }
+      }
+
+      void CoherenceCache::finish( uint32_t generation )
+      {
+        m_generation = generation;
+        m_previousFrustum = m_frustum;
+      }
+
+    } // namespace cpu
+  } // namespace culling
+} // namespace dp
@@ -0,0 +1,181 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <dp/culling/cpu/inc/CullingKernels.h>
+#include <dp/culling/cpu/inc/OBB.h>
+#include <stdexcept>
+
+#if defined(DP_ARCH_X86_64) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace dp
+{
+  namespace culling
+  {
+    namespace cpu
+    {
+
+      namespace
+      {
+
+        bool isSSE4_1Supported()
+        {
+#if defined(DP_CULLING_CPU_SSE4_1)
+#if defined(_MSC_VER)
+          int info[4];
+          __cpuid( info, 1 );
+          return !!( info[2] & ( 1 << 19 ) );
+#else
+          __builtin_cpu_init();
+          return !!__builtin_cpu_supports( "sse4.1" );
+#endif
+#else
+          return false;
+#endif
+        }
+
+        bool isAVX2Supported()
+        {
+#if defined(DP_CULLING_CPU_AVX2)
+#if defined(_MSC_VER)
+          int info[4];
+          __cpuid( info, 1 );
+          bool osxsave = !!( info[2] & ( 1 << 27 ) );
+          bool avx = !!( info[2] & ( 1 << 28 ) );
+          if ( !osxsave || !avx || ( _xgetbv( 0 ) & 0x6 ) != 0x6 )
+          {
+            // the OS does not save the ymm registers
+            return false;
+          }
+          __cpuidex( info, 7, 0 );
+          return !!( info[1] & ( 1 << 5 ) );
+#else
+          __builtin_cpu_init();
+          return !!__builtin_cpu_supports( "avx2" );
+#endif
+#else
+          return false;
+#endif
+        }
+
+      } // namespace anonymous
+
+      void cullScalar( float const* obbs, size_t stride, float const* viewProjection
+                     , size_t beginWord, size_t endWord, uint32_t* visibility )
+      {
+        dp::math::Mat44f const & vp = *reinterpret_cast<dp::math::Mat44f const*>( viewProjection );
+
+        for ( size_t word = beginWord; word < endWord; ++word )
+        {
+          size_t const beginIndex = word * 32;
+
+          uint32_t bits = 0;
+          for ( size_t index = beginIndex; index < beginIndex + 32; ++index )
+          {
+            OBB obb;
+            for ( unsigned int i = 0; i < 4; ++i )
+            {
+              obb.point[i] = obbs[(OBBArray::POINT_X + i) * stride + index];
+              obb.ex[i] = obbs[(OBBArray::EX_X + i) * stride + index];
+              obb.ey[i] = obbs[(OBBArray::EY_X + i) * stride + index];
+              obb.ez[i] = obbs[(OBBArray::EZ_X + i) * stride + index];
+            }
+            bits |= uint32_t( isVisible( vp, obb ) ) << ( index - beginIndex );
+          }
+          visibility[word] = bits;
+        }
+      }
+
+      bool Manager::isInstructionSetSupported( InstructionSet instructionSet )
+      {
+        switch ( instructionSet )
+        {
+        case InstructionSet::AUTO:
+        case InstructionSet::SCALAR:
+          return true;
+        case InstructionSet::SSE4_1:
+          return isSSE4_1Supported();
+        case InstructionSet::AVX2:
+          return isAVX2Supported();
+        case InstructionSet::NEON:
+#if defined(DP_CULLING_CPU_NEON)
+          return true;
+#else
+          return false;
+#endif
+        default:
+          DP_ASSERT( !"unknown instruction set" );
+          return false;
+        }
+      }
+
+      Manager::InstructionSet resolveInstructionSet( Manager::InstructionSet instructionSet )
+      {
+        if ( instructionSet == Manager::InstructionSet::AUTO )
+        {
+          Manager::InstructionSet const preferred[] = { Manager::InstructionSet::AVX2, Manager::InstructionSet::SSE4_1, Manager::InstructionSet::NEON };
+          for ( size_t index = 0; index < sizeof(preferred) / sizeof(preferred[0]); ++index )
+          {
+            if ( Manager::isInstructionSetSupported( preferred[index] ) )
+            {
+              return preferred[index];
+            }
+          }
+          return Manager::InstructionSet::SCALAR;
+        }
+        return instructionSet;
+      }
+
+      CullingKernel getCullingKernel( Manager::InstructionSet instructionSet )
+      {
+        if ( !Manager::isInstructionSetSupported( instructionSet ) )
+        {
+          throw std::runtime_error( "culling instruction set not supported" );
+        }
+
+        switch ( resolveInstructionSet( instructionSet ) )
+        {
+#if defined(DP_CULLING_CPU_SSE4_1)
+        case Manager::InstructionSet::SSE4_1:
+          return &cullSSE4_1;
+#endif
+#if defined(DP_CULLING_CPU_AVX2)
+        case Manager::InstructionSet::AVX2:
+          return &cullAVX2;
+#endif
+#if defined(DP_CULLING_CPU_NEON)
+        case Manager::InstructionSet::NEON:
+          return &cullNEON;
+#endif
+        default:
+          return &cullScalar;
+        }
+      }
+
+    } // namespace cpu
+  } // namespace culling
+} // namespace dp
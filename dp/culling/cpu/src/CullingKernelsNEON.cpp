@@ -0,0 +1,138 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <dp/culling/cpu/inc/CullingKernels.h>
+
+#if defined(DP_CULLING_CPU_NEON)
+
+#include <arm_neon.h>
+
+namespace dp
+{
+  namespace culling
+  {
+    namespace cpu
+    {
+
+      namespace
+      {
+        inline void transformNEON( float32x4_t const* matrix, float32x4_t const x, float32x4_t const y, float32x4_t const z, float32x4_t const w, float32x4_t* result )
+        {
+          for ( unsigned int column = 0; column < 4; ++column )
+          {
+            // same order of operations as Vec4f * Mat44f, no multiply accumulate to get the same rounding as the scalar path
+            result[column] = vaddq_f32( vaddq_f32( vaddq_f32( vmulq_f32( x, matrix[column] ), vmulq_f32( y, matrix[4 + column] ) )
+                                                 , vmulq_f32( z, matrix[8 + column] ) )
+                                      , vmulq_f32( w, matrix[12 + column] ) );
+          }
+        }
+
+        inline void determineCullFlagsNEON( float32x4_t const* corner, uint32x4_t* cfa )
+        {
+          float32x4_t const negativeW = vnegq_f32( corner[3] );
+
+          for ( unsigned int axis = 0; axis < 3; ++axis )
+          {
+            uint32x4_t lower = vcleq_f32( corner[axis], negativeW );
+            uint32x4_t upper = vbicq_u32( vcleq_f32( corner[3], corner[axis] ), lower );
+            cfa[2 * axis] = vandq_u32( cfa[2 * axis], lower );
+            cfa[2 * axis + 1] = vandq_u32( cfa[2 * axis + 1], upper );
+          }
+        }
+
+        inline void addNEON( float32x4_t const* lhs, float32x4_t const* rhs, float32x4_t* result )
+        {
+          for ( unsigned int i = 0; i < 4; ++i )
+          {
+            result[i] = vaddq_f32( lhs[i], rhs[i] );
+          }
+        }
+
+        inline uint32_t moveMaskNEON( uint32x4_t mask )
+        {
+          static uint32_t const laneBits[4] = { 1, 2, 4, 8 };
+          uint32x4_t bits = vandq_u32( mask, vld1q_u32( laneBits ) );
+          uint32x2_t pairs = vorr_u32( vget_low_u32( bits ), vget_high_u32( bits ) );
+          return vget_lane_u32( pairs, 0 ) | vget_lane_u32( pairs, 1 );
+        }
+      } // namespace anonymous
+
+      void cullNEON( float const* obbs, size_t stride, float const* viewProjection
+                   , size_t beginWord, size_t endWord, uint32_t* visibility )
+      {
+        float32x4_t matrix[16];
+        for ( unsigned int i = 0; i < 16; ++i )
+        {
+          matrix[i] = vdupq_n_f32( viewProjection[i] );
+        }
+
+        for ( size_t word = beginWord; word < endWord; ++word )
+        {
+          uint32_t bits = 0;
+          for ( unsigned int lane = 0; lane < 32; lane += 4 )
+          {
+            float const* obb = obbs + word * 32 + lane;
+
+            float32x4_t corners[8][4];
+            float32x4_t x[4];
+            float32x4_t y[4];
+            float32x4_t z[4];
+            transformNEON( matrix, vld1q_f32( obb ), vld1q_f32( obb + stride ), vld1q_f32( obb + 2 * stride ), vld1q_f32( obb + 3 * stride ), corners[0] );
+            transformNEON( matrix, vld1q_f32( obb + 4 * stride ), vld1q_f32( obb + 5 * stride ), vld1q_f32( obb + 6 * stride ), vld1q_f32( obb + 7 * stride ), x );
+            transformNEON( matrix, vld1q_f32( obb + 8 * stride ), vld1q_f32( obb + 9 * stride ), vld1q_f32( obb + 10 * stride ), vld1q_f32( obb + 11 * stride ), y );
+            transformNEON( matrix, vld1q_f32( obb + 12 * stride ), vld1q_f32( obb + 13 * stride ), vld1q_f32( obb + 14 * stride ), vld1q_f32( obb + 15 * stride ), z );
+
+            addNEON( corners[0], x, corners[1] );
+            addNEON( corners[0], y, corners[2] );
+            addNEON( corners[1], y, corners[3] );
+            addNEON( corners[0], z, corners[4] );
+            addNEON( corners[1], z, corners[5] );
+            addNEON( corners[2], z, corners[6] );
+            addNEON( corners[3], z, corners[7] );
+
+            uint32x4_t cfa[6];
+            for ( unsigned int plane = 0; plane < 6; ++plane )
+            {
+              cfa[plane] = vdupq_n_u32( ~0u );
+            }
+            for ( unsigned int corner = 0; corner < 8; ++corner )
+            {
+              determineCullFlagsNEON( corners[corner], cfa );
+            }
+
+            // an object is invisible if all corners are outside of the same plane
+            uint32x4_t invisible = vorrq_u32( vorrq_u32( vorrq_u32( cfa[0], cfa[1] ), vorrq_u32( cfa[2], cfa[3] ) ), vorrq_u32( cfa[4], cfa[5] ) );
+            bits |= ( ~moveMaskNEON( invisible ) & 0xf ) << lane;
+          }
+          visibility[word] = bits;
+        }
+      }
+
+    } // namespace cpu
+  } // namespace culling
+} // namespace dp
+
+#endif
@@ -0,0 +1,134 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <dp/culling/cpu/inc/CullingKernels.h>
+
+#if defined(DP_CULLING_CPU_SSE4_1)
+
+#include <smmintrin.h>
+
+// This file is compiled with SSE4.1 code generation enabled. Use intrinsics and plain arrays only, inline functions
+// from shared headers instantiated here might otherwise be picked by the linker for callers in other translation units.
+
+namespace dp
+{
+  namespace culling
+  {
+    namespace cpu
+    {
+
+      namespace
+      {
+        inline void transformSSE4_1( __m128 const* matrix, __m128 const x, __m128 const y, __m128 const z, __m128 const w, __m128* result )
+        {
+          for ( unsigned int column = 0; column < 4; ++column )
+          {
+            // same order of operations as Vec4f * Mat44f
+            result[column] = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, matrix[column] ), _mm_mul_ps( y, matrix[4 + column] ) )
+                                                   , _mm_mul_ps( z, matrix[8 + column] ) )
+                                       , _mm_mul_ps( w, matrix[12 + column] ) );
+          }
+        }
+
+        inline void determineCullFlagsSSE4_1( __m128 const* corner, __m128* cfa )
+        {
+          __m128 const signMask = _mm_set1_ps( -0.0f );
+          __m128 const negativeW = _mm_xor_ps( corner[3], signMask );
+
+          for ( unsigned int axis = 0; axis < 3; ++axis )
+          {
+            __m128 lower = _mm_cmple_ps( corner[axis], negativeW );
+            __m128 upper = _mm_andnot_ps( lower, _mm_cmple_ps( corner[3], corner[axis] ) );
+            cfa[2 * axis] = _mm_and_ps( cfa[2 * axis], lower );
+            cfa[2 * axis + 1] = _mm_and_ps( cfa[2 * axis + 1], upper );
+          }
+        }
+
+        inline void addSSE4_1( __m128 const* lhs, __m128 const* rhs, __m128* result )
+        {
+          for ( unsigned int i = 0; i < 4; ++i )
+          {
+            result[i] = _mm_add_ps( lhs[i], rhs[i] );
+          }
+        }
+      } // namespace anonymous
+
+      void cullSSE4_1( float const* obbs, size_t stride, float const* viewProjection
+                     , size_t beginWord, size_t endWord, uint32_t* visibility )
+      {
+        __m128 matrix[16];
+        for ( unsigned int i = 0; i < 16; ++i )
+        {
+          matrix[i] = _mm_set1_ps( viewProjection[i] );
+        }
+
+        for ( size_t word = beginWord; word < endWord; ++word )
+        {
+          uint32_t bits = 0;
+          for ( unsigned int lane = 0; lane < 32; lane += 4 )
+          {
+            float const* obb = obbs + word * 32 + lane;
+
+            __m128 corners[8][4];
+            __m128 x[4];
+            __m128 y[4];
+            __m128 z[4];
+            transformSSE4_1( matrix, _mm_load_ps( obb ), _mm_load_ps( obb + stride ), _mm_load_ps( obb + 2 * stride ), _mm_load_ps( obb + 3 * stride ), corners[0] );
+            transformSSE4_1( matrix, _mm_load_ps( obb + 4 * stride ), _mm_load_ps( obb + 5 * stride ), _mm_load_ps( obb + 6 * stride ), _mm_load_ps( obb + 7 * stride ), x );
+            transformSSE4_1( matrix, _mm_load_ps( obb + 8 * stride ), _mm_load_ps( obb + 9 * stride ), _mm_load_ps( obb + 10 * stride ), _mm_load_ps( obb + 11 * stride ), y );
+            transformSSE4_1( matrix, _mm_load_ps( obb + 12 * stride ), _mm_load_ps( obb + 13 * stride ), _mm_load_ps( obb + 14 * stride ), _mm_load_ps( obb + 15 * stride ), z );
+
+            addSSE4_1( corners[0], x, corners[1] );
+            addSSE4_1( corners[0], y, corners[2] );
+            addSSE4_1( corners[1], y, corners[3] );
+            addSSE4_1( corners[0], z, corners[4] );
+            addSSE4_1( corners[1], z, corners[5] );
+            addSSE4_1( corners[2], z, corners[6] );
+            addSSE4_1( corners[3], z, corners[7] );
+
+            __m128 cfa[6];
+            for ( unsigned int plane = 0; plane < 6; ++plane )
+            {
+              cfa[plane] = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+            }
+            for ( unsigned int corner = 0; corner < 8; ++corner )
+            {
+              determineCullFlagsSSE4_1( corners[corner], cfa );
+            }
+
+            // an object is invisible if all corners are outside of the same plane
+            __m128 invisible = _mm_or_ps( _mm_or_ps( _mm_or_ps( cfa[0], cfa[1] ), _mm_or_ps( cfa[2], cfa[3] ) ), _mm_or_ps( cfa[4], cfa[5] ) );
+            bits |= uint32_t( ~_mm_movemask_ps( invisible ) & 0xf ) << lane;
+          }
+          visibility[word] = bits;
+        }
+      }
+
+    } // namespace cpu
+  } // namespace culling
+} // namespace dp
+
+#endif
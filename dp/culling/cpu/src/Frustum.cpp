@@ -0,0 +1,95 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <dp/culling/cpu/inc/Frustum.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace dp
+{
+  namespace culling
+  {
+    namespace cpu
+    {
+
+      namespace
+      {
+        // the rounding error of the clip space test of a corner is bounded by this many floating point operations
+        double const ErrorOperations = 32.0;
+      } // namespace anonymous
+
+      Frustum::Frustum()
+        : m_errorScale( FLT_MAX )
+      {
+        for ( unsigned int plane = 0; plane < 6; ++plane )
+        {
+          m_normals[plane] = dp::math::Vec3f( 0.0f, 0.0f, 0.0f );
+          m_distances[plane] = 0.0f;
+        }
+      }
+
+      Frustum::Frustum( dp::math::Mat44f const & viewProjection )
+      {
+        double errorScale = 0.0;
+        for ( unsigned int plane = 0; plane < 6; ++plane )
+        {
+          // the plane of the flag 1 << plane is w + x_axis > 0 for side 0 and w - x_axis > 0 for side 1
+          unsigned int const axis = plane / 2;
+          double const sign = ( plane & 1 ) ? -1.0 : 1.0;
+
+          double coefficients[4];
+          double magnitude = 0.0;
+          for ( unsigned int i = 0; i < 4; ++i )
+          {
+            coefficients[i] = double( viewProjection[i][3] ) + sign * double( viewProjection[i][axis] );
+            magnitude += std::abs( double( viewProjection[i][3] ) ) + std::abs( double( viewProjection[i][axis] ) );
+          }
+
+          double const length = std::sqrt( coefficients[0] * coefficients[0] + coefficients[1] * coefficients[1] + coefficients[2] * coefficients[2] );
+          if ( length == 0.0 )
+          {
+            // degenerated frustum, no decision in world space is possible
+            m_normals[plane] = dp::math::Vec3f( 0.0f, 0.0f, 0.0f );
+            m_distances[plane] = 0.0f;
+            errorScale = DBL_MAX;
+            continue;
+          }
+
+          m_normals[plane] = dp::math::Vec3f( float( coefficients[0] / length ), float( coefficients[1] / length ), float( coefficients[2] / length ) );
+          m_distances[plane] = float( coefficients[3] / length );
+
+          // The clip space coordinates of a vector v have an error of about FLT_EPSILON * |v| * magnitude. The corners of a box are the
+          // sum of four transformed vectors. Scaled by 1 / length this is the error in world space, which also covers the float
+          // evaluation of the world space distances.
+          errorScale = std::max( errorScale, magnitude / length );
+        }
+        m_errorScale = float( std::min( ErrorOperations * FLT_EPSILON * errorScale, double( FLT_MAX ) ) );
+      }
+
+    } // namespace cpu
+  } // namespace culling
+} // namespace dp
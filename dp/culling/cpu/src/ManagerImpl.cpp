@@ -26,35 +26,18 @@
 
 #include <dp/culling/cpu/Manager.h>
 #include <dp/culling/cpu/inc/ManagerImpl.h>
+#include <dp/culling/cpu/inc/BoundingVolumeHierarchy.h>
+#include <dp/culling/cpu/inc/CoherenceCache.h>
+#include <dp/culling/cpu/inc/CullingKernels.h>
+#include <dp/culling/cpu/inc/OBB.h>
 #include <dp/culling/GroupBitSet.h>
 #include <dp/culling/ObjectBitSet.h>
 #include <dp/culling/ResultBitSet.h>
 #include <dp/util/FrameProfiler.h>
-
-// TODO figure out alignment issues on linux
-#if defined(DP_ARCH_X86_64) && defined(DP_OS_WINDOWS)
-  #define SSE
-#endif
-
-#if defined(SSE)
-#include <dp/math/sse/Vecnt.h>
-#include <dp/math/sse/Matmnt.h>
-static bool useSSE = true;
-#else
-static bool useSSE = false;
-#endif
-
-#if defined(DP_ARCH_ARM_32)
-//#define NEON
-#endif
-
-#if defined(NEON)
-#include <dp/math/neon/Vecnt.h>
-#include <dp/math/neon/Matmnt.h>
-static bool useNEON = true;
-#else
-static bool useNEON = false;
-#endif
+#include <algorithm>
+#include <bitset>
+#include <cfloat>
+#include <stdexcept>
 
 namespace dp
 {
@@ -65,17 +48,58 @@ namespace dp
 
       namespace {
 
-        struct OBB
+        // The visibility of a group is written in chunks of one cache line to avoid false sharing between threads
+        size_t const CacheLineSize = 64;
+        size_t const WordsPerChunk = CacheLineSize / sizeof(uint32_t);
+        size_t const ObjectsPerChunk = WordsPerChunk * 32;
+
+        // number of chunks culled by one task of the worker pool
+        size_t const ChunksPerTask = 8;
+
+        // the culling kernels may process all objects of a chunk
+        DP_STATIC_ASSERT( OBBArray::Granularity % ObjectsPerChunk == 0 );
+
+        /************************************************************************/
+        /* OccluderCPU                                                          */
+        /************************************************************************/
+        DEFINE_PTR_TYPES( OccluderCPU );
+
+        class OccluderCPU : public Occluder
         {
-          dp::math::Vec4f point;
-          dp::math::Vec4f ex;
-          dp::math::Vec4f ey;
-          dp::math::Vec4f ez;
+        public:
+          static OccluderCPUSharedPtr create( dp::math::Vec3f const* vertices, size_t vertexCount, uint32_t const* indices, size_t indexCount );
+
+          std::vector<dp::math::Vec3f> const & getVertices() const { return m_vertices; }
+          std::vector<uint32_t> const & getIndices() const { return m_indices; }
+
+          void setTransformIndex( size_t transformIndex ) { m_transformIndex = transformIndex; }
+          size_t getTransformIndex() const { return m_transformIndex; }
+
+        protected:
+          OccluderCPU( dp::math::Vec3f const* vertices, size_t vertexCount, uint32_t const* indices, size_t indexCount );
+
+        private:
+          std::vector<dp::math::Vec3f> m_vertices;
+          std::vector<uint32_t>        m_indices;
+          size_t                       m_transformIndex;
         };
 
+        OccluderCPUSharedPtr OccluderCPU::create( dp::math::Vec3f const* vertices, size_t vertexCount, uint32_t const* indices, size_t indexCount )
+        {
+          return( std::shared_ptr<OccluderCPU>( new OccluderCPU( vertices, vertexCount, indices, indexCount ) ) );
+        }
+
+        OccluderCPU::OccluderCPU( dp::math::Vec3f const* vertices, size_t vertexCount, uint32_t const* indices, size_t indexCount )
+          : m_vertices( vertices, vertices + vertexCount )
+          , m_indices( indices, indices + indexCount - indexCount % 3 )
+          , m_transformIndex( 0 )
+        {
+        }
+
         /************************************************************************/
         /* GroupCPU                                                             */
-        /* This group stores the cached OBB for each object                     */
+        /* This group stores the cached OBB for each object in a structure of   */
+        /* arrays. Changed matrices update only the OBBs of their objects.      */
         /************************************************************************/
         DEFINE_PTR_TYPES( GroupCPU );
 
@@ -85,14 +109,49 @@ namespace dp
           static GroupCPUSharedPtr create();
           void updateOBBs();
 
-          std::vector<OBB> const & getOBBs() const;
+          /** \brief Build or refit the hierarchy for the current OBBs. Call updateOBBs first. **/
+          void updateBoundingVolumeHierarchy();
+
+          OBBArray const & getOBBArray() const;
+
+          /** \brief Get the generation of the OBBs, which is incremented each time updateOBBs changes an OBB. **/
+          uint32_t getOBBGeneration() const;
+
+          /** \brief Get the generation of the last change of each OBB, padded like the OBBArray. **/
+          uint32_t const* getOBBGenerations() const;
+
+          /** \brief Get cache line aligned storage for one visibility bit per object, padded to a multiple of ObjectsPerChunk. **/
+          uint32_t* getVisibility();
+          BoundingVolumeHierarchy const & getBoundingVolumeHierarchy() const;
+
+          void addOccluder( OccluderCPUSharedPtr const & occluder );
+          void removeOccluder( OccluderCPUSharedPtr const & occluder );
+          std::vector<OccluderCPUSharedPtr> const & getOccluders() const;
 
         protected:
           GroupCPU();
 
         private:
-          std::vector<OBB> m_obbs;
-          size_t m_objectIncarnationOBB;
+          void updateOBB( size_t index, char const* basePtr, size_t matricesStride );
+          void updateTransformObjects();
+
+        private:
+          OBBArray              m_obbArray;
+          size_t                m_objectIncarnationOBB;
+          uint32_t              m_obbGeneration;
+          std::vector<uint32_t> m_obbGenerations;
+
+          // The objects using transform t are m_transformObjects[m_transformObjectsBegin[t]] to m_transformObjects[m_transformObjectsBegin[t + 1] - 1]
+          std::vector<uint32_t> m_transformObjectsBegin;
+          std::vector<uint32_t> m_transformObjects;
+
+          BoundingVolumeHierarchy m_boundingVolumeHierarchy;
+          size_t                  m_objectIncarnationBVH;
+          bool                    m_bvhDirty;
+
+          std::vector<uint32_t>   m_visibility;
+
+          std::vector<OccluderCPUSharedPtr> m_occluders;
         };
 
         GroupCPUSharedPtr GroupCPU::create()
@@ -103,61 +162,267 @@ namespace dp
         GroupCPU::GroupCPU()
           : GroupBitSet()
           , m_objectIncarnationOBB( m_objectIncarnation - 1)
+          , m_obbGeneration( 0 )
+          , m_objectIncarnationBVH( m_objectIncarnation - 1)
+          , m_bvhDirty( true )
+        {
+        }
+
+        uint32_t* GroupCPU::getVisibility()
+        {
+          size_t chunkCount = ( m_objects.size() + ObjectsPerChunk - 1 ) / ObjectsPerChunk;
+
+          // one additional chunk to be able to align the start to a cache line
+          m_visibility.resize( ( chunkCount + 1 ) * WordsPerChunk );
+
+          size_t address = reinterpret_cast<size_t>( m_visibility.data() );
+          return reinterpret_cast<uint32_t*>( ( address + CacheLineSize - 1 ) & ~( CacheLineSize - 1 ) );
+        }
+
+        OBBArray const & GroupCPU::getOBBArray() const
+        {
+          return m_obbArray;
+        }
+
+        uint32_t GroupCPU::getOBBGeneration() const
+        {
+          return m_obbGeneration;
+        }
+
+        uint32_t const* GroupCPU::getOBBGenerations() const
+        {
+          return m_obbGenerations.data();
+        }
+
+        BoundingVolumeHierarchy const & GroupCPU::getBoundingVolumeHierarchy() const
         {
+          return m_boundingVolumeHierarchy;
         }
 
-        std::vector<OBB> const & GroupCPU::getOBBs() const
+        void GroupCPU::addOccluder( OccluderCPUSharedPtr const & occluder )
         {
-          return m_obbs;
+          DP_ASSERT( std::find( m_occluders.begin(), m_occluders.end(), occluder ) == m_occluders.end() );
+          m_occluders.push_back( occluder );
+        }
+
+        void GroupCPU::removeOccluder( OccluderCPUSharedPtr const & occluder )
+        {
+          std::vector<OccluderCPUSharedPtr>::iterator it = std::find( m_occluders.begin(), m_occluders.end(), occluder );
+          DP_ASSERT( it != m_occluders.end() );
+          if ( it != m_occluders.end() )
+          {
+            m_occluders.erase( it );
+          }
+        }
+
+        std::vector<OccluderCPUSharedPtr> const & GroupCPU::getOccluders() const
+        {
+          return m_occluders;
+        }
+
+        void GroupCPU::updateBoundingVolumeHierarchy()
+        {
+          if ( m_objectIncarnationBVH != m_objectIncarnation )
+          {
+            m_boundingVolumeHierarchy.build( m_obbArray );
+            m_objectIncarnationBVH = m_objectIncarnation;
+            m_bvhDirty = false;
+          }
+          else if ( m_bvhDirty )
+          {
+            m_boundingVolumeHierarchy.refit( m_obbArray );
+            m_bvhDirty = false;
+          }
+        }
+
+        void GroupCPU::updateOBB( size_t index, char const* basePtr, size_t matricesStride )
+        {
+          ObjectBitSetSharedPtr const & objectImpl = getObject( index );
+          dp::math::Mat44f const & modelView = reinterpret_cast<dp::math::Mat44f const &>(*(basePtr + objectImpl->getTransformIndex() * matricesStride) );
+
+          OBB obb;
+          obb.point = objectImpl->getLowerLeft() * modelView;
+
+          dp::math::Vec4f const & extent = objectImpl->getExtent();
+
+          obb.ex = extent[0] * modelView[0];
+          obb.ey = extent[1] * modelView[1];
+          obb.ez = extent[2] * modelView[2];
+
+          m_obbArray.set( index, obb );
+        }
+
+        void GroupCPU::updateTransformObjects()
+        {
+          // counting sort of the object indices by transform index. Objects referencing a matrix
+          // which does not exist yet are updated by the full update once the matrices have been set.
+          size_t const matricesCount = getMatricesCount();
+          m_transformObjectsBegin.assign( matricesCount + 1, 0 );
+          for ( size_t index = 0; index < m_objects.size(); ++index )
+          {
+            size_t transformIndex = getObject( index )->getTransformIndex();
+            if ( transformIndex < matricesCount )
+            {
+              ++m_transformObjectsBegin[transformIndex + 1];
+            }
+          }
+
+          for ( size_t transformIndex = 0; transformIndex < matricesCount; ++transformIndex )
+          {
+            m_transformObjectsBegin[transformIndex + 1] += m_transformObjectsBegin[transformIndex];
+          }
+
+          m_transformObjects.resize( m_transformObjectsBegin.back() );
+          std::vector<uint32_t> position( m_transformObjectsBegin.begin(), m_transformObjectsBegin.end() - 1 );
+          for ( size_t index = 0; index < m_objects.size(); ++index )
+          {
+            size_t transformIndex = getObject( index )->getTransformIndex();
+            if ( transformIndex < matricesCount )
+            {
+              m_transformObjects[position[transformIndex]++] = dp::checked_cast<uint32_t>(index);
+            }
+          }
         }
 
         void GroupCPU::updateOBBs()
         {
           m_obbDirty |= (m_objectIncarnationOBB != m_objectIncarnation);
 
+          char const* basePtr = reinterpret_cast<char const*>( getMatrices() );
+          size_t matricesStride = getMatricesStride();
+
           if ( m_obbDirty )
           {
-            m_obbs.resize( m_objects.size() );
-
-            char const* basePtr = reinterpret_cast<char const*>( getMatrices() );
-            size_t matricesStride = getMatricesStride();
+            m_obbArray.resize( m_objects.size() );
 
             for ( size_t index = 0; index < m_objects.size();++index )
             {
-              OBB &obb = m_obbs[index];
-              ObjectBitSetSharedPtr const & objectImpl = getObject( index );
-              dp::math::Mat44f const & modelView = reinterpret_cast<dp::math::Mat44f const &>(*(basePtr + objectImpl->getTransformIndex() * matricesStride) );
-
-              obb.point = m_objects[index]->getLowerLeft() * modelView;
+              updateOBB( index, basePtr, matricesStride );
+            }
+            updateTransformObjects();
 
-              dp::math::Vec4f const & extent = m_objects[index]->getExtent();
+            ++m_obbGeneration;
+            m_obbGenerations.assign( m_obbArray.getStride(), m_obbGeneration );
 
-#if defined(SSE)
-              if ( useSSE )
+            m_objectIncarnationOBB = m_objectIncarnation;
+            m_obbDirty = false;
+            m_bvhDirty = true;
+          }
+          else
+          {
+            // only the objects referencing a changed matrix need a new OBB
+            uint32_t const generation = m_obbGeneration + 1;
+            m_dirtyMatrices.traverseBits( [&]( size_t transformIndex )
+            {
+              DP_ASSERT( transformIndex + 1 < m_transformObjectsBegin.size() );
+              for ( uint32_t i = m_transformObjectsBegin[transformIndex]; i < m_transformObjectsBegin[transformIndex + 1]; ++i )
               {
-                reinterpret_cast<dp::math::sse::Vec4f&>(obb.ex) = extent[0] * reinterpret_cast<dp::math::sse::Vec4f const&>(modelView[0]);
-                reinterpret_cast<dp::math::sse::Vec4f&>(obb.ey) = extent[1] * reinterpret_cast<dp::math::sse::Vec4f const&>(modelView[1]);
-                reinterpret_cast<dp::math::sse::Vec4f&>(obb.ez) = extent[2] * reinterpret_cast<dp::math::sse::Vec4f const&>(modelView[2]);
+                updateOBB( m_transformObjects[i], basePtr, matricesStride );
+                m_obbGenerations[m_transformObjects[i]] = generation;
+                m_obbGeneration = generation;
+                m_bvhDirty = true;
               }
-              else
-#elif defined(NEON)
-                if ( useNEON )
-                {
-                  reinterpret_cast<dp::math::neon::Vec4f&>(obb.ex) = extent[0] * reinterpret_cast<dp::math::neon::Vec4f const&>(modelView[0]);
-                  reinterpret_cast<dp::math::neon::Vec4f&>(obb.ey) = extent[1] * reinterpret_cast<dp::math::neon::Vec4f const&>(modelView[1]);
-                  reinterpret_cast<dp::math::neon::Vec4f&>(obb.ez) = extent[2] * reinterpret_cast<dp::math::neon::Vec4f const&>(modelView[2]);
-                }
-                else
-#endif
+            } );
+          }
+          m_dirtyMatrices.clear();
+        }
+
+        /************************************************************************/
+        /* ResultCPU                                                            */
+        /* This result stores the temporal coherence data of its view           */
+        /************************************************************************/
+        DEFINE_PTR_TYPES( ResultCPU );
+
+        class ResultCPU : public ResultBitSet
+        {
+        public:
+          static ResultCPUSharedPtr create( GroupBitSetSharedPtr const & parentGroup );
+
+          CoherenceCache & getCoherenceCache();
+
+        protected:
+          ResultCPU( GroupBitSetSharedPtr const & parentGroup );
+
+        private:
+          CoherenceCache m_coherenceCache;
+        };
+
+        ResultCPUSharedPtr ResultCPU::create( GroupBitSetSharedPtr const & parentGroup )
+        {
+          return( std::shared_ptr<ResultCPU>( new ResultCPU( parentGroup ) ) );
+        }
+
+        ResultCPU::ResultCPU( GroupBitSetSharedPtr const & parentGroup )
+          : ResultBitSet( parentGroup )
+        {
+        }
+
+        CoherenceCache & ResultCPU::getCoherenceCache()
+        {
+          return m_coherenceCache;
+        }
+
+        /************************************************************************/
+        /* Small feature culling                                                */
+        /************************************************************************/
+
+        /** \brief Compute the area in pixels of the screen space bounding rectangle of an OBB.
+            \return The area or FLT_MAX if a corner of the OBB is not in front of the eye.
+        **/
+        float getPixelArea( OBB const & obb, dp::math::Mat44f const & viewProjection, dp::math::Vec2ui const & viewportSize )
+        {
+          dp::math::Vec4f corners[8];
+          corners[0] = obb.point * viewProjection;
+          dp::math::Vec4f const x = obb.ex * viewProjection;
+          dp::math::Vec4f const y = obb.ey * viewProjection;
+          dp::math::Vec4f const z = obb.ez * viewProjection;
+          corners[1] = corners[0] + x;
+          corners[2] = corners[0] + y;
+          corners[3] = corners[1] + y;
+          corners[4] = corners[0] + z;
+          corners[5] = corners[1] + z;
+          corners[6] = corners[2] + z;
+          corners[7] = corners[3] + z;
+
+          float minX = FLT_MAX;
+          float maxX = -FLT_MAX;
+          float minY = FLT_MAX;
+          float maxY = -FLT_MAX;
+          for ( unsigned int i = 0; i < 8; ++i )
+          {
+            if ( !( 0.0f < corners[i][3] ) )
+            {
+              return FLT_MAX;
+            }
+            float const invW = 1.0f / corners[i][3];
+            minX = std::min( minX, corners[i][0] * invW );
+            maxX = std::max( maxX, corners[i][0] * invW );
+            minY = std::min( minY, corners[i][1] * invW );
+            maxY = std::max( maxY, corners[i][1] * invW );
+          }
+
+          // the rectangle is not clipped to the viewport, so the area of an object does not change when it leaves the screen
+          return ( maxX - minX ) * 0.5f * viewportSize[0] * ( maxY - minY ) * 0.5f * viewportSize[1];
+        }
+
+        /** \brief Clear the visibility bit of all visible objects in the words [beginWord, endWord) which cover
+                   less than minimumPixelArea pixels.
+        **/
+        void cullSmallFeatures( OBBArray const & obbArray, dp::math::Mat44f const & viewProjection, dp::math::Vec2ui const & viewportSize
+                              , float minimumPixelArea, size_t beginWord, size_t endWord, uint32_t* visibility )
+        {
+          for ( size_t word = beginWord; word < endWord; ++word )
+          {
+            uint32_t bits = visibility[word];
+            for ( uint32_t remaining = bits; remaining; remaining &= remaining - 1 )
+            {
+              size_t const i = dp::util::ctz( remaining );
+              if ( getPixelArea( obbArray.get( word * 32 + i ), viewProjection, viewportSize ) < minimumPixelArea )
               {
-                obb.ex = extent[0] * modelView[0];
-                obb.ey = extent[1] * modelView[1];
-                obb.ez = extent[2] * modelView[2];
+                bits &= ~( 1u << i );
               }
             }
-
-            m_objectIncarnationOBB = m_objectIncarnation;
-            m_obbDirty = false;
+            visibility[word] = bits;
           }
         }
 
@@ -167,13 +432,22 @@ namespace dp
       /* ManagerImpl                                                          */
       /************************************************************************/
 
-      Manager* Manager::create()
+      Manager* Manager::create( Algorithm algorithm )
       {
-        return new ManagerImpl;
+        return new ManagerImpl( algorithm );
       }
 
-      ManagerImpl::ManagerImpl()
+      ManagerImpl::ManagerImpl( Algorithm algorithm )
+        : m_algorithm( algorithm )
+        , m_threadCount( 0 )
+        , m_instructionSet( InstructionSet::AUTO )
+        , m_cullingKernel( getCullingKernel( InstructionSet::AUTO ) )
+        , m_temporalCoherence( false )
       {
+        m_occlusionBuffer.resize( 256, 128 );
+        m_occlusionStatistics.rasterizedTriangles = 0;
+        m_occlusionStatistics.testedObjects = 0;
+        m_occlusionStatistics.occludedObjects = 0;
       }
 
       ManagerImpl::~ManagerImpl()
@@ -193,328 +467,286 @@ namespace dp
 
       ResultSharedPtr ManagerImpl::groupCreateResult( GroupSharedPtr const& group )
       {
-        return ResultBitSet::create(std::static_pointer_cast<GroupBitSet>(group));
+        return ResultCPU::create(std::static_pointer_cast<GroupBitSet>(group));
       }
 
-      inline void determineCullFlags( const dp::math::Vec4f &p, unsigned int & cfo, unsigned int & cfa )
+      void ManagerImpl::setAlgorithm( Algorithm algorithm )
       {
-        unsigned int cf = 0;
-
-        if ( p[0] <= -p[3] )
-        {
-          cf |= 0x01;
-        }
-        else if ( p[3] <= p[0] )
-        {
-          cf |= 0x02;
-        }
-        if ( p[1] <= -p[3] )
-        {
-          cf |= 0x04;
-        }
-        else if ( p[3] <= p[1] )
-        {
-          cf |= 0x08;
-        }
-        if ( p[2] <= -p[3] )
-        {
-          cf |= 0x10;
-        }
-        else if ( p[3] <= p[2] )
-        {
-          cf |= 0x20;
-        }
-        cfo |= cf;
-        cfa &= cf;
+        m_algorithm = algorithm;
       }
 
-      inline bool isVisible( const dp::math::Mat44f& projection, const dp::math::Mat44f &modelView, const dp::math::Vec4f &lower, const dp::math::Vec4f &extent)
+      Manager::Algorithm ManagerImpl::getAlgorithm() const
       {
-        unsigned int cfo = 0;
-        unsigned int cfa = ~0;
-
-        dp::math::Vec4f vectors[8];
-        vectors[0] = (lower * modelView) * projection;
-
-        dp::math::Vec4f x( extent[0] * modelView[0] );
-        dp::math::Vec4f y( extent[1] * modelView[1] );
-        dp::math::Vec4f z( extent[2] * modelView[2] );
-
-        x = x * projection;
-        y = y * projection;
-        z = z * projection;
-
-        vectors[1] = vectors[0] + x;
-        vectors[2] = vectors[0] + y;
-        vectors[3] = vectors[1] + y;
-        vectors[4] = vectors[0] + z;
-        vectors[5] = vectors[1] + z;
-        vectors[6] = vectors[2] + z;
-        vectors[7] = vectors[3] + z;
+        return m_algorithm;
+      }
 
-        for ( unsigned int i = 0;i < 8; ++i )
+      dp::util::WorkerPoolSharedPtr const & ManagerImpl::getWorkerPool()
+      {
+        if ( m_threadCount != 1 && !m_workerPool )
         {
-          determineCullFlags( vectors[i], cfo, cfa );
+          m_workerPool = dp::util::WorkerPool::create( m_threadCount );
         }
-
-        return !cfo || !cfa;
+        return m_workerPool;
       }
 
-      inline bool isVisible( const dp::math::Mat44f& projection, OBB const & obb)
+      void ManagerImpl::setThreadCount( unsigned int threadCount )
       {
-        unsigned int cfo = 0;
-        unsigned int cfa = ~0;
-
-        dp::math::Vec4f vectors[8];
-        vectors[0] = obb.point * projection;
-
-        dp::math::Vec4f x = obb.ex * projection;
-        dp::math::Vec4f y = obb.ey * projection;
-        dp::math::Vec4f z = obb.ez * projection;
-
-        vectors[1] = vectors[0] + x;
-        vectors[2] = vectors[0] + y;
-        vectors[3] = vectors[1] + y;
-        vectors[4] = vectors[0] + z;
-        vectors[5] = vectors[1] + z;
-        vectors[6] = vectors[2] + z;
-        vectors[7] = vectors[3] + z;
-
-        for ( unsigned int i = 0;i < 8; ++i )
+        if ( threadCount != m_threadCount )
         {
-          determineCullFlags( vectors[i], cfo, cfa );
+          m_threadCount = threadCount;
+          m_workerPool.reset();
         }
+      }
 
-        return !cfo || !cfa;
+      unsigned int ManagerImpl::getThreadCount() const
+      {
+        return m_threadCount;
       }
 
-#if defined(SSE)
-      inline void determineCullFlagsSSE( const dp::math::sse::Vec4f& point, unsigned int &cfa )
+      void ManagerImpl::setInstructionSet( InstructionSet instructionSet )
       {
-        __m128 homogen = _mm_shuffle_ps( point.sse(), point.sse(), _MM_SHUFFLE( 3,3,3,3 ) );
+        m_cullingKernel = getCullingKernel( instructionSet );
+        m_instructionSet = instructionSet;
+      }
 
-        // compare each component point with the w coordinate and generate the corresponding bitmask
-        unsigned int mask = _mm_movemask_ps( _mm_cmpgt_ps( point.sse(), homogen ) ) << 4;
+      Manager::InstructionSet ManagerImpl::getInstructionSet() const
+      {
+        return m_instructionSet;
+      }
 
-        // IEEE 754 specifies that the highest bit of a float is the sign bit. Toggle it to get the negative value.
-        __m128 signBits =  _mm_castsi128_ps(_mm_set1_epi32( 0x80000000 ));
-        __m128 negHomogen = _mm_xor_ps( homogen, signBits );
+      void ManagerImpl::setTemporalCoherence( bool temporalCoherence )
+      {
+        m_temporalCoherence = temporalCoherence;
+      }
 
-        mask |= _mm_movemask_ps( _mm_cmpgt_ps( negHomogen, point.sse() ) );
+      bool ManagerImpl::getTemporalCoherence() const
+      {
+        return m_temporalCoherence;
+      }
 
-        cfa &= mask;
+      OccluderSharedPtr ManagerImpl::occluderCreate( dp::math::Vec3f const* vertices, size_t vertexCount, uint32_t const* indices, size_t indexCount )
+      {
+        return OccluderCPU::create( vertices, vertexCount, indices, indexCount );
       }
 
-      inline bool isVisibleSSE( const dp::math::sse::Mat44f& projection, const dp::math::sse::Mat44f &modelView, const dp::math::sse::Vec4f &lower, const dp::math::sse::Vec4f &extent)
+      void ManagerImpl::occluderSetTransformIndex( OccluderSharedPtr const & occluder, size_t index )
       {
-        unsigned int cfa = ~0;
+        std::static_pointer_cast<OccluderCPU>(occluder)->setTransformIndex( index );
+      }
 
-        dp::math::sse::Vec4f v = (lower * modelView) * projection;
+      void ManagerImpl::groupAddOccluder( GroupSharedPtr const & group, OccluderSharedPtr const & occluder )
+      {
+        std::static_pointer_cast<GroupCPU>(group)->addOccluder( std::static_pointer_cast<OccluderCPU>(occluder) );
+      }
 
-        determineCullFlagsSSE( v, cfa); // v
+      void ManagerImpl::groupRemoveOccluder( GroupSharedPtr const & group, OccluderSharedPtr const & occluder )
+      {
+        std::static_pointer_cast<GroupCPU>(group)->removeOccluder( std::static_pointer_cast<OccluderCPU>(occluder) );
+      }
 
-        // cfa != 0 -> trivial out.
-        // check for trivial out until each plane has one vertex which is not trivial out.
-        if ( cfa )
+      void ManagerImpl::setOcclusionBufferSize( unsigned int width, unsigned int height )
+      {
+        if ( !width || !height )
         {
-          // Compute x,z,y only if the first vertex is trivial out and the other vertices have to be checked.
-          // Compute all of them at once to avoid redundant loads later on.
-          dp::math::sse::Vec4f x( (modelView[0] * extent[0] ) * projection );
-          dp::math::sse::Vec4f y( (modelView[1] * extent[1] ) * projection );
-          dp::math::sse::Vec4f z( (modelView[2] * extent[2] ) * projection );
-          v += x; determineCullFlagsSSE( v, cfa); // v + x
-          if ( cfa )
-          {
-            v += y; determineCullFlagsSSE( v, cfa); // v + x + y
-            if ( cfa )
-            {
-              v -= x; determineCullFlagsSSE( v, cfa); // v + y
-              if ( cfa )
-              {
-                v += z; determineCullFlagsSSE( v, cfa); // v + y + z
-                if ( cfa )
-                {
-                  v += x; determineCullFlagsSSE( v, cfa); // v + x + y + z
-                  if ( cfa )
-                  {
-                    v -= y; determineCullFlagsSSE( v, cfa); // v + x + z
-                    if ( cfa )
-                    {
-                      v -= x; determineCullFlagsSSE( v, cfa); // v + z
-                    }
-                  }
-                }
-              }
-            }
-          }
+          throw std::runtime_error( "occlusion buffer size must not be zero" );
         }
+        m_occlusionBuffer.resize( width, height );
+      }
 
-        return !cfa;
+      dp::math::Vec2ui ManagerImpl::getOcclusionBufferSize() const
+      {
+        return dp::math::Vec2ui( m_occlusionBuffer.getWidth(), m_occlusionBuffer.getHeight() );
+      }
+
+      Manager::OcclusionStatistics const & ManagerImpl::getOcclusionStatistics() const
+      {
+        return m_occlusionStatistics;
+      }
+
+      void ManagerImpl::cull( GroupSharedPtr const& group, ResultSharedPtr const& result, const dp::math::Mat44f& viewProjection )
+      {
+        cull( group, result, viewProjection, dp::math::Vec2ui( 0, 0 ), 0.0f );
       }
 
-      inline bool isVisibleSSE( dp::math::sse::Mat44f const & projection, OBB const & obb )
+      void ManagerImpl::cull( GroupSharedPtr const & group, ResultSharedPtr const & result, dp::math::Mat44f const & viewProjection
+                            , dp::math::Vec2ui const & viewportSize, float minimumPixelArea )
       {
-        unsigned int cfa = ~0;
+        dp::util::ProfileEntry p("cull");
+        bool const smallFeatureCulling = 0.0f < minimumPixelArea && viewportSize[0] && viewportSize[1];
+        GroupCPUSharedPtr groupImpl = std::static_pointer_cast<GroupCPU>(group);
 
-        dp::math::sse::Vec4f v = reinterpret_cast<dp::math::sse::Vec4f const &>(obb.point) * projection;
+        groupImpl->updateOBBs();
+        OBBArray const & obbArray = groupImpl->getOBBArray();
 
-        determineCullFlagsSSE( v, cfa); // v
+        DP_STATIC_ASSERT( sizeof( dp::util::BitArray::BitStorageType) % sizeof(uint32_t) == 0 );
 
-        // cfa != 0 -> trivial out.
-        // check for trivial out until each plane has one vertex which is not trivial out.
-        if ( cfa )
+        if ( m_algorithm == Algorithm::BVH )
         {
-          // Compute x,z,y only if the first vertex is trivial out and the other vertices have to be checked.
-          // Compute all of them at once to avoid redundant loads later on.
-          dp::math::sse::Vec4f x( reinterpret_cast<dp::math::sse::Vec4f const &>(obb.ex) * projection );
-          dp::math::sse::Vec4f y( reinterpret_cast<dp::math::sse::Vec4f const &>(obb.ey) * projection );
-          dp::math::sse::Vec4f z( reinterpret_cast<dp::math::sse::Vec4f const &>(obb.ez) * projection );
+          // TODO this is an allocation which is potential slow. Keep memory allocated per group?
+          dp::util::BitArray visible( groupImpl->getObjectCount() );
 
-          v += x; determineCullFlagsSSE( v, cfa); // v + x
-          v += y; determineCullFlagsSSE( v, cfa); // v + x + y
-          v -= x; determineCullFlagsSSE( v, cfa); // v + y
-          v += z; determineCullFlagsSSE( v, cfa); // v + y + z
-          v += x; determineCullFlagsSSE( v, cfa); // v + x + y + z
-          v -= y; determineCullFlagsSSE( v, cfa); // v + x + z
-          v -= x; determineCullFlagsSSE( v, cfa); // v + z
-        }
+          groupImpl->updateBoundingVolumeHierarchy();
+          groupImpl->getBoundingVolumeHierarchy().cull( viewProjection, obbArray, visible );
 
-        return !cfa;
-      }
-#endif
+          if ( smallFeatureCulling )
+          {
+            // the hierarchy decides visibility per subtree only, so the small features are rejected on a copy of the bits
+            size_t const wordCount = ( groupImpl->getObjectCount() + 31 ) / 32;
+            uint32_t* visibility = groupImpl->getVisibility();
+            std::copy( reinterpret_cast<uint32_t const*>( visible.getBits() ), reinterpret_cast<uint32_t const*>( visible.getBits() ) + wordCount, visibility );
+            cullSmallFeatures( obbArray, viewProjection, viewportSize, minimumPixelArea, 0, wordCount, visibility );
+            std::static_pointer_cast<ResultBitSet>(result)->updateChanged( visibility );
+            return;
+          }
 
-#if defined(NEON)
+          std::static_pointer_cast<ResultBitSet>(result)->updateChanged( reinterpret_cast<uint32_t const*>( visible.getBits() ) );
+          return;
+        }
 
-      inline void determineCullFlagsNEON( const dp::math::neon::Vec4f &p, unsigned int & cfa )
-      {
-        unsigned int cf = 0;
+        size_t const chunkCount = ( groupImpl->getObjectCount() + ObjectsPerChunk - 1 ) / ObjectsPerChunk;
+        uint32_t* visibility = groupImpl->getVisibility();
 
-        if ( p[0] <= -p[3] )
-        {
-          cf |= 0x01;
-        }
-        else if ( p[3] <= p[0] )
+        CoherenceCache* coherenceCache = nullptr;
+        if ( m_temporalCoherence )
         {
-          cf |= 0x02;
+          coherenceCache = &std::static_pointer_cast<ResultCPU>(result)->getCoherenceCache();
+          coherenceCache->update( viewProjection, obbArray.getStride(), groupImpl->getObjectIncarnation() );
         }
-        if ( p[1] <= -p[3] )
+
+        // Each chunk covers one cache line of the visibility words, so no two threads ever write to the same cache line.
+        auto cullChunks = [&]( size_t beginChunk, size_t endChunk )
         {
-          cf |= 0x04;
-        }
-        else if ( p[3] <= p[1] )
+          if ( coherenceCache )
+          {
+            coherenceCache->cull( obbArray.getData(), obbArray.getStride(), groupImpl->getOBBGenerations(), viewProjection
+                                , beginChunk * WordsPerChunk, endChunk * WordsPerChunk, visibility );
+          }
+          else
+          {
+            m_cullingKernel( obbArray.getData(), obbArray.getStride(), viewProjection.getPtr()
+                           , beginChunk * WordsPerChunk, endChunk * WordsPerChunk, visibility );
+          }
+          if ( smallFeatureCulling )
+          {
+            cullSmallFeatures( obbArray, viewProjection, viewportSize, minimumPixelArea, beginChunk * WordsPerChunk, endChunk * WordsPerChunk, visibility );
+          }
+        };
+
+        dp::util::WorkerPoolSharedPtr const & workerPool = getWorkerPool();
+        if ( workerPool && ChunksPerTask < chunkCount )
         {
-          cf |= 0x08;
+          size_t const taskCount = ( chunkCount + ChunksPerTask - 1 ) / ChunksPerTask;
+          workerPool->execute( taskCount, [&]( size_t task )
+          {
+            cullChunks( task * ChunksPerTask, std::min( ( task + 1 ) * ChunksPerTask, chunkCount ) );
+          } );
         }
-        if ( p[2] <= -p[3] )
+        else
         {
-          cf |= 0x10;
+          cullChunks( 0, chunkCount );
         }
-        else if ( p[3] <= p[2] )
+
+        if ( coherenceCache )
         {
-          cf |= 0x20;
+          coherenceCache->finish( groupImpl->getOBBGeneration() );
         }
-        cfa &= cf;
+
+        std::static_pointer_cast<ResultBitSet>(result)->updateChanged( visibility );
       }
 
-      inline bool isVisibleNEON( const dp::math::neon::Mat44f& projection, const dp::math::neon::Mat44f &modelView, const dp::math::neon::Vec4f &lower, const dp::math::neon::Vec4f &extent)
+      void ManagerImpl::cullOcclusion( GroupSharedPtr const & group, ResultSharedPtr const & frustumResult, ResultSharedPtr const & occlusionResult
+                                     , dp::math::Mat44f const & viewProjection )
       {
-        unsigned int cfa = ~0;
+        dp::util::ProfileEntry p("cullOcclusion");
+        DP_ASSERT( frustumResult != occlusionResult );
+        GroupCPUSharedPtr groupImpl = std::static_pointer_cast<GroupCPU>(group);
 
-        dp::math::neon::Vec4f v = (lower * modelView) * projection;
+        groupImpl->updateOBBs();
+        OBBArray const & obbArray = groupImpl->getOBBArray();
 
-        determineCullFlagsNEON( v, cfa); // v
+        // render the occluders into the depth buffer
+        m_occlusionStatistics.rasterizedTriangles = 0;
+        m_occlusionBuffer.clear();
 
-        // cfa != 0 -> trivial out.
-        // check for trivial out until each plane has one vertex which is not trivial out.
-        if ( cfa )
+        char const* basePtr = reinterpret_cast<char const*>( groupImpl->getMatrices() );
+        std::vector<OccluderCPUSharedPtr> const & occluders = groupImpl->getOccluders();
+        for ( size_t index = 0; index < occluders.size(); ++index )
         {
-          // Compute x,z,y only if the first vertex is trivial out and the other vertices have to be checked.
-          // Compute all of them at once to avoid redundant loads later on.
-          dp::math::neon::Vec4f x( (modelView[0] * extent[0] ) * projection );
-          dp::math::neon::Vec4f y( (modelView[1] * extent[1] ) * projection );
-          dp::math::neon::Vec4f z( (modelView[2] * extent[2] ) * projection );
-          v += x; determineCullFlagsNEON( v, cfa); // v + x
-          if ( cfa )
+          OccluderCPUSharedPtr const & occluder = occluders[index];
+          if ( occluder->getTransformIndex() < groupImpl->getMatricesCount() )
           {
-            v += y; determineCullFlagsNEON( v, cfa); // v + x + y
-            if ( cfa )
-            {
-              v -= x; determineCullFlagsNEON( v, cfa); // v + y
-              if ( cfa )
-              {
-                v += z; determineCullFlagsNEON( v, cfa); // v + y + z
-                if ( cfa )
-                {
-                  v += x; determineCullFlagsNEON( v, cfa); // v + x + y + z
-                  if ( cfa )
-                  {
-                    v -= y; determineCullFlagsNEON( v, cfa); // v + x + z
-                    if ( cfa )
-                    {
-                      v -= x; determineCullFlagsNEON( v, cfa); // v + z
-                    }
-                  }
-                }
-              }
-            }
+            dp::math::Mat44f const & world = reinterpret_cast<dp::math::Mat44f const &>( *( basePtr + occluder->getTransformIndex() * groupImpl->getMatricesStride() ) );
+            m_occlusionStatistics.rasterizedTriangles += m_occlusionBuffer.rasterize( world * viewProjection
+                                                                                    , occluder->getVertices().data(), occluder->getVertices().size()
+                                                                                    , occluder->getIndices().data(), occluder->getIndices().size() );
           }
         }
-        return !cfa;
+        m_occlusionBuffer.buildHierarchy();
 
-      }
-#endif
-
-      void ManagerImpl::cull( GroupSharedPtr const& group, ResultSharedPtr const& result, const dp::math::Mat44f& viewProjection )
-      {
-        dp::util::ProfileEntry p("cull");
-        GroupCPUSharedPtr groupImpl = std::static_pointer_cast<GroupCPU>(group);
-
-        groupImpl->updateOBBs();
-        std::vector<OBB> const &obbs = groupImpl->getOBBs();
+        // only the objects visible in the frustum result are tested, objects unknown to it count as visible there
+        dp::util::BitArray const & frustumVisibility = std::static_pointer_cast<ResultBitSet>(frustumResult)->getVisibility();
+        uint32_t const* frustumBits = reinterpret_cast<uint32_t const*>( frustumVisibility.getBits() );
+        size_t const frustumCount = std::min( frustumVisibility.getSize(), groupImpl->getObjectCount() );
 
-        // TODO this is an allocation which is potential slow. Keep memory allocated per group?
-        DP_STATIC_ASSERT( sizeof( dp::util::BitArray::BitStorageType) % sizeof(uint32_t) == 0 );
-        dp::util::BitArray visible( groupImpl->getObjectCount() );
+        auto getTestedObjects = [&]( size_t word ) -> uint32_t
+        {
+          size_t const begin = word * 32;
+          if ( groupImpl->getObjectCount() <= begin )
+          {
+            return 0;
+          }
+          if ( frustumCount <= begin )
+          {
+            return ~0u;
+          }
+          uint32_t const unknown = ( begin + 32 <= frustumCount ) ? 0 : ~0u << ( frustumCount - begin );
+          return frustumBits[word] | unknown;
+        };
 
-        char const* basePtr = reinterpret_cast<char const*>(groupImpl->getMatrices());
-        size_t matricesStride = groupImpl->getMatricesStride();
-        size_t const count = groupImpl->getObjectCount();
+        size_t const chunkCount = ( groupImpl->getObjectCount() + ObjectsPerChunk - 1 ) / ObjectsPerChunk;
+        uint32_t* visibility = groupImpl->getVisibility();
 
-#if defined(SSE)
-        if ( useSSE )
+        auto cullChunks = [&]( size_t beginChunk, size_t endChunk )
         {
-          dp::math::sse::Mat44f vp = *reinterpret_cast<dp::math::sse::Mat44f const*>(&viewProjection);
-
-          for ( int index = 0;index < count; ++index )
+          for ( size_t word = beginChunk * WordsPerChunk; word < endChunk * WordsPerChunk; ++word )
           {
-            visible.setBit( index, isVisibleSSE( vp, obbs[index] ) );
+            uint32_t bits = ~0u;
+            for ( uint32_t tested = getTestedObjects( word ); tested; tested &= tested - 1 )
+            {
+              size_t const bit = dp::util::ctz( tested );
+              if ( m_occlusionBuffer.isOccluded( viewProjection, obbArray.get( word * 32 + bit ) ) )
+              {
+                bits &= ~( 1u << bit );
+              }
+            }
+            visibility[word] = bits;
           }
-        }
-        else
-#elif defined(NEON)
-        if ( useNEON )
-        {
-          dp::math::neon::Mat44f vp = *reinterpret_cast<dp::math::neon::Mat44f const*>(&viewProjection);
+        };
 
-          for ( int index = 0;index < count; ++index )
+        dp::util::WorkerPoolSharedPtr const & workerPool = getWorkerPool();
+        if ( workerPool && ChunksPerTask < chunkCount )
+        {
+          size_t const taskCount = ( chunkCount + ChunksPerTask - 1 ) / ChunksPerTask;
+          workerPool->execute( taskCount, [&]( size_t task )
           {
-            const ObjectBitSetSharedPtr& objectImpl = groupImpl->getObject( index );
-            const dp::math::neon::Mat44f &modelView = reinterpret_cast<const dp::math::neon::Mat44f&>(*(basePtr + objectImpl->getTransformIndex() * matricesStride) );
-            visible.setBit( index, isVisibleNEON( vp, modelView, *reinterpret_cast<dp::math::neon::Vec4f const*>(&objectImpl->getLowerLeft())
-              , *reinterpret_cast<dp::math::neon::Vec4f const*>(&objectImpl->getExtent()) ) );
-          }
+            cullChunks( task * ChunksPerTask, std::min( ( task + 1 ) * ChunksPerTask, chunkCount ) );
+          } );
         }
         else
-#endif
         {
-//#pragma omp parallel for
-          for ( size_t index = 0;index < count; ++index )
-          {
-            visible.setBit( index, isVisible( viewProjection, obbs[index] ) );
-          }
+          cullChunks( 0, chunkCount );
+        }
+
+        m_occlusionStatistics.testedObjects = 0;
+        m_occlusionStatistics.occludedObjects = 0;
+        for ( size_t word = 0; word < chunkCount * WordsPerChunk; ++word )
+        {
+          uint32_t tested = getTestedObjects( word );
+          m_occlusionStatistics.testedObjects += std::bitset<32>( tested ).count();
+          m_occlusionStatistics.occludedObjects += std::bitset<32>( tested & ~visibility[word] ).count();
         }
 
-        std::static_pointer_cast<ResultBitSet>(result)->updateChanged( reinterpret_cast<uint32_t const*>( visible.getBits() ) );
+        std::static_pointer_cast<ResultBitSet>(occlusionResult)->updateChanged( visibility );
       }
 
     } // namespace cpu
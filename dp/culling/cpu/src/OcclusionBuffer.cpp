@@ -0,0 +1,404 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <dp/culling/cpu/inc/OcclusionBuffer.h>
+#include <dp/util/Config.h>
+#include <dp/Assert.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// SSE2 is part of x86-64, so the rasterizer does not need a runtime dispatch like the culling kernels
+#if defined(DP_ARCH_X86_64)
+#include <emmintrin.h>
+#define DP_OCCLUSION_BUFFER_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DP_OCCLUSION_BUFFER_NEON
+#endif
+
+namespace dp
+{
+  namespace culling
+  {
+    namespace cpu
+    {
+
+      namespace
+      {
+        /** \brief Edge function of a triangle edge, relative to the start vertex of the edge to keep the precision
+                   for large screen space coordinates. Positive inside of the triangle.
+        **/
+        struct Edge
+        {
+          Edge( dp::math::Vec3f const & from, dp::math::Vec3f const & to )
+            : a( from[1] - to[1] )
+            , b( to[0] - from[0] )
+            , x( from[0] )
+            , y( from[1] )
+          {
+          }
+
+          float a;
+          float b;
+          float x;
+          float y;
+        };
+
+        /** \brief Write the minimum of the current depth and the depth plane zA * px + rowZ into the pixels [xBegin, xEnd) of a row
+                   whose centers are inside of all three edges. rowE is the row constant b * (py - y) of each edge.
+                   xBegin must be a multiple of 4 and the row must be padded to a multiple of 4 pixels.
+        **/
+        inline void rasterizeSpan( float* row, unsigned int xBegin, unsigned int xEnd, Edge const* edges, float const* rowE, float zA, float rowZ )
+        {
+#if defined(DP_OCCLUSION_BUFFER_SSE2)
+          __m128 const zero = _mm_setzero_ps();
+          __m128 const offsets = _mm_set_ps( 3.5f, 2.5f, 1.5f, 0.5f );
+          __m128 a[3], ox[3], re[3];
+          for ( unsigned int i = 0; i < 3; ++i )
+          {
+            a[i] = _mm_set1_ps( edges[i].a );
+            ox[i] = _mm_set1_ps( edges[i].x );
+            re[i] = _mm_set1_ps( rowE[i] );
+          }
+          __m128 const za = _mm_set1_ps( zA );
+          __m128 const rz = _mm_set1_ps( rowZ );
+
+          for ( unsigned int x = xBegin; x < xEnd; x += 4 )
+          {
+            __m128 px = _mm_add_ps( _mm_set1_ps( float( x ) ), offsets );
+            __m128 inside = _mm_cmpge_ps( _mm_add_ps( _mm_mul_ps( a[0], _mm_sub_ps( px, ox[0] ) ), re[0] ), zero );
+            inside = _mm_and_ps( inside, _mm_cmpge_ps( _mm_add_ps( _mm_mul_ps( a[1], _mm_sub_ps( px, ox[1] ) ), re[1] ), zero ) );
+            inside = _mm_and_ps( inside, _mm_cmpge_ps( _mm_add_ps( _mm_mul_ps( a[2], _mm_sub_ps( px, ox[2] ) ), re[2] ), zero ) );
+
+            __m128 depth = _mm_loadu_ps( row + x );
+            __m128 z = _mm_min_ps( depth, _mm_add_ps( _mm_mul_ps( za, px ), rz ) );
+            _mm_storeu_ps( row + x, _mm_or_ps( _mm_and_ps( inside, z ), _mm_andnot_ps( inside, depth ) ) );
+          }
+#elif defined(DP_OCCLUSION_BUFFER_NEON)
+          float const offsetValues[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+          float32x4_t const zero = vdupq_n_f32( 0.0f );
+          float32x4_t const offsets = vld1q_f32( offsetValues );
+          float32x4_t a[3], ox[3], re[3];
+          for ( unsigned int i = 0; i < 3; ++i )
+          {
+            a[i] = vdupq_n_f32( edges[i].a );
+            ox[i] = vdupq_n_f32( edges[i].x );
+            re[i] = vdupq_n_f32( rowE[i] );
+          }
+          float32x4_t const za = vdupq_n_f32( zA );
+          float32x4_t const rz = vdupq_n_f32( rowZ );
+
+          for ( unsigned int x = xBegin; x < xEnd; x += 4 )
+          {
+            float32x4_t px = vaddq_f32( vdupq_n_f32( float( x ) ), offsets );
+            uint32x4_t inside = vcgeq_f32( vaddq_f32( vmulq_f32( a[0], vsubq_f32( px, ox[0] ) ), re[0] ), zero );
+            inside = vandq_u32( inside, vcgeq_f32( vaddq_f32( vmulq_f32( a[1], vsubq_f32( px, ox[1] ) ), re[1] ), zero ) );
+            inside = vandq_u32( inside, vcgeq_f32( vaddq_f32( vmulq_f32( a[2], vsubq_f32( px, ox[2] ) ), re[2] ), zero ) );
+
+            float32x4_t depth = vld1q_f32( row + x );
+            float32x4_t z = vminq_f32( depth, vaddq_f32( vmulq_f32( za, px ), rz ) );
+            vst1q_f32( row + x, vbslq_f32( inside, z, depth ) );
+          }
+#else
+          for ( unsigned int x = xBegin; x < xEnd; ++x )
+          {
+            float px = float( x ) + 0.5f;
+            if (    0.0f <= edges[0].a * ( px - edges[0].x ) + rowE[0]
+                 && 0.0f <= edges[1].a * ( px - edges[1].x ) + rowE[1]
+                 && 0.0f <= edges[2].a * ( px - edges[2].x ) + rowE[2] )
+            {
+              row[x] = std::min( row[x], zA * px + rowZ );
+            }
+          }
+#endif
+        }
+
+        /** \brief Signed distance of a clip space point to the near plane, positive in front of it. **/
+        inline float nearDistance( dp::math::Vec4f const & clip )
+        {
+          return clip[2] + clip[3];
+        }
+      } // namespace anonymous
+
+      OcclusionBuffer::OcclusionBuffer()
+        : m_width( 0 )
+        , m_height( 0 )
+      {
+      }
+
+      void OcclusionBuffer::resize( unsigned int width, unsigned int height )
+      {
+        DP_ASSERT( width && height );
+
+        m_width = width;
+        m_height = height;
+        m_levels.clear();
+
+        // the last level has a single texel
+        Level level = { width, height, ( width + 3 ) & ~3u, 0 };
+        m_levels.push_back( level );
+        while ( 1 < level.width || 1 < level.height )
+        {
+          level.offset += size_t( level.stride ) * level.height;
+          level.width = ( level.width + 1 ) / 2;
+          level.height = ( level.height + 1 ) / 2;
+          level.stride = level.width;
+          m_levels.push_back( level );
+        }
+        m_depths.resize( level.offset + level.width * level.height );
+      }
+
+      void OcclusionBuffer::clear()
+      {
+        std::fill( m_depths.begin(), m_depths.begin() + m_levels[0].stride * m_height, FLT_MAX );
+      }
+
+      dp::math::Vec3f OcclusionBuffer::toScreen( dp::math::Vec4f const & clip ) const
+      {
+        float const invW = 1.0f / clip[3];
+        return dp::math::Vec3f( ( clip[0] * invW * 0.5f + 0.5f ) * m_width, ( clip[1] * invW * 0.5f + 0.5f ) * m_height, clip[2] * invW );
+      }
+
+      size_t OcclusionBuffer::rasterize( dp::math::Mat44f const & modelViewProjection, dp::math::Vec3f const* vertices, size_t vertexCount
+                                       , uint32_t const* indices, size_t indexCount )
+      {
+        DP_ASSERT( !m_levels.empty() );
+
+        m_clipVertices.resize( vertexCount );
+        for ( size_t index = 0; index < vertexCount; ++index )
+        {
+          m_clipVertices[index] = dp::math::Vec4f( vertices[index], 1.0f ) * modelViewProjection;
+        }
+
+        size_t triangles = 0;
+        for ( size_t index = 0; index + 2 < indexCount; index += 3 )
+        {
+          DP_ASSERT( indices[index] < vertexCount && indices[index + 1] < vertexCount && indices[index + 2] < vertexCount );
+          triangles += clipAndRasterize( m_clipVertices[indices[index]], m_clipVertices[indices[index + 1]], m_clipVertices[indices[index + 2]] );
+        }
+        return triangles;
+      }
+
+      size_t OcclusionBuffer::clipAndRasterize( dp::math::Vec4f const & c0, dp::math::Vec4f const & c1, dp::math::Vec4f const & c2 )
+      {
+        dp::math::Vec4f const* input[3] = { &c0, &c1, &c2 };
+
+        // clip the triangle at the near plane, this leaves at most four vertices
+        dp::math::Vec4f polygon[4];
+        unsigned int count = 0;
+        for ( unsigned int i = 0; i < 3; ++i )
+        {
+          dp::math::Vec4f const & current = *input[i];
+          dp::math::Vec4f const & next = *input[( i + 1 ) % 3];
+          float const currentDistance = nearDistance( current );
+          float const nextDistance = nearDistance( next );
+
+          if ( 0.0f <= currentDistance )
+          {
+            polygon[count++] = current;
+          }
+          if ( ( 0.0f <= currentDistance ) != ( 0.0f <= nextDistance ) )
+          {
+            float t = currentDistance / ( currentDistance - nextDistance );
+            polygon[count++] = current + t * ( next - current );
+          }
+        }
+
+        if ( count < 3 )
+        {
+          return 0;
+        }
+
+        dp::math::Vec3f screen[4];
+        for ( unsigned int i = 0; i < count; ++i )
+        {
+          // only projective matrices with a near plane in front of the eye are supported
+          if ( !( 0.0f < polygon[i][3] ) )
+          {
+            return 0;
+          }
+          screen[i] = toScreen( polygon[i] );
+        }
+
+        for ( unsigned int i = 2; i < count; ++i )
+        {
+          rasterizeTriangle( screen[0], screen[i - 1], screen[i] );
+        }
+        return count - 2;
+      }
+
+      void OcclusionBuffer::rasterizeTriangle( dp::math::Vec3f const & v0, dp::math::Vec3f const & v1, dp::math::Vec3f const & v2 )
+      {
+        float area = ( v1[0] - v0[0] ) * ( v2[1] - v0[1] ) - ( v2[0] - v0[0] ) * ( v1[1] - v0[1] );
+        if ( !( area != 0.0f ) )
+        {
+          // degenerated or not a number
+          return;
+        }
+
+        // occluders are double sided, orient all triangles counter clockwise
+        dp::math::Vec3f const* v[3] = { &v0, &v1, &v2 };
+        if ( area < 0.0f )
+        {
+          std::swap( v[1], v[2] );
+          area = -area;
+        }
+
+        // edge i is opposite of vertex i, its edge function divided by the area is the barycentric coordinate of vertex i
+        Edge const edges[3] = { Edge( *v[1], *v[2] ), Edge( *v[2], *v[0] ), Edge( *v[0], *v[1] ) };
+
+        // depth plane z = zA * px + zB * py + zC
+        float const dz1 = ( (*v[1])[2] - (*v[0])[2] ) / area;
+        float const dz2 = ( (*v[2])[2] - (*v[0])[2] ) / area;
+        float const zA = edges[1].a * dz1 + edges[2].a * dz2;
+        float const zB = edges[1].b * dz1 + edges[2].b * dz2;
+        float const zC = (*v[0])[2] - zA * (*v[0])[0] - zB * (*v[0])[1];
+
+        // pixels whose center lies within the bounds of the triangle
+        float const minX = std::min( std::min( v0[0], v1[0] ), v2[0] );
+        float const maxX = std::max( std::max( v0[0], v1[0] ), v2[0] );
+        float const minY = std::min( std::min( v0[1], v1[1] ), v2[1] );
+        float const maxY = std::max( std::max( v0[1], v1[1] ), v2[1] );
+        if ( !( maxX >= 0.5f && minX < m_width - 0.5f && maxY >= 0.5f && minY < m_height - 0.5f ) )
+        {
+          return;
+        }
+
+        unsigned int const xBegin = static_cast<unsigned int>( std::max( 0.0f, std::ceil( minX - 0.5f ) ) ) & ~3u;
+        unsigned int const xEnd = static_cast<unsigned int>( std::min( float( m_width ), std::floor( maxX - 0.5f ) + 1.0f ) );
+        unsigned int const yBegin = static_cast<unsigned int>( std::max( 0.0f, std::ceil( minY - 0.5f ) ) );
+        unsigned int const yEnd = static_cast<unsigned int>( std::min( float( m_height ), std::floor( maxY - 0.5f ) + 1.0f ) );
+
+        Level const & level = m_levels[0];
+        for ( unsigned int y = yBegin; y < yEnd; ++y )
+        {
+          float const py = float( y ) + 0.5f;
+          float const rowE[3] = { edges[0].b * ( py - edges[0].y ), edges[1].b * ( py - edges[1].y ), edges[2].b * ( py - edges[2].y ) };
+          rasterizeSpan( &m_depths[level.offset + y * level.stride], xBegin, xEnd, edges, rowE, zA, zB * py + zC );
+        }
+      }
+
+      void OcclusionBuffer::buildHierarchy()
+      {
+        for ( size_t index = 1; index < m_levels.size(); ++index )
+        {
+          Level const & source = m_levels[index - 1];
+          Level const & target = m_levels[index];
+          float const* sourceDepths = &m_depths[source.offset];
+          float* targetDepths = &m_depths[target.offset];
+
+          for ( unsigned int y = 0; y < target.height; ++y )
+          {
+            float const* row0 = sourceDepths + 2 * y * source.stride;
+            float const* row1 = sourceDepths + std::min( 2 * y + 1, source.height - 1 ) * source.stride;
+            for ( unsigned int x = 0; x < target.width; ++x )
+            {
+              unsigned int x0 = 2 * x;
+              unsigned int x1 = std::min( 2 * x + 1, source.width - 1 );
+              targetDepths[y * target.stride + x] = std::max( std::max( row0[x0], row0[x1] ), std::max( row1[x0], row1[x1] ) );
+            }
+          }
+        }
+      }
+
+      bool OcclusionBuffer::isOccluded( dp::math::Mat44f const & viewProjection, OBB const & obb ) const
+      {
+        DP_ASSERT( !m_levels.empty() );
+
+        dp::math::Vec4f corners[8];
+        corners[0] = obb.point * viewProjection;
+        dp::math::Vec4f const x = obb.ex * viewProjection;
+        dp::math::Vec4f const y = obb.ey * viewProjection;
+        dp::math::Vec4f const z = obb.ez * viewProjection;
+        corners[1] = corners[0] + x;
+        corners[2] = corners[0] + y;
+        corners[3] = corners[1] + y;
+        corners[4] = corners[0] + z;
+        corners[5] = corners[1] + z;
+        corners[6] = corners[2] + z;
+        corners[7] = corners[3] + z;
+
+        float minX = FLT_MAX;
+        float maxX = -FLT_MAX;
+        float minY = FLT_MAX;
+        float maxY = -FLT_MAX;
+        float minZ = FLT_MAX;
+        for ( unsigned int i = 0; i < 8; ++i )
+        {
+          if ( !( 0.0f < corners[i][3] && 0.0f <= nearDistance( corners[i] ) ) )
+          {
+            return false;
+          }
+          dp::math::Vec3f screen = toScreen( corners[i] );
+          minX = std::min( minX, screen[0] );
+          maxX = std::max( maxX, screen[0] );
+          minY = std::min( minY, screen[1] );
+          maxY = std::max( maxY, screen[1] );
+          minZ = std::min( minZ, screen[2] );
+        }
+
+        // the occluders are rasterized at the pixel centers, so a pixel's depth says nothing about the parts of it around its
+        // center. Expanding the bounds by half a pixel also tests the pixels whose centers are closest to the box, which
+        // keeps small boxes next to an occluder edge from being culled by the depth of a pixel they are only partly in.
+        minX -= 0.5f;
+        maxX += 0.5f;
+        minY -= 0.5f;
+        maxY += 0.5f;
+
+        // the pixels touched by the screen space bounds. Boxes outside of the buffer have not passed the frustum test.
+        if ( !( 0.0f <= maxX && minX < m_width && 0.0f <= maxY && minY < m_height ) )
+        {
+          return false;
+        }
+        unsigned int x0 = static_cast<unsigned int>( std::max( 0.0f, minX ) );
+        unsigned int x1 = static_cast<unsigned int>( std::min( float( m_width - 1 ), maxX ) );
+        unsigned int y0 = static_cast<unsigned int>( std::max( 0.0f, minY ) );
+        unsigned int y1 = static_cast<unsigned int>( std::min( float( m_height - 1 ), maxY ) );
+
+        // the first level where the bounds touch at most 2x2 texels
+        unsigned int index = 0;
+        while ( 1 < ( x1 >> index ) - ( x0 >> index ) || 1 < ( y1 >> index ) - ( y0 >> index ) )
+        {
+          ++index;
+        }
+        DP_ASSERT( index < m_levels.size() );
+
+        Level const & level = m_levels[index];
+        float const* depths = &m_depths[level.offset];
+        x0 >>= index;
+        x1 >>= index;
+        y0 >>= index;
+        y1 >>= index;
+        float maxDepth = std::max( std::max( depths[y0 * level.stride + x0], depths[y0 * level.stride + x1] )
+                                 , std::max( depths[y1 * level.stride + x0], depths[y1 * level.stride + x1] ) );
+
+        return maxDepth < minZ;
+      }
+
+    } // namespace cpu
+  } // namespace culling
+} // namespace dp
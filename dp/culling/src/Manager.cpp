@@ -38,6 +38,12 @@ namespace dp
 
     }
 
+    void Manager::cull( GroupSharedPtr const & group, ResultSharedPtr const & result, dp::math::Mat44f const & viewProjection
+                      , dp::math::Vec2ui const & /*viewportSize*/, float /*minimumPixelArea*/ )
+    {
+      cull( group, result, viewProjection );
+    }
+
     // dummy function to import the factory functions from the linked libraries
     void importSymbols()
     {
@@ -0,0 +1,98 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#pragma once
+/** @file */
+
+#include <dp/Types.h>
+#include <dp/math/Config.h>
+#include <dp/math/Boxnt.h>
+#include <dp/math/Spherent.h>
+#include <cstddef>
+
+namespace dp
+{
+  namespace math
+  {
+    /*! \brief Vectorized bounding volume kernels for float positions, as stored in vertex buffers.
+     *  \remarks All kernels take \a count positions of three floats, the first one at \a points and each
+     *  following one \a strideInBytes bytes after its predecessor. Contiguous positions (a stride of
+     *  3 * sizeof(float)) are read with vector loads, other strides and indexed positions are gathered
+     *  four at a time. The indexed variants take \a indexCount indices of type \a indexType, which can be
+     *  any of the 8, 16, or 32 bit integer types. Indices equal to \a primitiveRestartIndex are skipped,
+     *  as are indices not less than \a count. The latter are counted in \a invalidIndexCount, if given.
+     *  The results are the same as evaluating Box3f::update and lengthSquared on each position. */
+
+    /*! \brief Calculate the axis-aligned bounding box of a set of positions.
+     *  \return The bounding box of the positions, or an empty box if there are none. */
+    DP_MATH_API Box3f boundingBox( float const* points, size_t strideInBytes, size_t count );
+
+    /*! \brief Calculate the axis-aligned bounding box of a set of indexed positions.
+     *  \return The bounding box of the indexed positions, or an empty box if there are none. */
+    DP_MATH_API Box3f boundingBox( float const* points, size_t strideInBytes, size_t count
+                                 , void const* indices, dp::DataType indexType, size_t indexCount
+                                 , unsigned int primitiveRestartIndex = ~0, size_t * invalidIndexCount = nullptr );
+
+    /*! \brief Calculate the largest distance of a set of positions from a center.
+     *  \return The largest distance, or zero if there are no positions. */
+    DP_MATH_API float maxDistance( float const* points, size_t strideInBytes, size_t count, Vec3f const& center );
+
+    /*! \brief Calculate the largest distance of a set of indexed positions from a center.
+     *  \return The largest distance, or zero if there are no positions. */
+    DP_MATH_API float maxDistance( float const* points, size_t strideInBytes, size_t count
+                                 , void const* indices, dp::DataType indexType, size_t indexCount, Vec3f const& center
+                                 , unsigned int primitiveRestartIndex = ~0, size_t * invalidIndexCount = nullptr );
+
+    /*! \brief Calculate the bounding box and the bounding sphere around the center of that box in one call.
+     *  \param box Receives the bounding box of the positions.
+     *  \param sphere Receives the sphere around the center of \a box with the largest distance of the positions as
+     *  radius. If there are no positions, \a box is empty and \a sphere is the default, invalid sphere.
+     *  \remarks The center of the sphere is known only after all positions have been visited, so the positions are
+     *  read twice. */
+    DP_MATH_API void boundingBoxAndSphere( float const* points, size_t strideInBytes, size_t count, Box3f & box, Sphere3f & sphere );
+
+    /*! \brief Calculate the bounding box and the bounding sphere around the center of that box of a set of indexed positions.
+     *  \sa boundingBoxAndSphere( float const*, size_t, size_t, Box3f &, Sphere3f & ) */
+    DP_MATH_API void boundingBoxAndSphere( float const* points, size_t strideInBytes, size_t count
+                                         , void const* indices, dp::DataType indexType, size_t indexCount
+                                         , Box3f & box, Sphere3f & sphere
+                                         , unsigned int primitiveRestartIndex = ~0, size_t * invalidIndexCount = nullptr );
+
+    /*! \brief Calculate the bounding sphere of a set of positions with the specified algorithm.
+     *  \return The bounding sphere of the positions, or the default, invalid sphere if there are none.
+     *  \remarks BoundingSphereMethod::BOX_CENTER uses the vectorized kernels, the other methods evaluate
+     *  ritterSphere on the positions. */
+    DP_MATH_API Sphere3f boundingSphere( float const* points, size_t strideInBytes, size_t count, BoundingSphereMethod method );
+
+    /*! \brief Calculate the bounding sphere of a set of indexed positions with the specified algorithm.
+     *  \sa boundingSphere( float const*, size_t, size_t, BoundingSphereMethod ) */
+    DP_MATH_API Sphere3f boundingSphere( float const* points, size_t strideInBytes, size_t count
+                                       , void const* indices, dp::DataType indexType, size_t indexCount, BoundingSphereMethod method
+                                       , unsigned int primitiveRestartIndex = ~0, size_t * invalidIndexCount = nullptr );
+
+  } // namespace math
+} // namespace dp
@@ -27,6 +27,7 @@
 #pragma once
 /** @file */
 
+#include <algorithm>
 #include <dp/math/Vecnt.h>
 #include <dp/math/Boxnt.h>
 
@@ -95,21 +96,71 @@ namespace dp
     // non-member functions
     // - - - - -  - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
 
+    /*! \brief The algorithms to determine the bounding sphere of a number of points.
+     *  \remarks None of them determines the smallest possible bounding sphere in general. Ritter's algorithm
+     *  tends to be closer to it, but the center of the bounding box is optimal for points filling a box. */
+    enum class BoundingSphereMethod
+    {
+      BOX_CENTER,       //!< Around the center of the bounding box of the points. Two passes over the points.
+      RITTER,           //!< Ritter's algorithm, growing a sphere around two far apart points. Four passes over the points.
+      RITTER_REFINED    //!< Ritter's algorithm, followed by passes shrinking and regrowing the sphere. Twelve passes over the points.
+    };
+
+    /*! \brief Random access to points through an array of indices.
+     *  \remarks This adapter lets the bounding sphere algorithms taking a random access iterator work on indexed points. */
+    template<unsigned int n, typename T, typename RandomAccessIterator>
+    class IndexedPoints
+    {
+      public:
+        IndexedPoints( RandomAccessIterator points, const unsigned int * indices )
+          : m_points( points )
+          , m_indices( indices )
+        {
+        }
+
+        Vecnt<n,T> operator[]( unsigned int i ) const
+        {
+          return( m_points[m_indices[i]] );
+        }
+
+      private:
+        RandomAccessIterator  m_points;
+        const unsigned int  * m_indices;
+    };
+
     /*! \brief Determine the bounding sphere of a number of points.
      *  \param points A pointer to the points to include.
      *  \param numberOfPoints The number of points used.
+     *  \param method The algorithm to use.
      *  \return A small sphere around the given points.
      *  \remarks The sphere is not necessarily the smallest possible bounding sphere. */
     template<unsigned int n, typename T>
-      Spherent<n,T> boundingSphere( const Vecnt<n,T> * points, unsigned int numberOfPoints );
+      Spherent<n,T> boundingSphere( const Vecnt<n,T> * points, unsigned int numberOfPoints
+                                  , BoundingSphereMethod method = BoundingSphereMethod::BOX_CENTER );
 
     /*! \brief Determine the bounding sphere of a number of points.
      *  \param points A random access iterator to the points to use.
      *  \param numberOfPoints The number of points used.
+     *  \param method The algorithm to use.
      *  \return A small sphere around the given points.
      *  \remarks The sphere is not necessarily the smallest possible bounding sphere. */
     template<unsigned int n, typename T, typename RandomAccessIterator >
-      Spherent<n,T> boundingSphere( RandomAccessIterator points, unsigned int numberOfPoints );
+      Spherent<n,T> boundingSphere( RandomAccessIterator points, unsigned int numberOfPoints
+                                  , BoundingSphereMethod method = BoundingSphereMethod::BOX_CENTER );
+
+    /*! \brief Determine the bounding sphere of a number of points with Ritter's algorithm.
+     *  \param points A random access iterator to the points to use.
+     *  \param numberOfPoints The number of points used.
+     *  \param method Either BoundingSphereMethod::RITTER or BoundingSphereMethod::RITTER_REFINED.
+     *  \return A small sphere around the given points, or an invalid sphere if there are no points.
+     *  \remarks The initial sphere is spanned by the point farthest from the first point and the point farthest
+     *  from that one. It is grown to include each point outside of it, like boundingSphere( Spherent, Vecnt ) does.
+     *  With BoundingSphereMethod::RITTER_REFINED, the sphere is shrunk and grown again a few times, visiting the
+     *  points in a different order each time, and the smallest of these spheres is kept. The radius finally is
+     *  determined as the largest distance of the points from the center, so that rounding while growing the
+     *  sphere can't leave points outside of it. */
+    template<unsigned int n, typename T, typename RandomAccessIterator >
+      Spherent<n,T> ritterSphere( RandomAccessIterator points, unsigned int numberOfPoints, BoundingSphereMethod method );
 
   #if 0
     /*! \brief Determine the bounding sphere of a number of points.
@@ -125,21 +176,23 @@ namespace dp
      *  \param points A pointer to the points to use.
      *  \param indices A pointer to the indices to use.
      *  \param numberOfIndices The number of indices used.
+     *  \param method The algorithm to use.
      *  \return A small sphere around the given points.
      *  \remarks The sphere is not necessarily the smallest possible bounding sphere. */
     template<unsigned int n, typename T>
       Spherent<n,T> boundingSphere( const Vecnt<n,T> * points, const unsigned int * indices
-                                  , unsigned int numberOfIndices );
+                                  , unsigned int numberOfIndices, BoundingSphereMethod method = BoundingSphereMethod::BOX_CENTER );
 
     /*! \brief Determine the bounding sphere of a number of indexed points.
      *  \param points A random access iterator to the points to use.
      *  \param indices A pointer to the indices to use.
      *  \param numberOfIndices The number of indices used.
+     *  \param method The algorithm to use.
      *  \return A small sphere around the given points.
      *  \remarks The sphere is not necessarily the smallest possible bounding sphere. */
     template<unsigned int n, typename T, typename RandomAccessIterator>
     Spherent<n,T> boundingSphere( RandomAccessIterator points, const unsigned int * indices
-                                , unsigned int numberOfIndices );
+                                , unsigned int numberOfIndices, BoundingSphereMethod method = BoundingSphereMethod::BOX_CENTER );
 
     /*! \brief Determine the bounding sphere of a number of strip-indexed points.
      *  \param points A pointer to the points to use.
@@ -283,9 +336,14 @@ namespace dp
     }
 
     template<unsigned int n, typename T>
-    inline Spherent<n,T> boundingSphere( const dp::math::Vecnt<n,T> *points, unsigned int numberOfPoints )
+    inline Spherent<n,T> boundingSphere( const dp::math::Vecnt<n,T> *points, unsigned int numberOfPoints, BoundingSphereMethod method )
     {
       DP_ASSERT( points );
+      if ( method != BoundingSphereMethod::BOX_CENTER )
+      {
+        return( ritterSphere<n,T>( points, numberOfPoints, method ) );
+      }
+
       //  determine the bounding box
       Vecnt<n,T> bbox[2];
       bbox[0] = points[0];
@@ -322,8 +380,13 @@ namespace dp
     }
 
     template<unsigned int n, typename T, typename RandomAccessIterator >
-    inline Spherent<n,T> boundingSphere( RandomAccessIterator points, unsigned int numberOfPoints )
+    inline Spherent<n,T> boundingSphere( RandomAccessIterator points, unsigned int numberOfPoints, BoundingSphereMethod method )
     {
+      if ( method != BoundingSphereMethod::BOX_CENTER )
+      {
+        return( ritterSphere<n,T>( points, numberOfPoints, method ) );
+      }
+
       //  determine the bounding box
       Vecnt<n,T> bbox[2];
       bbox[0] = points[0];
@@ -360,9 +423,14 @@ namespace dp
     }
 
     template<unsigned int n, typename T>
-    inline Spherent<n,T> boundingSphere( const Vecnt<n,T> * points, const unsigned int * indices, unsigned int numberOfIndices )
+    inline Spherent<n,T> boundingSphere( const Vecnt<n,T> * points, const unsigned int * indices, unsigned int numberOfIndices, BoundingSphereMethod method )
     {
       DP_ASSERT( points && indices );
+      if ( method != BoundingSphereMethod::BOX_CENTER )
+      {
+        return( ritterSphere<n,T>( IndexedPoints<n,T,const Vecnt<n,T> *>( points, indices ), numberOfIndices, method ) );
+      }
+
       //  determine the bounding box
       Vecnt<n,T> bbox[2];
       bbox[0] = points[indices[0]];
@@ -400,9 +468,14 @@ namespace dp
     }
 
     template<unsigned int n, typename T, typename RandomAccessIterator>
-    inline Spherent<n,T> boundingSphere( RandomAccessIterator points, const unsigned int * indices, unsigned int numberOfIndices )
+    inline Spherent<n,T> boundingSphere( RandomAccessIterator points, const unsigned int * indices, unsigned int numberOfIndices, BoundingSphereMethod method )
     {
       DP_ASSERT( indices );
+      if ( method != BoundingSphereMethod::BOX_CENTER )
+      {
+        return( ritterSphere<n,T>( IndexedPoints<n,T,RandomAccessIterator>( points, indices ), numberOfIndices, method ) );
+      }
+
       //  determine the bounding box
       Vecnt<n,T> bbox[2];
       bbox[0] = points[indices[0]];
@@ -610,6 +683,98 @@ namespace dp
       }
     }
 
+    template<unsigned int n, typename T, typename RandomAccessIterator>
+    inline unsigned int farthestPoint( RandomAccessIterator points, unsigned int numberOfPoints, const Vecnt<n,T> & p )
+    {
+      unsigned int farthest = 0;
+      T maxDistance(0);
+      for ( unsigned int i=0 ; i<numberOfPoints ; i++ )
+      {
+        T d = lengthSquared( points[i] - p );
+        if ( maxDistance < d )
+        {
+          maxDistance = d;
+          farthest = i;
+        }
+      }
+      return( farthest );
+    }
+
+    template<unsigned int n, typename T, typename RandomAccessIterator>
+    inline void growSphere( Spherent<n,T> & s, RandomAccessIterator points, unsigned int numberOfPoints, unsigned int first, bool forward )
+    {
+      //  visits each point once, starting at first and wrapping around at the ends
+      DP_ASSERT( first < numberOfPoints );
+      unsigned int index = first;
+      for ( unsigned int i=0 ; i<numberOfPoints ; i++ )
+      {
+        Vecnt<n,T> p = points[index];
+        if ( s.getRadius() * s.getRadius() < lengthSquared( p - s.getCenter() ) )
+        {
+          s = boundingSphere( s, p );
+        }
+        if ( forward )
+        {
+          index = ( index + 1 < numberOfPoints ) ? index + 1 : 0;
+        }
+        else
+        {
+          index = index ? index - 1 : numberOfPoints - 1;
+        }
+      }
+    }
+
+    template<unsigned int n, typename T, typename RandomAccessIterator>
+    inline Spherent<n,T> ritterSphere( RandomAccessIterator points, unsigned int numberOfPoints, BoundingSphereMethod method )
+    {
+      DP_STATIC_ASSERT( !std::numeric_limits<T>::is_integer );
+      DP_ASSERT( method != BoundingSphereMethod::BOX_CENTER );
+      if ( !numberOfPoints )
+      {
+        return( Spherent<n,T>() );
+      }
+
+      //  start with the sphere spanned by two far apart points, and grow it to include all the others
+      unsigned int a = farthestPoint<n,T>( points, numberOfPoints, points[0] );
+      unsigned int b = farthestPoint<n,T>( points, numberOfPoints, points[a] );
+      Vecnt<n,T> pa = points[a];
+      Vecnt<n,T> pb = points[b];
+      Spherent<n,T> sphere( T(0.5) * ( pa + pb ), T(0.5) * distance( pa, pb ) );
+      growSphere( sphere, points, numberOfPoints, 0, true );
+
+      if ( method == BoundingSphereMethod::RITTER_REFINED )
+      {
+        //  shrink the sphere and grow it again, each time with the points in a different order; the passes start
+        //  at offsets spread by the golden ratio and alternate their direction, but still read the points in sequence
+        Spherent<n,T> grown( sphere );
+        for ( unsigned int i=0 ; i<8 ; i++ )
+        {
+          double f = ( i + 1 ) * 0.6180339887498949;
+          unsigned int first = std::min( static_cast<unsigned int>( ( f - floor( f ) ) * numberOfPoints ), numberOfPoints - 1 );
+
+          grown.setRadius( T(0.95) * grown.getRadius() );
+          growSphere( grown, points, numberOfPoints, first, ( i & 1 ) == 0 );
+          if ( grown.getRadius() < sphere.getRadius() )
+          {
+            sphere = grown;
+          }
+        }
+      }
+
+      //  the growing steps are subject to rounding, so measure the final radius from the center
+      Vecnt<n,T> center = sphere.getCenter();
+      T maxRadius(0);
+      for ( unsigned int i=0 ; i<numberOfPoints ; i++ )
+      {
+        T d = lengthSquared( points[i] - center );
+        if ( maxRadius < d )
+        {
+          maxRadius = d;
+        }
+      }
+      return( Spherent<n,T>( center, sqrt( maxRadius ) ) );
+    }
+
     template<unsigned int n, typename T>
     inline Spherent<n,T> boundingSphere( const Spherent<n,T> & s0, const Spherent<n,T> & s1 )
     {
@@ -0,0 +1,531 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include <dp/math/Bounds.h>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#if defined(DP_ARCH_X86_64)
+// SSE2 is part of x86_64, so no runtime dispatch is needed
+#include <emmintrin.h>
+#define DP_MATH_BOUNDS_SSE2
+#endif
+
+namespace dp
+{
+  namespace math
+  {
+
+    namespace
+    {
+
+#if defined(DP_MATH_BOUNDS_SSE2)
+      // four floats of four different positions
+      struct Float4
+      {
+        Float4() {}
+        Float4( __m128 v ) : m_v( v ) {}
+        explicit Float4( float f ) : m_v( _mm_set1_ps( f ) ) {}
+        Float4( float f0, float f1, float f2, float f3 ) : m_v( _mm_setr_ps( f0, f1, f2, f3 ) ) {}
+
+        __m128 m_v;
+      };
+
+      inline Float4 operator+( Float4 a, Float4 b ) { return _mm_add_ps( a.m_v, b.m_v ); }
+      inline Float4 operator-( Float4 a, Float4 b ) { return _mm_sub_ps( a.m_v, b.m_v ); }
+      inline Float4 operator*( Float4 a, Float4 b ) { return _mm_mul_ps( a.m_v, b.m_v ); }
+      inline Float4 min( Float4 a, Float4 b ) { return _mm_min_ps( a.m_v, b.m_v ); }
+      inline Float4 max( Float4 a, Float4 b ) { return _mm_max_ps( a.m_v, b.m_v ); }
+      inline void store( Float4 a, float * f ) { _mm_storeu_ps( f, a.m_v ); }
+
+      // load four consecutive positions with three loads and transpose them to one register per component
+      inline void loadPoints( float const* p, Float4 & x, Float4 & y, Float4 & z )
+      {
+        __m128 v0 = _mm_loadu_ps( p );                                // x0 y0 z0 x1
+        __m128 v1 = _mm_loadu_ps( p + 4 );                            // y1 z1 x2 y2
+        __m128 v2 = _mm_loadu_ps( p + 8 );                            // z2 x3 y3 z3
+        __m128 a = _mm_shuffle_ps( v1, v2, _MM_SHUFFLE( 2, 1, 3, 2 ) ); // x2 y2 x3 y3
+        __m128 b = _mm_shuffle_ps( v0, v1, _MM_SHUFFLE( 1, 0, 2, 1 ) ); // y0 z0 y1 z1
+        x = _mm_shuffle_ps( v0, a, _MM_SHUFFLE( 2, 0, 3, 0 ) );
+        y = _mm_shuffle_ps( b, a, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+        z = _mm_shuffle_ps( b, v2, _MM_SHUFFLE( 3, 0, 3, 1 ) );
+      }
+#else
+      // portable fallback, simple enough for the compiler to vectorize
+      struct Float4
+      {
+        Float4() {}
+        explicit Float4( float f ) { m_v[0] = m_v[1] = m_v[2] = m_v[3] = f; }
+        Float4( float f0, float f1, float f2, float f3 ) { m_v[0] = f0; m_v[1] = f1; m_v[2] = f2; m_v[3] = f3; }
+
+        float m_v[4];
+      };
+
+      inline Float4 operator+( Float4 a, Float4 b ) { return Float4( a.m_v[0] + b.m_v[0], a.m_v[1] + b.m_v[1], a.m_v[2] + b.m_v[2], a.m_v[3] + b.m_v[3] ); }
+      inline Float4 operator-( Float4 a, Float4 b ) { return Float4( a.m_v[0] - b.m_v[0], a.m_v[1] - b.m_v[1], a.m_v[2] - b.m_v[2], a.m_v[3] - b.m_v[3] ); }
+      inline Float4 operator*( Float4 a, Float4 b ) { return Float4( a.m_v[0] * b.m_v[0], a.m_v[1] * b.m_v[1], a.m_v[2] * b.m_v[2], a.m_v[3] * b.m_v[3] ); }
+      inline Float4 min( Float4 a, Float4 b ) { return Float4( std::min( a.m_v[0], b.m_v[0] ), std::min( a.m_v[1], b.m_v[1] ), std::min( a.m_v[2], b.m_v[2] ), std::min( a.m_v[3], b.m_v[3] ) ); }
+      inline Float4 max( Float4 a, Float4 b ) { return Float4( std::max( a.m_v[0], b.m_v[0] ), std::max( a.m_v[1], b.m_v[1] ), std::max( a.m_v[2], b.m_v[2] ), std::max( a.m_v[3], b.m_v[3] ) ); }
+      inline void store( Float4 a, float * f ) { f[0] = a.m_v[0]; f[1] = a.m_v[1]; f[2] = a.m_v[2]; f[3] = a.m_v[3]; }
+
+      inline void loadPoints( float const* p, Float4 & x, Float4 & y, Float4 & z )
+      {
+        x = Float4( p[0], p[3], p[6], p[9] );
+        y = Float4( p[1], p[4], p[7], p[10] );
+        z = Float4( p[2], p[5], p[8], p[11] );
+      }
+#endif
+
+      // gather four arbitrary positions, reading just their three floats each
+      inline void loadPoints( float const* p0, float const* p1, float const* p2, float const* p3, Float4 & x, Float4 & y, Float4 & z )
+      {
+        x = Float4( p0[0], p1[0], p2[0], p3[0] );
+        y = Float4( p0[1], p1[1], p2[1], p3[1] );
+        z = Float4( p0[2], p1[2], p2[2], p3[2] );
+      }
+
+      class Points
+      {
+      public:
+        Points( float const* points, size_t strideInBytes, size_t count )
+          : m_data( reinterpret_cast<char const*>( points ) )
+          , m_stride( strideInBytes )
+          , m_count( count )
+        {
+          DP_ASSERT( !count || points );
+          DP_ASSERT( 3 * sizeof(float) <= strideInBytes );
+        }
+
+        float const* operator[]( size_t index ) const { return reinterpret_cast<float const*>( m_data + index * m_stride ); }
+        size_t getCount() const { return m_count; }
+        bool isContiguous() const { return m_stride == 3 * sizeof(float); }
+
+      private:
+        char const* m_data;
+        size_t      m_stride;
+        size_t      m_count;
+      };
+
+      class BoxAccumulator
+      {
+      public:
+        BoxAccumulator()
+          : m_lowerX( std::numeric_limits<float>::max() )
+          , m_lowerY( std::numeric_limits<float>::max() )
+          , m_lowerZ( std::numeric_limits<float>::max() )
+          , m_upperX( -std::numeric_limits<float>::max() )
+          , m_upperY( -std::numeric_limits<float>::max() )
+          , m_upperZ( -std::numeric_limits<float>::max() )
+        {
+        }
+
+        void operator()( Float4 x, Float4 y, Float4 z )
+        {
+          m_lowerX = min( m_lowerX, x );
+          m_lowerY = min( m_lowerY, y );
+          m_lowerZ = min( m_lowerZ, z );
+          m_upperX = max( m_upperX, x );
+          m_upperY = max( m_upperY, y );
+          m_upperZ = max( m_upperZ, z );
+        }
+
+        void operator()( float const* p )
+        {
+          m_box.update( Vec3f( p[0], p[1], p[2] ) );
+        }
+
+        Box3f getBox() const
+        {
+          // the lanes still at their initial values just reproduce the empty box
+          float lower[3][4], upper[3][4];
+          store( m_lowerX, lower[0] );
+          store( m_lowerY, lower[1] );
+          store( m_lowerZ, lower[2] );
+          store( m_upperX, upper[0] );
+          store( m_upperY, upper[1] );
+          store( m_upperZ, upper[2] );
+
+          Vec3f boxLower( m_box.getLower() );
+          Vec3f boxUpper( m_box.getUpper() );
+          for ( unsigned int i = 0 ; i < 3 ; ++i )
+          {
+            for ( unsigned int lane = 0 ; lane < 4 ; ++lane )
+            {
+              boxLower[i] = std::min( boxLower[i], lower[i][lane] );
+              boxUpper[i] = std::max( boxUpper[i], upper[i][lane] );
+            }
+          }
+          return( ( boxLower[0] <= boxUpper[0] ) ? Box3f( boxLower, boxUpper ) : Box3f() );
+        }
+
+      private:
+        Float4  m_lowerX, m_lowerY, m_lowerZ;
+        Float4  m_upperX, m_upperY, m_upperZ;
+        Box3f   m_box;
+      };
+
+      class DistanceAccumulator
+      {
+      public:
+        DistanceAccumulator( Vec3f const& center )
+          : m_center( center )
+          , m_centerX( center[0] )
+          , m_centerY( center[1] )
+          , m_centerZ( center[2] )
+          , m_max4( 0.0f )
+          , m_max( 0.0f )
+        {
+        }
+
+        void operator()( Float4 x, Float4 y, Float4 z )
+        {
+          Float4 dx = x - m_centerX;
+          Float4 dy = y - m_centerY;
+          Float4 dz = z - m_centerZ;
+          m_max4 = max( m_max4, dx * dx + dy * dy + dz * dz );
+        }
+
+        void operator()( float const* p )
+        {
+          m_max = std::max( m_max, lengthSquared( Vec3f( p[0], p[1], p[2] ) - m_center ) );
+        }
+
+        float getMaxDistance() const
+        {
+          float max4[4];
+          store( m_max4, max4 );
+          return( std::sqrt( std::max( std::max( m_max, std::max( max4[0], max4[1] ) ), std::max( max4[2], max4[3] ) ) ) );
+        }
+
+      private:
+        Vec3f   m_center;
+        Float4  m_centerX, m_centerY, m_centerZ;
+        Float4  m_max4;
+        float   m_max;
+      };
+
+      // hand groups of four positions to the vector path of the accumulator, the remaining ones to the scalar path
+      template <typename Accumulator>
+      void accumulate( Points const& points, Accumulator & accumulator )
+      {
+        size_t count = points.getCount();
+        size_t i = 0;
+        Float4 x, y, z;
+        if ( points.isContiguous() )
+        {
+          for ( ; i + 4 <= count ; i += 4 )
+          {
+            loadPoints( points[i], x, y, z );
+            accumulator( x, y, z );
+          }
+        }
+        else
+        {
+          for ( ; i + 4 <= count ; i += 4 )
+          {
+            loadPoints( points[i], points[i + 1], points[i + 2], points[i + 3], x, y, z );
+            accumulator( x, y, z );
+          }
+        }
+        for ( ; i < count ; ++i )
+        {
+          accumulator( points[i] );
+        }
+      }
+
+      template <typename IndexType, typename Accumulator>
+      size_t accumulate( Points const& points, IndexType const* indices, size_t indexCount, unsigned int primitiveRestartIndex, Accumulator & accumulator )
+      {
+        DP_ASSERT( !indexCount || indices );
+
+        size_t invalidIndexCount = 0;
+        float const* p[4];
+        unsigned int n = 0;
+        Float4 x, y, z;
+        for ( size_t i = 0 ; i < indexCount ; ++i )
+        {
+          // compare like the scalar code did, with signed indices converted to unsigned int
+          unsigned int index = static_cast<unsigned int>( indices[i] );
+          if ( index != primitiveRestartIndex )
+          {
+            if ( index < points.getCount() )
+            {
+              p[n++] = points[index];
+              if ( n == 4 )
+              {
+                loadPoints( p[0], p[1], p[2], p[3], x, y, z );
+                accumulator( x, y, z );
+                n = 0;
+              }
+            }
+            else
+            {
+              ++invalidIndexCount;
+            }
+          }
+        }
+        for ( unsigned int i = 0 ; i < n ; ++i )
+        {
+          accumulator( p[i] );
+        }
+        return( invalidIndexCount );
+      }
+
+      template <typename Accumulator>
+      void accumulate( Points const& points, void const* indices, dp::DataType indexType, size_t indexCount
+                     , unsigned int primitiveRestartIndex, size_t * invalidIndexCount, Accumulator & accumulator )
+      {
+        size_t invalid = 0;
+        switch ( indexType )
+        {
+          case dp::DataType::UNSIGNED_INT_8:
+            invalid = accumulate( points, reinterpret_cast<uint8_t const*>( indices ), indexCount, primitiveRestartIndex, accumulator );
+            break;
+          case dp::DataType::UNSIGNED_INT_16:
+            invalid = accumulate( points, reinterpret_cast<uint16_t const*>( indices ), indexCount, primitiveRestartIndex, accumulator );
+            break;
+          case dp::DataType::UNSIGNED_INT_32:
+            invalid = accumulate( points, reinterpret_cast<uint32_t const*>( indices ), indexCount, primitiveRestartIndex, accumulator );
+            break;
+          case dp::DataType::INT_8:
+            invalid = accumulate( points, reinterpret_cast<int8_t const*>( indices ), indexCount, primitiveRestartIndex, accumulator );
+            break;
+          case dp::DataType::INT_16:
+            invalid = accumulate( points, reinterpret_cast<int16_t const*>( indices ), indexCount, primitiveRestartIndex, accumulator );
+            break;
+          case dp::DataType::INT_32:
+            invalid = accumulate( points, reinterpret_cast<int32_t const*>( indices ), indexCount, primitiveRestartIndex, accumulator );
+            break;
+          default:
+            DP_ASSERT( !"unsupported index type" );
+            break;
+        }
+        if ( invalidIndexCount )
+        {
+          *invalidIndexCount = invalid;
+        }
+      }
+
+      // random access to the positions as Vec3f, as used by ritterSphere
+      class PositionIterator
+      {
+      public:
+        PositionIterator( Points const& points )
+          : m_points( points )
+        {
+        }
+
+        Vec3f operator[]( unsigned int index ) const
+        {
+          float const* p = m_points[index];
+          return( Vec3f( p[0], p[1], p[2] ) );
+        }
+
+      private:
+        Points const& m_points;
+      };
+
+      // random access to indexed positions, restart and out of range indices read the position of a valid index instead
+      template <typename IndexType>
+      class IndexedPositionIterator
+      {
+      public:
+        IndexedPositionIterator( Points const& points, IndexType const* indices, unsigned int primitiveRestartIndex, unsigned int replacement )
+          : m_points( points )
+          , m_indices( indices )
+          , m_primitiveRestartIndex( primitiveRestartIndex )
+          , m_replacement( replacement )
+        {
+        }
+
+        Vec3f operator[]( unsigned int i ) const
+        {
+          unsigned int index = static_cast<unsigned int>( m_indices[i] );
+          float const* p = m_points[( ( index != m_primitiveRestartIndex ) && ( index < m_points.getCount() ) ) ? index : m_replacement];
+          return( Vec3f( p[0], p[1], p[2] ) );
+        }
+
+      private:
+        Points const&     m_points;
+        IndexType const*  m_indices;
+        unsigned int      m_primitiveRestartIndex;
+        unsigned int      m_replacement;
+      };
+
+      template <typename IndexType>
+      Sphere3f indexedRitterSphere( Points const& points, IndexType const* indices, size_t indexCount, unsigned int primitiveRestartIndex
+                           , BoundingSphereMethod method, size_t & invalidIndexCount )
+      {
+        DP_ASSERT( !indexCount || indices );
+
+        // visiting a position more than once does not change the sphere, so the indices are used in place, with the
+        // restart and out of range indices replaced by the first valid one
+        bool found = false;
+        unsigned int replacement = 0;
+        invalidIndexCount = 0;
+        for ( size_t i = 0 ; i < indexCount ; ++i )
+        {
+          unsigned int index = static_cast<unsigned int>( indices[i] );
+          if ( index != primitiveRestartIndex )
+          {
+            if ( index < points.getCount() )
+            {
+              if ( !found )
+              {
+                found = true;
+                replacement = index;
+              }
+            }
+            else
+            {
+              ++invalidIndexCount;
+            }
+          }
+        }
+        return( found
+              ? ritterSphere<3,float>( IndexedPositionIterator<IndexType>( points, indices, primitiveRestartIndex, replacement )
+                                     , dp::checked_cast<unsigned int>( indexCount ), method )
+              : Sphere3f() );
+      }
+
+      Sphere3f indexedRitterSphere( Points const& points, void const* indices, dp::DataType indexType, size_t indexCount
+                           , unsigned int primitiveRestartIndex, BoundingSphereMethod method, size_t * invalidIndexCount )
+      {
+        Sphere3f sphere;
+        size_t invalid = 0;
+        switch ( indexType )
+        {
+          case dp::DataType::UNSIGNED_INT_8:
+            sphere = indexedRitterSphere( points, reinterpret_cast<uint8_t const*>( indices ), indexCount, primitiveRestartIndex, method, invalid );
+            break;
+          case dp::DataType::UNSIGNED_INT_16:
+            sphere = indexedRitterSphere( points, reinterpret_cast<uint16_t const*>( indices ), indexCount, primitiveRestartIndex, method, invalid );
+            break;
+          case dp::DataType::UNSIGNED_INT_32:
+            sphere = indexedRitterSphere( points, reinterpret_cast<uint32_t const*>( indices ), indexCount, primitiveRestartIndex, method, invalid );
+            break;
+          case dp::DataType::INT_8:
+            sphere = indexedRitterSphere( points, reinterpret_cast<int8_t const*>( indices ), indexCount, primitiveRestartIndex, method, invalid );
+            break;
+          case dp::DataType::INT_16:
+            sphere = indexedRitterSphere( points, reinterpret_cast<int16_t const*>( indices ), indexCount, primitiveRestartIndex, method, invalid );
+            break;
+          case dp::DataType::INT_32:
+            sphere = indexedRitterSphere( points, reinterpret_cast<int32_t const*>( indices ), indexCount, primitiveRestartIndex, method, invalid );
+            break;
+          default:
+            DP_ASSERT( !"unsupported index type" );
+            break;
+        }
+        if ( invalidIndexCount )
+        {
+          *invalidIndexCount = invalid;
+        }
+        return( sphere );
+      }
+
+    } // namespace
+
+    Box3f boundingBox( float const* points, size_t strideInBytes, size_t count )
+    {
+      BoxAccumulator accumulator;
+      accumulate( Points( points, strideInBytes, count ), accumulator );
+      return( accumulator.getBox() );
+    }
+
+    Box3f boundingBox( float const* points, size_t strideInBytes, size_t count
+                     , void const* indices, dp::DataType indexType, size_t indexCount
+                     , unsigned int primitiveRestartIndex, size_t * invalidIndexCount )
+    {
+      BoxAccumulator accumulator;
+      accumulate( Points( points, strideInBytes, count ), indices, indexType, indexCount, primitiveRestartIndex, invalidIndexCount, accumulator );
+      return( accumulator.getBox() );
+    }
+
+    float maxDistance( float const* points, size_t strideInBytes, size_t count, Vec3f const& center )
+    {
+      DistanceAccumulator accumulator( center );
+      accumulate( Points( points, strideInBytes, count ), accumulator );
+      return( accumulator.getMaxDistance() );
+    }
+
+    float maxDistance( float const* points, size_t strideInBytes, size_t count
+                     , void const* indices, dp::DataType indexType, size_t indexCount, Vec3f const& center
+                     , unsigned int primitiveRestartIndex, size_t * invalidIndexCount )
+    {
+      DistanceAccumulator accumulator( center );
+      accumulate( Points( points, strideInBytes, count ), indices, indexType, indexCount, primitiveRestartIndex, invalidIndexCount, accumulator );
+      return( accumulator.getMaxDistance() );
+    }
+
+    void boundingBoxAndSphere( float const* points, size_t strideInBytes, size_t count, Box3f & box, Sphere3f & sphere )
+    {
+      box = boundingBox( points, strideInBytes, count );
+      sphere = isValid( box ) ? Sphere3f( box.getCenter(), maxDistance( points, strideInBytes, count, box.getCenter() ) ) : Sphere3f();
+    }
+
+    void boundingBoxAndSphere( float const* points, size_t strideInBytes, size_t count
+                             , void const* indices, dp::DataType indexType, size_t indexCount
+                             , Box3f & box, Sphere3f & sphere
+                             , unsigned int primitiveRestartIndex, size_t * invalidIndexCount )
+    {
+      box = boundingBox( points, strideInBytes, count, indices, indexType, indexCount, primitiveRestartIndex, invalidIndexCount );
+      sphere = isValid( box )
+             ? Sphere3f( box.getCenter(), maxDistance( points, strideInBytes, count, indices, indexType, indexCount, box.getCenter(), primitiveRestartIndex ) )
+             : Sphere3f();
+    }
+
+    Sphere3f boundingSphere( float const* points, size_t strideInBytes, size_t count, BoundingSphereMethod method )
+    {
+      if ( method == BoundingSphereMethod::BOX_CENTER )
+      {
+        Box3f box;
+        Sphere3f sphere;
+        boundingBoxAndSphere( points, strideInBytes, count, box, sphere );
+        return( sphere );
+      }
+      Points p( points, strideInBytes, count );
+      return( ritterSphere<3,float>( PositionIterator( p ), dp::checked_cast<unsigned int>( count ), method ) );
+    }
+
+    Sphere3f boundingSphere( float const* points, size_t strideInBytes, size_t count
+                           , void const* indices, dp::DataType indexType, size_t indexCount, BoundingSphereMethod method
+                           , unsigned int primitiveRestartIndex, size_t * invalidIndexCount )
+    {
+      if ( method == BoundingSphereMethod::BOX_CENTER )
+      {
+        Box3f box;
+        Sphere3f sphere;
+        boundingBoxAndSphere( points, strideInBytes, count, indices, indexType, indexCount, box, sphere, primitiveRestartIndex, invalidIndexCount );
+        return( sphere );
+      }
+      return( indexedRitterSphere( Points( points, strideInBytes, count ), indices, indexType, indexCount, primitiveRestartIndex, method, invalidIndexCount ) );
+    }
+
+  } // namespace math
+} // namespace dp
@@ -0,0 +1,62 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#pragma once
+
+#include <dp/sg/algorithm/Config.h>
+#include <dp/sg/core/CoreTypes.h>
+
+namespace dp
+{
+  namespace sg
+  {
+    namespace algorithm
+    {
+
+      /** \brief Calculate the bounding volumes of all nodes and primitives below a node in parallel.
+          \param root The node whose subgraph gets its bounding boxes and bounding spheres calculated.
+          \param threadCount The number of threads to use, including the calling thread. If 0, the number
+                 of hardware threads is used. If 1, the bounding volumes are calculated on the calling thread.
+          \remarks The objects are processed level by level, starting at the leaves, such that each object
+                   finds the bounding volumes of its children already calculated. Objects shared in the graph
+                   are calculated just once. The graph must not be modified while the bounding volumes are
+                   calculated, and the vertex and index buffers must be readable from any thread, as it is the
+                   case for host buffers.
+      **/
+      DP_SG_ALGORITHM_API void computeBoundingVolumes( const dp::sg::core::NodeSharedPtr & root, unsigned int threadCount = 0 );
+
+      /** \brief Calculate the bounding volumes of all nodes and primitives of a scene in parallel.
+          \param scene The scene whose bounding volumes are calculated.
+          \param threadCount The number of threads to use, including the calling thread. If 0, the number
+                 of hardware threads is used.
+          \sa computeBoundingVolumes( const dp::sg::core::NodeSharedPtr &, unsigned int )
+      **/
+      DP_SG_ALGORITHM_API void computeBoundingVolumes( const dp::sg::core::SceneSharedPtr & scene, unsigned int threadCount = 0 );
+
+    } // namespace algorithm
+  } // namespace sg
+} // namespace dp
@@ -0,0 +1,168 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include <dp/sg/algorithm/BoundingVolumes.h>
+#include <dp/sg/core/GeoNode.h>
+#include <dp/sg/core/Group.h>
+#include <dp/sg/core/Scene.h>
+#include <dp/util/WorkerPool.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+using namespace dp::sg::core;
+
+namespace dp
+{
+  namespace sg
+  {
+    namespace algorithm
+    {
+
+      namespace
+      {
+        void gatherChildren( BoundingVolumeObject const* object, std::vector<BoundingVolumeObject const*> & children )
+        {
+          if ( Group const* group = dynamic_cast<Group const*>( object ) )
+          {
+            for ( Group::ChildrenConstIterator it = group->beginChildren() ; it != group->endChildren() ; ++it )
+            {
+              children.push_back( it->get() );
+            }
+          }
+          else if ( GeoNode const* geoNode = dynamic_cast<GeoNode const*>( object ) )
+          {
+            if ( geoNode->getPrimitive() )
+            {
+              children.push_back( geoNode->getPrimitive().get() );
+            }
+          }
+        }
+
+        struct Frame
+        {
+          Frame( BoundingVolumeObject const* o )
+            : object( o )
+            , next( 0 )
+            , height( 0 )
+          {
+            gatherChildren( object, children );
+          }
+
+          BoundingVolumeObject const*               object;
+          std::vector<BoundingVolumeObject const*>  children;
+          size_t                                    next;
+          unsigned int                              height;
+        };
+
+        /** \brief Sort the objects below root by their height, which is the length of the longest path down to a leaf.
+            All children of an object are of a lower height than the object itself. The graph is traversed iteratively,
+            as scenes might be too deep for a recursive traversal.
+        **/
+        void gatherLevels( BoundingVolumeObject const* root, std::vector<std::vector<BoundingVolumeObject const*>> & levels )
+        {
+          std::unordered_map<BoundingVolumeObject const*, unsigned int> heights;
+          std::vector<Frame> stack;
+          stack.push_back( Frame( root ) );
+          while ( !stack.empty() )
+          {
+            Frame & frame = stack.back();
+            if ( frame.next < frame.children.size() )
+            {
+              BoundingVolumeObject const* child = frame.children[frame.next++];
+              std::unordered_map<BoundingVolumeObject const*, unsigned int>::const_iterator it = heights.find( child );
+              if ( it != heights.end() )
+              {
+                frame.height = std::max( frame.height, it->second + 1 );
+              }
+              else
+              {
+                stack.push_back( Frame( child ) );    // invalidates frame
+              }
+            }
+            else
+            {
+              unsigned int height = frame.height;
+              heights[frame.object] = height;
+              if ( levels.size() <= height )
+              {
+                levels.resize( height + 1 );
+              }
+              levels[height].push_back( frame.object );
+              stack.pop_back();
+              if ( !stack.empty() )
+              {
+                stack.back().height = std::max( stack.back().height, height + 1 );
+              }
+            }
+          }
+        }
+      }
+
+      void computeBoundingVolumes( const NodeSharedPtr & root, unsigned int threadCount )
+      {
+        if ( !root )
+        {
+          return;
+        }
+
+        std::vector<std::vector<BoundingVolumeObject const*>> levels;
+        gatherLevels( root.get(), levels );
+
+        dp::util::WorkerPoolSharedPtr workerPool = ( threadCount != 1 ) ? dp::util::WorkerPool::create( threadCount ) : nullptr;
+        for ( size_t level = 0 ; level < levels.size() ; ++level )
+        {
+          std::vector<BoundingVolumeObject const*> const& objects = levels[level];
+          std::function<void( size_t )> task = [&objects]( size_t index )
+          {
+            objects[index]->getBoundingBox();
+            objects[index]->getBoundingSphere();
+          };
+
+          if ( workerPool )
+          {
+            workerPool->execute( objects.size(), task );
+          }
+          else
+          {
+            for ( size_t index = 0 ; index < objects.size() ; ++index )
+            {
+              task( index );
+            }
+          }
+        }
+      }
+
+      void computeBoundingVolumes( const SceneSharedPtr & scene, unsigned int threadCount )
+      {
+        DP_ASSERT( scene );
+        computeBoundingVolumes( scene->getRootNode(), threadCount );
+      }
+
+    } // namespace algorithm
+  } // namespace sg
+} // namespace dp
@@ -28,6 +28,8 @@
 /** @file */
 
 #include <dp/sg/core/Object.h>
+#include <atomic>
+#include <thread>
 
 namespace dp
 {
@@ -41,6 +43,9 @@ namespace dp
        * bounding volume functionality.
        * Override the protected virtual functions calculateBoundingBox and calculateBoundingSphere
        * in the derived class to calculate the right bounding volume data for the class.
+       * The bounding volumes can be queried concurrently from multiple threads, as long as the
+       * object is not modified at the same time. Only one thread calculates a dirty bounding volume,
+       * the others wait for the result.
        */
       class BoundingVolumeObject : public Object
       {
@@ -100,9 +105,17 @@ namespace dp
          */
         virtual dp::math::Sphere3f calculateBoundingSphere() const;
 
+        /*! \brief Invalidate the cached bounding sphere of the object.
+         *  \remarks The next call to getBoundingSphere recalculates it. Use this when the way the bounding sphere is
+         *  calculated changes, without any change of the data it is calculated from.
+         */
+        void invalidateBoundingSphere();
+
       private:
         mutable dp::math::Box3f     m_boundingBox;    //!< The cached bounding box of the object
         mutable dp::math::Sphere3f  m_boundingSphere; //!< The cached bounding sphere of the object.
+        mutable std::atomic_flag    m_boundingBoxLock;    //!< Serializes the calculation of the bounding box.
+        mutable std::atomic_flag    m_boundingSphereLock; //!< Serializes the calculation of the bounding sphere.
       };
 
 
@@ -110,8 +123,17 @@ namespace dp
       {
         if( !!( this->m_dirtyState & this->DP_SG_BOUNDING_BOX ) )
         {
-          this->m_dirtyState &= ~this->DP_SG_BOUNDING_BOX;
-          m_boundingBox = calculateBoundingBox();
+          while ( m_boundingBoxLock.test_and_set( std::memory_order_acquire ) )
+          {
+            std::this_thread::yield();
+          }
+          // another thread might have calculated the bounding box in the meantime
+          if( !!( this->m_dirtyState & this->DP_SG_BOUNDING_BOX ) )
+          {
+            m_boundingBox = calculateBoundingBox();
+            this->m_dirtyState &= ~this->DP_SG_BOUNDING_BOX;
+          }
+          m_boundingBoxLock.clear( std::memory_order_release );
         }
         return m_boundingBox;
       }
@@ -120,14 +142,30 @@ namespace dp
       {
         if( !!( this->m_dirtyState & this->DP_SG_BOUNDING_SPHERE ) )
         {
-          this->m_dirtyState &= ~this->DP_SG_BOUNDING_SPHERE;
-          m_boundingSphere = calculateBoundingSphere();
+          while ( m_boundingSphereLock.test_and_set( std::memory_order_acquire ) )
+          {
+            std::this_thread::yield();
+          }
+          // another thread might have calculated the bounding sphere in the meantime
+          if( !!( this->m_dirtyState & this->DP_SG_BOUNDING_SPHERE ) )
+          {
+            m_boundingSphere = calculateBoundingSphere();
+            this->m_dirtyState &= ~this->DP_SG_BOUNDING_SPHERE;
+          }
+          m_boundingSphereLock.clear( std::memory_order_release );
         }
         return m_boundingSphere;
       }
 
+      inline void BoundingVolumeObject::invalidateBoundingSphere()
+      {
+        this->m_dirtyState |= this->DP_SG_BOUNDING_SPHERE;
+      }
+
       inline BoundingVolumeObject::BoundingVolumeObject()
       {
+        m_boundingBoxLock.clear();
+        m_boundingSphereLock.clear();
       }
 
       inline BoundingVolumeObject::BoundingVolumeObject( const BoundingVolumeObject &rhs )
@@ -135,6 +173,8 @@ namespace dp
         , m_boundingBox( rhs.m_boundingBox )
         , m_boundingSphere( rhs.m_boundingSphere )
       {
+        m_boundingBoxLock.clear();
+        m_boundingSphereLock.clear();
       }
 
       inline BoundingVolumeObject::~BoundingVolumeObject()
@@ -36,6 +36,8 @@
 #include <dp/util/HashGenerator.h>
 #include <dp/util/StridedIterator.h>
 #include <cstring>
+#include <mutex>
+#include <vector>
 
 namespace dp
 {
@@ -53,18 +55,66 @@ namespace dp
       class Buffer : public HandledObject
       {
       public:
+        /** \brief A range of bytes within a Buffer. **/
+        struct Range
+        {
+          size_t offset;
+          size_t length;
+        };
+
+        /** \brief Sorted list of disjoint byte ranges. An added range is merged with all ranges it overlaps or touches,
+                   so consumers can collect the writes of several map/unmap calls and handle each byte only once.
+        **/
+        class RangeList
+        {
+        public:
+          DP_SG_CORE_API void add( size_t offset, size_t length );
+          void clear() { m_ranges.clear(); }
+          bool empty() const { return m_ranges.empty(); }
+
+          std::vector<Range> const& getRanges() const { return m_ranges; }
+
+          /** \brief Returns the number of bytes covered by all ranges. **/
+          DP_SG_CORE_API size_t getByteCount() const;
+
+        private:
+          std::vector<Range> m_ranges;
+        };
+
+        /** \brief Event sent after a range of the buffer has been written. **/
         class Event : public core::Event
         {
         public:
+          /** \brief Event for a change of the whole buffer. **/
           Event( Buffer const* buffer )
             : core::Event( core::Event::Type::BUFFER )
             , m_buffer( buffer)
+            , m_offset( 0 )
+            , m_length( buffer->getSize() )
+          {
+          }
+
+          Event( Buffer const* buffer, size_t offset, size_t length )
+            : core::Event( core::Event::Type::BUFFER )
+            , m_buffer( buffer)
+            , m_offset( offset )
+            , m_length( length )
           {
           }
 
           Buffer const* getBuffer() const { return m_buffer; }
+
+          /** \brief Returns the offset in bytes of the written range. **/
+          size_t getOffset() const { return m_offset; }
+
+          /** \brief Returns the length in bytes of the written range. **/
+          size_t getLength() const { return m_length; }
+
+          virtual std::unique_ptr<dp::util::Event> clone() const { return std::unique_ptr<dp::util::Event>( new Event( *this ) ); }
         private:
           const Buffer* m_buffer;
+          size_t        m_offset;
+          size_t        m_length;
         };
 
       public:
@@ -248,6 +298,7 @@ namespace dp
 
       protected:
         DP_SG_CORE_API Buffer();
+        DP_SG_CORE_API Buffer( const Buffer & rhs );
 
         /**
          * \brief Retrieve pointer to a range within buffer data. Only use the pointers the way the MapMode describes it!
@@ -279,12 +330,28 @@ namespace dp
         void unlock();
         void unlockRead() const;
 
+        /** \brief Notify the observers that the range mapped for writing has been written. Implementations call this
+                   on unmap. While the buffer is write locked, the range is narrowed to the union of the locked ranges.
+        **/
+        DP_SG_CORE_API void notifyWrite( size_t offset, size_t length );
+
+      private:
+        void addWrittenRange( size_t offset, size_t length );
+
       private:
+        mutable std::mutex        m_lockMutex;            // guards the lock count, as the buffer might be read locked concurrently. Not held while notifying.
         mutable int               m_lockCount;
         mutable void*             m_mappedPtr;
         bool                      m_managedBySystem;
-        mutable dp::util::HashKey m_hashKey;
-        mutable bool              m_hashKeyValid;
+        size_t                    m_lockBegin;            // union of the ranges write locked since the first lock
+        size_t                    m_lockEnd;
+
+        // the hash key is combined from the keys of blocks of hashBlockSize bytes, only the written blocks are rehashed
+        mutable dp::util::HashKey               m_hashKey;
+        mutable bool                            m_hashKeyValid;
+        mutable size_t                          m_hashedSize;
+        mutable std::vector<dp::util::HashKey>  m_blockHashKeys;
+        mutable RangeList                       m_hashDirtyRanges;
       };
 
       inline Buffer::MapModeMask operator|( Buffer::MapMode bit0, Buffer::MapMode bit1 )
@@ -325,7 +392,7 @@ namespace dp
           unmap();
 
           free( tmpData );
-          m_hashKeyValid = false;
+          addWrittenRange( 0, newSize );
         }
         else
         {
@@ -335,28 +402,37 @@ namespace dp
 
       inline void *Buffer::lock( Buffer::MapMode mapMode )
       {
-        if (!m_lockCount)
-        {
-          m_mappedPtr = map( mapMode );
-        }
-        ++m_lockCount;
-        m_hashKeyValid = false;
-        return m_mappedPtr;
+        return lock( mapMode, 0, getSize() );
       }
 
       inline void *Buffer::lock( Buffer::MapMode mapMode, size_t offset, size_t length )
       {
+        std::lock_guard<std::mutex> guard( m_lockMutex );
         if (!m_lockCount)
         {
           m_mappedPtr = map( mapMode, 0, getSize() );
         }
         ++m_lockCount;
-        m_hashKeyValid = false;
+        if ( MapModeMask( mapMode ) & MapMode::WRITE )
+        {
+          if ( m_lockBegin < m_lockEnd )
+          {
+            m_lockBegin = std::min( m_lockBegin, offset );
+            m_lockEnd = std::max( m_lockEnd, offset + length );
+          }
+          else
+          {
+            m_lockBegin = offset;
+            m_lockEnd = offset + length;
+          }
+          addWrittenRange( offset, length );
+        }
         return (char *)m_mappedPtr + offset;
       }
 
       inline const void *Buffer::lockRead() const
       {
+        std::lock_guard<std::mutex> guard( m_lockMutex );
         if (!m_lockCount)
         {
           m_mappedPtr = const_cast<void*>(mapRead( ));
@@ -367,6 +443,7 @@ namespace dp
 
       inline const void *Buffer::lockRead( size_t offset, size_t length ) const
       {
+        std::lock_guard<std::mutex> guard( m_lockMutex );
         if (!m_lockCount)
         {
           m_mappedPtr = const_cast<void*>(mapRead( 0, getSize() ));
@@ -377,17 +454,31 @@ namespace dp
 
       inline void Buffer::unlock()
       {
-        assert(!m_hashKeyValid);
-        --m_lockCount;
-        if (!m_lockCount)
         {
-          unmap();
+          std::lock_guard<std::mutex> guard( m_lockMutex );
+          --m_lockCount;
+          if ( m_lockCount )
+          {
+            return;
+          }
           m_mappedPtr = nullptr;
         }
+
+        // unmap notifies the observers of a write lock, which might read the buffer, so the mutex must not be held
+        unmap();
+        m_lockBegin = 0;
+        m_lockEnd = 0;
+      }
+
+      inline void Buffer::addWrittenRange( size_t offset, size_t length )
+      {
+        m_hashKeyValid = false;
+        m_hashDirtyRanges.add( offset, length );
       }
 
       inline void Buffer::unlockRead() const
       {
+        std::lock_guard<std::mutex> guard( m_lockMutex );
         --m_lockCount;
         if (!m_lockCount)
         {
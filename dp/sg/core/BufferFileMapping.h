@@ -0,0 +1,89 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#pragma once
+/** @file */
+
+#include <dp/sg/core/BufferHost.h>
+#include <dp/util/FileMapping.h>
+
+namespace dp
+{
+  namespace sg
+  {
+    namespace core
+    {
+
+      /** \brief Buffer referencing a range of a file mapping instead of copying it. Reading accesses the mapped file
+       *  directly. The first write access, resize or setUnmanagedDataPtr copies the data to the host and releases the
+       *  mapping, from then on the buffer behaves like a BufferHost. The ReadMapping stays alive as long as a buffer
+       *  references it, so loaders can hand out vertex and index data without touching it.
+       *  create throws a std::runtime_error if the range can't be mapped, ReadMapping::getLastError tells the reason.
+       *  \note ReadMapping is not thread-safe. The buffers of one mapping must not be created, cloned, written or
+       *  destroyed concurrently.
+       *  \sa BufferHost, dp::util::ReadMapping
+      **/
+      class BufferFileMapping : public BufferHost
+      {
+      public:
+        DP_SG_CORE_API static BufferFileMappingSharedPtr create( std::shared_ptr<dp::util::ReadMapping> const& mapping, size_t offset, size_t size );
+
+        DP_SG_CORE_API virtual HandledObjectSharedPtr clone() const;
+
+        DP_SG_CORE_API virtual ~BufferFileMapping();
+
+      public:
+        /** \brief Returns true as long as the data is read from the mapped file. **/
+        bool isFileMapped() const;
+
+        DP_SG_CORE_API virtual void setUnmanagedDataPtr( void *data );
+        DP_SG_CORE_API virtual void setSize( size_t size );
+
+      protected:
+        DP_SG_CORE_API BufferFileMapping( std::shared_ptr<dp::util::ReadMapping> const& mapping, size_t offset, size_t size );
+        DP_SG_CORE_API BufferFileMapping( BufferFileMapping const& rhs );
+
+        using BufferHost::map;
+        DP_SG_CORE_API virtual void *map( MapMode mode, size_t offset, size_t length );
+
+      private:
+        void copyOnWrite();
+        void releaseMapping();
+
+      private:
+        std::shared_ptr<dp::util::ReadMapping>  m_mapping;
+        size_t                                  m_fileOffset;
+      };
+
+      inline bool BufferFileMapping::isFileMapped() const
+      {
+        return( !!m_mapping );
+      }
+
+    } // namespace core
+  } // namespace sg
+} // namespace dp
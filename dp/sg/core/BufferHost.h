@@ -69,6 +69,8 @@ namespace dp
         size_t                      m_sizeInBytes;
         char*                       m_data;
         mutable Buffer::MapModeMask m_mapMode;
+        size_t                      m_mapOffset;
+        size_t                      m_mapLength;
         bool                        m_managed;
       };
 
@@ -74,6 +74,7 @@ namespace dp
     {
       DEFINE_PTR_TYPES( Billboard );
       DEFINE_PTR_TYPES( Buffer );
+      DEFINE_PTR_TYPES( BufferFileMapping );
       DEFINE_PTR_TYPES( BufferHost );
       DEFINE_PTR_TYPES( Camera );
       DEFINE_PTR_TYPES( ClipPlane );
@@ -138,6 +139,7 @@ namespace dp
     SHARED_OBJECT_TRAITS( dp::sg::core::Scene,               dp::sg::core::Object );
     SHARED_OBJECT_TRAITS( dp::sg::core::Buffer,              dp::sg::core::HandledObject );
     SHARED_OBJECT_TRAITS( dp::sg::core::BufferHost,          dp::sg::core::Buffer );
+    SHARED_OBJECT_TRAITS( dp::sg::core::BufferFileMapping,   dp::sg::core::BufferHost );
     SHARED_OBJECT_TRAITS( dp::sg::core::Sampler,             dp::sg::core::Object );
     SHARED_OBJECT_TRAITS( dp::sg::core::Texture,             dp::sg::core::HandledObject );
     SHARED_OBJECT_TRAITS( dp::sg::core::TextureFile,         dp::sg::core::Texture );
@@ -78,6 +78,8 @@ namespace dp
             GeoNode const* getGeoNode() const { return m_geoNode; }
             Type           getType() const { return m_type; }
 
+            virtual std::unique_ptr<dp::util::Event> clone() const { return std::unique_ptr<dp::util::Event>( new Event( *this ) ); }
+
           private:
             GeoNode const* m_geoNode;
             Type           m_type;
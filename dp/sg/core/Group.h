@@ -450,8 +450,10 @@ namespace dp
         // override getType from dp::sg::core::Event
         Type          getType() const         { return m_type; }
 
+        virtual std::unique_ptr<dp::util::Event> clone() const { return std::unique_ptr<dp::util::Event>( new Event( *this ) ); }
+
       private:
-        GroupSharedPtr const& m_group;
+        GroupSharedPtr        m_group;
         Type                  m_type;
         const NodeSharedPtr   m_child;
         unsigned int          m_index;
@@ -27,6 +27,7 @@
 #pragma once
 /** @file */
 
+#include <atomic>
 #include <typeinfo>
 #include <dp/sg/core/Config.h> // commonly used stuff
 #include <dp/math/Boxnt.h>
@@ -472,7 +473,7 @@ namespace dp
         unsigned int      m_hints;         // object exclusive hints
         unsigned int      m_traversalMask; // object traversal mask
 
-        mutable unsigned int m_dirtyState;
+        mutable std::atomic<unsigned int> m_dirtyState;   // atomic, as bounding volumes might be evaluated concurrently
       };
 
 
@@ -487,6 +488,8 @@ namespace dp
 
         Object const* getObject() const { return m_object; }
 
+        virtual std::unique_ptr<dp::util::Event> clone() const { return std::unique_ptr<dp::util::Event>( new Event( *this ) ); }
+
       private:
         Object const* m_object;
       };
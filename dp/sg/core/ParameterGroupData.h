@@ -95,8 +95,10 @@ namespace dp
             }
 
             const dp::fx::ParameterGroupSpec::iterator& getParameter() const { return m_parameter; }
+
+            virtual std::unique_ptr<dp::util::Event> clone() const { return std::unique_ptr<dp::util::Event>( new Event( *this ) ); }
           private:
-            const dp::fx::ParameterGroupSpec::iterator& m_parameter;
+            dp::fx::ParameterGroupSpec::iterator m_parameter;
           };
 
           REFLECTION_INFO_API( DP_SG_CORE_API, ParameterGroupData );
@@ -218,6 +218,15 @@ namespace dp
           DP_SG_CORE_API void setInstanceCount( unsigned int icount );
           DP_SG_CORE_API unsigned int getInstanceCount() const;
 
+          /*! \brief Set the algorithm to calculate the bounding sphere of this Primitive with.
+           *  \param method The algorithm to use.
+           *  \remarks The default, dp::math::BoundingSphereMethod::BOX_CENTER, reads the positions once, as the bounding box
+           *  is cached. The other methods read them a few more times, but often result in a considerably smaller sphere.
+           *  The sphere around the center of the bounding box is still calculated, and used if it is the smaller one.
+           *  \sa dp::math::ritterSphere */
+          DP_SG_CORE_API void setBoundingSphereMethod( dp::math::BoundingSphereMethod method );
+          DP_SG_CORE_API dp::math::BoundingSphereMethod getBoundingSphereMethod() const;
+
           /*! \brief Set the VertexAttributeSet.
            *  \param vash The VertexAttributeSet to set.
            *  \sa VertexAttributeSet */
@@ -456,6 +465,7 @@ namespace dp
           unsigned int                m_elementCount;
           unsigned int                m_instanceCount;
           unsigned int                m_renderFlags;
+          dp::math::BoundingSphereMethod m_boundingSphereMethod;
           mutable dp::math::Box3f     m_boundingBox;
           mutable dp::math::Sphere3f  m_boundingSphere;
           mutable unsigned int        m_cachedNumberOfPrimitives;
@@ -515,6 +525,11 @@ namespace dp
         return m_instanceCount;
       }
 
+      inline dp::math::BoundingSphereMethod Primitive::getBoundingSphereMethod() const
+      {
+        return( m_boundingSphereMethod );
+      }
+
       inline unsigned int Primitive::getNumberOfVerticesPerPrimitive() const
       {
         switch( getPrimitiveType() )
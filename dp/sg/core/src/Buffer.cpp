@@ -26,6 +26,7 @@
 
 #include <dp/sg/core/Buffer.h>
 #include <dp/util/HashGeneratorMurMur.h>
+#include <algorithm>
 
 namespace dp
 {
@@ -33,12 +34,90 @@ namespace dp
   {
     namespace core
     {
+      namespace
+      {
+        // granularity of the incremental hash key
+        const size_t hashBlockSize = 64 * 1024;
+
+        dp::util::HashKey hashBlock( const unsigned char * data, size_t size )
+        {
+          dp::util::HashKey key;
+          dp::util::HashGeneratorMurMur hg;
+          hg.update( data, dp::checked_cast<unsigned int>(size) );
+          hg.finalize( (unsigned int *)&key );
+          return( key );
+        }
+      }
+
+      void Buffer::RangeList::add( size_t offset, size_t length )
+      {
+        if ( !length )
+        {
+          return;
+        }
+
+        size_t end = offset + length;
+        if ( m_ranges.empty() || m_ranges.back().offset + m_ranges.back().length < offset )
+        {
+          // writes in increasing order just append
+          Range range = { offset, length };
+          m_ranges.push_back( range );
+          return;
+        }
+
+        // first range ending at or behind offset, and first range starting behind end
+        std::vector<Range>::iterator first = std::lower_bound( m_ranges.begin(), m_ranges.end(), offset
+                                                             , []( Range const& range, size_t value ) { return range.offset + range.length < value; } );
+        std::vector<Range>::iterator last = std::upper_bound( first, m_ranges.end(), end
+                                                            , []( size_t value, Range const& range ) { return value < range.offset; } );
+        if ( first == last )
+        {
+          Range range = { offset, length };
+          m_ranges.insert( first, range );
+        }
+        else
+        {
+          size_t begin = std::min( first->offset, offset );
+          end = std::max( (last - 1)->offset + (last - 1)->length, end );
+          first->offset = begin;
+          first->length = end - begin;
+          m_ranges.erase( first + 1, last );
+        }
+      }
+
+      size_t Buffer::RangeList::getByteCount() const
+      {
+        size_t count = 0;
+        for ( std::vector<Range>::const_iterator it = m_ranges.begin(); it != m_ranges.end(); ++it )
+        {
+          count += it->length;
+        }
+        return( count );
+      }
 
       Buffer::Buffer()
         : m_lockCount(0)
         , m_mappedPtr(nullptr)
         , m_managedBySystem(true)
+        , m_lockBegin(0)
+        , m_lockEnd(0)
         , m_hashKeyValid(false)
+        , m_hashedSize(0)
+      {
+      }
+
+      Buffer::Buffer( const Buffer & rhs )
+        : HandledObject( rhs )
+        , m_lockCount(0)
+        , m_mappedPtr(nullptr)
+        , m_managedBySystem(rhs.m_managedBySystem)
+        , m_lockBegin(0)
+        , m_lockEnd(0)
+        , m_hashKey(rhs.m_hashKey)
+        , m_hashKeyValid(rhs.m_hashKeyValid)
+        , m_hashedSize(rhs.m_hashedSize)
+        , m_blockHashKeys(rhs.m_blockHashKeys)
+        , m_hashDirtyRanges(rhs.m_hashDirtyRanges)
       {
       }
 
@@ -62,7 +141,7 @@ namespace dp
         void* to = map( MapMode::WRITE, dst_offset, size );
         memcpy( to, src_data, size );
         unmap();
-        m_hashKeyValid = false;
+        addWrittenRange( dst_offset, size );
       }
 
 
@@ -90,17 +169,63 @@ namespace dp
 
         src_buffer->unmapRead();
         unmap();
-        m_hashKeyValid = false;
+        addWrittenRange( offset, size );
+      }
+
+      void Buffer::notifyWrite( size_t offset, size_t length )
+      {
+        if ( m_lockBegin < m_lockEnd )
+        {
+          offset = m_lockBegin;
+          length = m_lockEnd - m_lockBegin;
+        }
+        notify( Event( this, offset, length ) );
       }
 
       dp::util::HashKey Buffer::getHashKey() const
       {
         if (!m_hashKeyValid)
         {
-          dp::util::HashGeneratorMurMur hg;
-          hg.update(reinterpret_cast<const unsigned char *>(lockRead()), dp::checked_cast<unsigned int>(getSize()));
-          unlockRead();
-          hg.finalize((unsigned int *)&m_hashKey);
+          size_t size = getSize();
+          size_t blockCount = ( size + hashBlockSize - 1 ) / hashBlockSize;
+          if ( blockCount )
+          {
+            const unsigned char * data = reinterpret_cast<const unsigned char *>(lockRead());
+            if ( size != m_hashedSize )
+            {
+              m_blockHashKeys.resize( blockCount );
+              for ( size_t block = 0; block < blockCount; ++block )
+              {
+                m_blockHashKeys[block] = hashBlock( data + block * hashBlockSize, std::min( hashBlockSize, size - block * hashBlockSize ) );
+              }
+            }
+            else
+            {
+              // ranges are disjoint, but neighbouring ranges might share a block
+              size_t nextBlock = 0;
+              std::vector<Range> const& ranges = m_hashDirtyRanges.getRanges();
+              for ( std::vector<Range>::const_iterator it = ranges.begin(); it != ranges.end(); ++it )
+              {
+                size_t endBlock = std::min( blockCount, ( it->offset + it->length + hashBlockSize - 1 ) / hashBlockSize );
+                for ( size_t block = std::max( nextBlock, it->offset / hashBlockSize ); block < endBlock; ++block )
+                {
+                  m_blockHashKeys[block] = hashBlock( data + block * hashBlockSize, std::min( hashBlockSize, size - block * hashBlockSize ) );
+                }
+                nextBlock = std::max( nextBlock, endBlock );
+              }
+            }
+            unlockRead();
+          }
+          else
+          {
+            m_blockHashKeys.clear();
+          }
+          m_hashedSize = size;
+          m_hashDirtyRanges.clear();
+
+          // a buffer of a single block keeps the plain hash of its data
+          m_hashKey = ( blockCount == 1 ) ? m_blockHashKeys[0]
+                                          : hashBlock( reinterpret_cast<const unsigned char *>(m_blockHashKeys.data()), m_blockHashKeys.size() * sizeof(dp::util::HashKey) );
           m_hashKeyValid = true;
         }
         return(m_hashKey);
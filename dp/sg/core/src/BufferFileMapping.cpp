@@ -0,0 +1,150 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include <dp/sg/core/BufferFileMapping.h>
+#include <stdexcept>
+
+namespace dp
+{
+  namespace sg
+  {
+    namespace core
+    {
+
+      BufferFileMappingSharedPtr BufferFileMapping::create( std::shared_ptr<dp::util::ReadMapping> const& mapping, size_t offset, size_t size )
+      {
+        return( std::shared_ptr<BufferFileMapping>( new BufferFileMapping( mapping, offset, size ) ) );
+      }
+
+      HandledObjectSharedPtr BufferFileMapping::clone() const
+      {
+        return( std::shared_ptr<BufferFileMapping>( new BufferFileMapping( *this ) ) );
+      }
+
+      BufferFileMapping::BufferFileMapping( std::shared_ptr<dp::util::ReadMapping> const& mapping, size_t offset, size_t size )
+        : m_fileOffset( offset )
+      {
+        DP_ASSERT( mapping && mapping->isValid() );
+
+        m_sizeInBytes = size;
+        if ( size )
+        {
+          m_data = reinterpret_cast<char*>( const_cast<void*>( mapping->mapIn( offset, size ) ) );
+          if ( !m_data )
+          {
+            // the reason is available through mapping->getLastError()
+            throw std::runtime_error( "BufferFileMapping: failed to map the file range" );
+          }
+          m_managed = false;
+          m_mapping = mapping;
+        }
+      }
+
+      BufferFileMapping::BufferFileMapping( BufferFileMapping const& rhs )
+        : BufferHost( rhs )
+        , m_mapping( rhs.m_mapping )
+        , m_fileOffset( rhs.m_fileOffset )
+      {
+        DP_ASSERT( m_mapMode == MapMode::NONE );
+
+        if ( m_mapping )
+        {
+          // share the mapped file
+          m_data = reinterpret_cast<char*>( const_cast<void*>( m_mapping->mapIn( m_fileOffset, m_sizeInBytes ) ) );
+          if ( !m_data )
+          {
+            // the range is still mapped for rhs, so fall back to a copy on the host
+            m_mapping.reset();
+            m_managed = true;
+            m_data = new char[m_sizeInBytes];
+            memcpy( m_data, rhs.m_data, m_sizeInBytes );
+          }
+          DP_ASSERT( !m_mapping || ( m_data == rhs.m_data ) );
+        }
+        else if ( m_managed )
+        {
+          m_data = new char[m_sizeInBytes];
+          memcpy( m_data, rhs.m_data, m_sizeInBytes );
+        }
+      }
+
+      BufferFileMapping::~BufferFileMapping()
+      {
+        releaseMapping();
+      }
+
+      void BufferFileMapping::setUnmanagedDataPtr( void *data )
+      {
+        releaseMapping();
+        BufferHost::setUnmanagedDataPtr( data );
+      }
+
+      void BufferFileMapping::setSize( size_t size )
+      {
+        if ( m_mapping && ( size != m_sizeInBytes ) )
+        {
+          // the data is lost on resize, like with a BufferHost
+          releaseMapping();
+          m_data = nullptr;
+          m_managed = true;
+        }
+        BufferHost::setSize( size );
+      }
+
+      void *BufferFileMapping::map( MapMode mapMode, size_t offset, size_t size )
+      {
+        if ( m_mapping && ( MapModeMask( mapMode ) & MapMode::WRITE ) )
+        {
+          copyOnWrite();
+        }
+        return( BufferHost::map( mapMode, offset, size ) );
+      }
+
+      void BufferFileMapping::copyOnWrite()
+      {
+        DP_ASSERT( m_mapping && !m_managed );
+
+        char * data = new char[m_sizeInBytes];
+        memcpy( data, m_data, m_sizeInBytes );
+        releaseMapping();
+        m_data = data;
+        m_managed = true;
+      }
+
+      void BufferFileMapping::releaseMapping()
+      {
+        if ( m_mapping )
+        {
+          m_mapping->mapOut( m_data );
+          m_mapping.reset();
+          m_data = nullptr;
+        }
+      }
+
+    } // namespace core
+  } // namespace sg
+} // namespace dp
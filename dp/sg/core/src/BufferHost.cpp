@@ -48,6 +48,8 @@ namespace dp
         : m_sizeInBytes( 0 )
         , m_data( 0 )
         , m_mapMode( MapMode::NONE )
+        , m_mapOffset( 0 )
+        , m_mapLength( 0 )
         , m_managed( true )
       {
       }
@@ -77,6 +79,8 @@ namespace dp
         DP_ASSERT( (offset + size) >= offset && (offset + size) <= m_sizeInBytes );
 
         m_mapMode = mapMode;
+        m_mapOffset = offset;
+        m_mapLength = size;
         char* data = reinterpret_cast<char*>( m_data );
         return reinterpret_cast<void*>( data + offset );
       }
@@ -85,11 +89,13 @@ namespace dp
       {
         DP_ASSERT( m_mapMode != MapMode::NONE );
 
-        if ( m_mapMode & MapMode::WRITE )
+        // unmap before notifying, so that the observers can read the buffer
+        MapModeMask mapMode = m_mapMode;
+        m_mapMode = MapMode::NONE;
+        if ( mapMode & MapMode::WRITE )
         {
-          notify( Event( this ) );
+          notifyWrite( m_mapOffset, m_mapLength );
         }
-        m_mapMode = MapMode::NONE;
       }
 
       const void *BufferHost::mapRead( size_t offset, size_t size ) const
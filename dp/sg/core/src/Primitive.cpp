@@ -25,6 +25,7 @@
 
 
 #include <dp/Assert.h>
+#include <dp/math/Bounds.h>
 #include <dp/math/Spherent.h>
 #include <limits>
 
@@ -145,6 +146,7 @@ namespace dp
         , m_instanceCount( 1 )
         , m_vertexAttributeSet( 0 )
         , m_renderFlags( 0 )
+        , m_boundingSphereMethod( dp::math::BoundingSphereMethod::BOX_CENTER )
         , m_cachedNumberOfPrimitives( ~0 )
         , m_cachedNumberOfFaces( ~0 )
         , m_cachedNumberOfPrimitiveRestarts( ~0 )
@@ -179,6 +181,7 @@ namespace dp
         m_elementOffset    = rhs.m_elementOffset;
         m_elementCount     = rhs.m_elementCount;
         m_instanceCount    = rhs.m_instanceCount;
+        m_boundingSphereMethod = rhs.m_boundingSphereMethod;
 
         m_cachedNumberOfPrimitives        = rhs.m_cachedNumberOfPrimitives;
         m_cachedNumberOfFaces             = rhs.m_cachedNumberOfFaces;
@@ -214,6 +217,7 @@ namespace dp
           m_elementOffset    = rhs.m_elementOffset;
           m_elementCount     = rhs.m_elementCount;
           m_instanceCount    = rhs.m_instanceCount;
+          m_boundingSphereMethod = rhs.m_boundingSphereMethod;
           m_boundingBox      = rhs.m_boundingBox;
           m_boundingSphere   = rhs.m_boundingSphere;
 
@@ -320,6 +324,16 @@ namespace dp
         }
       }
 
+      void Primitive::setBoundingSphereMethod( dp::math::BoundingSphereMethod method )
+      {
+        if ( m_boundingSphereMethod != method )
+        {
+          m_boundingSphereMethod = method;
+          invalidateBoundingSphere();
+          notify( Event( this ) );
+        }
+      }
+
       void Primitive::setPatchesOrdering( PatchesOrdering po )
       {
         if ( m_patchesOrdering != po )
@@ -567,116 +581,33 @@ namespace dp
         }
       }
 
-      template <typename IndexType>
-      Box3f getBoundingBoxForIndices( const IndexSetSharedPtr &indexSet, unsigned int offset, unsigned int count
-                                    , unsigned int primitiveRestartIndex, const Buffer::ConstIterator<Vec3f>::Type &points )
-      {
-        Box3f bbox;
-
-        Buffer::DataReadLock drl( indexSet->getBuffer() );
-        const IndexType* indices = drl.getPtr<IndexType>() + offset;
-
-        for ( unsigned int i=0; i<count; ++i )
-        {
-          // make sure to skip primitive restart index
-          if( indices[i] != primitiveRestartIndex )
-          {
-            bbox.update(points[indices[i]]);
-          }
-        }
-
-        return bbox;
-      }
-
       Box3f Primitive::calculateBoundingBox() const
       {
-        Box3f bbox;
-
         unsigned int offset = getElementOffset();
         unsigned int count  = getElementCount();
 
-        Buffer::ConstIterator<Vec3f>::Type points = m_vertexAttributeSet->getVertices();
-
-        if( isIndexed() )
+        unsigned int numberOfVertices = m_vertexAttributeSet->getNumberOfVertices();
+        if ( !numberOfVertices )
         {
-          // The general purpose IndexSet::ConstIterator is slow since each indexed access is a virtual function call.
-          // Instead use a templated version of the algorithm which is operation directly on the buffer of the IndexSet to gain speed.
-          const IndexSetSharedPtr &indexSet = getIndexSet();
-          unsigned int prIdx = indexSet->getPrimitiveRestartIndex();
-          switch (indexSet->getIndexDataType() )
-          {
-          case dp::DataType::UNSIGNED_INT_32:
-            bbox = getBoundingBoxForIndices<uint32_t>( indexSet, offset, count, prIdx, points );
-            break;
-          case dp::DataType::INT_32:
-            bbox = getBoundingBoxForIndices<int32_t>( indexSet, offset, count, prIdx, points );
-            break;
-          case dp::DataType::UNSIGNED_INT_16:
-            bbox = getBoundingBoxForIndices<uint16_t>( indexSet, offset, count, prIdx, points );
-            break;
-          case dp::DataType::INT_16:
-            bbox = getBoundingBoxForIndices<int16_t>( indexSet, offset, count, prIdx, points );
-            break;
-          case dp::DataType::UNSIGNED_INT_8:
-            bbox = getBoundingBoxForIndices<uint8_t>( indexSet, offset, count, prIdx, points );
-            break;
-          case dp::DataType::INT_8:
-            bbox = getBoundingBoxForIndices<int8_t>( indexSet, offset, count, prIdx, points );
-            break;
-          default:
-            DP_ASSERT( 0 && "unsupported datatype for indexset");
-          }
-        }
-        else
-        {
-          DP_ASSERT( offset+count <= m_vertexAttributeSet->getNumberOfVertices() );
-          for( unsigned int i=offset; i < offset+count; ++i )
-          {
-            bbox.update( points[i] );
-          }
+          return Box3f();
         }
 
-        return bbox;
-      }
-
-      template <typename IndexType>
-      float computeMinRadius(IndexSetSharedPtr const& indexSet,
-                             uint32_t count,
-                             uint32_t offset,
-                             Buffer::ConstIterator<Vec3f>::Type const& points,
-                             Vec3f const& center,
-                             size_t numberOfVertices)
-      {
-        IndexSet::ConstIterator<IndexType> indices(indexSet, offset);
-        float minRadius = 0.f;
+        Buffer::DataReadLock vertices = m_vertexAttributeSet->getVertexData( VertexAttributeSet::AttributeID::POSITION );
+        size_t stride = m_vertexAttributeSet->getStrideOfVertexData( VertexAttributeSet::AttributeID::POSITION );
 
-        unsigned int primitiveRestartIndex = indexSet->getPrimitiveRestartIndex();
-
-        bool invalidIndices = false;
-        for (uint32_t i = 0; i < count; i++)
+        if( isIndexed() )
         {
-          IndexType index = indices[i];
-
-          if ((index != primitiveRestartIndex) && (index < numberOfVertices))
-          {
-            float d = lengthSquared(points[index] - center);
-            if (minRadius < d)
-            {
-              minRadius = d;
-            }
-          }
-          else
-          {
-            invalidIndices |= (index != primitiveRestartIndex);
-          }
+          dp::DataType indexType = m_indexSet->getIndexDataType();
+          Buffer::DataReadLock indices( m_indexSet->getBuffer() );
+          return dp::math::boundingBox( vertices.getPtr<float>(), stride, numberOfVertices
+                                      , indices.getPtr<char>() + offset * dp::getSizeOf( indexType ), indexType, count
+                                      , m_indexSet->getPrimitiveRestartIndex() );
         }
-        if (invalidIndices)
+        else
         {
-          std::cerr << "Primitive contains out of range indices" << std::endl;
-          DP_ASSERT(false);
+          DP_ASSERT( offset+count <= numberOfVertices );
+          return dp::math::boundingBox( reinterpret_cast<const float *>( vertices.getPtr<char>() + offset * stride ), stride, count );
         }
-
-        return minRadius;
       }
 
       Sphere3f Primitive::calculateBoundingSphere() const
@@ -684,60 +615,69 @@ namespace dp
         unsigned int offset = getElementOffset();
         unsigned int count  = getElementCount();
 
-        Sphere3f bsphere;
-        Box3f bbox = calculateBoundingBox();
-        Vec3f center = bbox.getCenter();
+        // the bounding box is cached, so just the distances to its center are left to calculate
+        Vec3f center = getBoundingBox().getCenter();
 
-        Buffer::ConstIterator<Vec3f>::Type points = m_vertexAttributeSet->getVertices();
+        unsigned int numberOfVertices = m_vertexAttributeSet->getNumberOfVertices();
+        if ( !numberOfVertices )
+        {
+          return Sphere3f( center, 0.0f );
+        }
 
-        // now determine min radius
-        float minRadius = 0.f;
+        Buffer::DataReadLock vertices = m_vertexAttributeSet->getVertexData( VertexAttributeSet::AttributeID::POSITION );
+        size_t stride = m_vertexAttributeSet->getStrideOfVertexData( VertexAttributeSet::AttributeID::POSITION );
+
+        // the sphere around the box center is optimal for points filling the box, so the sphere of any other method
+        // is used only if it is smaller
+        float radius;
+        Sphere3f sphere;
+        bool const boxCenter = ( m_boundingSphereMethod == dp::math::BoundingSphereMethod::BOX_CENTER );
         if( isIndexed() )
         {
-          switch (m_indexSet->getIndexDataType())
+          dp::DataType indexType = m_indexSet->getIndexDataType();
+          Buffer::DataReadLock indices( m_indexSet->getBuffer() );
+          const char * firstIndex = indices.getPtr<char>() + offset * dp::getSizeOf( indexType );
+          size_t invalidIndexCount;
+          radius = dp::math::maxDistance( vertices.getPtr<float>(), stride, numberOfVertices
+                                        , firstIndex, indexType, count, center
+                                        , m_indexSet->getPrimitiveRestartIndex(), &invalidIndexCount );
+          if ( !boxCenter )
           {
-          case dp::DataType::INT_8:
-            minRadius = computeMinRadius<int8_t>(m_indexSet, count, offset, points, center, m_vertexAttributeSet->getNumberOfVertices());
-            break;
-          case dp::DataType::INT_16:
-            minRadius = computeMinRadius<int16_t>(m_indexSet, count, offset, points, center, m_vertexAttributeSet->getNumberOfVertices());
-            break;
-          case dp::DataType::INT_32:
-            minRadius = computeMinRadius<int32_t>(m_indexSet, count, offset, points, center, m_vertexAttributeSet->getNumberOfVertices());
-            break;
-          case dp::DataType::UNSIGNED_INT_8:
-            minRadius = computeMinRadius<uint8_t>(m_indexSet, count, offset, points, center, m_vertexAttributeSet->getNumberOfVertices());
-            break;
-          case dp::DataType::UNSIGNED_INT_16:
-            minRadius = computeMinRadius<uint16_t>(m_indexSet, count, offset, points, center, m_vertexAttributeSet->getNumberOfVertices());
-            break;
-          case dp::DataType::UNSIGNED_INT_32:
-            minRadius = computeMinRadius<uint32_t>(m_indexSet, count, offset, points, center, m_vertexAttributeSet->getNumberOfVertices());
-            break;
-          default:
-            DP_ASSERT(!"unsupported datatype");
+            sphere = dp::math::boundingSphere( vertices.getPtr<float>(), stride, numberOfVertices
+                                             , firstIndex, indexType, count, m_boundingSphereMethod
+                                             , m_indexSet->getPrimitiveRestartIndex() );
+          }
+          if ( invalidIndexCount )
+          {
+            std::cerr << "Primitive contains out of range indices" << std::endl;
+            DP_ASSERT(false);
           }
         }
         else
         {
           unsigned int end = offset + count;
-          if ( end > m_vertexAttributeSet->getNumberOfVertices() )
+          if ( end > numberOfVertices )
           {
             std::cerr << "Primitive " << getName() << " references out of range vertices" << std::endl;
             DP_ASSERT( false );
-            end = m_vertexAttributeSet->getNumberOfVertices();
+            end = numberOfVertices;
           }
-          for( unsigned int i = offset; i < end; i ++ )
+          if ( offset < end )
           {
-            float d = lengthSquared( points[i] - center );
-            if( minRadius < d )
+            const float * first = reinterpret_cast<const float *>( vertices.getPtr<char>() + offset * stride );
+            radius = dp::math::maxDistance( first, stride, end - offset, center );
+            if ( !boxCenter )
             {
-              minRadius = d;
+              sphere = dp::math::boundingSphere( first, stride, end - offset, m_boundingSphereMethod );
             }
           }
+          else
+          {
+            radius = 0.0f;
+          }
         }
 
-        return Sphere3f( center, sqrt(minRadius) );
+        return ( isValid( sphere ) && ( sphere.getRadius() < radius ) ) ? sphere : Sphere3f( center, radius );
       }
 
       void Primitive::setElementRange( unsigned int offset, unsigned int count )
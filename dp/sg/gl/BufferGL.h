@@ -138,6 +138,8 @@ namespace dp
         DP_SG_GL_API virtual void unmapRead( ) const;
 
         mutable Buffer::MapModeMask m_mapMode;
+        size_t                      m_mapOffset;
+        size_t                      m_mapLength;
 
         GLenum    m_target;
         GLenum    m_usage;
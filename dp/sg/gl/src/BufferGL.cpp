@@ -44,6 +44,8 @@ namespace dp
 
       BufferGL::BufferGL( )
         : m_mapMode( MapMode::NONE )
+        , m_mapOffset( 0 )
+        , m_mapLength( 0 )
         , m_target( GL_ARRAY_BUFFER )
         , m_usage( GL_STATIC_DRAW )
         , m_stateFlags( State::MANAGED )
@@ -79,6 +81,8 @@ namespace dp
         DP_ASSERT( (offset + size) >= offset && (offset + size) <= m_buffer->getSize() );
 
         m_mapMode = mapMode;
+        m_mapOffset = offset;
+        m_mapLength = size;
 
         GLbitfield access;
         switch (mapMode)
@@ -114,13 +118,15 @@ namespace dp
 
       void BufferGL::unmap( )
       {
-        if ( m_mapMode & MapMode::WRITE )
-        {
-          notify( Event( this ) );
-        }
-
+        // unmap before notifying, so that the observers can read the buffer
         m_buffer->unmap();
+        MapModeMask mapMode = m_mapMode;
         m_mapMode = MapMode::NONE;
+
+        if ( mapMode & MapMode::WRITE )
+        {
+          notifyWrite( m_mapOffset, m_mapLength );
+        }
       }
 
       void BufferGL::unmapRead( ) const
@@ -30,6 +30,7 @@
 #include <dp/Exception.h>
 #include <dp/fx/EffectLibrary.h>
 #include <dp/sg/core/Billboard.h>
+#include <dp/sg/core/BufferFileMapping.h>
 #include <dp/sg/core/ClipPlane.h>
 #include <dp/sg/core/FrustumCamera.h>
 #include <dp/sg/core/GeoNode.h>
@@ -1853,7 +1854,8 @@ SceneSharedPtr DPBFLoader::load(const string& filename, dp::util::FileFinder con
     // the resulting file name should be valid if we get here
     DP_ASSERT(!filename.empty());
     // map the file into our address space
-    m_fm = new ReadMapping( filename );
+    m_mapping = std::make_shared<ReadMapping>( filename );
+    m_fm = m_mapping.get();
     if ( m_fm->isValid() )
     {
       {
@@ -2870,14 +2872,17 @@ SceneSharedPtr DPBFLoader::load(const string& filename, dp::util::FileFinder con
           INVOKE_CALLBACK(onInvalidFile(filename, "NBF"));
         }
       }
-      delete m_fm;
     }
+    m_mapping.reset();
+    m_fm = nullptr;
   }
   // catch all exception here to do cleanup
   catch ( ... )
   {
     // TODO it would be better to have a local object for the state and provide a weak-ptr to the loader during the call of this function.
     // If we want to add reentrace support the state-object should be passed by the traversers.
+    m_mapping.reset();
+    m_fm = nullptr;
     m_offsetObjectMap.clear();
     m_sharedObjectsMap.clear();
     m_textureImages.clear();
@@ -5579,10 +5584,10 @@ void DPBFLoader::readPrimitive_nbf_4d( PrimitiveSharedPtr const& dst, const NBFP
   {
     IndexSetSharedPtr iset( IndexSet::create() );
 
+    // reference the indices in the file instead of copying them
     unsigned int byteSize = dp::checked_cast<unsigned int>(dp::getSizeOf( convertDataType(src->indexSet.dataType) ) * src->indexSet.numberOfIndices);
-    Offset_AutoPtr<byte_t> indicesPtr( m_fm, callback(), src->indexSet.idata, byteSize );
-
-    iset->setData( indicesPtr, src->indexSet.numberOfIndices, convertDataType(src->indexSet.dataType), src->indexSet.primitiveRestartIndex );
+    iset->setBuffer( mapBuffer( src->indexSet.idata, byteSize ), src->indexSet.numberOfIndices
+                   , convertDataType(src->indexSet.dataType), src->indexSet.primitiveRestartIndex );
 
     dst->setIndexSet( iset );
   }
@@ -5929,12 +5934,12 @@ void DPBFLoader::readVertexAttributeSet( VertexAttributeSetSharedPtr const& dst,
     VertexAttributeSet::AttributeID id = static_cast<VertexAttributeSet::AttributeID>(i);
     if ( src->vattribs[i].numVData )
     {
+      // reference the vertex data in the file instead of copying it
       uint_t sizeofVertex = dp::checked_cast<uint_t>(src->vattribs[i].size * dp::getSizeOf( convertDataType(src->vattribs[i].type) ));
-      Offset_AutoPtr<byte_t> vdata( m_fm, callback(), src->vattribs[i].vdata,
-        src->vattribs[i].numVData * sizeofVertex );
+      BufferSharedPtr vdata = mapBuffer( src->vattribs[i].vdata, src->vattribs[i].numVData * sizeofVertex );
 
       dst->setVertexData( id, src->vattribs[i].size, convertDataType(src->vattribs[i].type),
-        vdata, 0, src->vattribs[i].numVData );
+        vdata, 0, sizeofVertex, src->vattribs[i].numVData );
 
       // enable for rendering?
       DP_ASSERT(!(src->enableFlags & (1<<i)) || !(src->enableFlags & (1<<(i+16))));
@@ -5948,6 +5953,20 @@ void DPBFLoader::readVertexAttributeSet( VertexAttributeSetSharedPtr const& dst,
   }
 }
 
+BufferSharedPtr DPBFLoader::mapBuffer( uint_t offset, size_t size )
+{
+  try
+  {
+    return( BufferFileMapping::create( m_mapping, offset, size ) );
+  }
+  catch ( std::runtime_error const& )
+  {
+    // report the failed mapping like Offset_AutoPtr does, and fail the load instead of handing out a buffer without data
+    INVOKE_CALLBACK(onFileMappingFailed(m_fm->getLastError()));
+    throw;
+  }
+}
+
 IndexSetSharedPtr DPBFLoader::loadIndexSet( uint_t offset )
 {
   if ( m_offsetObjectMap.find( offset ) == m_offsetObjectMap.end() )
@@ -5959,9 +5978,8 @@ IndexSetSharedPtr DPBFLoader::loadIndexSet( uint_t offset )
     if ( !loadSharedObject<IndexSet>( iset, isPtr ) )
     {
       unsigned int byteSize = dp::checked_cast<uint_t>(dp::getSizeOf( convertDataType(isPtr->dataType) ) * isPtr->numberOfIndices);
-      Offset_AutoPtr<byte_t> indicesPtr( m_fm, callback(), isPtr->idata, byteSize );
-
-      iset->setData( indicesPtr, isPtr->numberOfIndices, convertDataType(isPtr->dataType), isPtr->primitiveRestartIndex );
+      iset->setBuffer( mapBuffer( isPtr->idata, byteSize ), isPtr->numberOfIndices
+                     , convertDataType(isPtr->dataType), isPtr->primitiveRestartIndex );
     }
     mapObject( offset, iset );
   }
@@ -161,6 +161,10 @@ private:
 
 
   dp::util::ReadMapping * m_fm;
+  std::shared_ptr<dp::util::ReadMapping> m_mapping;   // owns m_fm, the buffers referencing the file keep it alive after loading
+
+  // reference a range of the file as a buffer, reports a failed mapping and throws
+  dp::sg::core::BufferSharedPtr mapBuffer( uint_t offset, size_t size );
 
   // assign an object to an offset
   void mapObject(uint_t offset, const dp::sg::core::ObjectSharedPtr & object );
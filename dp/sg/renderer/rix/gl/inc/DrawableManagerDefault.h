@@ -167,7 +167,6 @@ namespace dp
               // culling information
               dp::math::Vec4f                  m_boundingBoxLower;
               dp::math::Vec4f                  m_boundingBoxExtent;
-              dp::sg::xbar::TransformIndex     m_transformIndex;
 
               PayloadSharedPtr  m_payload;
               bool              m_effectDataAttached;
@@ -212,6 +211,24 @@ namespace dp
             void setCullingEnabled( bool enabled );
             bool isCullingEnabled( ) const;
 
+            /** \brief Enable the occlusion culling stage after the frustum culling. It is only available for the CPU culling modes
+                       and culls objects hidden behind the occluders added by addOccluder.
+            **/
+            void setOcclusionCullingEnabled( bool enabled );
+            bool isOcclusionCullingEnabled() const;
+
+            /** \brief Hide objects whose projected bounding box covers less than the given number of pixels in the viewport.
+                       0, the default, disables small feature culling. It is only available for the CPU culling modes.
+            **/
+            void setMinimumPixelArea( float minimumPixelArea );
+            float getMinimumPixelArea() const;
+
+            /** \brief Use the GeoNode at the given ObjectTree index as occluder. Occluders must be opaque.
+                \return false if the culling mode does not support occlusion culling or the GeoNode has no triangles.
+            **/
+            bool addOccluder( dp::sg::xbar::ObjectTreeIndex objectTreeIndex );
+            void removeOccluder( dp::sg::xbar::ObjectTreeIndex objectTreeIndex );
+
           protected:
             class EffectDataObserver : public dp::util::Observer
             {
@@ -232,6 +249,7 @@ namespace dp
             friend class TransformObserver;
 
             void cullManager( const dp::sg::core::CameraSharedPtr &camera );
+            void updateVisibility( std::vector<dp::sg::xbar::ObjectTreeIndex> const & changed );
             void setActiveTraversalMask( unsigned int nodeMask );
 
             dp::fx::Manager                         m_shaderManagerType;
@@ -252,7 +270,10 @@ namespace dp
             dp::culling::Mode                       m_cullingMode;
             dp::sg::xbar::culling::CullingSharedPtr m_cullingManager;
             dp::sg::xbar::culling::ResultSharedPtr  m_cullingResult;
+            dp::sg::xbar::culling::ResultSharedPtr  m_occlusionResult;
             bool                                    m_cullingEnabled;
+            bool                                    m_occlusionCullingEnabled;
+            float                                   m_minimumPixelArea;
 
           private:
             dp::sg::core::SamplerSharedPtr  m_environmentSampler;
@@ -53,12 +53,17 @@ namespace dp
             virtual dp::sg::core::HandledObjectSharedPtr getHandledObject() const;
             virtual void update();
 
+            /** \brief Collects the written ranges of the buffer, update uploads only those. **/
+            virtual bool update( const dp::util::Event& event );
+            virtual bool isCollectingEvents() const;
+
             dp::rix::core::BufferSharedHandle  m_bufferHandle;
             bool                    m_isNativeBuffer;
             size_t                  m_bufferSize;
 
           protected:
-            dp::sg::core::BufferSharedPtr m_buffer;
+            dp::sg::core::BufferSharedPtr           m_buffer;
+            dp::sg::core::Buffer::RangeList         m_dirtyRanges;
             ResourceBuffer( const dp::sg::core::BufferSharedPtr& buffer, const ResourceManagerSharedPtr& resourceManager );
           };
 
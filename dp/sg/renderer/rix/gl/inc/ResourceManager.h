@@ -85,6 +85,11 @@ namespace dp
               **/
               virtual bool update( const dp::util::Event& event);
 
+              /** \brief Determines if update( const dp::util::Event & ) is called for events received while the resource is dirty.
+                  \return true if the resource collects what has changed until the next update, false by default.
+              **/
+              virtual bool isCollectingEvents() const;
+
               void setPayload( const PayloadSharedPtr &payload );
               const PayloadSharedPtr &getPayload() const;
 
@@ -118,6 +118,8 @@ namespace dp
             , m_shaderManagerType( shaderManagerType )
             , m_cullingMode( cullingMode)
             , m_cullingEnabled( true )
+            , m_occlusionCullingEnabled( false )
+            , m_minimumPixelArea( 0.0f )
             , m_activeTraversalMask( ~0 )
             , m_viewportSize( 0, 0 )
             , m_transparencyManager( transparencyManager )
@@ -136,7 +138,6 @@ namespace dp
           DrawableManager::Handle DrawableManagerDefault::addDrawableInstance( dp::sg::core::GeoNodeWeakPtr geoNode, ObjectTreeIndex objectTreeIndex )
           {
             dp::rix::core::Renderer *renderer = m_resourceManager->getRenderer();
-            ObjectTreeNode objectTreeNode = getSceneTree()->getObjectTreeNode( objectTreeIndex );
 
             // generate a new handle and fill it
             DefaultHandleDataSharedPtr handle = DefaultHandleData::create( dp::sg::xbar::ObjectTreeIndex(m_instances.size()) );
@@ -147,7 +148,6 @@ namespace dp
             di.m_handle = handle;
             di.m_geoNode = geoNode.lock();
             di.m_objectTreeIndex = objectTreeIndex;
-            di.m_transformIndex = objectTreeNode.m_transform;
             di.m_transparent = false;
             di.m_currentRenderGroup = nullptr;
             di.m_isVisible = true; // gis are visible by default
@@ -354,25 +354,38 @@ namespace dp
             {
               const Mat44f worldToViewProjection = camera->getWorldToViewMatrix() * camera->getProjection();
 
-              ObjectTree    &objectTree = getSceneTree()->getObjectTree();
-              dp::rix::core::Renderer* renderer = m_resourceManager->getRenderer();
-
-              m_cullingManager->cull( m_cullingResult, worldToViewProjection );
-
-              std::vector<ObjectTreeIndex> const & changed = m_cullingManager->resultGetChangedIndices( m_cullingResult );
+              m_cullingManager->cull( m_cullingResult, worldToViewProjection, m_viewportSize, m_minimumPixelArea );
+              updateVisibility( m_cullingManager->resultGetChangedIndices( m_cullingResult ) );
 
-              for ( size_t index = 0;index < changed.size(); ++index )
+              if ( m_occlusionCullingEnabled && m_cullingManager->isOcclusionCullingSupported() )
               {
-                DP_ASSERT( std::dynamic_pointer_cast<DefaultHandleData>(getDrawableInstance( changed[index] )) );
-                DefaultHandleDataSharedPtr defaultHandleData = std::static_pointer_cast<DefaultHandleData>(getDrawableInstance( changed[index] ));
-                Instance & instance = m_instances[defaultHandleData->m_index];
-
-                bool newVisible = m_cullingManager->resultIsVisible( m_cullingResult, changed[index] );
-                if ( instance.m_isVisible != newVisible )
+                if ( !m_occlusionResult )
                 {
-                  instance.m_isVisible = newVisible;
-                  instance.updateRendererVisibility( renderer );
+                  m_occlusionResult = m_cullingManager->resultCreate();
                 }
+                m_cullingManager->cullOcclusion( m_cullingResult, m_occlusionResult, worldToViewProjection );
+                updateVisibility( m_cullingManager->resultGetChangedIndices( m_occlusionResult ) );
+              }
+            }
+          }
+
+          void DrawableManagerDefault::updateVisibility( std::vector<ObjectTreeIndex> const & changed )
+          {
+            dp::rix::core::Renderer* renderer = m_resourceManager->getRenderer();
+
+            for ( size_t index = 0;index < changed.size(); ++index )
+            {
+              DP_ASSERT( std::dynamic_pointer_cast<DefaultHandleData>(getDrawableInstance( changed[index] )) );
+              DefaultHandleDataSharedPtr defaultHandleData = std::static_pointer_cast<DefaultHandleData>(getDrawableInstance( changed[index] ));
+              Instance & instance = m_instances[defaultHandleData->m_index];
+
+              // an object is visible if it passes the frustum and the occlusion test
+              bool newVisible = m_cullingManager->resultIsVisible( m_cullingResult, changed[index] )
+                             && ( !m_occlusionResult || m_cullingManager->resultIsVisible( m_occlusionResult, changed[index] ) );
+              if ( instance.m_isVisible != newVisible )
+              {
+                instance.m_isVisible = newVisible;
+                instance.updateRendererVisibility( renderer );
               }
             }
           }
@@ -407,7 +420,8 @@ namespace dp
                 info.gi = instance.m_geometryInstance.get();
 
                 Vec4f center = instance.m_boundingBoxLower + 0.5 * instance.m_boundingBoxExtent;
-                center = center * getSceneTree()->getTransformTree().getTree().getWorldMatrix(instance.m_transformIndex);
+                // the transform index is taken from the SceneTree, it changes when the transform tree is compacted
+                center = center * getSceneTree()->getTransformTree().getTree().getWorldMatrix(getSceneTree()->getObjectTreeNode(instance.m_objectTreeIndex).m_transform);
                 Vec3f distance = Vec3f(center) - cameraPosition;
                 info.squaredDistance = lengthSquared(distance);
                 sortInfo.push_back( info );
@@ -510,6 +524,56 @@ namespace dp
             return m_cullingEnabled;
           }
 
+          void DrawableManagerDefault::setOcclusionCullingEnabled( bool enabled )
+          {
+            if ( !enabled && m_occlusionResult )
+            {
+              // show the objects which have been hidden by the occluders again
+              m_occlusionResult.reset();
+
+              dp::rix::core::Renderer* renderer = m_resourceManager->getRenderer();
+              for ( size_t index = 0; index < m_instances.size(); ++index )
+              {
+                Instance & instance = m_instances[index];
+                bool newVisible = m_cullingManager->resultIsVisible( m_cullingResult, instance.m_objectTreeIndex );
+                if ( instance.m_isVisible != newVisible )
+                {
+                  instance.m_isVisible = newVisible;
+                  instance.updateRendererVisibility( renderer );
+                }
+              }
+            }
+            m_occlusionCullingEnabled = enabled;
+          }
+
+          bool DrawableManagerDefault::isOcclusionCullingEnabled() const
+          {
+            return m_occlusionCullingEnabled;
+          }
+
+          void DrawableManagerDefault::setMinimumPixelArea( float minimumPixelArea )
+          {
+            DP_ASSERT( 0.0f <= minimumPixelArea );
+            m_minimumPixelArea = minimumPixelArea;
+          }
+
+          float DrawableManagerDefault::getMinimumPixelArea() const
+          {
+            return m_minimumPixelArea;
+          }
+
+          bool DrawableManagerDefault::addOccluder( ObjectTreeIndex objectTreeIndex )
+          {
+            DP_ASSERT( m_cullingManager );
+            return m_cullingManager->occluderAdd( objectTreeIndex );
+          }
+
+          void DrawableManagerDefault::removeOccluder( ObjectTreeIndex objectTreeIndex )
+          {
+            DP_ASSERT( m_cullingManager );
+            m_cullingManager->occluderRemove( objectTreeIndex );
+          }
+
           void DrawableManagerDefault::detachEffectDataObserver()
           {
             for ( std::vector<Instance>::iterator it = m_instances.begin(); it != m_instances.end(); ++it )
@@ -534,6 +598,7 @@ namespace dp
               }
               m_cullingManager = dp::sg::xbar::culling::Culling::create( getSceneTree(), m_cullingMode );
               m_cullingResult = m_cullingManager->resultCreate();
+              m_occlusionResult.reset();
 
               switch ( m_shaderManagerType )
               {
@@ -568,6 +633,8 @@ namespace dp
             }
             else
             {
+              m_occlusionResult.reset();
+              m_cullingResult.reset();
               m_cullingManager.reset();
               m_shaderManager.reset();
               m_effectDataObserver.reset( );
@@ -104,8 +104,40 @@ namespace dp
             {
               m_bufferSize = bufferSize;
               m_resourceManager->getRenderer()->bufferSetSize( m_bufferHandle, m_bufferSize );
+              m_dirtyRanges.clear();
             }
-            m_resourceManager->getRenderer()->bufferUpdateData( m_bufferHandle, 0, drl.getPtr(), bufferSize );
+
+            if ( m_dirtyRanges.empty() )
+            {
+              m_resourceManager->getRenderer()->bufferUpdateData( m_bufferHandle, 0, drl.getPtr(), bufferSize );
+            }
+            else
+            {
+              // upload only the ranges written since the last update
+              char const* data = drl.getPtr<char>();
+              std::vector<dp::sg::core::Buffer::Range> const& ranges = m_dirtyRanges.getRanges();
+              for ( std::vector<dp::sg::core::Buffer::Range>::const_iterator it = ranges.begin(); it != ranges.end(); ++it )
+              {
+                DP_ASSERT( it->offset + it->length <= bufferSize );
+                m_resourceManager->getRenderer()->bufferUpdateData( m_bufferHandle, it->offset, data + it->offset, it->length );
+              }
+              m_dirtyRanges.clear();
+            }
+          }
+
+          bool ResourceBuffer::isCollectingEvents() const
+          {
+            return true;
+          }
+
+          bool ResourceBuffer::update( const dp::util::Event& event )
+          {
+            if ( !m_isNativeBuffer )
+            {
+              dp::sg::core::Buffer::Event const& bufferEvent = static_cast<dp::sg::core::Buffer::Event const&>(event);
+              m_dirtyRanges.add( bufferEvent.getOffset(), bufferEvent.getLength() );
+            }
+            return false;
           }
 
         } // namespace gl
@@ -91,6 +91,11 @@ namespace dp
             return false;
           }
 
+          bool ResourceManager::Resource::isCollectingEvents() const
+          {
+            return false;
+          }
+
           void ResourceManager::Resource::setPayload( const PayloadSharedPtr &payload )
           {
             m_payload = payload;
@@ -160,15 +165,20 @@ namespace dp
 
           void ResourceManager::ResourceObserver::onNotify( const dp::util::Event &event, dp::util::Payload *payload )
           {
+            // a dirty resource is updated anyway, only resources collecting what has changed until the update see further events
             ResourceManager::Payload* p = static_cast<ResourceManager::Payload*>(payload);
-            if ( !p->m_isDirty )
+            if ( p->m_isDirty )
             {
-              if ( !p->m_resource->update( event ) )
+              if ( p->m_resource->isCollectingEvents() )
               {
-                p->m_isDirty = true;
-                m_dirtyPayloads.push_back( std::static_pointer_cast<ResourceManager::Payload>(p->shared_from_this()) );
+                p->m_resource->update( event );
               }
             }
+            else if ( !p->m_resource->update( event ) )
+            {
+              p->m_isDirty = true;
+              m_dirtyPayloads.push_back( std::static_pointer_cast<ResourceManager::Payload>(p->shared_from_this()) );
+            }
           }
 
           void ResourceManager::ResourceObserver::updateResources()
@@ -298,8 +298,8 @@ namespace dp
             dp::sg::xbar::SceneTreeSharedPtr sceneTree = m_sceneTree.lock();
             DP_ASSERT( sceneTree );
             dp::math::Mat44f const * transforms = sceneTree->getTransformTree().getTree().getWorldMatrices();
-            std::set< ObjectTreeIndex > const & lightSources = sceneTree->getLightSources();
-            for ( std::set< ObjectTreeIndex >::const_iterator itLight = lightSources.begin(); itLight != lightSources.end() && lightId < MAXLIGHTS; ++itLight )
+            ObjectTreeIndexSet const & lightSources = sceneTree->getLightSources();
+            for ( ObjectTreeIndexSet::const_iterator itLight = lightSources.begin(); itLight != lightSources.end() && lightId < MAXLIGHTS; ++itLight )
             {
               ObjectTreeNode& otn = sceneTree->getObjectTreeNode(*itLight);
 
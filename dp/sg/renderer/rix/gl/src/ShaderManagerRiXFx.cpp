@@ -89,6 +89,7 @@ namespace dp
             dp::util::BitArray m_usedTransforms;     // transforms which are being used by the renderer
 
           private:
+            void remapTransforms(std::vector<dp::transform::Index> const & remap);
             void updateTransformNode(const dp::rix::fx::ManagerSharedPtr& manager, const dp::rix::fx::GroupDataSharedHandle& groupHandle, dp::math::Mat44f const & matrix);
           };
 
@@ -124,6 +125,12 @@ namespace dp
 
           void ShaderManagerTransformsRiXFx::onNotify(dp::util::Event const & event, dp::util::Payload * payload)
           {
+            if (static_cast<dp::transform::Tree::Event const &>(event).getType() == dp::transform::Tree::Event::Type::TRANSFORMS_REMAPPED)
+            {
+              remapTransforms(static_cast<dp::transform::Tree::EventTransformsRemapped const &>(event).getRemap());
+              return;
+            }
+
             dp::transform::Tree::EventWorldMatricesChanged const & eventWorldMatrices = static_cast<dp::transform::Tree::EventWorldMatricesChanged const &>(event);
             dp::util::BitArray changedTransforms = eventWorldMatrices.getDirtyWorldMatrices();
             changedTransforms.resize(m_dirtyWorldMatrices.getSize(), false);
@@ -136,6 +143,33 @@ namespace dp
             DP_ASSERT(!"Should not happen!");
           }
 
+          void ShaderManagerTransformsRiXFx::remapTransforms(std::vector<dp::transform::Index> const & remap)
+          {
+            // the group data moves with its transform, so the geometry instances using it keep their matrices.
+            // A transform may move past the end of the vectors, they grow to the size of the transform tree.
+            TransformGroupDatas transformGroupDatas(std::max(m_transformGroupDatas.size(), remap.size()));
+            dp::util::BitArray dirtyWorldMatrices(transformGroupDatas.size());
+            dp::util::BitArray usedTransforms(transformGroupDatas.size());
+            for (size_t index = 0; index < m_transformGroupDatas.size(); ++index)
+            {
+              if (m_transformGroupDatas[index] && remap[index] != dp::transform::InvalidIndex)
+              {
+                transformGroupDatas[remap[index]] = m_transformGroupDatas[index];
+                if (m_dirtyWorldMatrices.getBit(index))
+                {
+                  dirtyWorldMatrices.enableBit(remap[index]);
+                }
+                if (m_usedTransforms.getBit(index))
+                {
+                  usedTransforms.enableBit(remap[index]);
+                }
+              }
+            }
+            m_transformGroupDatas.swap(transformGroupDatas);
+            m_dirtyWorldMatrices = dirtyWorldMatrices;
+            m_usedTransforms = usedTransforms;
+          }
+
           dp::rix::fx::GroupDataSharedHandle ShaderManagerTransformsRiXFx::getGroupData(dp::sg::xbar::TransformIndex transformIndex)
           {
             dp::rix::core::Renderer *renderer = m_resourceManager->getRenderer();
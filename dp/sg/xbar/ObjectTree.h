@@ -28,14 +28,13 @@
 
 #include <dp/math/Boxnt.h>
 #include <dp/sg/core/CoreTypes.h>
+#include <dp/sg/xbar/TreeIndexMap.h>
 #include <dp/sg/xbar/Tree.h>
 #include <dp/sg/xbar/TreeResourceGroup.h>
 #include <dp/util/BitMask.h>
 #include <dp/util/BitArray.h>
 #include <dp/sg/core/Object.h>
-#include <set>
 #include <vector>
-#include <map>
 
 namespace dp
 {
@@ -99,11 +98,14 @@ namespace dp
       class ObjectTree : public TreeBaseClass< ObjectTreeNode, ObjectTreeIndex >
       {
       public:
-        std::map< ObjectTreeIndex, dp::sg::core::SwitchWeakPtr > m_switchNodes;
-        std::map< ObjectTreeIndex, dp::sg::core::LODWeakPtr >    m_LODs;
+        typedef TreeIndexMap< ObjectTreeIndex, dp::sg::core::SwitchWeakPtr > SwitchMap;
+        typedef TreeIndexMap< ObjectTreeIndex, dp::sg::core::LODWeakPtr >    LODMap;
+
+        SwitchMap m_switchNodes;
+        LODMap    m_LODs;
       };
 
-      typedef std::set< ObjectTreeIndex > ObjectTreeIndexSet;
+      typedef TreeIndexSet< ObjectTreeIndex > ObjectTreeIndexSet;
 
       typedef std::vector< dp::sg::core::SwitchWeakPtr > SwitchVector;
 
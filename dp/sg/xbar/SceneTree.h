@@ -35,6 +35,7 @@
 #include <dp/sg/xbar/TransformTree.h>
 
 #include <vector>
+#include <deque>
 #include <stack>
 #include <algorithm>
 #include <memory>
@@ -57,6 +58,7 @@ namespace dp
       DEFINE_PTR_TYPES( TransformObserver );
       DEFINE_PTR_TYPES( ObjectObserver );
       DEFINE_PTR_TYPES( SceneObserver );
+      DEFINE_PTR_TYPES( LODSelector );
       DEFINE_PTR_TYPES( SceneTree );
 
       /*===========================================================================*/
@@ -66,6 +68,9 @@ namespace dp
         SceneTree(const dp::sg::core::SceneSharedPtr & scene );
 
       public:
+        /** \brief Batch of changes of drawable ObjectTree nodes. The changes are in the order they happened. Structural changes
+                   are sent at the end of addSubTree and removeObjectTreeIndex, the active and traversal mask changes once per update.
+        **/
         class Event : public dp::util::Event
         {
         public:
@@ -78,27 +83,35 @@ namespace dp
             , TRAVERSAL_MASK_CHANGED
           };
 
-          Event(ObjectTreeIndex index, ObjectTreeNode const& node, Type subType)
-            : m_type( subType )
-            , m_index( index )
-            , m_node( node )
+          struct Change
           {
-          }
+            ObjectTreeIndex index;
+            Type            type;
+          };
 
+          typedef std::vector<Change> Changes;
 
-          Type getType() const { return m_type; }
-          ObjectTreeIndex getIndex() const { return m_index; }
-          ObjectTreeNode const & getNode() const { return m_node; }
+          Event( Changes const & changes )
+            : m_changes( changes )
+          {
+          }
 
-        protected:
-          Type               m_type;
-          ObjectTreeIndex       m_index;
-          ObjectTreeNode const& m_node;
+          Changes const & getChanges() const { return m_changes; }
 
+        protected:
+          Changes const & m_changes;
         };
 
       public:
-        DP_SG_XBAR_API static SceneTreeSharedPtr create( dp::sg::core::SceneSharedPtr const & scene );
+        /** \brief Create a SceneTree and generate it for the given scene.
+            \param scene The scene to generate the SceneTree for.
+            \param generatorThreadCount The number of threads filling disjoint subtrees of the scene during the initial generation.
+                   0 uses one thread per hardware thread, 1, the default, generates serially.
+            \param streamingBudget If not 0, the scene is generated breadth first, about streamingBudget ObjectTree nodes on
+                   creation and on each update, so that the top levels are available for rendering before the whole scene
+                   has been generated. Streaming generation is serial. The default 0 generates the whole scene on creation.
+        **/
+        DP_SG_XBAR_API static SceneTreeSharedPtr create( dp::sg::core::SceneSharedPtr const & scene, unsigned int generatorThreadCount = 1, size_t streamingBudget = 0 );
         virtual ~SceneTree();
 
         DP_SG_XBAR_API dp::sg::core::SceneSharedPtr const & getScene() const;
@@ -137,9 +150,51 @@ namespace dp
         DP_SG_XBAR_API ObjectTree& getObjectTree();
         DP_SG_XBAR_API ObjectTreeNode& getObjectTreeNode( ObjectTreeIndex index );
 
-        const std::set< ObjectTreeIndex >& getLightSources() const { return m_lightSources; }
+        /** \brief Set the hysteresis of the LOD selection as a fraction of the ranges. A LOD switches to a finer level
+                   once it is closer than range * ( 1 - hysteresis ) and back once it is farther than range * ( 1 + hysteresis ).
+                   Must be in [0,1), the default of 0 selects exactly like LOD::getLODToUse. The first selection of a LOD
+                   ignores the hysteresis.
+        **/
+        DP_SG_XBAR_API void setLODHysteresis( float hysteresis );
+        DP_SG_XBAR_API float getLODHysteresis() const;
+
+        /** \brief Set the number of threads used to select the LOD levels. 0 uses one thread per hardware thread, 1 is the default. **/
+        DP_SG_XBAR_API void setLODThreadCount( unsigned int threadCount );
+        DP_SG_XBAR_API unsigned int getLODThreadCount() const;
+
+        /** \brief Check if subtrees of a streamed scene are still waiting to be generated by update. **/
+        bool isGenerating() const { return !m_pendingSubTrees.empty(); }
+
+        /** \brief Check if the children of the node at index are still waiting to be generated. **/
+        bool isPendingSubTree( ObjectTreeIndex index ) const { return m_pendingSubTrees.find( index ) != m_pendingSubTrees.end(); }
+
+        const ObjectTreeIndexSet& getLightSources() const { return m_lightSources; }
+
+        /** \brief Get the TransformTree. Its tree may be compacted with dp::transform::Tree::compact between updates, the
+                   SceneTree then moves the transform indices of its nodes, clip planes and LODs to the new indices.
+        **/
         TransformTree & getTransformTree() { return m_transformTree; }
 
+        /** \brief Counters of the last call to update. They are collected on every update at the cost of a few clock reads
+                   and additions, so they can stay enabled to find out why some frames take longer than others.
+        **/
+        struct UpdateStatistics
+        {
+          size_t    generatedObjects;   // ObjectTree nodes added by a streaming generation
+          size_t    changedObjects;     // ObjectTree nodes with changed hints or traversal mask
+          size_t    dirtyObjects;       // ObjectTree nodes marked dirty, the world information is propagated from them
+          size_t    dirtyTransforms;    // transforms with a changed local matrix
+          size_t    evaluatedLODs;      // LODs whose level has been selected
+          size_t    changedLODs;        // LODs which switched to another level
+          size_t    changedSwitches;    // switches with a changed active mask
+          size_t    emittedChanges;     // changes sent to the observers with the batch of the update
+          uint64_t  generateTime;       // nanoseconds spent in the streaming generation
+          uint64_t  transformTreeTime;  // nanoseconds spent updating the TransformTree
+          uint64_t  objectTreeTime;     // nanoseconds spent updating the ObjectTree
+        };
+
+        UpdateStatistics const & getUpdateStatistics() const { return m_updateStatistics; }
+
       protected:
         // remove a transform from the transform array
         DP_SG_XBAR_API void removeTransform(TransformIndex index);
@@ -148,13 +203,43 @@ namespace dp
 
         DP_SG_XBAR_API void onRootNodeChanged( );
 
+        // attach the observers and transforms of a node which is already linked into the ObjectTree
+        DP_SG_XBAR_API void attachObject( ObjectTreeIndex index );
+
+        // generate the children of the given group on a later update
+        DP_SG_XBAR_API void deferSubTree( ObjectTreeIndex index, dp::sg::core::GroupSharedPtr const & group );
+        DP_SG_XBAR_API void generatePendingSubTrees();
+
+        // queue a change for the next batch of changes sent to the observers
+        void addChange( ObjectTreeIndex index, Event::Type type ) { m_changes.push_back( { index, type } ); }
+        DP_SG_XBAR_API void notifyChanges();
+
       private:
-        void init();
+        void init( unsigned int generatorThreadCount );
+
+        // move all transform indices kept by the SceneTree to their new index after the transform tree has been compacted
+        void remapTransforms( std::vector<TransformIndex> const & remap );
+
+        class TransformTreeObserver : public dp::util::Observer
+        {
+        public:
+          TransformTreeObserver( SceneTree & sceneTree )
+            : m_sceneTree( sceneTree )
+          {
+          }
+
+          virtual void onNotify( dp::util::Event const & event, dp::util::Payload * payload );
+          virtual void onDestroyed( dp::util::Subject const & subject, dp::util::Payload * payload );
+
+        private:
+          SceneTree & m_sceneTree;
+        };
 
         friend class UpdateTransformVisitor;
         friend class UpdateObjectVisitor;
         friend class SceneObserver;
         friend class SceneGenerator;
+        friend class SceneTreeGenerator;
         friend class GeneratorState;
 
         dp::sg::core::SceneSharedPtr m_scene;
@@ -167,6 +252,7 @@ namespace dp
         ObjectObserverSharedPtr    m_objectObserver;
         SwitchObserverSharedPtr    m_switchObserver;
         SceneObserverSharedPtr     m_sceneObserver;
+        LODSelectorSharedPtr       m_lodSelector;
 
 
         ObjectTree                               m_objectTree;
@@ -174,9 +260,17 @@ namespace dp
         ObjectTreeIndex                          m_objectTreeRootNode;
         std::vector< ObjectTreeIndex >           m_objectIndexStack;    // temp variable
 
-        std::set< ObjectTreeIndex >              m_lightSources;
+        ObjectTreeIndexSet                       m_lightSources;
+        Event::Changes                           m_changes;             // changes not yet sent to the observers
+
+        size_t                                   m_streamingBudget;
+        TreeIndexMap<ObjectTreeIndex, dp::sg::core::GroupWeakPtr> m_pendingSubTrees;   // groups whose children are not generated yet
+        std::deque<ObjectTreeIndex>              m_pendingQueue;        // the pending groups in breadth first order
 
         TransformTree m_transformTree;
+        TransformTreeObserver m_transformTreeObserver;
+
+        UpdateStatistics                         m_updateStatistics;
       };
 
       /*===========================================================================*/
@@ -62,8 +62,14 @@ namespace dp
         TransformIndex addBillboard(TransformIndex parentIndex, dp::sg::core::BillboardSharedPtr const & billboard);
         void removeBillboard(TransformIndex transformIndex);
 
-        //! \brief Recompute the values in the transform tree
-        void compute(dp::sg::core::CameraSharedPtr const & camera);
+        //! \brief Make room for count transforms or billboards about to be added
+        void reserve(size_t count);
+
+        //! \brief Recompute the values in the transform tree, returns the number of transforms with a changed local matrix
+        size_t compute(dp::sg::core::CameraSharedPtr const & camera);
+
+        //! \brief Move the data of each transform to its new index after the tree has been compacted, see dp::transform::Tree::compact
+        void remapTransforms(std::vector<TransformIndex> const & remap);
 
         dp::transform::Tree & getTree() { return m_tree; }
 
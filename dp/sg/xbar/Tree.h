@@ -26,9 +26,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <deque>
 #include <vector>
 #include <dp/Assert.h>
+#include <dp/util/WorkerPool.h>
 
 namespace dp
 {
@@ -51,6 +53,9 @@ namespace dp
 
         IndexClass getFreeNode();
 
+        // make sure that count nodes can be inserted without growing the tree
+        void reserve( size_t count );
+
         IndexClass insertNode( const NodeClass & node, IndexClass parentIndex, IndexClass prevSiblingIndex );
 
         void deleteNode( IndexClass index );
@@ -66,6 +71,10 @@ namespace dp
         IndexClass               m_firstFreeIndex;
         std::vector< NodeClass > m_tree;
         std::vector< IndexClass> m_dirtyObjects;
+
+        // scratch data of PreOrderTreeTraverser::processDirtyList, one stamp per node. A stamp is valid if its upper bits match the epoch.
+        std::vector< uint32_t >  m_dirtyRootStamps;
+        uint32_t                 m_dirtyRootEpoch;
       };
 
       template <typename TreeType, typename TreeNodeVisitor>
@@ -74,17 +83,40 @@ namespace dp
       public:
         void traverse( TreeType &tree, TreeNodeVisitor &visitor, typename TreeType::IndexType root = 0 );
 
+        /** \brief Traverse the subtrees below the topmost nodes of the dirty list which have a bit of dirtyBitMask set.
+            \remarks Each subtree is traversed once, even if several nodes in it are dirty. If a WorkerPool is set, the
+                     subtrees are traversed concurrently and the visitor has to support concurrent calls for disjoint subtrees.
+        **/
         void processDirtyList( TreeType &tree, TreeNodeVisitor &visitor, unsigned int dirtyBitMask );
 
+        /** \brief Set the WorkerPool used by processDirtyList. If nullptr, which is the default, the subtrees are traversed serially. **/
+        void setWorkerPool( dp::util::WorkerPoolSharedPtr const & workerPool ) { m_workerPool = workerPool; }
+        dp::util::WorkerPoolSharedPtr const & getWorkerPool() const { return m_workerPool; }
+
       protected:
-        void doTraverse( typename TreeType::IndexType index );
+        struct StackEntry
+        {
+          typename TreeType::IndexType  index;
+          typename TreeType::IndexType  child;  // next child to traverse, ~0 if all children have been traversed
+          typename TreeNodeVisitor::Data data;
+        };
+
+        // traverse the subtree below index with an explicit stack, so that deep trees do not overflow the call stack
+        void doTraverse( typename TreeType::IndexType index, std::vector<StackEntry> & stack );
+        void collectDirtyRoots( unsigned int dirtyBitMask );
 
         TreeType        *m_tree;
         TreeNodeVisitor *m_visitor;
+
+        dp::util::WorkerPoolSharedPtr                 m_workerPool;
+        std::vector<StackEntry>                       m_stack;
+        std::vector<typename TreeType::IndexType>     m_dirtyRoots;
+        std::vector<typename TreeType::IndexType>     m_dirtyPath;
       };
 
       template< class NodeClass, class IndexClass >
       TreeBaseClass<NodeClass, IndexClass>::TreeBaseClass()
+        : m_dirtyRootEpoch( 0 )
       {
         // initialize object tree with some free indices
         IndexType n( 65536 );
@@ -128,6 +160,33 @@ namespace dp
         return index;
       }
 
+      template< class NodeClass, class IndexClass >
+      void TreeBaseClass<NodeClass, IndexClass>::reserve( size_t count )
+      {
+        // count the free nodes, the last one in the free list is never handed out by getFreeNode
+        size_t freeCount = 0;
+        IndexClass lastFree = m_firstFreeIndex;
+        while ( freeCount < count && m_tree[lastFree].m_nextSibling != ~0 )
+        {
+          lastFree = m_tree[lastFree].m_nextSibling;
+          ++freeCount;
+        }
+
+        if ( freeCount < count )
+        {
+          IndexType size = IndexType(m_tree.size());
+          m_tree.resize( size + count - freeCount );
+          IndexType newSize = IndexType(m_tree.size());
+
+          // append a new chain of free objects to the free list
+          m_tree[lastFree].m_nextSibling = size;
+          for( IndexType i = size; i < newSize - 1; ++i )
+          {
+            m_tree[i].m_nextSibling = i+1;
+          }
+        }
+      }
+
       template< class NodeClass, class IndexClass >
       IndexClass TreeBaseClass<NodeClass, IndexClass>::insertNode( const NodeClass & node, IndexClass parentIndex, IndexClass prevSiblingIndex )
       {
@@ -314,7 +373,7 @@ namespace dp
         m_tree = &tree;
         m_visitor = &visitor;
 
-        doTraverse( root );
+        doTraverse( root, m_stack );
       };
 
       template <typename TreeType, typename TreeNodeVisitor>
@@ -323,44 +382,114 @@ namespace dp
         m_tree = &tree;
         m_visitor = &visitor;
 
-        typename std::vector<typename TreeType::IndexType>::iterator itEnd = m_tree->m_dirtyObjects.end();
-        for ( typename std::vector<typename TreeType::IndexType>::iterator it = m_tree->m_dirtyObjects.begin(); it != itEnd;++it )
+        collectDirtyRoots( dirtyBitMask );
+
+        if ( m_workerPool && 1 < m_dirtyRoots.size() )
+        {
+          m_workerPool->execute( m_dirtyRoots.size(), [this]( size_t task )
+          {
+            std::vector<StackEntry> stack;
+            doTraverse( m_dirtyRoots[task], stack );
+          } );
+        }
+        else
+        {
+          for ( size_t i = 0; i < m_dirtyRoots.size(); ++i )
+          {
+            doTraverse( m_dirtyRoots[i], m_stack );
+          }
+        }
+      }
+
+      template <typename TreeType, typename TreeNodeVisitor>
+      void PreOrderTreeTraverser<TreeType, TreeNodeVisitor>::collectDirtyRoots( unsigned int dirtyBitMask )
+      {
+        typedef typename TreeType::IndexType IndexType;
+
+        // A stamp holds the epoch in the upper 30 bits, whether the node or one of its ancestors is dirty in bit 0
+        // and whether the node already is a dirty root in bit 1. Each clean node is resolved at most once, so all
+        // dirty roots are found in a single pass over the dirty list instead of walking to the root of the tree for
+        // each dirty node.
+        std::vector<uint32_t> & stamps = m_tree->m_dirtyRootStamps;
+        if ( stamps.size() < m_tree->size() )
+        {
+          stamps.resize( m_tree->size(), 0 );
+        }
+        m_tree->m_dirtyRootEpoch = ( m_tree->m_dirtyRootEpoch + 1 ) & 0x3fffffff;
+        if ( !m_tree->m_dirtyRootEpoch )
+        {
+          std::fill( stamps.begin(), stamps.end(), 0 );
+          m_tree->m_dirtyRootEpoch = 1;
+        }
+        uint32_t const epoch = m_tree->m_dirtyRootEpoch << 2;
+
+        m_dirtyRoots.clear();
+        for ( size_t i = 0; i < m_tree->m_dirtyObjects.size(); ++i )
         {
-          if ( ((*m_tree)[*it].m_dirtyBits & dirtyBitMask) == 0)
+          IndexType index = m_tree->m_dirtyObjects[i];
+          if ( ( (*m_tree)[index].m_dirtyBits & dirtyBitMask ) == 0 )
           {
             continue;
           }
 
-          // search dirty parent node
-          typename TreeType::IndexType dirtyRootNode = ~0;
-          typename TreeType::IndexType currentNode = *it;
-          while ( currentNode != ~0 )
+          if ( stamps[index] == ( epoch | 3 ) )
           {
-            if ( ((*m_tree)[currentNode].m_dirtyBits & dirtyBitMask) != 0 )
-            {
-              dirtyRootNode = currentNode;
-            }
-            currentNode = (*m_tree)[currentNode].m_parentIndex;
+            continue;   // listed twice
           }
 
-          doTraverse( dirtyRootNode );
+          // walk up to the first dirty ancestor or the first ancestor resolved before
+          m_dirtyPath.clear();
+          IndexType current = (*m_tree)[index].m_parentIndex;
+          while ( current != ~0 && ( stamps[current] & ~3u ) != epoch && ( (*m_tree)[current].m_dirtyBits & dirtyBitMask ) == 0 )
+          {
+            m_dirtyPath.push_back( current );
+            current = (*m_tree)[current].m_parentIndex;
+          }
+          uint32_t dirtyAbove = ( current == ~0 ) ? 0 : ( ( stamps[current] & ~3u ) == epoch ) ? ( stamps[current] & 1 ) : 1;
+          for ( size_t p = 0; p < m_dirtyPath.size(); ++p )
+          {
+            stamps[m_dirtyPath[p]] = epoch | dirtyAbove;
+          }
+
+          // the node is a dirty root if none of its ancestors is dirty
+          if ( !dirtyAbove )
+          {
+            stamps[index] = epoch | 3;
+            m_dirtyRoots.push_back( index );
+          }
         }
       }
 
       template <typename TreeType, typename TreeNodeVisitor>
-      void PreOrderTreeTraverser<TreeType, TreeNodeVisitor>::doTraverse( typename TreeType::IndexType index )
+      void PreOrderTreeTraverser<TreeType, TreeNodeVisitor>::doTraverse( typename TreeType::IndexType index, std::vector<StackEntry> & stack )
       {
-        typename TreeNodeVisitor::Data data;
-        if ( m_visitor->preTraverse( index, data ) )
+        DP_ASSERT( stack.empty() );
+
+        stack.push_back( StackEntry() );
+        stack.back().index = index;
+        stack.back().child = m_visitor->preTraverse( index, stack.back().data ) ? (*m_tree)[index].m_firstChild : ~0;
+
+        while ( !stack.empty() )
         {
-          typename TreeType::IndexType sibling = (*m_tree)[index].m_firstChild;
-          while ( sibling != ~0 )
+          typename TreeType::IndexType child = stack.back().child;
+          if ( child != ~0 )
+          {
+            stack.push_back( StackEntry() );
+            stack.back().index = child;
+            stack.back().child = m_visitor->preTraverse( child, stack.back().data ) ? (*m_tree)[child].m_firstChild : ~0;
+          }
+          else
           {
-            doTraverse( sibling );
-            sibling = (*m_tree)[sibling].m_nextSibling;
+            // all children have been traversed, continue with the next sibling in the parent
+            typename TreeType::IndexType finished = stack.back().index;
+            m_visitor->postTraverse( finished, stack.back().data );
+            stack.pop_back();
+            if ( !stack.empty() )
+            {
+              stack.back().child = (*m_tree)[finished].m_nextSibling;
+            }
           }
         }
-        m_visitor->postTraverse( index, data );
       }
 
     } // namespace xbar
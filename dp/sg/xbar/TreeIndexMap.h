@@ -0,0 +1,352 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#pragma once
+
+#include <dp/Assert.h>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dp
+{
+  namespace sg
+  {
+    namespace xbar
+    {
+
+      /** \brief Open addressing hash table with linear probing, mapping tree indices to slots of a dense array.
+                 ~0 is no valid index, it marks the empty buckets. Erased entries are closed by shifting back the
+                 following entries of their probe sequence, so there are no tombstones.
+      **/
+      template <typename IndexType>
+      class TreeIndexTable
+      {
+      public:
+        static const uint32_t InvalidSlot = ~0u;
+
+        TreeIndexTable()
+          : m_count( 0 )
+        {
+        }
+
+        uint32_t find( IndexType index ) const
+        {
+          if ( m_count )
+          {
+            for ( size_t bucket = hash( index ); ; bucket = ( bucket + 1 ) & mask() )
+            {
+              if ( m_buckets[bucket].first == index )
+              {
+                return m_buckets[bucket].second;
+              }
+              if ( m_buckets[bucket].first == IndexType(~0) )
+              {
+                break;
+              }
+            }
+          }
+          return InvalidSlot;
+        }
+
+        // index must not be in the table yet
+        void insert( IndexType index, uint32_t slot )
+        {
+          DP_ASSERT( index != IndexType(~0) && find( index ) == InvalidSlot );
+          if ( m_buckets.size() < 2 * ( m_count + 1 ) )
+          {
+            rehash( std::max( size_t(16), 2 * m_buckets.size() ) );
+          }
+          m_buckets[findBucket( index )] = std::make_pair( index, slot );
+          ++m_count;
+        }
+
+        // index must be in the table
+        void setSlot( IndexType index, uint32_t slot )
+        {
+          size_t bucket = findBucket( index );
+          DP_ASSERT( m_buckets[bucket].first == index );
+          m_buckets[bucket].second = slot;
+        }
+
+        // index must be in the table
+        void erase( IndexType index )
+        {
+          size_t bucket = findBucket( index );
+          DP_ASSERT( m_buckets[bucket].first == index );
+
+          // move back the following entries which would not be reachable anymore through the new hole
+          for ( size_t next = ( bucket + 1 ) & mask(); m_buckets[next].first != IndexType(~0); next = ( next + 1 ) & mask() )
+          {
+            size_t home = hash( m_buckets[next].first );
+            if ( ( ( next - home ) & mask() ) >= ( ( next - bucket ) & mask() ) )
+            {
+              m_buckets[bucket] = m_buckets[next];
+              bucket = next;
+            }
+          }
+          m_buckets[bucket].first = IndexType(~0);
+          --m_count;
+        }
+
+        void clear()
+        {
+          std::fill( m_buckets.begin(), m_buckets.end(), std::make_pair( IndexType(~0), InvalidSlot ) );
+          m_count = 0;
+        }
+
+        size_t capacity() const { return m_buckets.size(); }
+
+        void swap( TreeIndexTable & rhs )
+        {
+          m_buckets.swap( rhs.m_buckets );
+          std::swap( m_count, rhs.m_count );
+        }
+
+      private:
+        size_t mask() const { return m_buckets.size() - 1; }
+
+        // Fibonacci hashing, the upper bits of the product are the best mixed ones
+        size_t hash( IndexType index ) const
+        {
+          return size_t( ( uint64_t( index ) * 0x9E3779B97F4A7C15ull ) >> 32 ) & mask();
+        }
+
+        // bucket of index or the empty bucket where it would be inserted
+        size_t findBucket( IndexType index ) const
+        {
+          size_t bucket = hash( index );
+          while ( m_buckets[bucket].first != index && m_buckets[bucket].first != IndexType(~0) )
+          {
+            bucket = ( bucket + 1 ) & mask();
+          }
+          return bucket;
+        }
+
+        void rehash( size_t bucketCount )
+        {
+          DP_ASSERT( ( bucketCount & ( bucketCount - 1 ) ) == 0 );
+          std::vector<std::pair<IndexType, uint32_t>> buckets( bucketCount, std::make_pair( IndexType(~0), InvalidSlot ) );
+          m_buckets.swap( buckets );
+          for ( size_t i = 0; i < buckets.size(); ++i )
+          {
+            if ( buckets[i].first != IndexType(~0) )
+            {
+              m_buckets[findBucket( buckets[i].first )] = buckets[i];
+            }
+          }
+        }
+
+      private:
+        std::vector<std::pair<IndexType, uint32_t>> m_buckets;
+        size_t                                      m_count;
+      };
+
+      template <typename IndexType>
+      const uint32_t TreeIndexTable<IndexType>::InvalidSlot;
+
+      /** \brief Map from tree indices to values with the interface of the used subset of std::map. The entries are stored
+                 in a dense vector, so iterating them is a linear walk. The order of the entries is unspecified, erasing moves
+                 the last entry into the erased one.
+      **/
+      template <typename IndexType, typename T>
+      class TreeIndexMap
+      {
+      public:
+        typedef std::pair<IndexType, T>                           value_type;
+        typedef typename std::vector<value_type>::iterator        iterator;
+        typedef typename std::vector<value_type>::const_iterator  const_iterator;
+
+        iterator begin() { return m_entries.begin(); }
+        iterator end() { return m_entries.end(); }
+        const_iterator begin() const { return m_entries.begin(); }
+        const_iterator end() const { return m_entries.end(); }
+
+        size_t size() const { return m_entries.size(); }
+        bool empty() const { return m_entries.empty(); }
+
+        iterator find( IndexType index )
+        {
+          uint32_t slot = m_table.find( index );
+          return slot == TreeIndexTable<IndexType>::InvalidSlot ? m_entries.end() : m_entries.begin() + slot;
+        }
+
+        const_iterator find( IndexType index ) const
+        {
+          uint32_t slot = m_table.find( index );
+          return slot == TreeIndexTable<IndexType>::InvalidSlot ? m_entries.end() : m_entries.begin() + slot;
+        }
+
+        T & operator[]( IndexType index )
+        {
+          uint32_t slot = m_table.find( index );
+          if ( slot == TreeIndexTable<IndexType>::InvalidSlot )
+          {
+            slot = uint32_t( m_entries.size() );
+            m_table.insert( index, slot );
+            m_entries.push_back( value_type( index, T() ) );
+          }
+          return m_entries[slot].second;
+        }
+
+        void erase( iterator it )
+        {
+          m_table.erase( it->first );
+          if ( it + 1 != m_entries.end() )
+          {
+            *it = std::move( m_entries.back() );
+            m_table.setSlot( it->first, uint32_t( it - m_entries.begin() ) );
+          }
+          m_entries.pop_back();
+        }
+
+        size_t erase( IndexType index )
+        {
+          iterator it = find( index );
+          if ( it == m_entries.end() )
+          {
+            return 0;
+          }
+          erase( it );
+          return 1;
+        }
+
+        void clear()
+        {
+          // a table grown in a frame with many entries would make a complete reset expensive for the following small ones
+          if ( m_entries.size() < m_table.capacity() / 8 )
+          {
+            for ( size_t i = 0; i < m_entries.size(); ++i )
+            {
+              m_table.erase( m_entries[i].first );
+            }
+          }
+          else
+          {
+            m_table.clear();
+          }
+          m_entries.clear();
+        }
+
+        void swap( TreeIndexMap & rhs )
+        {
+          m_entries.swap( rhs.m_entries );
+          m_table.swap( rhs.m_table );
+        }
+
+      private:
+        std::vector<value_type> m_entries;
+        TreeIndexTable<IndexType>   m_table;
+      };
+
+      /** \brief Set of tree indices with the interface of the used subset of std::set. Like TreeIndexMap, the indices are
+                 stored in a dense vector in unspecified order.
+      **/
+      template <typename IndexType>
+      class TreeIndexSet
+      {
+      public:
+        typedef IndexType                                         value_type;
+        typedef typename std::vector<IndexType>::const_iterator   iterator;
+        typedef typename std::vector<IndexType>::const_iterator   const_iterator;
+
+        const_iterator begin() const { return m_indices.begin(); }
+        const_iterator end() const { return m_indices.end(); }
+
+        size_t size() const { return m_indices.size(); }
+        bool empty() const { return m_indices.empty(); }
+
+        const_iterator find( IndexType index ) const
+        {
+          uint32_t slot = m_table.find( index );
+          return slot == TreeIndexTable<IndexType>::InvalidSlot ? m_indices.end() : m_indices.begin() + slot;
+        }
+
+        bool insert( IndexType index )
+        {
+          if ( m_table.find( index ) != TreeIndexTable<IndexType>::InvalidSlot )
+          {
+            return false;
+          }
+          m_table.insert( index, uint32_t( m_indices.size() ) );
+          m_indices.push_back( index );
+          return true;
+        }
+
+        size_t erase( IndexType index )
+        {
+          uint32_t slot = m_table.find( index );
+          if ( slot == TreeIndexTable<IndexType>::InvalidSlot )
+          {
+            return 0;
+          }
+          m_table.erase( index );
+          if ( slot + 1 != m_indices.size() )
+          {
+            m_indices[slot] = m_indices.back();
+            m_table.setSlot( m_indices[slot], slot );
+          }
+          m_indices.pop_back();
+          return 1;
+        }
+
+        void erase( const_iterator it )
+        {
+          erase( *it );
+        }
+
+        void clear()
+        {
+          if ( m_indices.size() < m_table.capacity() / 8 )
+          {
+            for ( size_t i = 0; i < m_indices.size(); ++i )
+            {
+              m_table.erase( m_indices[i] );
+            }
+          }
+          else
+          {
+            m_table.clear();
+          }
+          m_indices.clear();
+        }
+
+        void swap( TreeIndexSet & rhs )
+        {
+          m_indices.swap( rhs.m_indices );
+          m_table.swap( rhs.m_table );
+        }
+
+      private:
+        std::vector<IndexType>  m_indices;
+        TreeIndexTable<IndexType>   m_table;
+      };
+
+    } // namespace xbar
+  } // namespace sg
+} // namespace dp
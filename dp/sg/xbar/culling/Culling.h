@@ -74,6 +74,29 @@ namespace dp
           /** \brief Cull the SceneTree against the given world2ViewProjection matrix and update the given result **/
           DP_SG_XBAR_CULLING_API virtual void cull( ResultSharedPtr const& result, dp::math::Mat44f const & world2ViewProjection ) = 0;
 
+          /** \brief Cull the SceneTree like cull above and additionally hide objects whose projected bounding box covers less than
+                     minimumPixelArea pixels in a viewport of the given size. Culling modes without small feature culling ignore the size.
+          **/
+          DP_SG_XBAR_CULLING_API virtual void cull( ResultSharedPtr const& result, dp::math::Mat44f const & world2ViewProjection
+                                                  , dp::math::Vec2ui const & viewportSize, float minimumPixelArea ) = 0;
+
+          /** \brief Check if the culling mode supports occlusion culling. Currently only the CPU modes support it. **/
+          DP_SG_XBAR_CULLING_API virtual bool isOcclusionCullingSupported() const = 0;
+
+          /** \brief Use the triangles of the GeoNode at the given ObjectTree index as occluder for cullOcclusion. Only primitives
+                     of type TRIANGLES are used. Occluders should be a few large, opaque objects with a small number of triangles.
+              \return false if occlusion culling is not supported or the GeoNode has no triangles.
+          **/
+          DP_SG_XBAR_CULLING_API virtual bool occluderAdd( ObjectTreeIndex objectTreeIndex ) = 0;
+          DP_SG_XBAR_CULLING_API virtual void occluderRemove( ObjectTreeIndex objectTreeIndex ) = 0;
+
+          /** \brief Cull the objects which are visible in frustumResult, but hidden behind the occluders, and update occlusionResult.
+                     The frustumResult must have been culled with the same world2ViewProjection matrix before. Objects are visible
+                     if they are visible in both results.
+          **/
+          DP_SG_XBAR_CULLING_API virtual void cullOcclusion( ResultSharedPtr const & frustumResult, ResultSharedPtr const & occlusionResult
+                                                           , dp::math::Mat44f const & world2ViewProjection ) = 0;
+
           /** \brief Calculate the bounding box of the SceneTree. Currently all active and inactive objects are used to calculate the result **/
           DP_SG_XBAR_CULLING_API virtual dp::math::Box3f getBoundingBox( ) = 0;
         };
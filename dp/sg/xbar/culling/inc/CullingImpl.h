@@ -28,6 +28,8 @@
 
 #include <dp/sg/xbar/culling/Culling.h>
 #include <dp/culling/Manager.h>
+#include <dp/culling/cpu/Manager.h>
+#include <map>
 
 namespace dp
 {
@@ -49,8 +51,15 @@ namespace dp
           virtual bool resultIsVisible( ResultSharedPtr const & result, ObjectTreeIndex objectTreeIndex ) const;
           virtual std::vector<dp::sg::xbar::ObjectTreeIndex> const & resultGetChangedIndices( ResultSharedPtr const & result ) const;
           virtual void cull( ResultSharedPtr const & result, dp::math::Mat44f const & world2ViewProjection );
+          virtual void cull( ResultSharedPtr const & result, dp::math::Mat44f const & world2ViewProjection
+                           , dp::math::Vec2ui const & viewportSize, float minimumPixelArea );
           virtual dp::math::Box3f getBoundingBox();
 
+          virtual bool isOcclusionCullingSupported() const;
+          virtual bool occluderAdd( ObjectTreeIndex objectTreeIndex );
+          virtual void occluderRemove( ObjectTreeIndex objectTreeIndex );
+          virtual void cullOcclusion( ResultSharedPtr const & frustumResult, ResultSharedPtr const & occlusionResult, dp::math::Mat44f const & world2ViewProjection );
+
         protected:
           CullingImpl( SceneTreeSharedPtr const & sceneTree, dp::culling::Mode cullingMode );
 
@@ -65,19 +74,22 @@ namespace dp
           //! \brief Update bounding box for the given ObjectTreeIndex
           void updateBoundingBox( ObjectTreeIndex objectTreeIndex );
 
+          //! \brief Update the culling result from the changed objects of the culling manager
+          void updateChangedIndices( ResultSharedPtr const & result );
+
         private:
           SceneTreeSharedPtr const m_sceneTree;
 
           // culling data
 
-          //! \brief Payload class which assigns an ObjectTreeIndex to each culling object.
+          //! \brief Payload class which assigns an ObjectTreeIndex and the index of its transform to each culling object.
           DEFINE_PTR_TYPES( Payload );
           class Payload : public dp::culling::Payload
           {
           public:
-            static PayloadSharedPtr create( ObjectTreeIndex objectTreeIndex )
+            static PayloadSharedPtr create( ObjectTreeIndex objectTreeIndex, TransformIndex transformIndex )
             {
-              return( std::shared_ptr<Payload>( new Payload( objectTreeIndex ) ) );
+              return( std::shared_ptr<Payload>( new Payload( objectTreeIndex, transformIndex ) ) );
             }
 
             virtual ~Payload()
@@ -86,14 +98,20 @@ namespace dp
 
             ObjectTreeIndex getObjectTreeIndex() const { return m_objectTreeIndex; }
 
+            // the transform index is moved along when the transform tree is compacted
+            TransformIndex getTransformIndex() const { return m_transformIndex; }
+            void setTransformIndex( TransformIndex transformIndex ) { m_transformIndex = transformIndex; }
+
           protected:
-            Payload( ObjectTreeIndex objectTreeIndex )
+            Payload( ObjectTreeIndex objectTreeIndex, TransformIndex transformIndex )
               : m_objectTreeIndex( objectTreeIndex )
+              , m_transformIndex( transformIndex )
             {
             }
 
           private:
             ObjectTreeIndex m_objectTreeIndex;
+            TransformIndex  m_transformIndex;
           };
 
           class TransformObserver : public dp::util::Observer
@@ -111,8 +129,11 @@ namespace dp
           };
 
           std::unique_ptr<dp::culling::Manager>  m_culling;
+          dp::culling::cpu::Manager               * m_cullingCPU; // m_culling if it supports occlusion culling
+          TransformObserver                         m_transformObserver;
           dp::culling::GroupSharedPtr               m_cullingGroup;
           std::vector<dp::culling::ObjectSharedPtr> m_objects;
+          std::map<ObjectTreeIndex, dp::culling::cpu::OccluderSharedPtr> m_occluders;
         };
 
       } // namespace culling
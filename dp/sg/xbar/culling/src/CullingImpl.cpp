@@ -27,6 +27,9 @@
 #include <dp/sg/xbar/culling/inc/CullingImpl.h>
 #include <dp/sg/xbar/culling/inc/ResultImpl.h>
 #include <dp/sg/core/GeoNode.h>
+#include <dp/sg/core/IndexSet.h>
+#include <dp/sg/core/Primitive.h>
+#include <dp/sg/core/VertexAttributeSet.h>
 
 #include <dp/culling/cpu/Manager.h>
 #include <dp/culling/opengl/Manager.h>
@@ -48,18 +51,26 @@ namespace dp
 
         CullingImpl::CullingImpl( SceneTreeSharedPtr const & sceneTree, dp::culling::Mode cullingMode )
           : m_sceneTree( sceneTree )
+          , m_cullingCPU( nullptr )
+          , m_transformObserver( *this )
         {
           switch ( cullingMode )
           {
           case dp::culling::Mode::CPU:
-            m_culling.reset(dp::culling::cpu::Manager::create());
+            m_cullingCPU = dp::culling::cpu::Manager::create();
+            m_culling.reset(m_cullingCPU);
+            break;
+          case dp::culling::Mode::CPU_BVH:
+            m_cullingCPU = dp::culling::cpu::Manager::create(dp::culling::cpu::Manager::Algorithm::BVH);
+            m_culling.reset(m_cullingCPU);
             break;
           case dp::culling::Mode::OPENGL_COMPUTE:
             m_culling.reset(dp::culling::opengl::Manager::create());
             break;
           default:
             std::cerr << "unknown culling mode, falling back to CPU version" << std::endl;
-            m_culling.reset(dp::culling::cpu::Manager::create());
+            m_cullingCPU = dp::culling::cpu::Manager::create();
+            m_culling.reset(m_cullingCPU);
           }
           m_cullingGroup = m_culling->groupCreate();
 
@@ -100,10 +111,14 @@ namespace dp
 
           // and attach to SceneTree get update events
           m_sceneTree->attach( this );
+
+          // changed world matrices update only the culling data of the objects using them
+          m_sceneTree->getTransformTree().getTree().attach( &m_transformObserver );
         }
 
         CullingImpl::~CullingImpl()
         {
+          m_sceneTree->getTransformTree().getTree().detach( &m_transformObserver );
           m_cullingGroup.reset();
           m_sceneTree->detach( this );
         }
@@ -124,12 +139,106 @@ namespace dp
         }
 
         void CullingImpl::cull( ResultSharedPtr const & result, dp::math::Mat44f const & world2ViewProjection )
+        {
+          cull( result, world2ViewProjection, dp::math::Vec2ui( 0, 0 ), 0.0f );
+        }
+
+        void CullingImpl::cull( ResultSharedPtr const & result, dp::math::Mat44f const & world2ViewProjection
+                              , dp::math::Vec2ui const & viewportSize, float minimumPixelArea )
         {
           ResultImplSharedPtr resultImpl = std::static_pointer_cast<ResultImpl>(result);
           dp::math::Mat44f const * transforms = m_sceneTree->getTransformTree().getTree().getWorldMatrices();
           m_culling->groupSetMatrices(m_cullingGroup, transforms, m_sceneTree->getTransformTree().getTree().getTransformCount(), sizeof(transforms[0]));
-          m_culling->cull( m_cullingGroup, resultImpl->getResult(), world2ViewProjection );
+          m_culling->cull( m_cullingGroup, resultImpl->getResult(), world2ViewProjection, viewportSize, minimumPixelArea );
+          updateChangedIndices( result );
+        }
+
+        bool CullingImpl::isOcclusionCullingSupported() const
+        {
+          return !!m_cullingCPU;
+        }
+
+        bool CullingImpl::occluderAdd( ObjectTreeIndex objectTreeIndex )
+        {
+          if ( !m_cullingCPU )
+          {
+            return false;
+          }
+
+          DP_ASSERT( m_sceneTree->getObjectTreeNode( objectTreeIndex ).m_isDrawable );
+          dp::sg::core::GeoNodeSharedPtr geoNode = std::static_pointer_cast<dp::sg::core::GeoNode>(m_sceneTree->getObjectTreeNode( objectTreeIndex ).m_object);
+          dp::sg::core::PrimitiveSharedPtr const & primitive = geoNode->getPrimitive();
+          if ( !primitive || primitive->getPrimitiveType() != dp::sg::core::PrimitiveType::TRIANGLES || !primitive->getVertexAttributeSet() )
+          {
+            return false;
+          }
+
+          // gather the triangles of the element range, the vertices are copied as a whole
+          dp::sg::core::VertexAttributeSetSharedPtr const & vertexAttributeSet = primitive->getVertexAttributeSet();
+          dp::sg::core::Buffer::ConstIterator<dp::math::Vec3f>::Type vertexIterator = vertexAttributeSet->getVertices();
+          std::vector<dp::math::Vec3f> vertices( vertexAttributeSet->getNumberOfVertices() );
+          for ( size_t index = 0; index < vertices.size(); ++index )
+          {
+            vertices[index] = vertexIterator[index];
+          }
+
+          unsigned int const offset = primitive->getElementOffset();
+          unsigned int const count = primitive->getElementCount() - primitive->getElementCount() % 3;
+          std::vector<uint32_t> indices( count );
+          if ( primitive->isIndexed() )
+          {
+            // assume no primitive restarts in data stream
+            dp::sg::core::IndexSet::ConstIterator<unsigned int> indexIterator( primitive->getIndexSet(), offset );
+            for ( unsigned int index = 0; index < count; ++index )
+            {
+              indices[index] = indexIterator[index];
+            }
+          }
+          else
+          {
+            for ( unsigned int index = 0; index < count; ++index )
+            {
+              indices[index] = offset + index;
+            }
+          }
+
+          if ( indices.empty() )
+          {
+            return false;
+          }
+
+          occluderRemove( objectTreeIndex );
+
+          dp::culling::cpu::OccluderSharedPtr occluder = m_cullingCPU->occluderCreate( vertices.data(), vertices.size(), indices.data(), indices.size() );
+          m_cullingCPU->occluderSetTransformIndex( occluder, m_sceneTree->getObjectTreeNode( objectTreeIndex ).m_transform );
+          m_cullingCPU->groupAddOccluder( m_cullingGroup, occluder );
+          m_occluders[objectTreeIndex] = occluder;
+          return true;
+        }
 
+        void CullingImpl::occluderRemove( ObjectTreeIndex objectTreeIndex )
+        {
+          std::map<ObjectTreeIndex, dp::culling::cpu::OccluderSharedPtr>::iterator it = m_occluders.find( objectTreeIndex );
+          if ( it != m_occluders.end() )
+          {
+            m_cullingCPU->groupRemoveOccluder( m_cullingGroup, it->second );
+            m_occluders.erase( it );
+          }
+        }
+
+        void CullingImpl::cullOcclusion( ResultSharedPtr const & frustumResult, ResultSharedPtr const & occlusionResult, dp::math::Mat44f const & world2ViewProjection )
+        {
+          DP_ASSERT( m_cullingCPU && "occlusion culling is not supported by this culling mode" );
+
+          // the matrices have been set by the cull call of the frustum result
+          m_cullingCPU->cullOcclusion( m_cullingGroup, std::static_pointer_cast<ResultImpl>(frustumResult)->getResult()
+                                     , std::static_pointer_cast<ResultImpl>(occlusionResult)->getResult(), world2ViewProjection );
+          updateChangedIndices( occlusionResult );
+        }
+
+        void CullingImpl::updateChangedIndices( ResultSharedPtr const & result )
+        {
+          ResultImplSharedPtr resultImpl = std::static_pointer_cast<ResultImpl>(result);
           std::vector<dp::culling::ObjectSharedPtr> const & changedObjects = m_culling->resultGetChanged( resultImpl->getResult() );
           std::vector<ObjectTreeIndex> & changedIndices = resultImpl->getChanged();
 
@@ -170,7 +279,7 @@ namespace dp
 
           // create a new culling object and add it to the culling group
           ObjectTreeNode const &node = m_sceneTree->getObjectTreeNode( index );
-          m_objects[index] = m_culling->objectCreate( Payload::create( index ) );
+          m_objects[index] = m_culling->objectCreate( Payload::create( index, node.m_transform ) );
           m_culling->groupAddObject( m_cullingGroup, m_objects[index] );
           m_culling->objectSetTransformIndex(m_objects[index], node.m_transform);
           updateBoundingBox( index );
@@ -179,29 +288,34 @@ namespace dp
         void CullingImpl::onNotify( dp::util::Event const & event, dp::util::Payload * payload )
         {
           SceneTree::Event const & eventObject = static_cast<SceneTree::Event const&>(event);
-          ObjectTreeIndex index = eventObject.getIndex();
-          ObjectTreeNode const &node = eventObject.getNode();
+          SceneTree::Event::Changes const & changes = eventObject.getChanges();
 
-          switch (eventObject.getType())
+          for ( size_t i = 0; i < changes.size(); ++i )
           {
-          case SceneTree::Event::Type::ADDED:
-            addObject(index);
-            break;
-
-          case SceneTree::Event::Type::REMOVED:
-            DP_ASSERT( m_objects[eventObject.getIndex()] && "culling object for the given object has already been destroyed" );
-            m_culling->groupRemoveObject( m_cullingGroup, m_objects[index] );
-            m_objects[index].reset();
-            break;
-
-          case SceneTree::Event::Type::CHANGED:
-            DP_ASSERT( m_objects[eventObject.getIndex()]  && "no culling object available for the given index" );
-            updateBoundingBox( index );
-            // TODO update bounding box!
-            break;
+            ObjectTreeIndex index = changes[i].index;
 
-          default:
-            break;
+            switch (changes[i].type)
+            {
+            case SceneTree::Event::Type::ADDED:
+              addObject(index);
+              break;
+
+            case SceneTree::Event::Type::REMOVED:
+              DP_ASSERT( m_objects[index] && "culling object for the given object has already been destroyed" );
+              occluderRemove( index );
+              m_culling->groupRemoveObject( m_cullingGroup, m_objects[index] );
+              m_objects[index].reset();
+              break;
+
+            case SceneTree::Event::Type::CHANGED:
+              DP_ASSERT( m_objects[index]  && "no culling object available for the given index" );
+              updateBoundingBox( index );
+              // TODO update bounding box!
+              break;
+
+            default:
+              break;
+            }
           }
         }
 
@@ -216,11 +330,43 @@ namespace dp
 
         void CullingImpl::TransformObserver::onNotify(dp::util::Event const & event, dp::util::Payload * payload)
         {
-          dp::transform::Tree::EventWorldMatricesChanged const & eventWorldMatrices = static_cast<dp::transform::Tree::EventWorldMatricesChanged const&>(event);
-          eventWorldMatrices.getDirtyWorldMatrices().traverseBits([&](size_t index)
+          switch (static_cast<dp::transform::Tree::Event const&>(event).getType())
           {
-            m_cullingImpl.m_culling->groupMatrixChanged(m_cullingImpl.m_cullingGroup, index);
-          } );
+          case dp::transform::Tree::Event::Type::WORLD_MATRICES_CHANGED:
+            {
+              dp::transform::Tree::EventWorldMatricesChanged const & eventWorldMatrices = static_cast<dp::transform::Tree::EventWorldMatricesChanged const&>(event);
+              eventWorldMatrices.getDirtyWorldMatrices().traverseBits([&](size_t index)
+              {
+                m_cullingImpl.m_culling->groupMatrixChanged(m_cullingImpl.m_cullingGroup, index);
+              } );
+            }
+            break;
+
+          case dp::transform::Tree::Event::Type::TRANSFORMS_REMAPPED:
+            {
+              // the payloads keep the old transform indices, so the remap does not depend on the SceneTree being notified first
+              std::vector<dp::transform::Index> const & remap = static_cast<dp::transform::Tree::EventTransformsRemapped const&>(event).getRemap();
+              for (size_t index = 0; index < m_cullingImpl.m_objects.size(); ++index)
+              {
+                dp::culling::ObjectSharedPtr const & object = m_cullingImpl.m_objects[index];
+                if (object)
+                {
+                  PayloadSharedPtr p = std::static_pointer_cast<Payload>(m_cullingImpl.m_culling->objectGetUserData(object));
+                  DP_ASSERT(remap[p->getTransformIndex()] != dp::transform::InvalidIndex);
+                  p->setTransformIndex(remap[p->getTransformIndex()]);
+                  m_cullingImpl.m_culling->objectSetTransformIndex(object, p->getTransformIndex());
+                }
+              }
+
+              // an occluder uses the transform of its object
+              for (std::map<ObjectTreeIndex, dp::culling::cpu::OccluderSharedPtr>::const_iterator it = m_cullingImpl.m_occluders.begin(); it != m_cullingImpl.m_occluders.end(); ++it)
+              {
+                PayloadSharedPtr p = std::static_pointer_cast<Payload>(m_cullingImpl.m_culling->objectGetUserData(m_cullingImpl.m_objects[it->first]));
+                m_cullingImpl.m_cullingCPU->occluderSetTransformIndex(it->second, p->getTransformIndex());
+              }
+            }
+            break;
+          }
         }
 
         void CullingImpl::TransformObserver::onDestroyed(dp::util::Subject const & subject, dp::util::Payload * payload)
@@ -48,9 +48,7 @@ namespace dp
 
         void attach( dp::sg::core::GeoNodeSharedPtr const& geoNode, ObjectTreeIndex index )
         {
-          DP_ASSERT( m_indexMap.find( index ) == m_indexMap.end() );
-
-          Observer<ObjectTreeIndex>::attach( geoNode, Payload::create( index ) );
+          Observer<ObjectTreeIndex>::attach( geoNode, index );
         }
 
         virtual void onDetach( ObjectTreeIndex index )
@@ -58,10 +56,12 @@ namespace dp
           m_dirtyGeoNodes.erase( index );
         }
 
-        void popDirtyGeoNodes( ObjectTreeIndexSet & currentSet ) const
+        // the returned set stays valid until the next call
+        ObjectTreeIndexSet const & popDirtyGeoNodes() const
         {
-          currentSet = m_dirtyGeoNodes;
-          m_dirtyGeoNodes.clear();
+          m_currentGeoNodes.clear();
+          m_currentGeoNodes.swap( m_dirtyGeoNodes );
+          return m_currentGeoNodes;
         }
 
       protected:
@@ -76,6 +76,7 @@ namespace dp
 
       private:
         mutable ObjectTreeIndexSet m_dirtyGeoNodes;
+        mutable ObjectTreeIndexSet m_currentGeoNodes;
         SceneTreeSharedPtr m_sceneTree;
       };
 
@@ -0,0 +1,132 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#pragma once
+
+#include <dp/sg/xbar/inc/Observer.h>
+#include <dp/sg/core/LOD.h>
+#include <dp/math/Matmnt.h>
+#include <dp/util/WorkerPool.h>
+#include <cstdint>
+#include <vector>
+
+namespace dp
+{
+  namespace sg
+  {
+    namespace xbar
+    {
+      DEFINE_PTR_TYPES( LODSelector );
+
+      /** \brief Selects the levels of all LODs of a SceneTree in one pass. The centers, ranges, transform indices and levels
+                 of the LODs are kept in parallel arrays, which are refreshed only for LODs which notified a change. The
+                 levels are picked four LODs at a time with SSE on x86-64, wide passes are split over a WorkerPool.
+      **/
+      class LODSelector : public Observer<ObjectTreeIndex>
+      {
+      public:
+        struct LevelChange
+        {
+          ObjectTreeIndex index;
+          unsigned int    level;      // index of the active child, ~0 if there is none
+        };
+
+        typedef std::vector<LevelChange> LevelChanges;
+
+      public:
+        static LODSelectorSharedPtr create()
+        {
+          return( std::shared_ptr<LODSelector>( new LODSelector() ) );
+        }
+
+        ~LODSelector();
+
+        void attach( dp::sg::core::LODSharedPtr const & lod, ObjectTreeIndex index, TransformIndex transform );
+
+        /** \brief Pick the level of every LOD for the given camera.
+            \param worldMatrices The world matrices of the TransformTree.
+            \param worldToView The world to view matrix of the camera.
+            \param rangeScale Factor applied to all ranges.
+            \return The LODs whose level changed since the last call and those whose children or data changed.
+                    The vector stays valid until the next call.
+        **/
+        LevelChanges const & select( dp::math::Mat44f const * worldMatrices, dp::math::Mat44f const & worldToView, float rangeScale );
+
+        /** \brief Set the relative width of the band around each range in which a LOD keeps its current level.
+                   A LOD switches to a finer level once it is closer than range * ( 1 - hysteresis ) and to a coarser level
+                   once it is farther than range * ( 1 + hysteresis ). The default of 0 selects exactly like LOD::getLODToUse.
+                   A LOD without a current level, as on its first selection, always gets the level of the plain ranges.
+        **/
+        void setHysteresis( float hysteresis );
+        float getHysteresis() const { return m_hysteresis; }
+
+        /** \brief Replace the transform index of every LOD by its entry in remap after the TransformTree has been compacted. **/
+        void remapTransforms( std::vector<TransformIndex> const & remap );
+
+        /** \brief Set the number of threads used by select. 0 uses one thread per hardware thread, 1 is the default. **/
+        void setThreadCount( unsigned int threadCount );
+        unsigned int getThreadCount() const { return m_threadCount; }
+
+      protected:
+        LODSelector();
+
+        void onNotify( dp::util::Event const & event, dp::util::Payload * payload );
+        virtual void onDetach( ObjectTreeIndex index );
+
+      private:
+        void resize( size_t count );
+        void refresh( uint32_t slot );
+        void computeLevels( size_t begin, size_t end, dp::math::Mat44f const * worldMatrices, dp::math::Mat44f const & worldToView, float rangeScale ) const;
+
+      private:
+        // one entry per LOD, padded to a multiple of four with LODs without children
+        std::vector<ObjectTreeIndex>            m_index;
+        std::vector<TransformIndex>             m_transform;
+        std::vector<dp::sg::core::LODWeakPtr>   m_lods;
+        std::vector<float>                      m_centerX;
+        std::vector<float>                      m_centerY;
+        std::vector<float>                      m_centerZ;
+        std::vector<std::vector<float>>         m_ranges;       // m_ranges[i][slot] is range i of a LOD, 0 past its last range
+        std::vector<int32_t>                    m_levelLimit;   // min( number of ranges, number of children - 1 )
+        std::vector<int32_t>                    m_lockedLevel;  // -1 if the range lock is off
+        std::vector<int32_t>                    m_level;        // -1 if not selected yet
+        mutable std::vector<int32_t>            m_newLevel;
+        size_t                                  m_count;
+
+        TreeIndexMap<ObjectTreeIndex, uint32_t> m_slots;
+        ObjectTreeIndexSet                      m_dirty;
+        std::vector<uint32_t>                   m_forced;
+        LevelChanges                            m_changes;
+
+        float                                   m_hysteresis;
+        unsigned int                            m_threadCount;
+        dp::util::WorkerPoolSharedPtr           m_workerPool;
+      };
+
+    } // namespace xbar
+  } // namespace sg
+} // namespace dp
@@ -47,7 +47,7 @@ namespace dp
           unsigned int m_hints;
           unsigned int m_mask;
         };
-        typedef std::map< ObjectTreeIndex, CacheData >  NewCacheData;
+        typedef TreeIndexMap< ObjectTreeIndex, CacheData >  NewCacheData;
 
       public:
         virtual ~ObjectObserver();
@@ -60,10 +60,12 @@ namespace dp
         void attach( dp::sg::core::ObjectSharedPtr const& obj, ObjectTreeIndex index );
         virtual void onDetach( ObjectTreeIndex index );
 
-        void popNewCacheData( NewCacheData & currentData ) const
+        // the returned data stays valid until the next call
+        NewCacheData const & popNewCacheData() const
         {
-          currentData = m_newCacheData;
-          m_newCacheData.clear();
+          m_currentCacheData.clear();
+          m_currentCacheData.swap( m_newCacheData );
+          return m_currentCacheData;
         }
 
       protected:
@@ -73,11 +75,12 @@ namespace dp
         {
         }
         void onNotify( const dp::util::Event &event, dp::util::Payload * payload );
-        virtual void onPreRemoveChild( dp::sg::core::GroupSharedPtr const& group, dp::sg::core::NodeSharedPtr const & child, unsigned int index, Payload * payload );
-        virtual void onPostAddChild( dp::sg::core::GroupSharedPtr const& group, dp::sg::core::NodeSharedPtr const & child, unsigned int index, Payload * payload );
+        virtual void onPreRemoveChild( dp::sg::core::GroupSharedPtr const& group, dp::sg::core::NodeSharedPtr const & child, unsigned int index, ObjectTreeIndex objectIndex );
+        virtual void onPostAddChild( dp::sg::core::GroupSharedPtr const& group, dp::sg::core::NodeSharedPtr const & child, unsigned int index, ObjectTreeIndex objectIndex );
 
       private:
         mutable NewCacheData m_newCacheData;
+        mutable NewCacheData m_currentCacheData;
         SceneTreeSharedPtr m_sceneTree;
       };
 
@@ -27,6 +27,8 @@
 #pragma once
 
 #include <dp/sg/xbar/SceneTree.h>
+#include <unordered_map>
+#include <vector>
 
 namespace dp
 {
@@ -35,43 +37,57 @@ namespace dp
     namespace xbar
     {
 
+      /** \brief Base class of the observers of the objects in the trees. A subject is attached only once, however often
+                 it is referenced. Its payload holds the tree indices of all its references, so a shared object keeps a
+                 single entry in its list of observers and a notification reaches all references in one call.
+      **/
       template <typename IndexType>
       class Observer : public dp::util::Observer
       {
       public:
-        DEFINE_PTR_TYPES( Payload );
-
         class Payload : public dp::util::Payload
         {
         public:
-          static PayloadSharedPtr create( IndexType index )
+          Payload( dp::util::Subject * subject )
+            : m_subject( subject )
+            , m_handle( ~0 )
           {
-            return( std::shared_ptr<Payload>( new Payload( index ) ) );
           }
 
         public:
-          IndexType m_index;
-
-        protected:
-          Payload( IndexType index )
-            : m_index( index )
-          {
-          }
+          dp::util::Subject *                 m_subject;
+          dp::util::Subject::ObserverHandle   m_handle;
+          std::vector<IndexType>              m_indices;    // the tree indices referencing the subject
         };
 
         Observer();
         virtual ~Observer();
 
-        void attach( dp::util::SubjectSharedPtr const& subject, PayloadSharedPtr const& payload );
+        void attach( dp::util::SubjectSharedPtr const& subject, IndexType index );
         void detach( IndexType index );
         void detachAll();
+        bool isAttached( IndexType index ) const;
+
+        // prepare for count more subjects to attach
+        void reserve( size_t count );
+
+        // replace each attached index by its entry in remap, the indices must not map to ~0
+        void remap( std::vector<IndexType> const & remap );
 
         virtual void onDestroyed( dp::util::Subject const& subject, dp::util::Payload * payload );
       protected:
         virtual void onDetach( IndexType index ) {};
 
-        typedef std::multimap<ObjectTreeIndex, std::pair<dp::util::SubjectWeakPtr, PayloadSharedPtr> > IndexMap;
-        IndexMap m_indexMap;
+        struct Reference
+        {
+          Payload *     m_payload;
+          unsigned int  m_position;   // position of the index in m_payload->m_indices
+        };
+
+        // the payloads are kept in the map nodes, which do not move on insertion or erasure of other entries
+        typedef std::unordered_map<dp::util::Subject const*, Payload> PayloadMap;
+        PayloadMap                            m_payloads;
+        TreeIndexMap<IndexType, Reference>    m_references;
       };
 
       template <typename IndexType>
@@ -86,10 +102,22 @@ namespace dp
       }
 
       template <typename IndexType>
-      void Observer<IndexType>::attach( dp::util::SubjectSharedPtr const& subject, PayloadSharedPtr const& payload )
+      void Observer<IndexType>::attach( dp::util::SubjectSharedPtr const& subject, IndexType index )
       {
-        m_indexMap.insert( std::make_pair(payload->m_index, std::make_pair( dp::util::SubjectWeakPtr(subject), payload ) ) );
-        subject->attach( this, payload.operator->() );    // BIG HACK!! we somehow need to align dp::util::Payload and dp::sg::xbar::Observer<IndexType::Payload
+        DP_ASSERT( !isAttached( index ) );
+
+        // only the first reference attaches to the subject, the others just add their index to its payload
+        std::pair<typename PayloadMap::iterator, bool> inserted = m_payloads.emplace( subject.get(), Payload( subject.get() ) );
+        Payload & payload = inserted.first->second;
+        if ( inserted.second )
+        {
+          payload.m_handle = subject->attach( this, &payload );
+        }
+
+        Reference & reference = m_references[index];
+        reference.m_payload = &payload;
+        reference.m_position = dp::checked_cast<unsigned int>( payload.m_indices.size() );
+        payload.m_indices.push_back( index );
       }
 
       template <typename IndexType>
@@ -97,25 +125,76 @@ namespace dp
       {
         onDetach( index );
 
-        typename IndexMap::iterator it = m_indexMap.find( index );
-        DP_ASSERT( it != m_indexMap.end() );
+        typename TreeIndexMap<IndexType, Reference>::iterator it = m_references.find( index );
+        DP_ASSERT( it != m_references.end() );
+        Payload * payload = it->second.m_payload;
+        unsigned int position = it->second.m_position;
+        m_references.erase( it );
 
-        it->second.first.lock()->detach( this, it->second.second.get() );    // BIG HACK!! we somehow need to align dp::util::Payload and dp::sg::xbar::Observer<IndexType::Payload
+        // move the last index into the free position to keep the removal constant time
+        DP_ASSERT( position < payload->m_indices.size() );
+        if ( position + 1 != payload->m_indices.size() )
+        {
+          payload->m_indices[position] = payload->m_indices.back();
+          DP_ASSERT( isAttached( payload->m_indices[position] ) );
+          m_references.find( payload->m_indices[position] )->second.m_position = position;
+        }
+        payload->m_indices.pop_back();
 
-        m_indexMap.erase( it );
+        if ( payload->m_indices.empty() )
+        {
+          // the last reference is gone, this also releases the payload
+          dp::util::Subject * subject = payload->m_subject;
+          subject->detach( payload->m_handle );
+          m_payloads.erase( subject );
+        }
       }
 
       template <typename IndexType>
       void Observer<IndexType>::detachAll( )
       {
-        typename IndexMap::iterator it, it_end = m_indexMap.end();
-        for( it = m_indexMap.begin(); it != it_end; ++it )
+        typename PayloadMap::iterator it, it_end = m_payloads.end();
+        for( it = m_payloads.begin(); it != it_end; ++it )
         {
-          it->second.first.lock()->detach( this, it->second.second.get() );    // BIG HACK!! we somehow need to align dp::util::Payload and dp::sg::xbar::Observer<IndexType::Payload
+          it->second.m_subject->detach( it->second.m_handle );
         }
-        m_indexMap.clear();
+        m_payloads.clear();
+        m_references.clear();
       }
 
+      template <typename IndexType>
+      bool Observer<IndexType>::isAttached( IndexType index ) const
+      {
+        return( m_references.find( index ) != m_references.end() );
+      }
+
+      template <typename IndexType>
+      void Observer<IndexType>::reserve( size_t count )
+      {
+        m_payloads.reserve( m_payloads.size() + count );
+      }
+
+      template <typename IndexType>
+      void Observer<IndexType>::remap( std::vector<IndexType> const & remap )
+      {
+        // the payloads stay in place, only their indices and the references to them change
+        TreeIndexMap<IndexType, Reference> references;
+        typename PayloadMap::iterator it, it_end = m_payloads.end();
+        for ( it = m_payloads.begin(); it != it_end; ++it )
+        {
+          std::vector<IndexType> & indices = it->second.m_indices;
+          for ( size_t i = 0; i < indices.size(); ++i )
+          {
+            DP_ASSERT( indices[i] < remap.size() && remap[indices[i]] != IndexType(~0) );
+            indices[i] = remap[indices[i]];
+
+            Reference & reference = references[indices[i]];
+            reference.m_payload = &it->second;
+            reference.m_position = dp::checked_cast<unsigned int>( i );
+          }
+        }
+        m_references = std::move( references );
+      }
 
       template <typename IndexType>
       void Observer<IndexType>::onDestroyed( dp::util::Subject const& subject, dp::util::Payload * payload )
@@ -123,11 +202,14 @@ namespace dp
         DP_ASSERT( dynamic_cast<Payload*>(payload) );
         Payload const* p = static_cast<Payload const*>(payload);
 
-        onDetach( p->m_index );
+        for ( size_t i = 0; i < p->m_indices.size(); ++i )
+        {
+          onDetach( p->m_indices[i] );
+          m_references.erase( p->m_indices[i] );
+        }
 
-        typename IndexMap::iterator it = m_indexMap.find( p->m_index );
-        DP_ASSERT( it != m_indexMap.end() );
-        m_indexMap.erase( it );
+        DP_ASSERT( m_payloads.find( &subject ) != m_payloads.end() );
+        m_payloads.erase( &subject );
       }
 
     } // namespace xbar
@@ -30,6 +30,9 @@
 #include <dp/sg/xbar/xbar.h>
 #include <dp/sg/xbar/SceneTree.h>
 #include <dp/sg/algorithm/ModelViewTraverser.h>
+#include <dp/util/WorkerPool.h>
+#include <unordered_map>
+#include <vector>
 
 namespace dp
 {
@@ -51,6 +54,20 @@ namespace dp
 
         DP_SG_XBAR_API void addClipPlane( const dp::sg::core::ClipPlaneWeakPtr& clipPlane );
 
+        /** \brief Set a WorkerPool to fill disjoint subtrees concurrently. Subtrees without clip planes are linked into the
+                   ObjectTree by the workers, their observers and transforms are attached serially afterwards.
+        **/
+        DP_SG_XBAR_API void setWorkerPool( dp::util::WorkerPoolSharedPtr const & workerPool );
+
+        /** \brief Generate groups, transforms and billboards without their children and defer the children to the SceneTree. **/
+        DP_SG_XBAR_API void setDeferChildren( bool deferChildren );
+
+        // generate the children of a group already in the ObjectTree at index
+        DP_SG_XBAR_API void generateChildren( dp::sg::core::GroupSharedPtr const & group, ObjectTreeIndex index );
+
+        // number of ObjectTree nodes generated so far
+        size_t getObjectCount() const { return m_objectCount; }
+
       protected:  
         DP_SG_XBAR_API virtual bool preTraverseGroup( const dp::sg::core::Group *p );
         DP_SG_XBAR_API virtual void postTraverseGroup( const dp::sg::core::Group *p );
@@ -62,9 +79,37 @@ namespace dp
 
         DP_SG_XBAR_API virtual void handleLightSource( const dp::sg::core::LightSource * p );
 
+      private:
+        struct SubTreeInfo
+        {
+          size_t objects;       // number of ObjectTree nodes
+          size_t transforms;    // number of transforms and billboards
+          bool   serial;        // contains clip planes or unknown nodes, has to be generated by the traverser
+        };
+
+        struct Task
+        {
+          dp::sg::core::Group const * group;
+          ObjectTreeIndex             index;      // index of the group, which has been generated already
+          size_t                      begin;      // first reserved index of the children in m_taskIndices
+        };
+
+        SubTreeInfo countSubTree( dp::sg::core::Node const * node );
+        bool deferToTask( dp::sg::core::Group const * group );
+        void fillChildren( ObjectTree & objectTree, dp::sg::core::Group const * group, ObjectTreeIndex groupIndex, ObjectTreeIndex const * & indices );
+        void attachChildren( Task const & task, size_t end );
+
       private:
         SceneTreeWeakPtr       m_sceneTree;
         GeneratorStateSharedPtr m_generatorState;
+
+        dp::util::WorkerPoolSharedPtr                                   m_workerPool;
+        bool                                                            m_deferChildren;
+        size_t                                                          m_objectCount;
+        size_t                                                          m_taskSize;
+        std::unordered_map<dp::sg::core::Group const *, SubTreeInfo>    m_subTreeInfos;
+        std::vector<Task>                                               m_tasks;
+        std::vector<ObjectTreeIndex>                                    m_taskIndices;
       };
 
     } // namespace xbar
@@ -44,28 +44,6 @@ namespace dp
           return( std::shared_ptr<SwitchObserver>( new SwitchObserver() ) );
         }
 
-      public:
-        DEFINE_PTR_TYPES( SwitchObserverPayload );
-
-        class SwitchObserverPayload : public Observer<ObjectTreeIndex>::Payload
-        {
-        public:
-          static SwitchObserverPayloadSharedPtr create( ObjectTreeIndex index, unsigned int hints )
-          {
-            return( std::shared_ptr<SwitchObserverPayload>( new SwitchObserverPayload( index, hints ) ) );
-          }
-
-        public:
-          unsigned int    m_hints;
-
-        protected:
-          SwitchObserverPayload( ObjectTreeIndex index, unsigned int hints )
-            : Observer<ObjectTreeIndex>::Payload( index )
-            , m_hints( hints )
-          {
-          }
-        };
-
       public:
         ~SwitchObserver()
         {
@@ -75,10 +53,12 @@ namespace dp
 
         bool isChanged() const { return m_changed; }
 
-        void popDirtySwitches( ObjectTreeIndexSet currentSet )
+        // the returned set stays valid until the next call
+        ObjectTreeIndexSet const & popDirtySwitches()
         {
-          currentSet = m_dirtySwitches;
-          m_dirtySwitches.clear();
+          m_currentSwitches.clear();
+          m_currentSwitches.swap( m_dirtySwitches );
+          return m_currentSwitches;
         }
 
       protected:
@@ -94,6 +74,7 @@ namespace dp
       private:
         mutable bool               m_changed;
         mutable ObjectTreeIndexSet m_dirtySwitches;
+        ObjectTreeIndexSet         m_currentSwitches;
       };
 
     } // namespace xbar
@@ -40,26 +40,6 @@ namespace dp
 
       class TransformObserver : public Observer<TransformIndex>
       {
-      public:
-        DEFINE_PTR_TYPES( DirtyPayload );
-
-        class DirtyPayload : public Payload
-        {
-        public:
-          static DirtyPayloadSharedPtr create( TransformIndex index )
-          {
-            return( std::shared_ptr<DirtyPayload>( new DirtyPayload( index ) ) );
-          }
-
-        protected:
-          DirtyPayload( TransformIndex index )
-            : Payload( index )
-          {
-          }
-        };
-
-        typedef std::vector<DirtyPayload*> DirtyPayloads;
-
       public:
         virtual ~TransformObserver();
 
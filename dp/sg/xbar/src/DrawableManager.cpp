@@ -66,40 +66,50 @@ namespace dp
       void SceneTreeObserver::onNotify( dp::util::Event const & event, dp::util::Payload * payload )
       {
         SceneTree::Event const& eventObject = static_cast<SceneTree::Event const&>(event);
-        ObjectTreeNode const &node = eventObject.getNode();
-        dp::sg::core::GeoNodeSharedPtr geoNode = std::static_pointer_cast<dp::sg::core::GeoNode>(node.m_object);
+        ObjectTree const & objectTree = m_drawableManager->m_sceneTree->getObjectTree();
+        std::vector<DrawableManager::Handle> & dis = m_drawableManager->m_dis;
 
-        if ( m_drawableManager->m_dis.size() != m_drawableManager->m_sceneTree->getObjectTree().size() )
+        if ( dis.size() != objectTree.size() )
         {
-          m_drawableManager->m_dis.resize( m_drawableManager->m_sceneTree->getObjectTree().size() );
+          dis.resize( objectTree.size() );
         }
 
-        switch ( eventObject.getType() )
+        SceneTree::Event::Changes const & changes = eventObject.getChanges();
+        for ( size_t i = 0; i < changes.size(); ++i )
         {
-        case SceneTree::Event::Type::ADDED:
-          DP_ASSERT( !m_drawableManager->m_dis[eventObject.getIndex()] );
+          ObjectTreeIndex index = changes[i].index;
+          ObjectTreeNode const &node = objectTree[index];
 
-          // TODO there're two locations which execute this code, unify with as function
-          m_drawableManager->m_dis[eventObject.getIndex()] = m_drawableManager->addDrawableInstance( geoNode, eventObject.getIndex() ); // TODO, don't pass geonode?
-          m_drawableManager->setDrawableInstanceActive( m_drawableManager->m_dis[eventObject.getIndex()], node.m_worldActive );
-          m_drawableManager->m_geoNodeObserver->attach( geoNode, eventObject.getIndex() );
-          break;
-        case SceneTree::Event::Type::REMOVED:
-          DP_ASSERT( m_drawableManager->m_dis[eventObject.getIndex()] );
-          m_drawableManager->m_geoNodeObserver->detach( eventObject.getIndex() );
-          m_drawableManager->removeDrawableInstance( m_drawableManager->m_dis[eventObject.getIndex()] );
-          m_drawableManager->m_dis[eventObject.getIndex()].reset();
-          break;
-        case SceneTree::Event::Type::CHANGED:
-          DP_ASSERT(!"removed");
-        case SceneTree::Event::Type::ACTIVE_CHANGED:
-          DP_ASSERT( m_drawableManager->m_dis[eventObject.getIndex()] );
-          m_drawableManager->setDrawableInstanceActive( m_drawableManager->m_dis[eventObject.getIndex()], node.m_worldActive );
-          break;
-        case SceneTree::Event::Type::TRAVERSAL_MASK_CHANGED:
-          DP_ASSERT( m_drawableManager->m_dis[eventObject.getIndex()] );
-          m_drawableManager->setDrawableInstanceTraversalMask( m_drawableManager->m_dis[eventObject.getIndex()], node.m_worldMask );
-          break;
+          switch ( changes[i].type )
+          {
+          case SceneTree::Event::Type::ADDED:
+            {
+              DP_ASSERT( !dis[index] );
+              dp::sg::core::GeoNodeSharedPtr geoNode = std::static_pointer_cast<dp::sg::core::GeoNode>(node.m_object);
+
+              // TODO there're two locations which execute this code, unify with as function
+              dis[index] = m_drawableManager->addDrawableInstance( geoNode, index ); // TODO, don't pass geonode?
+              m_drawableManager->setDrawableInstanceActive( dis[index], node.m_worldActive );
+              m_drawableManager->m_geoNodeObserver->attach( geoNode, index );
+            }
+            break;
+          case SceneTree::Event::Type::REMOVED:
+            DP_ASSERT( dis[index] );
+            m_drawableManager->m_geoNodeObserver->detach( index );
+            m_drawableManager->removeDrawableInstance( dis[index] );
+            dis[index].reset();
+            break;
+          case SceneTree::Event::Type::CHANGED:
+            DP_ASSERT(!"removed");
+          case SceneTree::Event::Type::ACTIVE_CHANGED:
+            DP_ASSERT( dis[index] );
+            m_drawableManager->setDrawableInstanceActive( dis[index], node.m_worldActive );
+            break;
+          case SceneTree::Event::Type::TRAVERSAL_MASK_CHANGED:
+            DP_ASSERT( dis[index] );
+            m_drawableManager->setDrawableInstanceTraversalMask( dis[index], node.m_worldMask );
+            break;
+          }
         }
       }
 
@@ -246,8 +256,7 @@ namespace dp
 
       void DrawableManager::update()
       {
-        ObjectTreeIndexSet dirtyGeoNodes;
-        m_geoNodeObserver->popDirtyGeoNodes(dirtyGeoNodes);
+        ObjectTreeIndexSet const & dirtyGeoNodes = m_geoNodeObserver->popDirtyGeoNodes();
         for ( ObjectTreeIndexSet::const_iterator it = dirtyGeoNodes.begin(); it != dirtyGeoNodes.end(); ++it )
         {
           ObjectTreeIndex index = *it;
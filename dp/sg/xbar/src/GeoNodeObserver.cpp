@@ -42,7 +42,11 @@ namespace dp
         if( m_sceneTree )
         {
           DP_ASSERT( dynamic_cast<Payload*>(payload) );
-          m_dirtyGeoNodes.insert( static_cast<Payload*>(payload)->m_index );
+          std::vector<ObjectTreeIndex> const& indices = static_cast<Payload*>(payload)->m_indices;
+          for ( size_t i = 0; i < indices.size(); ++i )
+          {
+            m_dirtyGeoNodes.insert( indices[i] );
+          }
         }
       }
 
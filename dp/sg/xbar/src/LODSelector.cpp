@@ -0,0 +1,338 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include <dp/sg/xbar/inc/LODSelector.h>
+#include <algorithm>
+
+#if defined(DP_ARCH_X86_64)
+#include <emmintrin.h>
+#endif
+
+namespace dp
+{
+  namespace sg
+  {
+    namespace xbar
+    {
+
+      namespace
+      {
+        // number of LODs per task of a multithreaded select, a multiple of four
+        size_t const TaskSize = 4096;
+
+#if defined(DP_ARCH_X86_64)
+        inline __m128i blend( __m128i mask, __m128i a, __m128i b )
+        {
+          return _mm_or_si128( _mm_and_si128( mask, a ), _mm_andnot_si128( mask, b ) );
+        }
+
+        inline __m128i min32( __m128i a, __m128i b )
+        {
+          return blend( _mm_cmpgt_epi32( a, b ), b, a );
+        }
+
+        inline __m128i max32( __m128i a, __m128i b )
+        {
+          return blend( _mm_cmpgt_epi32( a, b ), a, b );
+        }
+#endif
+      }
+
+      LODSelector::LODSelector()
+        : Observer<ObjectTreeIndex>()
+        , m_count( 0 )
+        , m_hysteresis( 0.0f )
+        , m_threadCount( 1 )
+      {
+      }
+
+      LODSelector::~LODSelector()
+      {
+      }
+
+      void LODSelector::attach( dp::sg::core::LODSharedPtr const & lod, ObjectTreeIndex index, TransformIndex transform )
+      {
+        DP_ASSERT( m_slots.find( index ) == m_slots.end() );
+
+        Observer<ObjectTreeIndex>::attach( lod, index );
+
+        uint32_t slot = dp::checked_cast<uint32_t>( m_count );
+        resize( m_count + 1 );
+        m_slots[index] = slot;
+        m_index[slot] = index;
+        m_transform[slot] = transform;
+        m_lods[slot] = lod;
+        refresh( slot );
+      }
+
+      void LODSelector::onDetach( ObjectTreeIndex index )
+      {
+        TreeIndexMap<ObjectTreeIndex, uint32_t>::iterator it = m_slots.find( index );
+        DP_ASSERT( it != m_slots.end() );
+        uint32_t slot = it->second;
+        m_slots.erase( it );
+        m_dirty.erase( index );
+
+        // move the last LOD into the hole and turn its old slot into padding
+        size_t last = m_count - 1;
+        if ( slot != last )
+        {
+          m_index[slot] = m_index[last];
+          m_transform[slot] = m_transform[last];
+          m_lods[slot] = m_lods[last];
+          m_centerX[slot] = m_centerX[last];
+          m_centerY[slot] = m_centerY[last];
+          m_centerZ[slot] = m_centerZ[last];
+          for ( size_t i = 0; i < m_ranges.size(); ++i )
+          {
+            m_ranges[i][slot] = m_ranges[i][last];
+          }
+          m_levelLimit[slot] = m_levelLimit[last];
+          m_lockedLevel[slot] = m_lockedLevel[last];
+          m_level[slot] = m_level[last];
+          m_slots[m_index[slot]] = slot;
+        }
+        m_index[last] = ~0;
+        m_transform[last] = 0;
+        m_lods[last].reset();
+        m_levelLimit[last] = -1;
+        m_lockedLevel[last] = -1;
+        m_level[last] = -1;
+        resize( last );
+      }
+
+      void LODSelector::remapTransforms( std::vector<TransformIndex> const & remap )
+      {
+        for ( size_t slot = 0; slot < m_count; ++slot )
+        {
+          DP_ASSERT( remap[m_transform[slot]] != ~0 );
+          m_transform[slot] = remap[m_transform[slot]];
+        }
+      }
+
+      void LODSelector::onNotify( dp::util::Event const & event, dp::util::Payload * payload )
+      {
+        // ranges, center, range lock or children changed, refresh the LOD on the next select
+        DP_ASSERT( dynamic_cast<Payload*>(payload) );
+        std::vector<ObjectTreeIndex> const& indices = static_cast<Payload*>(payload)->m_indices;
+        for ( size_t i = 0; i < indices.size(); ++i )
+        {
+          m_dirty.insert( indices[i] );
+        }
+      }
+
+      void LODSelector::resize( size_t count )
+      {
+        m_count = count;
+        size_t padded = ( count + 3 ) & ~size_t(3);
+        m_index.resize( padded, ~0 );
+        m_transform.resize( padded, 0 );
+        m_lods.resize( padded );
+        m_centerX.resize( padded, 0.0f );
+        m_centerY.resize( padded, 0.0f );
+        m_centerZ.resize( padded, 0.0f );
+        for ( size_t i = 0; i < m_ranges.size(); ++i )
+        {
+          m_ranges[i].resize( padded, 0.0f );
+        }
+        m_levelLimit.resize( padded, -1 );
+        m_lockedLevel.resize( padded, -1 );
+        m_level.resize( padded, -1 );
+        m_newLevel.resize( padded, -1 );
+      }
+
+      void LODSelector::refresh( uint32_t slot )
+      {
+        dp::sg::core::LODSharedPtr lod = m_lods[slot].lock();
+        DP_ASSERT( lod );
+
+        dp::math::Vec3f const & center = lod->getCenter();
+        m_centerX[slot] = center[0];
+        m_centerY[slot] = center[1];
+        m_centerZ[slot] = center[2];
+
+        unsigned int rangeCount = lod->getNumberOfRanges();
+        float const * ranges = lod->getRanges();
+        if ( m_ranges.size() < rangeCount )
+        {
+          m_ranges.resize( rangeCount, std::vector<float>( m_index.size(), 0.0f ) );
+        }
+        for ( unsigned int i = 0; i < m_ranges.size(); ++i )
+        {
+          m_ranges[i][slot] = i < rangeCount ? ranges[i] : 0.0f;
+        }
+
+        // same limits as in LOD::getLODToUse
+        int32_t childCount = dp::checked_cast<int32_t>( lod->getNumberOfChildren() );
+        m_levelLimit[slot] = std::min( int32_t( rangeCount ), childCount - 1 );
+        m_lockedLevel[slot] = ( childCount && lod->isRangeLockEnabled() ) ? int32_t( std::min( lod->getRangeLock(), static_cast<unsigned int>( childCount - 1 ) ) ) : -1;
+      }
+
+      LODSelector::LevelChanges const & LODSelector::select( dp::math::Mat44f const * worldMatrices, dp::math::Mat44f const & worldToView, float rangeScale )
+      {
+        for ( ObjectTreeIndexSet::const_iterator it = m_dirty.begin(); it != m_dirty.end(); ++it )
+        {
+          TreeIndexMap<ObjectTreeIndex, uint32_t>::const_iterator itSlot = m_slots.find( *it );
+          if ( itSlot != m_slots.end() )
+          {
+            refresh( itSlot->second );
+            m_forced.push_back( itSlot->second );
+          }
+        }
+        m_dirty.clear();
+
+        size_t padded = m_index.size();
+        if ( m_workerPool && TaskSize < padded )
+        {
+          m_workerPool->execute( ( padded + TaskSize - 1 ) / TaskSize, [&]( size_t task )
+          {
+            computeLevels( task * TaskSize, std::min( padded, ( task + 1 ) * TaskSize ), worldMatrices, worldToView, rangeScale );
+          } );
+        }
+        else
+        {
+          computeLevels( 0, padded, worldMatrices, worldToView, rangeScale );
+        }
+
+        // the children of a changed LOD have to be updated even if its level stays the same
+        for ( size_t i = 0; i < m_forced.size(); ++i )
+        {
+          m_level[m_forced[i]] = -2;
+        }
+        m_forced.clear();
+
+        m_changes.clear();
+        for ( size_t slot = 0; slot < m_count; ++slot )
+        {
+          if ( m_newLevel[slot] != m_level[slot] )
+          {
+            m_level[slot] = m_newLevel[slot];
+            LevelChange change = { m_index[slot], static_cast<unsigned int>( m_newLevel[slot] ) };
+            m_changes.push_back( change );
+          }
+        }
+        return m_changes;
+      }
+
+      void LODSelector::computeLevels( size_t begin, size_t end, dp::math::Mat44f const * worldMatrices, dp::math::Mat44f const & worldToView, float rangeScale ) const
+      {
+        DP_ASSERT( begin % 4 == 0 && end % 4 == 0 );
+
+        int32_t const rangeCount = int32_t( m_ranges.size() );
+        float const scaleFine = rangeScale * ( 1.0f + m_hysteresis );
+        float const scaleCoarse = rangeScale * ( 1.0f - m_hysteresis );
+
+        for ( size_t slot = begin; slot < end; slot += 4 )
+        {
+          // squared distance of the centers in view space, the transforms are gathered one by one
+          float distance[4];
+          for ( size_t i = 0; i < 4; ++i )
+          {
+            distance[i] = 0.0f;
+            if ( slot + i < m_count )
+            {
+              dp::math::Vec4f center( m_centerX[slot + i], m_centerY[slot + i], m_centerZ[slot + i], 1.0f );
+              dp::math::Vec4f centerES = ( center * worldMatrices[m_transform[slot + i]] ) * worldToView;
+              distance[i] = centerES[0] * centerES[0] + centerES[1] * centerES[1] + centerES[2] * centerES[2];
+            }
+          }
+
+          // level = first range the center is closer than, computed for the finest and the coarsest admissible range,
+          // and for the plain range, which is used while there is no current level to keep
+#if defined(DP_ARCH_X86_64)
+          __m128 d = _mm_loadu_ps( distance );
+          __m128 sExact = _mm_set1_ps( rangeScale );
+          __m128 sFine = _mm_set1_ps( scaleFine );
+          __m128 sCoarse = _mm_set1_ps( scaleCoarse );
+          __m128i exact = _mm_set1_epi32( rangeCount );
+          __m128i fine = exact;
+          __m128i coarse = exact;
+          for ( int32_t i = rangeCount - 1; 0 <= i; --i )
+          {
+            __m128 range = _mm_loadu_ps( &m_ranges[i][slot] );
+            __m128 rangeExact = _mm_mul_ps( range, sExact );
+            __m128 rangeFine = _mm_mul_ps( range, sFine );
+            __m128 rangeCoarse = _mm_mul_ps( range, sCoarse );
+            __m128i level = _mm_set1_epi32( i );
+            exact = blend( _mm_castps_si128( _mm_cmplt_ps( d, _mm_mul_ps( rangeExact, rangeExact ) ) ), level, exact );
+            fine = blend( _mm_castps_si128( _mm_cmplt_ps( d, _mm_mul_ps( rangeFine, rangeFine ) ) ), level, fine );
+            coarse = blend( _mm_castps_si128( _mm_cmplt_ps( d, _mm_mul_ps( rangeCoarse, rangeCoarse ) ) ), level, coarse );
+          }
+          __m128i limit = _mm_loadu_si128( reinterpret_cast<__m128i const*>( &m_levelLimit[slot] ) );
+          __m128i current = _mm_loadu_si128( reinterpret_cast<__m128i const*>( &m_level[slot] ) );
+          __m128i locked = _mm_loadu_si128( reinterpret_cast<__m128i const*>( &m_lockedLevel[slot] ) );
+          exact = min32( exact, limit );
+          fine = min32( fine, limit );
+          coarse = min32( coarse, limit );
+          // keep the current level if it is admissible, without one (-1 or -2) take the exact level
+          __m128i level = max32( fine, min32( current, coarse ) );
+          level = blend( _mm_cmpgt_epi32( _mm_setzero_si128(), current ), exact, level );
+          level = blend( _mm_cmpgt_epi32( locked, _mm_set1_epi32( -1 ) ), locked, level );
+          _mm_storeu_si128( reinterpret_cast<__m128i*>( &m_newLevel[slot] ), level );
+#else
+          for ( size_t j = 0; j < 4; ++j )
+          {
+            int32_t exact = rangeCount;
+            int32_t fine = rangeCount;
+            int32_t coarse = rangeCount;
+            for ( int32_t i = rangeCount - 1; 0 <= i; --i )
+            {
+              float rangeExact = m_ranges[i][slot + j] * rangeScale;
+              float rangeFine = m_ranges[i][slot + j] * scaleFine;
+              float rangeCoarse = m_ranges[i][slot + j] * scaleCoarse;
+              exact = distance[j] < rangeExact * rangeExact ? i : exact;
+              fine = distance[j] < rangeFine * rangeFine ? i : fine;
+              coarse = distance[j] < rangeCoarse * rangeCoarse ? i : coarse;
+            }
+            exact = std::min( exact, m_levelLimit[slot + j] );
+            fine = std::min( fine, m_levelLimit[slot + j] );
+            coarse = std::min( coarse, m_levelLimit[slot + j] );
+            int32_t level = ( m_level[slot + j] < 0 ) ? exact : std::max( fine, std::min( m_level[slot + j], coarse ) );
+            m_newLevel[slot + j] = -1 < m_lockedLevel[slot + j] ? m_lockedLevel[slot + j] : level;
+          }
+#endif
+        }
+      }
+
+      void LODSelector::setHysteresis( float hysteresis )
+      {
+        DP_ASSERT( 0.0f <= hysteresis && hysteresis < 1.0f );
+        m_hysteresis = hysteresis;
+      }
+
+      void LODSelector::setThreadCount( unsigned int threadCount )
+      {
+        if ( threadCount != m_threadCount )
+        {
+          m_threadCount = threadCount;
+          m_workerPool = ( threadCount != 1 ) ? dp::util::WorkerPool::create( threadCount ) : nullptr;
+        }
+      }
+
+    } // namespace xbar
+  } // namespace sg
+} // namespace dp
@@ -39,10 +39,7 @@ namespace dp
 
       void ObjectObserver::attach( dp::sg::core::ObjectSharedPtr const& obj, ObjectTreeIndex index )
       {
-        DP_ASSERT( m_indexMap.find(index) == m_indexMap.end() );
-
-        PayloadSharedPtr payload( Payload::create( index ) );
-        Observer<ObjectTreeIndex>::attach( obj, payload );
+        Observer<ObjectTreeIndex>::attach( obj, index );
 
         // fill cache data entry with current data
         CacheData data;
@@ -79,7 +76,11 @@ namespace dp
               data.m_mask  = o->getTraversalMask();
 
               DP_ASSERT( dynamic_cast<Payload*>(payload) );
-              m_newCacheData[static_cast<Payload*>(payload)->m_index] = data;
+              std::vector<ObjectTreeIndex> const& indices = static_cast<Payload*>(payload)->m_indices;
+              for ( size_t i = 0; i < indices.size(); ++i )
+              {
+                m_newCacheData[indices[i]] = data;
+              }
             }
           }
           break;
@@ -90,22 +91,32 @@ namespace dp
             {
               dp::sg::core::Group::Event const& groupEvent = static_cast<dp::sg::core::Group::Event const&>(coreEvent);
               DP_ASSERT( dynamic_cast<Payload*>(payload) );
-              Payload* groupPayload = static_cast<Payload*>(payload);
 
-              switch ( groupEvent.getType() )
+              // handling a reference modifies the ObjectTree and might release the payload, so work on a copy of the indices
+              std::vector<ObjectTreeIndex> indices( static_cast<Payload*>(payload)->m_indices );
+              for ( size_t i = 0; i < indices.size(); ++i )
               {
-              case dp::sg::core::Group::Event::Type::POST_CHILD_ADD:
-                onPostAddChild( groupEvent.getGroup(), groupEvent.getChild(), groupEvent.getIndex(), groupPayload );
-                break;
-              case dp::sg::core::Group::Event::Type::PRE_CHILD_REMOVE:
-                onPreRemoveChild( groupEvent.getGroup(), groupEvent.getChild(), groupEvent.getIndex(), groupPayload );
-                break;
-              case dp::sg::core::Group::Event::Type::POST_GROUP_EXCHANGED:
-                m_sceneTree->replaceSubTree( groupEvent.getGroup(), groupPayload->m_index );
-                break;
-              case dp::sg::core::Group::Event::Type::CLIP_PLANES_CHANGED:
-                DP_ASSERT( !"clipplanes not supported" );
-                break;
+                // skip the references removed while handling an earlier one
+                if ( !isAttached( indices[i] ) )
+                {
+                  continue;
+                }
+
+                switch ( groupEvent.getType() )
+                {
+                case dp::sg::core::Group::Event::Type::POST_CHILD_ADD:
+                  onPostAddChild( groupEvent.getGroup(), groupEvent.getChild(), groupEvent.getIndex(), indices[i] );
+                  break;
+                case dp::sg::core::Group::Event::Type::PRE_CHILD_REMOVE:
+                  onPreRemoveChild( groupEvent.getGroup(), groupEvent.getChild(), groupEvent.getIndex(), indices[i] );
+                  break;
+                case dp::sg::core::Group::Event::Type::POST_GROUP_EXCHANGED:
+                  m_sceneTree->replaceSubTree( groupEvent.getGroup(), indices[i] );
+                  break;
+                case dp::sg::core::Group::Event::Type::CLIP_PLANES_CHANGED:
+                  DP_ASSERT( !"clipplanes not supported" );
+                  break;
+                }
               }
             }
           }
@@ -113,9 +124,13 @@ namespace dp
         }
       }
 
-      void ObjectObserver::onPreRemoveChild( dp::sg::core::GroupSharedPtr const& group, dp::sg::core::NodeSharedPtr const & child, unsigned int index, Payload * payload )
+      void ObjectObserver::onPreRemoveChild( dp::sg::core::GroupSharedPtr const& group, dp::sg::core::NodeSharedPtr const & child, unsigned int index, ObjectTreeIndex objectIndex )
       {
-        ObjectTreeIndex objectIndex = payload->m_index;
+        // the children of a streamed group are generated from the group later on
+        if ( m_sceneTree->isPendingSubTree( objectIndex ) )
+        {
+          return;
+        }
 
         // determine the index of child in the ObjectTree3
         ObjectTree& tree = m_sceneTree->getObjectTree();
@@ -164,9 +179,13 @@ namespace dp
         }
       }
 
-      void ObjectObserver::onPostAddChild( dp::sg::core::GroupSharedPtr const& group, dp::sg::core::NodeSharedPtr const & child, unsigned int index, Payload * payload )
+      void ObjectObserver::onPostAddChild( dp::sg::core::GroupSharedPtr const& group, dp::sg::core::NodeSharedPtr const & child, unsigned int index, ObjectTreeIndex objectIndex )
       {
-        ObjectTreeIndex objectIndex = payload->m_index;
+        // the children of a streamed group are generated from the group later on
+        if ( m_sceneTree->isPendingSubTree( objectIndex ) )
+        {
+          return;
+        }
 
         // find the left sibling and the left transform of our new child
         ObjectTree& tree = m_sceneTree->getObjectTree();
@@ -27,6 +27,7 @@
 #include <dp/sg/xbar/DrawableManager.h>
 #include <dp/sg/xbar/SceneTree.h>
 #include <dp/sg/xbar/inc/UpdateObjectVisitor.h>
+#include <dp/sg/xbar/inc/LODSelector.h>
 #include <dp/sg/xbar/inc/SceneTreeGenerator.h>
 
 // observers
@@ -56,6 +57,8 @@
 #include <dp/util/BitArray.h>
 
 #include <algorithm>
+#include <chrono>
+#include <unordered_set>
 
 using namespace dp::math;
 using namespace dp::util;
@@ -71,27 +74,52 @@ namespace dp
     namespace xbar
     {
 
+      namespace
+      {
+        uint64_t nanosecondsSince( std::chrono::steady_clock::time_point start )
+        {
+          return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+        }
+
+        // the key strings are only built if someone looks at the profile
+        void addProfileEntry( char const* key, uint64_t nanoseconds )
+        {
+          dp::util::FrameProfiler & profiler = dp::util::FrameProfiler::instance();
+          if ( profiler.isEnabled() )
+          {
+            profiler.addEntry( key, 1e-9 * nanoseconds );
+          }
+        }
+      }
+
       SceneTree::SceneTree( dp::sg::core::SceneSharedPtr const & scene )
         : m_scene( scene )
         , m_rootNode( scene->getRootNode() )
         , m_dirty( false )
         , m_switchObserver( SwitchObserver::create() )
+        , m_lodSelector( LODSelector::create() )
+        , m_streamingBudget( 0 )
+        , m_transformTreeObserver( *this )
+        , m_updateStatistics()
       {
+        m_transformTree.getTree().attach( &m_transformTreeObserver );
       }
 
       SceneTree::~SceneTree()
       {
+        m_transformTree.getTree().detach( &m_transformTreeObserver );
         m_sceneObserver.reset();
       }
 
-      SceneTreeSharedPtr SceneTree::create( SceneSharedPtr const & scene )
+      SceneTreeSharedPtr SceneTree::create( SceneSharedPtr const & scene, unsigned int generatorThreadCount, size_t streamingBudget )
       {
         SceneTreeSharedPtr st = std::shared_ptr<SceneTree>( new SceneTree( scene ) );
-        st->init();
+        st->m_streamingBudget = streamingBudget;
+        st->init( generatorThreadCount );
         return( st );
       }
 
-      void SceneTree::init()
+      void SceneTree::init( unsigned int generatorThreadCount )
       {
         m_objectObserver = ObjectObserver::create( shared_from_this() );
         m_sceneObserver = SceneObserver::create( shared_from_this() );
@@ -104,11 +132,24 @@ namespace dp
         m_objectTreeSentinel = m_objectTree.insertNode( objectTreeSentinel, ~0, ~0 );
 
         SceneTreeGenerator rlg( this->shared_from_this() );
+        if ( m_streamingBudget )
+        {
+          rlg.setDeferChildren( true );
+        }
+        else if ( generatorThreadCount != 1 )
+        {
+          rlg.setWorkerPool( WorkerPool::create( generatorThreadCount ) );
+        }
         rlg.setCurrentObjectTreeData( m_objectTreeSentinel, ~0 );
         rlg.apply( m_scene );
 
         // root node is first child below sentinel
         m_objectTreeRootNode = m_objectTree[m_objectTreeSentinel].m_firstChild;
+
+        generatePendingSubTrees();
+
+        // observers attached later on pick up the initial nodes on their own
+        m_changes.clear();
       }
 
       dp::sg::core::SceneSharedPtr const & SceneTree::getScene() const
@@ -122,6 +163,8 @@ namespace dp
 
         rlg.setCurrentObjectTreeData( parentIndex, leftSibling );
         rlg.apply( root );
+
+        notifyChanges();
       }
 
       void SceneTree::replaceSubTree( NodeSharedPtr const& node, ObjectTreeIndex objectIndex )
@@ -152,21 +195,36 @@ namespace dp
 
       void SceneTree::update(dp::sg::core::CameraSharedPtr const& camera, float lodScaleRange)
       {
+        m_updateStatistics = UpdateStatistics();
+
+        // continue a streaming generation, the new drawables are announced with the other changes of this update
+        if ( !m_pendingSubTrees.empty() )
+        {
+          std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+          generatePendingSubTrees();
+          m_updateStatistics.generateTime = nanosecondsSince( start );
+          addProfileEntry( "Generate pending subtrees", m_updateStatistics.generateTime );
+        }
+
         // for now it is important to update the transform tree first to clear the DIRTY_TRANSFORM bit
         {
-          dp::util::ProfileEntry p("Update TransformTree");
+          std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
           updateTransformTree(camera);
+          m_updateStatistics.transformTreeTime = nanosecondsSince( start );
+          addProfileEntry( "Update TransformTree", m_updateStatistics.transformTreeTime );
         }
 
         {
-          dp::util::ProfileEntry p("Update ObjectTree");
+          std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
           updateObjectTree(camera, lodScaleRange);
+          m_updateStatistics.objectTreeTime = nanosecondsSince( start );
+          addProfileEntry( "Update ObjectTree", m_updateStatistics.objectTreeTime );
         }
       }
 
       void SceneTree::updateTransformTree(dp::sg::core::CameraSharedPtr const& camera)
       {
-        m_transformTree.compute(camera);
+        m_updateStatistics.dirtyTransforms = m_transformTree.compute(camera);
       }
 
       void SceneTree::updateObjectTree(dp::sg::core::CameraSharedPtr const& camera, float lodRangeScale)
@@ -177,8 +235,8 @@ namespace dp
 
         // update dirty object hints & masks
         {
-          ObjectObserver::NewCacheData cd;
-          m_objectObserver->popNewCacheData( cd );
+          ObjectObserver::NewCacheData const & cd = m_objectObserver->popNewCacheData();
+          m_updateStatistics.changedObjects = cd.size();
 
           ObjectObserver::NewCacheData::const_iterator it, it_end = cd.end();
           for( it=cd.begin(); it!=it_end; ++it )
@@ -192,11 +250,11 @@ namespace dp
         }
 
         // update dirty switch information
-        ObjectTreeIndexSet dirtySwitches;
-        m_switchObserver->popDirtySwitches( dirtySwitches );
+        ObjectTreeIndexSet const & dirtySwitches = m_switchObserver->popDirtySwitches();
+        m_updateStatistics.changedSwitches = dirtySwitches.size();
         if( !dirtySwitches.empty() )
         {
-          ObjectTreeIndexSet::iterator it, it_end = dirtySwitches.end();
+          ObjectTreeIndexSet::const_iterator it, it_end = dirtySwitches.end();
           for( it=dirtySwitches.begin(); it!=it_end; ++it )
           {
             ObjectTreeIndex index = *it;
@@ -229,28 +287,21 @@ namespace dp
         // update all lods
         if( !m_objectTree.m_LODs.empty() )
         {
-          const Mat44f& worldToView = camera->getWorldToViewMatrix();
-
-          std::map< ObjectTreeIndex, LODWeakPtr >::iterator it, it_end = m_objectTree.m_LODs.end();
-          for( it = m_objectTree.m_LODs.begin(); it != it_end; ++it )
+          LODSelector::LevelChanges const & levelChanges = m_lodSelector->select( m_transformTree.getTree().getWorldMatrices(), camera->getWorldToViewMatrix(), lodRangeScale );
+          m_updateStatistics.evaluatedLODs = m_objectTree.m_LODs.size();
+          m_updateStatistics.changedLODs = levelChanges.size();
+          for ( LODSelector::LevelChanges::const_iterator it = levelChanges.begin(); it != levelChanges.end(); ++it )
           {
-            ObjectTreeIndex index = it->first;
-            const ObjectTreeNode& node = m_objectTree[ index ];
-
-            Mat44f const & modelToWorld = m_transformTree.getTree().getWorldMatrix(node.m_transform);
-            const Mat44f modelToView = modelToWorld * worldToView;
-            ObjectTreeIndex activeIndex = it->second.lock()->getLODToUse( modelToView, lodRangeScale );
-
-            ObjectTreeIndex childIndex = m_objectTree[index].m_firstChild;
+            ObjectTreeIndex childIndex = m_objectTree[it->index].m_firstChild;
             // counter for the i-th child
             size_t i = 0;
 
             while( childIndex != ~0 )
             {
               ObjectTreeNode& childNode = m_objectTree[childIndex];
-              DP_ASSERT( childNode.m_parentIndex == index );
+              DP_ASSERT( childNode.m_parentIndex == it->index );
 
-              bool newActive = activeIndex == i;
+              bool newActive = it->level == i;
               if ( childNode.m_localActive != newActive )
               {
                 childNode.m_localActive = newActive;
@@ -267,43 +318,84 @@ namespace dp
         // second step: update resulting node-world information
         //
 
+        m_updateStatistics.dirtyObjects = m_objectTree.m_dirtyObjects.size();
         UpdateObjectVisitor objectVisitor( m_objectTree, this );
         PreOrderTreeTraverser<ObjectTree, UpdateObjectVisitor> objectTraverser;
 
         objectTraverser.processDirtyList( m_objectTree, objectVisitor, ObjectTreeNode::DEFAULT_DIRTY );
         m_objectTree.m_dirtyObjects.clear();
+
+        m_updateStatistics.emittedChanges = m_changes.size();
+        notifyChanges();
       }
 
       ObjectTreeIndex SceneTree::addObject( const ObjectTreeNode & node, ObjectTreeIndex parentIndex, ObjectTreeIndex siblingIndex )
       {
         // add object to object tree
         ObjectTreeIndex index = m_objectTree.insertNode( node, parentIndex, siblingIndex );
+        attachObject( index );
 
-        // observe object
-        m_objectObserver->attach( node.m_object, index );
+        return index;
+      }
 
-        ObjectTreeNode const & parentNode = m_objectTree[parentIndex];
+      void SceneTree::attachObject( ObjectTreeIndex index )
+      {
         ObjectTreeNode & newNode = m_objectTree[index];
-        if (std::dynamic_pointer_cast<dp::sg::core::Transform>(node.m_object))
+
+        // observe object
+        m_objectObserver->attach( newNode.m_object, index );
+
+        ObjectTreeNode const & parentNode = m_objectTree[newNode.m_parentIndex];
+        if (std::dynamic_pointer_cast<dp::sg::core::Transform>(newNode.m_object))
         {
           newNode.m_transformParent = parentNode.m_transform;
-          newNode.m_transform = m_transformTree.addTransform(parentNode.m_transform, std::static_pointer_cast<dp::sg::core::Transform>(node.m_object));
+          newNode.m_transform = m_transformTree.addTransform(parentNode.m_transform, std::static_pointer_cast<dp::sg::core::Transform>(newNode.m_object));
           newNode.m_isTransform = true;
         }
-        else if(std::dynamic_pointer_cast<dp::sg::core::Billboard>(node.m_object))
+        else if(std::dynamic_pointer_cast<dp::sg::core::Billboard>(newNode.m_object))
         {
           newNode.m_transformParent = parentNode.m_transform;
-          newNode.m_transform = m_transformTree.addBillboard(parentNode.m_transform, std::static_pointer_cast<dp::sg::core::Billboard>(node.m_object));
+          newNode.m_transform = m_transformTree.addBillboard(parentNode.m_transform, std::static_pointer_cast<dp::sg::core::Billboard>(newNode.m_object));
           newNode.m_isBillboard = true;
         }
+      }
 
-        return index;
+      void SceneTree::deferSubTree( ObjectTreeIndex index, GroupSharedPtr const & group )
+      {
+        DP_ASSERT( m_streamingBudget && !isPendingSubTree( index ) );
+        m_pendingSubTrees[index] = group;
+        m_pendingQueue.push_back( index );
+      }
+
+      void SceneTree::generatePendingSubTrees()
+      {
+        SceneTreeGenerator rlg( this->shared_from_this() );
+        rlg.setDeferChildren( true );
+
+        // the children of a group are generated at once, so the budget might be exceeded by a single wide group
+        while ( !m_pendingQueue.empty() && rlg.getObjectCount() < m_streamingBudget )
+        {
+          ObjectTreeIndex index = m_pendingQueue.front();
+          m_pendingQueue.pop_front();
+
+          // the group might have been removed or replaced in the meantime
+          TreeIndexMap<ObjectTreeIndex, GroupWeakPtr>::iterator it = m_pendingSubTrees.find( index );
+          if ( it != m_pendingSubTrees.end() )
+          {
+            GroupSharedPtr group = it->second.lock();
+            m_pendingSubTrees.erase( it );
+            DP_ASSERT( group && group == m_objectTree[index].m_object );
+            rlg.generateChildren( group, index );
+          }
+        }
+        m_updateStatistics.generatedObjects = rlg.getObjectCount();
       }
 
       void SceneTree::addLOD( LODSharedPtr const& lod, ObjectTreeIndex index )
       {
         DP_ASSERT( m_objectTree.m_LODs.find(index) == m_objectTree.m_LODs.end() );
         m_objectTree.m_LODs[index] = lod;
+        m_lodSelector->attach( lod, index, m_objectTree[index].m_transform );
       }
 
       void SceneTree::addSwitch( const SwitchSharedPtr& s, ObjectTreeIndex index )
@@ -319,7 +411,7 @@ namespace dp
       {
         // attach observer
         m_objectTree[index].m_isDrawable = true;
-        notify( Event( index, m_objectTree[index], Event::Type::ADDED ) );
+        addChange( index, Event::Type::ADDED );
       }
 
       void SceneTree::addLightSource( ObjectTreeIndex index )
@@ -354,26 +446,32 @@ namespace dp
 
           if ( m_objectTree[currentIndex].m_isDrawable )
           {
-            notify( Event( currentIndex, m_objectTree[currentIndex], Event::Type::REMOVED) );
+            addChange( currentIndex, Event::Type::REMOVED );
             m_objectTree[index].m_isDrawable = false;
           }
 
           current.m_clipPlaneGroup.reset();
 
+          if ( !m_pendingSubTrees.empty() )
+          {
+            m_pendingSubTrees.erase( currentIndex );
+          }
+
           // detach current index from object observer
           m_objectObserver->detach( currentIndex );
 
           // TODO: add observer flag to specify which observers must be detached?
-          std::map< ObjectTreeIndex, SwitchWeakPtr >::iterator itSwitch = m_objectTree.m_switchNodes.find( currentIndex );
+          ObjectTree::SwitchMap::iterator itSwitch = m_objectTree.m_switchNodes.find( currentIndex );
           if ( itSwitch != m_objectTree.m_switchNodes.end() )
           {
             m_switchObserver->detach( currentIndex );
             m_objectTree.m_switchNodes.erase( itSwitch );
           }
 
-          std::map< ObjectTreeIndex, LODWeakPtr >::iterator itLod = m_objectTree.m_LODs.find( currentIndex );
+          ObjectTree::LODMap::iterator itLod = m_objectTree.m_LODs.find( currentIndex );
           if ( itLod != m_objectTree.m_LODs.end() )
           {
+            m_lodSelector->detach( currentIndex );
             m_objectTree.m_LODs.erase( itLod );
           }
 
@@ -403,10 +501,73 @@ namespace dp
           }
         }
 
+        // the observers might still access the removed nodes
+        notifyChanges();
+
         // delete the node and its children from the object tree
         m_objectTree.deleteNode( index );
       }
 
+      void SceneTree::notifyChanges()
+      {
+        if ( !m_changes.empty() )
+        {
+          notify( Event( m_changes ) );
+          m_changes.clear();
+        }
+      }
+
+      void SceneTree::remapTransforms( std::vector<TransformIndex> const & remap )
+      {
+        m_transformTree.remapTransforms( remap );
+        m_lodSelector->remapTransforms( remap );
+
+        // clip plane instances may be shared by several nodes
+        std::vector<ObjectTreeIndex> stack( 1, m_objectTreeSentinel );
+        std::unordered_set<ClipPlaneInstance *> clipPlanes;
+        while ( !stack.empty() )
+        {
+          ObjectTreeNode & node = m_objectTree[stack.back()];
+          stack.pop_back();
+
+          DP_ASSERT( remap[node.m_transform] != dp::transform::InvalidIndex );
+          node.m_transform = remap[node.m_transform];
+          if ( node.m_transformParent != ~0 )
+          {
+            node.m_transformParent = remap[node.m_transformParent];
+          }
+
+          if ( node.m_clipPlaneGroup )
+          {
+            std::vector<ClipPlaneInstanceSharedPtr> const & instances = node.m_clipPlaneGroup->getVector();
+            for ( size_t i = 0; i < instances.size(); ++i )
+            {
+              if ( clipPlanes.insert( instances[i].get() ).second && instances[i]->m_transformIndex != ~0 )
+              {
+                instances[i]->m_transformIndex = remap[instances[i]->m_transformIndex];
+              }
+            }
+          }
+
+          for ( ObjectTreeIndex child = node.m_firstChild; child != ~0; child = m_objectTree[child].m_nextSibling )
+          {
+            stack.push_back( child );
+          }
+        }
+      }
+
+      void SceneTree::TransformTreeObserver::onNotify( dp::util::Event const & event, dp::util::Payload * payload )
+      {
+        if ( static_cast<dp::transform::Tree::Event const &>(event).getType() == dp::transform::Tree::Event::Type::TRANSFORMS_REMAPPED )
+        {
+          m_sceneTree.remapTransforms( static_cast<dp::transform::Tree::EventTransformsRemapped const &>(event).getRemap() );
+        }
+      }
+
+      void SceneTree::TransformTreeObserver::onDestroyed( dp::util::Subject const & subject, dp::util::Payload * payload )
+      {
+      }
+
       ObjectTree& SceneTree::getObjectTree()
       {
         return m_objectTree;
@@ -417,6 +578,26 @@ namespace dp
         return m_objectTree[index];
       }
 
+      void SceneTree::setLODHysteresis( float hysteresis )
+      {
+        m_lodSelector->setHysteresis( hysteresis );
+      }
+
+      float SceneTree::getLODHysteresis() const
+      {
+        return m_lodSelector->getHysteresis();
+      }
+
+      void SceneTree::setLODThreadCount( unsigned int threadCount )
+      {
+        m_lodSelector->setThreadCount( threadCount );
+      }
+
+      unsigned int SceneTree::getLODThreadCount() const
+      {
+        return m_lodSelector->getThreadCount();
+      }
+
       void SceneTree::onRootNodeChanged()
       {
         replaceSubTree( m_scene->getRootNode(), m_objectTreeRootNode );
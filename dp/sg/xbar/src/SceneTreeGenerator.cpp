@@ -25,6 +25,7 @@
 
 
 #include <dp/sg/xbar/inc/SceneTreeGenerator.h>
+#include <dp/sg/xbar/inc/ObjectObserver.h>
 
 #include <dp/sg/core/Billboard.h>
 #include <dp/sg/core/ClipPlane.h>
@@ -35,6 +36,8 @@
 #include <dp/sg/core/Switch.h>
 #include <dp/sg/core/Transform.h>
 
+#include <algorithm>
+
 using namespace dp::sg::core;
 
 using std::vector;
@@ -46,8 +49,17 @@ namespace dp
     namespace xbar
     {
 
+      namespace
+      {
+        // smallest number of ObjectTree nodes filled by one task of a parallel generation
+        size_t const MinimumTaskSize = 1024;
+      }
+
       SceneTreeGenerator::SceneTreeGenerator( SceneTreeSharedPtr const& sceneTree )
         : m_sceneTree( sceneTree )
+        , m_deferChildren( false )
+        , m_objectCount( 0 )
+        , m_taskSize( 0 )
       {
         setTraversalMaskOverride( ~0 );
 
@@ -56,7 +68,203 @@ namespace dp
 
       void SceneTreeGenerator::doApply( const dp::sg::core::NodeSharedPtr & root )
       {
+        // a streaming generation stops below the first group
+        if ( m_deferChildren )
+        {
+          SharedTraverser::doApply( root );
+          return;
+        }
+
+        // grow the ObjectTree and the TransformTree once for the whole subtree
+        SceneTreeSharedPtr sceneTree = m_sceneTree.lock();
+        SubTreeInfo info = countSubTree( root.get() );
+        sceneTree->m_objectTree.reserve( info.objects );
+        sceneTree->m_transformTree.reserve( info.transforms );
+        sceneTree->m_objectObserver->reserve( info.objects );
+
+        // the traverser generates the top of the scene and leaves subtrees of at most m_taskSize nodes to the tasks
+        if ( m_workerPool )
+        {
+          m_taskSize = std::max( MinimumTaskSize, info.objects / ( 8 * m_workerPool->getThreadCount() ) );
+        }
+
         SharedTraverser::doApply( root );
+
+        if ( !m_tasks.empty() )
+        {
+          // reserve the indices of the children of each task in pre-order, the tree does not grow anymore after reserve
+          ObjectTree & objectTree = sceneTree->m_objectTree;
+          for ( size_t i = 0; i < m_tasks.size(); ++i )
+          {
+            m_tasks[i].begin = m_taskIndices.size();
+            for ( size_t j = 1; j < m_subTreeInfos[m_tasks[i].group].objects; ++j )
+            {
+              m_taskIndices.push_back( objectTree.getFreeNode() );
+            }
+          }
+
+          m_workerPool->execute( m_tasks.size(), [&]( size_t i )
+          {
+            ObjectTreeIndex const * indices = &m_taskIndices[m_tasks[i].begin];
+            fillChildren( objectTree, m_tasks[i].group, m_tasks[i].index, indices );
+          } );
+
+          // observers and transforms are not thread safe
+          for ( size_t i = 0; i < m_tasks.size(); ++i )
+          {
+            attachChildren( m_tasks[i], i + 1 < m_tasks.size() ? m_tasks[i + 1].begin : m_taskIndices.size() );
+          }
+          m_objectCount += m_taskIndices.size();
+
+          m_tasks.clear();
+          m_taskIndices.clear();
+        }
+      }
+
+      void SceneTreeGenerator::setWorkerPool( dp::util::WorkerPoolSharedPtr const & workerPool )
+      {
+        m_workerPool = workerPool;
+      }
+
+      void SceneTreeGenerator::setDeferChildren( bool deferChildren )
+      {
+        m_deferChildren = deferChildren;
+      }
+
+      void SceneTreeGenerator::generateChildren( GroupSharedPtr const & group, ObjectTreeIndex index )
+      {
+        m_generatorState->setCurrentObjectTreeData( index, ~0 );
+        for ( Group::ChildrenIterator gci = group->beginChildren(); gci != group->endChildren(); ++gci )
+        {
+          traverseObject( *gci );
+        }
+        m_generatorState->popObject();
+        m_generatorState->popClipPlaneSet();
+      }
+
+      SceneTreeGenerator::SubTreeInfo SceneTreeGenerator::countSubTree( Node const * node )
+      {
+        switch ( node->getObjectCode() )
+        {
+        case ObjectCode::GEO_NODE:
+        case ObjectCode::LIGHT_SOURCE:
+          {
+            SubTreeInfo info = { 1, 0, false };
+            return info;
+          }
+        case ObjectCode::GROUP:
+        case ObjectCode::LOD:
+        case ObjectCode::SWITCH:
+        case ObjectCode::TRANSFORM:
+        case ObjectCode::BILLBOARD:
+          {
+            // instanced groups are counted once
+            Group const * group = static_cast<Group const *>( node );
+            std::unordered_map<Group const *, SubTreeInfo>::const_iterator it = m_subTreeInfos.find( group );
+            if ( it == m_subTreeInfos.end() )
+            {
+              bool isTransform = ( node->getObjectCode() == ObjectCode::TRANSFORM ) || ( node->getObjectCode() == ObjectCode::BILLBOARD );
+              SubTreeInfo info = { 1, isTransform ? 1u : 0u, group->getNumberOfClipPlanes() != 0 };
+              for ( Group::ChildrenConstIterator gcci = group->beginChildren(); gcci != group->endChildren(); ++gcci )
+              {
+                SubTreeInfo childInfo = countSubTree( gcci->get() );
+                info.objects += childInfo.objects;
+                info.transforms += childInfo.transforms;
+                info.serial |= childInfo.serial;
+              }
+              it = m_subTreeInfos.insert( std::make_pair( group, info ) ).first;
+            }
+            return it->second;
+          }
+        default:
+          {
+            SubTreeInfo info = { 0, 0, true };
+            return info;
+          }
+        }
+      }
+
+      bool SceneTreeGenerator::deferToTask( Group const * group )
+      {
+        if ( m_workerPool && group->getNumberOfChildren() )
+        {
+          SubTreeInfo info = countSubTree( group );
+          if ( !info.serial && info.objects <= m_taskSize )
+          {
+            Task task = { group, m_generatorState->getParentObjectIndex(), 0 };
+            m_tasks.push_back( task );
+            return true;
+          }
+        }
+        return false;
+      }
+
+      void SceneTreeGenerator::fillChildren( ObjectTree & objectTree, Group const * group, ObjectTreeIndex groupIndex, ObjectTreeIndex const * & indices )
+      {
+        ObjectTreeIndex previousIndex = ~0;
+        for ( Group::ChildrenConstIterator gcci = group->beginChildren(); gcci != group->endChildren(); ++gcci )
+        {
+          ObjectTreeIndex index = *indices++;
+
+          // the same node GeneratorState::insertNode creates, the transforms are set up by attachChildren
+          ObjectTreeNode node;
+          node.m_object         = *gcci;
+          node.m_clipPlaneGroup = objectTree[groupIndex].m_clipPlaneGroup;
+          node.m_parentIndex    = groupIndex;
+          objectTree[index] = node;
+
+          if ( previousIndex == ~0 )
+          {
+            objectTree[groupIndex].m_firstChild = index;
+          }
+          else
+          {
+            objectTree[previousIndex].m_nextSibling = index;
+          }
+          previousIndex = index;
+
+          ObjectCode objectCode = (*gcci)->getObjectCode();
+          if ( ( objectCode != ObjectCode::GEO_NODE ) && ( objectCode != ObjectCode::LIGHT_SOURCE ) )
+          {
+            fillChildren( objectTree, static_cast<Group const *>( gcci->get() ), index, indices );
+          }
+        }
+      }
+
+      void SceneTreeGenerator::attachChildren( Task const & task, size_t end )
+      {
+        SceneTreeSharedPtr sceneTree = m_sceneTree.lock();
+        ObjectTree & objectTree = sceneTree->m_objectTree;
+
+        // the indices are in pre-order, so each parent is attached before its children
+        for ( size_t i = task.begin; i < end; ++i )
+        {
+          ObjectTreeIndex index = m_taskIndices[i];
+          ObjectTreeNode & node = objectTree[index];
+          ObjectTreeNode const & parentNode = objectTree[node.m_parentIndex];
+          node.m_transform = parentNode.m_transform;
+          node.m_transformParent = parentNode.m_transformParent;
+          objectTree.markDirty( index, ~0 );
+
+          sceneTree->attachObject( index );
+          switch ( node.m_object->getObjectCode() )
+          {
+          case ObjectCode::LOD:
+            sceneTree->addLOD( std::static_pointer_cast<LOD>( node.m_object ), index );
+            break;
+          case ObjectCode::SWITCH:
+            sceneTree->addSwitch( std::static_pointer_cast<Switch>( node.m_object ), index );
+            break;
+          case ObjectCode::GEO_NODE:
+            sceneTree->addGeoNode( index );
+            break;
+          case ObjectCode::LIGHT_SOURCE:
+            sceneTree->addLightSource( index );
+            break;
+          default:
+            break;
+          }
+        }
       }
 
       void SceneTreeGenerator::setCurrentObjectTreeData( ObjectTreeIndex parentIndex, ObjectTreeIndex siblingIndex )
@@ -78,6 +286,7 @@ namespace dp
 
         if( ok )
         {
+          ++m_objectCount;
           switch ( p->getObjectCode() )
           {
           case ObjectCode::LOD:
@@ -105,6 +314,25 @@ namespace dp
             }
           }
 
+          // a streaming generation leaves the children of plain groups to a later frame,
+          // a parallel generation leaves small subtrees to the worker tasks
+          ObjectCode objectCode = p->getObjectCode();
+          if ( m_deferChildren && p->getNumberOfChildren()
+            && ( ( objectCode == ObjectCode::GROUP ) || ( objectCode == ObjectCode::TRANSFORM ) || ( objectCode == ObjectCode::BILLBOARD ) ) )
+          {
+            m_sceneTree.lock()->deferSubTree( m_generatorState->getParentObjectIndex(), p->getSharedPtr<Group>() );
+            if ( p->getNumberOfClipPlanes() )
+            {
+              m_generatorState->popClipPlaneSet();
+            }
+            m_generatorState->popObject();
+            ok = false;
+          }
+          else if ( deferToTask( p ) )
+          {
+            m_generatorState->popObject();
+            ok = false;
+          }
         }
 
         return ok;
@@ -154,6 +382,7 @@ namespace dp
       void SceneTreeGenerator::handleGeoNode( const dp::sg::core::GeoNode *p )
       {
         m_generatorState->addGeoNode( p->getSharedPtr<GeoNode>() );
+        ++m_objectCount;
 
         // stop traversal here, we only need the geonode position
       }
@@ -161,6 +390,7 @@ namespace dp
       void SceneTreeGenerator::handleLightSource( const LightSource * p )
       {
         m_generatorState->addLightSource( p->getSharedPtr<LightSource>() );
+        ++m_objectCount;
 
         // stop traversal here, we only need the light source position
       }
@@ -36,10 +36,7 @@ namespace dp
 
       void SwitchObserver::attach( dp::sg::core::SwitchSharedPtr const & s, ObjectTreeIndex index )
       {
-        DP_ASSERT( m_indexMap.find( index ) == m_indexMap.end() );
-
-        SwitchObserverPayloadSharedPtr payload = SwitchObserverPayload::create( index, s->getHints() );
-        Observer<ObjectTreeIndex>::attach( s, payload );
+        Observer<ObjectTreeIndex>::attach( s, index );
 
         if( s->getHints(dp::sg::core::Object::DP_SG_HINT_DYNAMIC) )
         {
@@ -67,7 +64,12 @@ namespace dp
 
             if( propertyEvent.getPropertyId() == dp::sg::core::Switch::PID_ActiveSwitchMask )
             {
-                m_dirtySwitches.insert( static_cast<SwitchObserverPayload*>(payload)->m_index );
+              DP_ASSERT( dynamic_cast<Payload*>(payload) );
+              std::vector<ObjectTreeIndex> const& indices = static_cast<Payload*>(payload)->m_indices;
+              for ( size_t i = 0; i < indices.size(); ++i )
+              {
+                m_dirtySwitches.insert( indices[i] );
+              }
             }
           }
           break;
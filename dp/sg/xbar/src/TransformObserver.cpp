@@ -39,10 +39,7 @@ namespace dp
 
       void TransformObserver::attach( dp::sg::core::TransformSharedPtr const & t, ObjectTreeIndex index )
       {
-        DP_ASSERT( m_indexMap.find( index ) == m_indexMap.end() );
-
-        DirtyPayloadSharedPtr payload( DirtyPayload::create( index ) );
-        Observer<ObjectTreeIndex>::attach( t, payload );
+        Observer<TransformIndex>::attach( t, index );
       }
 
       void TransformObserver::onNotify( const dp::util::Event &event, dp::util::Payload *payload )
@@ -55,8 +52,12 @@ namespace dp
 
             if( propertyEvent.getPropertyId() == dp::sg::core::Transform::PID_Matrix )
             {
-              DirtyPayload* p = static_cast< DirtyPayload* >(payload);
-              m_dirtyTransforms.enableBit(p->m_index);
+              DP_ASSERT( dynamic_cast<Payload*>(payload) );
+              std::vector<TransformIndex> const& indices = static_cast<Payload*>(payload)->m_indices;
+              for ( size_t i = 0; i < indices.size(); ++i )
+              {
+                m_dirtyTransforms.enableBit( indices[i] );
+              }
             }
           }
           break;
@@ -63,6 +63,7 @@ namespace dp
         m_tree.removeTransform(transformIndex);
         m_transformObserver->detach(transformIndex);
         m_objects[transformIndex].reset();
+        m_dirtyTransforms.disableBit(transformIndex);
       }
 
       TransformIndex TransformTree::addBillboard(TransformIndex parentIndex, dp::sg::core::BillboardSharedPtr const & billboard)
@@ -80,6 +81,13 @@ namespace dp
         m_objects[billboardIndex].reset();
       }
 
+      void TransformTree::reserve(size_t count)
+      {
+        m_tree.reserve(count);
+        m_transformObserver->reserve(count);
+        resizeDataStructures(m_tree.getTransformCount());
+      }
+
       void TransformTree::resizeDataStructures(size_t newSize)
       {
         if (newSize != m_objects.size())
@@ -89,14 +97,49 @@ namespace dp
         }
       }
 
-      void TransformTree::compute(dp::sg::core::CameraSharedPtr const & camera)
+      size_t TransformTree::compute(dp::sg::core::CameraSharedPtr const & camera)
       {
+        size_t dirtyCount = 0;
         m_dirtyTransforms.traverseBits([&](size_t index)
         {
           m_tree.updateLocalMatrix(static_cast<dp::transform::Index>(index), std::static_pointer_cast<dp::sg::core::Transform>(m_objects[index])->getMatrix());
+          ++dirtyCount;
         } );
+        m_dirtyTransforms.clear();
 
         m_tree.compute(camera->getViewToWorldMatrix());
+        return dirtyCount;
+      }
+
+      void TransformTree::remapTransforms(std::vector<TransformIndex> const & remap)
+      {
+        DP_ASSERT(remap.size() == m_objects.size());
+
+        // the transforms dropped by the compaction are no longer observed
+        Objects objects(m_objects.size());
+        for (size_t index = 0; index < m_objects.size(); ++index)
+        {
+          if (remap[index] != dp::transform::InvalidIndex)
+          {
+            objects[remap[index]] = std::move(m_objects[index]);
+          }
+          else if (m_transformObserver->isAttached(dp::checked_cast<TransformIndex>(index)))
+          {
+            m_transformObserver->detach(dp::checked_cast<TransformIndex>(index));
+          }
+        }
+        m_objects.swap(objects);
+        m_transformObserver->remap(remap);
+
+        dp::util::BitArray dirtyTransforms(m_dirtyTransforms.getSize());
+        m_dirtyTransforms.traverseBits([&](size_t index)
+        {
+          if (remap[index] != dp::transform::InvalidIndex)
+          {
+            dirtyTransforms.enableBit(remap[index]);
+          }
+        });
+        m_dirtyTransforms = dirtyTransforms;
       }
 
     } // namespace xbar
@@ -28,6 +28,7 @@
 #include <dp/transform/Config.h>
 #include <dp/util/BitArray.h>
 #include <dp/util/Observer.h>
+#include <dp/util/WorkerPool.h>
 #include <dp/math/Matmnt.h>
 
 namespace dp
@@ -39,17 +40,44 @@ namespace dp
 
     typedef uint32_t Index;
 
+    //! \brief Marks an index which does not refer to a transform
+    const Index InvalidIndex = ~0u;
+
     class Tree : public dp::util::Subject
     {
     public:
       typedef std::vector<dp::math::Mat44f> Transforms;
 
+      //! \brief Base class of all events sent by the Tree
+      class Event : public dp::util::Event
+      {
+      public:
+        enum class Type
+        {
+            WORLD_MATRICES_CHANGED
+          , TRANSFORMS_REMAPPED
+        };
+
+        Type getType() const { return m_eventType; }
+
+      protected:
+        Event(Type type)
+          : dp::util::Event(dp::util::Event::Type::DP_TRANSFORM)
+          , m_eventType(type)
+        {
+        }
+
+      private:
+        Type m_eventType;
+      };
+
       /** \brief EventWorldMatricesChanged is triggered after compute() to notify observers which world matrices have been changed **/
-      class EventWorldMatricesChanged : public dp::util::Event
+      class EventWorldMatricesChanged : public Event
       {
       public:
         EventWorldMatricesChanged(dp::util::BitArray const & dirtyWorldMatrices)
-          : m_dirtyWorldMatrices(dirtyWorldMatrices)
+          : Event(Type::WORLD_MATRICES_CHANGED)
+          , m_dirtyWorldMatrices(dirtyWorldMatrices)
         {
         }
 
@@ -59,6 +87,23 @@ namespace dp
         dp::util::BitArray const & m_dirtyWorldMatrices;
       };
 
+      /** \brief EventTransformsRemapped is triggered by compact() to notify observers about the new index of each transform **/
+      class EventTransformsRemapped : public Event
+      {
+      public:
+        EventTransformsRemapped(std::vector<Index> const & remap)
+          : Event(Type::TRANSFORMS_REMAPPED)
+          , m_remap(remap)
+        {
+        }
+
+        /** \brief Get the new index per old index. Old indices which have not been in use or have been orphaned map to InvalidIndex. **/
+        std::vector<Index> const & getRemap() const { return m_remap; }
+
+      private:
+        std::vector<Index> const & m_remap;
+      };
+
       DP_TRANSFORM_API Tree();
       DP_TRANSFORM_API virtual ~Tree();
 
@@ -68,15 +113,50 @@ namespace dp
       **/
       DP_TRANSFORM_API Index addTransform(Index parentIndex, dp::math::Mat44f const & matrix);
 
+      /** \brief Grow the data structures once, so that count transforms can be added without further reallocations.
+          \param count The number of transforms about to be added.
+      **/
+      DP_TRANSFORM_API void reserve(size_t count);
+
       /** \brief Remove a single Transform from the Tree. The children of the deleted transform will
-                 not be deleted resulting in orphaned subtrees.
+                 not be deleted resulting in orphaned subtrees. The world matrices of orphaned subtrees are no longer
+                 updated by compute when only a few transforms have changed, and compact drops them.
           \param transformIndex Index to the transform to delete.
       **/
       DP_TRANSFORM_API void removeTransform(Index transformIndex);
 
-      //! \brief Recompute the values in the transform tree
+      /** \brief Renumber the transforms level by level, so that the transforms of each level and their parents are stored
+                 close to each other again after many transforms have been added and removed. Observers receive an
+                 EventTransformsRemapped and have to update all indices they keep. The root keeps its index. Orphaned
+                 subtrees are removed, their transforms map to InvalidIndex.
+          \remarks Call this periodically, e.g. after removing large subtrees. The capacity of the tree does not change.
+      **/
+      DP_TRANSFORM_API void compact();
+
+      //! \brief Get the number of transforms in the tree, excluding the root
+      size_t getUsedTransformCount() const { return m_transformCount; }
+
+      /** \brief Recompute the values in the transform tree. If only a small fraction of the world matrices is affected
+                 by the changed transforms, only the subtrees below the changed transforms are visited. Otherwise all
+                 levels are swept.
+      **/
       DP_TRANSFORM_API virtual void compute(dp::math::Mat44f const & camera);
 
+      /** \brief Set the largest fraction of all transforms whose world matrices are updated by visiting the subtrees below
+                 the changed transforms. If more world matrices are affected, compute sweeps all levels.
+          \param sparseFraction 0 always sweeps all levels. The default is 1/16.
+      **/
+      DP_TRANSFORM_API void setSparseFraction(float sparseFraction);
+      DP_TRANSFORM_API float getSparseFraction() const;
+
+      /** \brief Set the number of threads used by compute. The transforms of one level are independent of each other
+                 and wide levels are split into tasks, the levels themselves are processed one after the other.
+          \param threadCount 0 uses one thread per hardware thread, 1 computes on the calling thread only.
+          \remarks The default is 1. Narrow levels are always computed on the calling thread.
+      **/
+      DP_TRANSFORM_API void setThreadCount(unsigned int threadCount);
+      DP_TRANSFORM_API unsigned int getThreadCount() const;
+
       dp::math::Mat44f const & getWorldMatrix(Index index) const { return m_matricesWorld[index]; }
       dp::math::Mat44f const * getWorldMatrices() const { return m_matricesWorld.data(); }
       size_t            getTransformCount() const { return m_level.size(); }
@@ -93,6 +173,12 @@ namespace dp
 
       DP_TRANSFORM_API void notifyTransformsChanged(dp::util::BitArray const & dirtyWorldMatrices);
 
+      //! \brief Update the subtrees below the changed transforms. Returns false without changes if too many world matrices are affected.
+      DP_TRANSFORM_API bool computeSparse();
+
+      //! \brief Update all levels of the tree
+      DP_TRANSFORM_API void computeLevels();
+
       DP_TRANSFORM_API Index allocateIndex();
       DP_TRANSFORM_API void freeIndex(Index transformIndex);
 
@@ -111,6 +197,8 @@ namespace dp
       bool  m_transformsManaged;
       Index m_maxUsedTransform; // max ever used transformIndex
 
+      std::vector<Index> m_freeList; // removed transforms below m_maxUsedTransform, reused first
+
       struct TransformListEntry {
         unsigned int parent;    // index to parent transform in transform array
         unsigned int transform; // index to transform in transform array
@@ -125,7 +213,24 @@ namespace dp
       typedef std::vector<TransformLevel> TransformLevels;
       TransformLevels m_transformLevels;
 
-      std::vector<uint32_t> m_level; // level per node
+      std::vector<uint32_t> m_level;          // level per node
+      std::vector<uint32_t> m_levelPosition;  // position of the node in the transformListEntries of its level
+
+      // links to the children per node for the sparse update
+      std::vector<Index> m_parent;
+      std::vector<Index> m_firstChild;
+      std::vector<Index> m_nextSibling;
+      std::vector<Index> m_previousSibling;
+
+      size_t              m_transformCount; // number of transforms in the tree
+      float               m_sparseFraction;
+      std::vector<Index>  m_sparseRoots;    // changed transforms
+      std::vector<Index>  m_sparseStack;
+      std::vector<Index>  m_sparseUpdates;  // transforms to update in the order of the update
+
+      unsigned int                  m_threadCount;
+      dp::util::WorkerPoolSharedPtr m_workerPool;
+      std::vector<char>             m_levelDirty; // dirty flag per entry of the level computed in parallel
     };
 
   } // namespace transform
@@ -24,6 +24,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <dp/transform/Tree.h>
+#include <algorithm>
 
 namespace dp
 {
@@ -33,9 +34,44 @@ namespace dp
     namespace
     {
       const size_t VectorGrowth = 65536;
+
+      // number of transforms of a level computed by one task of the worker pool
+      const size_t EntriesPerTask = 1024;
+
+      //! \brief Move each value to the new index of its old index. Values at indices not in use are dropped.
+      template <typename T>
+      void permute(std::vector<T> & values, std::vector<Index> const & remap, T const & defaultValue)
+      {
+        std::vector<T> result(values.size(), defaultValue);
+        for (size_t index = 0; index < values.size(); ++index)
+        {
+          if (remap[index] != InvalidIndex)
+          {
+            result[remap[index]] = values[index];
+          }
+        }
+        values.swap(result);
+      }
+
+      //! \brief Move the values like permute and map each value, which is an index itself, to its new index
+      void permuteIndices(std::vector<Index> & indices, std::vector<Index> const & remap)
+      {
+        permute(indices, remap, InvalidIndex);
+        for (Index & index : indices)
+        {
+          if (index != InvalidIndex)
+          {
+            index = remap[index];
+          }
+        }
+      }
     }
 
     Tree::Tree()
+      : m_maxUsedTransform(0)
+      , m_transformCount(0)
+      , m_sparseFraction(1.0f / 16.0f)
+      , m_threadCount(1)
     {
       resizeDataStructures(VectorGrowth);
 
@@ -68,10 +104,23 @@ namespace dp
         m_transformLevels.resize(m_level[newIndex] + 1);
       }
 
-      // TODO add parent info or entry to this list in transform info?
-      m_transformLevels[m_level[newIndex]].transformListEntries.push_back(TransformListEntry{ parentIndex, newIndex });
+      TransformListEntries &entries = m_transformLevels[m_level[newIndex]].transformListEntries;
+      m_levelPosition[newIndex] = checked_cast<uint32_t>(entries.size());
+      entries.push_back(TransformListEntry{ parentIndex, newIndex });
       m_matricesLocal[newIndex] = matrix;
 
+      // prepend the new transform to the children of its parent
+      m_parent[newIndex] = parentIndex;
+      m_firstChild[newIndex] = InvalidIndex;
+      m_previousSibling[newIndex] = InvalidIndex;
+      m_nextSibling[newIndex] = m_firstChild[parentIndex];
+      if (m_nextSibling[newIndex] != InvalidIndex)
+      {
+        m_previousSibling[m_nextSibling[newIndex]] = newIndex;
+      }
+      m_firstChild[parentIndex] = newIndex;
+      ++m_transformCount;
+
       return newIndex;
     }
 
@@ -82,26 +131,141 @@ namespace dp
         throw std::runtime_error("Tree::removeTransform: Transform does not exist");
       }
 
-      // TODO store position in array in offset for efficient removal
-      TransformLevel &level = m_transformLevels[m_level[index]];
-      for (size_t entry = 0; entry < level.transformListEntries.size(); ++entry)
+      // move the last entry of the level to the position of the removed one
+      TransformListEntries &entries = m_transformLevels[m_level[index]].transformListEntries;
+      uint32_t position = m_levelPosition[index];
+      DP_ASSERT(entries[position].transform == index);
+      entries[position] = entries.back();
+      m_levelPosition[entries[position].transform] = position;
+      entries.pop_back();
+
+      // unlink the transform from its parent, the children of the transform are orphaned
+      if (m_previousSibling[index] != InvalidIndex)
+      {
+        m_nextSibling[m_previousSibling[index]] = m_nextSibling[index];
+      }
+      else
+      {
+        m_firstChild[m_parent[index]] = m_nextSibling[index];
+      }
+      if (m_nextSibling[index] != InvalidIndex)
       {
-        if (level.transformListEntries[entry].transform == index)
+        m_previousSibling[m_nextSibling[index]] = m_previousSibling[index];
+      }
+      m_firstChild[index] = InvalidIndex;
+      --m_transformCount;
+
+      freeIndex(index);
+    }
+
+    void Tree::compact()
+    {
+      // removeTransform unlinks a transform from its parent, so the transforms reachable through the child links are the
+      // ones in use. The orphaned subtrees below removed transforms are dropped.
+      std::vector<char> reachable(m_level.size(), 0);
+      std::vector<Index> stack(1, getRoot());
+      while (!stack.empty())
+      {
+        Index index = stack.back();
+        stack.pop_back();
+        reachable[index] = 1;
+        for (Index child = m_firstChild[index]; child != InvalidIndex; child = m_nextSibling[child])
         {
-          level.transformListEntries[entry] = level.transformListEntries.back();
-          level.transformListEntries.pop_back();
-          break;
+          stack.push_back(child);
         }
       }
 
-      freeIndex(index);
+      // assign the new indices level by level in the order of the levels' entries
+      std::vector<Index> remap(m_level.size(), InvalidIndex);
+      remap[getRoot()] = getRoot();
+      Index nextIndex = getRoot() + 1;
+      for (TransformLevel &transformLevel : m_transformLevels)
+      {
+        TransformListEntries &entries = transformLevel.transformListEntries;
+        size_t count = 0;
+        for (size_t position = 0; position < entries.size(); ++position)
+        {
+          if (reachable[entries[position].transform])
+          {
+            remap[entries[position].transform] = nextIndex++;
+            entries[count++] = entries[position];
+          }
+        }
+        entries.resize(count);
+      }
+      m_transformCount = nextIndex - 1;
+
+      permute(m_matricesLocal, remap, dp::math::cIdentity44f);
+      permute(m_matricesWorld, remap, dp::math::cIdentity44f);
+      permute(m_level, remap, 0u);
+      permuteIndices(m_parent, remap);
+      permuteIndices(m_firstChild, remap);
+      permuteIndices(m_nextSibling, remap);
+      permuteIndices(m_previousSibling, remap);
+
+      for (TransformLevel &transformLevel : m_transformLevels)
+      {
+        TransformListEntries &entries = transformLevel.transformListEntries;
+        for (size_t position = 0; position < entries.size(); ++position)
+        {
+          entries[position].parent = remap[entries[position].parent];
+          entries[position].transform = remap[entries[position].transform];
+          m_levelPosition[entries[position].transform] = checked_cast<uint32_t>(position);
+        }
+      }
+
+      dp::util::BitArray dirtyTransforms(m_dirtyTransforms.getSize());
+      m_dirtyTransforms.traverseBits([&](size_t index)
+      {
+        if (remap[index] != InvalidIndex)
+        {
+          dirtyTransforms.enableBit(remap[index]);
+        }
+      });
+      m_dirtyTransforms = dirtyTransforms;
+      m_dirtyWorldMatrices.clear();
+
+      // all used indices are at the beginning now
+      m_freeTransforms.fill();
+      for (Index index = 0; index < nextIndex; ++index)
+      {
+        m_freeTransforms.disableBit(index);
+      }
+      m_freeList.clear();
+      m_maxUsedTransform = nextIndex - 1;
+
+      notify(EventTransformsRemapped(remap));
+    }
+
+    void Tree::reserve(size_t count)
+    {
+      // allocateIndex takes the free list first, then the indices after the highest used one
+      if (m_freeList.size() < count)
+      {
+        size_t size = m_maxUsedTransform + 1 + count - m_freeList.size();
+        if (m_freeTransforms.getSize() < size)
+        {
+          resizeDataStructures(size);
+        }
+      }
     }
 
     Index Tree::allocateIndex()
     {
-      Index newIndex = checked_cast<Index>(m_freeTransforms.countLeadingZeroes());
-      if (newIndex == m_freeTransforms.getSize()) {
-        resizeDataStructures(m_freeTransforms.getSize() + VectorGrowth);
+      Index newIndex;
+      if (!m_freeList.empty())
+      {
+        newIndex = m_freeList.back();
+        m_freeList.pop_back();
+      }
+      else
+      {
+        newIndex = m_maxUsedTransform + 1;
+        if (newIndex == m_freeTransforms.getSize())
+        {
+          resizeDataStructures(m_freeTransforms.getSize() + VectorGrowth);
+        }
+        m_maxUsedTransform = newIndex;
       }
 
       m_freeTransforms.disableBit(newIndex);
@@ -109,9 +273,10 @@ namespace dp
       return newIndex;
     }
 
-    void Tree::freeIndex(Index Index)
+    void Tree::freeIndex(Index index)
     {
-      m_freeTransforms.enableBit(Index);
+      m_freeTransforms.enableBit(index);
+      m_freeList.push_back(index);
     }
 
     void Tree::resizeDataStructures(size_t newSize)
@@ -123,6 +288,12 @@ namespace dp
       m_dirtyTransforms.resize(newSize, false);
       m_dirtyWorldMatrices.resize(newSize, false);
       m_level.resize(newSize);
+      m_levelPosition.resize(newSize);
+
+      m_parent.resize(newSize, InvalidIndex);
+      m_firstChild.resize(newSize, InvalidIndex);
+      m_nextSibling.resize(newSize, InvalidIndex);
+      m_previousSibling.resize(newSize, InvalidIndex);
     }
 
     void Tree::notifyTransformsChanged(dp::util::BitArray const &dirtyWorldMatrices)
@@ -131,6 +302,82 @@ namespace dp
     }
 
     void Tree::compute(dp::math::Mat44f const & camera)
+    {
+      if (!computeSparse())
+      {
+        computeLevels();
+      }
+      notifyTransformsChanged(m_dirtyWorldMatrices);
+
+      m_dirtyTransforms.clear();
+      m_dirtyWorldMatrices.clear();
+    }
+
+    bool Tree::computeSparse()
+    {
+      size_t const limit = static_cast<size_t>(m_sparseFraction * m_transformCount);
+      if (!limit)
+      {
+        return false;
+      }
+
+      // gather the changed transforms, a single changed transform may already affect too many world matrices
+      bool sparse = true;
+      m_sparseRoots.clear();
+      m_dirtyTransforms.traverseBits([&](size_t index)
+      {
+        if (sparse)
+        {
+          sparse = m_sparseRoots.size() < limit;
+          m_sparseRoots.push_back(checked_cast<Index>(index));
+        }
+      });
+      if (!sparse)
+      {
+        return false;
+      }
+
+      // visit the subtrees of the changed transforms top down. A changed transform below another changed transform
+      // has been visited already together with the subtree of the upper one. The visited transforms are marked in
+      // m_dirtyWorldMatrices, so the order of m_sparseUpdates has each parent before its children.
+      std::sort(m_sparseRoots.begin(), m_sparseRoots.end(), [this](Index lhs, Index rhs) { return m_level[lhs] < m_level[rhs]; });
+      m_sparseUpdates.clear();
+      for (Index root : m_sparseRoots)
+      {
+        if (root == getRoot() || !isValidIndex(root) || m_dirtyWorldMatrices.getBit(root))
+        {
+          continue;
+        }
+
+        m_sparseStack.push_back(root);
+        while (!m_sparseStack.empty())
+        {
+          if (m_sparseUpdates.size() == limit)
+          {
+            m_sparseStack.clear();
+            m_dirtyWorldMatrices.clear();
+            return false;
+          }
+
+          Index transform = m_sparseStack.back();
+          m_sparseStack.pop_back();
+          m_sparseUpdates.push_back(transform);
+          m_dirtyWorldMatrices.enableBit(transform);
+          for (Index child = m_firstChild[transform]; child != InvalidIndex; child = m_nextSibling[child])
+          {
+            m_sparseStack.push_back(child);
+          }
+        }
+      }
+
+      for (Index transform : m_sparseUpdates)
+      {
+        m_matricesWorld[transform] = m_matricesLocal[transform] * m_matricesWorld[m_parent[transform]];
+      }
+      return true;
+    }
+
+    void Tree::computeLevels()
     {
       for (TransformLevel const &transformLevel : m_transformLevels)
       {
@@ -150,19 +397,73 @@ namespace dp
 #endif
 
         // update transforms
-        for (TransformListEntry const &transformEntry : transformLevel.transformListEntries)
+        TransformListEntries const &entries = transformLevel.transformListEntries;
+        if (m_workerPool && EntriesPerTask < entries.size())
         {
-          if (m_dirtyWorldMatrices.getBit(transformEntry.parent) || m_dirtyTransforms.getBit(transformEntry.transform))
+          // the bits of m_dirtyWorldMatrices share words between transforms, so the tasks only write flags per entry
+          // and the bits of this level are enabled after all tasks have finished
+          m_levelDirty.resize(entries.size());
+          size_t const taskCount = (entries.size() + EntriesPerTask - 1) / EntriesPerTask;
+          m_workerPool->execute(taskCount, [&](size_t task)
           {
-            m_matricesWorld[transformEntry.transform] = m_matricesLocal[transformEntry.transform] * m_matricesWorld[transformEntry.parent];
-            m_dirtyWorldMatrices.enableBit(transformEntry.transform);
+            size_t const end = std::min((task + 1) * EntriesPerTask, entries.size());
+            for (size_t entry = task * EntriesPerTask; entry < end; ++entry)
+            {
+              TransformListEntry const &transformEntry = entries[entry];
+              bool const dirty = m_dirtyWorldMatrices.getBit(transformEntry.parent) || m_dirtyTransforms.getBit(transformEntry.transform);
+              if (dirty)
+              {
+                m_matricesWorld[transformEntry.transform] = m_matricesLocal[transformEntry.transform] * m_matricesWorld[transformEntry.parent];
+              }
+              m_levelDirty[entry] = dirty;
+            }
+          });
+
+          for (size_t entry = 0; entry < entries.size(); ++entry)
+          {
+            if (m_levelDirty[entry])
+            {
+              m_dirtyWorldMatrices.enableBit(entries[entry].transform);
+            }
+          }
+        }
+        else
+        {
+          for (TransformListEntry const &transformEntry : entries)
+          {
+            if (m_dirtyWorldMatrices.getBit(transformEntry.parent) || m_dirtyTransforms.getBit(transformEntry.transform))
+            {
+              m_matricesWorld[transformEntry.transform] = m_matricesLocal[transformEntry.transform] * m_matricesWorld[transformEntry.parent];
+              m_dirtyWorldMatrices.enableBit(transformEntry.transform);
+            }
           }
         }
       }
-      notifyTransformsChanged(m_dirtyWorldMatrices);
+    }
 
-      m_dirtyTransforms.clear();
-      m_dirtyWorldMatrices.clear();
+    void Tree::setSparseFraction(float sparseFraction)
+    {
+      DP_ASSERT(0.0f <= sparseFraction && sparseFraction <= 1.0f);
+      m_sparseFraction = sparseFraction;
+    }
+
+    float Tree::getSparseFraction() const
+    {
+      return m_sparseFraction;
+    }
+
+    void Tree::setThreadCount(unsigned int threadCount)
+    {
+      if (threadCount != m_threadCount)
+      {
+        m_threadCount = threadCount;
+        m_workerPool = (threadCount != 1) ? dp::util::WorkerPool::create(threadCount) : nullptr;
+      }
+    }
+
+    unsigned int Tree::getThreadCount() const
+    {
+      return m_threadCount;
     }
 
   } // namespace sg
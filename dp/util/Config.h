@@ -40,8 +40,10 @@
 #if defined(__GNUC__)
 #define DP_COMPILER_GCC 1
 
-#if defined(_LP64)
+#if defined(__x86_64__)
 #define DP_ARCH_X86_64
+#elif defined(__aarch64__)
+#define DP_ARCH_ARM_64
 #elif defined(__ARMEL__)
 #define DP_ARCH_ARM_32
 #elif defined(__i386__)
@@ -28,6 +28,8 @@
 
 #include <dp/util/Config.h>
 #include <dp/util/PointerTypes.h>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -37,6 +39,7 @@ namespace dp
   {
     class Subject;
     class Observer;
+    class NotificationQueue;
 
     class Payload : public std::enable_shared_from_this<Payload>
     {
@@ -55,11 +58,17 @@ namespace dp
           GENERIC
         , PROPERTY
         , DP_SG_CORE
+        , DP_TRANSFORM
       };
 
       virtual~ Event() {}
       Type getType() const { return m_eventType; }
 
+      /** \brief Copy the event for a queued delivery. Events referring to data which does not outlive the notification
+                 return nullptr and cannot be queued, see NotificationQueue.
+      **/
+      virtual std::unique_ptr<Event> clone() const { return nullptr; }
+
       Event( Type type = Type::GENERIC )
         : m_eventType( type )
       {
@@ -69,32 +78,59 @@ namespace dp
       Type m_eventType;
     };
 
+    /** \brief Subject of the observer pattern. The observers are kept in slots which do not move, so the handle returned by
+               attach detaches in constant time and notify walks the slots without any allocation or compaction. Attaching,
+               detaching and notifying are not thread-safe, worker threads modifying observed subjects have to queue their
+               notifications with a NotificationQueue.
+    **/
     class Subject
     {
     public:
+      typedef uint32_t ObserverHandle;
+
       // Do not copy the list of observers during copy/assignment.
       // The observers won't know about the 'new' attachment and thus
       // it cannot detach itself;
-      Subject() : m_inNotify(false) {}
-      Subject( Subject const& ) : m_inNotify(false) {}
+      Subject() : m_firstFree( ~0 ), m_observerCount( 0 ), m_notifyDepth( 0 ) {}
+      Subject( Subject const& ) : m_firstFree( ~0 ), m_observerCount( 0 ), m_notifyDepth( 0 ) {}
       Subject& operator=( const Subject& /* rhs */ ) { return *this; }
 
       DP_UTIL_API virtual ~Subject();
 
-      DP_UTIL_API void attach( Observer* observer, Payload * payload = nullptr );
+      /** \brief Attach an observer, which is notified with the given payload. The returned handle is valid until detached. **/
+      DP_UTIL_API ObserverHandle attach( Observer* observer, Payload * payload = nullptr );
+      DP_UTIL_API void detach( ObserverHandle handle );
+
+      /** \brief Detach an observer by searching it. Prefer detaching with the handle returned by attach. **/
       DP_UTIL_API void detach( Observer* observer, Payload * payload = nullptr  );
       DP_UTIL_API bool isAttached( Observer * observer, Payload * payload = nullptr ) const;
 
     protected:
+      /** \brief Notify all observers. On a thread within a NotificationQueue::Scope the event is queued instead. **/
       DP_UTIL_API void notify( const Event &event );
 
     private:
-      typedef std::pair<Observer*, Payload*> ObserverEntry;
+      void deliver( const Event &event );
+
+      friend class NotificationQueue;
+
+    private:
+      struct ObserverEntry
+      {
+        Observer *    observer;   // nullptr for a free slot
+        union
+        {
+          Payload *   payload;
+          uint32_t    nextFree;   // next free slot in the list of free slots
+        };
+      };
       typedef std::vector<ObserverEntry> Observers;
 
     private:
-      Observers m_observers;
-      bool      m_inNotify;
+      Observers             m_observers;
+      uint32_t              m_firstFree;
+      std::atomic<uint32_t> m_observerCount;  // read without synchronization by NotificationQueue::Scope threads
+      uint32_t              m_notifyDepth;
     };
 
     DEFINE_PTR_TYPES( Subject );
@@ -108,5 +144,60 @@ namespace dp
     };
 
 
+    /** \brief Queue for the notifications of subjects modified on worker threads, like loader threads extending the scene
+               while it is being rendered. A thread within a Scope of the queue does not notify the observers, but pushes a
+               copy of the event, see Event::clone, without taking a lock. The thread owning the observers, usually the render
+               thread, calls deliver to notify them in the order the events have been queued. The subjects have to stay alive
+               until their notifications have been delivered. Subjects without observers do not queue anything. The
+               destructor delivers the remaining notifications.
+               Queueing an event whose clone returns nullptr, like the events of dp::sg::xbar::SceneTree and
+               dp::transform::Tree, is an error and throws a std::runtime_error, so these subjects must not be notified
+               within a Scope.
+               A queued event describes a change which has already happened. In particular a Group::Event of type
+               PRE_CHILD_REMOVE is delivered after the child has been removed from the group, so observers must not look
+               the child up in the group.
+    **/
+    class NotificationQueue
+    {
+    public:
+      DP_UTIL_API NotificationQueue();
+      DP_UTIL_API ~NotificationQueue();
+
+      /** \brief Queue the notifications of the calling thread in the given queue while the scope exists. **/
+      class Scope
+      {
+      public:
+        DP_UTIL_API Scope( NotificationQueue & queue );
+        DP_UTIL_API ~Scope();
+
+      private:
+        NotificationQueue * m_previous;
+      };
+
+      /** \brief Notify the observers of all queued events. Returns the number of delivered events. **/
+      DP_UTIL_API size_t deliver();
+      DP_UTIL_API bool empty() const;
+
+    private:
+      friend class Subject;
+
+      struct Notification
+      {
+        Notification *          next;
+        Subject *               subject;
+        std::unique_ptr<Event>  event;
+      };
+
+      // throws if the event cannot be cloned
+      void push( Subject * subject, Event const & event );
+
+      NotificationQueue( NotificationQueue const & );
+      NotificationQueue & operator=( NotificationQueue const & );
+
+    private:
+      std::atomic<Notification *> m_head;   // the most recent notification
+    };
+
+
   } // namespace util
 } // namespace dp
@@ -1180,6 +1180,8 @@ namespace dp
 
       Reflection const* getSource() const { return m_source; }
       dp::util::PropertyId getPropertyId() const { return m_propertyId; }
+
+      virtual std::unique_ptr<dp::util::Event> clone() const { return std::unique_ptr<dp::util::Event>( new PropertyEvent( *this ) ); }
     private:
       Reflection const*    m_source;
       dp::util::PropertyId m_propertyId;
@@ -0,0 +1,89 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <dp/util/Config.h>
+#include <dp/util/PointerTypes.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dp
+{
+  namespace util
+  {
+    DEFINE_PTR_TYPES( WorkerPool );
+
+    /** \brief A fixed set of threads which execute a number of independent tasks in parallel.
+        \remarks The thread calling execute participates in the work, so a pool with a thread count of n
+                 starts n - 1 additional threads. Tasks are handed out dynamically, so tasks with different
+                 costs are balanced between the threads. Concurrent calls to execute are serialized.
+    **/
+    class WorkerPool
+    {
+    public:
+      /** \brief Create a WorkerPool.
+          \param threadCount The number of threads executing tasks, including the calling thread.
+                 If 0, std::thread::hardware_concurrency() threads are used.
+      **/
+      DP_UTIL_API static WorkerPoolSharedPtr create( unsigned int threadCount = 0 );
+      DP_UTIL_API ~WorkerPool();
+
+      /** \brief Get the number of threads executing tasks, including the calling thread. **/
+      DP_UTIL_API unsigned int getThreadCount() const;
+
+      /** \brief Call task(index) for each index in [0, taskCount) and return once all tasks have finished.
+          \param taskCount The number of tasks to execute.
+          \param task The function to call per task. It is called concurrently from multiple threads and must not throw.
+      **/
+      DP_UTIL_API void execute( size_t taskCount, std::function<void( size_t )> const & task );
+
+    private:
+      WorkerPool( unsigned int threadCount );
+
+      void workerFunction();
+      void executeTasks();
+
+    private:
+      std::vector<std::thread>            m_threads;
+      std::mutex                          m_executeMutex;
+      std::mutex                          m_mutex;
+      std::condition_variable             m_startCondition;
+      std::condition_variable             m_finishCondition;
+      std::function<void( size_t )> const* m_task;
+      size_t                              m_taskCount;
+      std::atomic<size_t>                 m_nextTask;
+      size_t                              m_busyThreads;
+      size_t                              m_generation;
+      bool                                m_terminate;
+    };
+
+  } // namespace util
+} // namespace dp
@@ -106,7 +106,17 @@ namespace dp
     void * FileMapping::mapIn( size_t offset, size_t numBytes )
     {
       DP_ASSERT( m_isValid );
-      DP_ASSERT( offset + numBytes <= m_mappingSize );
+
+      if ( m_mappingSize < offset + numBytes )
+      {
+        // the range reaches past the end of the file
+  #if defined(_WIN32)
+        SetLastError( ERROR_INVALID_PARAMETER );
+  #elif defined(LINUX)
+        errno = EINVAL;
+  #endif
+        return( NULL );
+      }
 
       ViewHeader * vh = NULL;
       void * offsetPtr = NULL;
@@ -167,10 +177,18 @@ namespace dp
         void * basePtr = MapViewOfFile( m_fileMapping, m_accessType, HIDWORD(startOffset), LODWORD(startOffset), (SIZE_T)viewSize );
   #elif defined(LINUX)
         void * basePtr = mmap( 0, viewSize, m_accessType, MAP_SHARED, m_file, startOffset );
+        if ( basePtr == MAP_FAILED )
+        {
+          basePtr = NULL;
+        }
   #else
         DP_STATIC_ASSERT( false );
   #endif
-        DP_ASSERT( basePtr );
+        if ( !basePtr )
+        {
+          // the reason is available through getLastError
+          return( NULL );
+        }
 
         vh = new ViewHeader( startOffset, viewSize, basePtr );
         m_mappedViews.push_front( vh );
@@ -25,8 +25,14 @@
 
 
 #include <dp/util/Observer.h>
+#include <dp/Assert.h>
+#include <stdexcept>
 
-#include <algorithm>
+namespace
+{
+  // the queue of the innermost NotificationQueue::Scope on this thread
+  thread_local dp::util::NotificationQueue * currentNotificationQueue = nullptr;
+}
 
 namespace dp
 {
@@ -47,92 +53,191 @@ namespace dp
 
       for ( it = m_observers.begin(); it != itEnd;++it )
       {
-        if( it->first )
+        if( it->observer )
         {
-          it->first->onDestroyed( *this, it->second );
+          it->observer->onDestroyed( *this, it->payload );
         }
       }
     }
 
-    void Subject::attach( Observer *observer, Payload *payload )
+    Subject::ObserverHandle Subject::attach( Observer *observer, Payload *payload )
     {
-      m_observers.push_back( ObserverEntry(observer, payload) );
+      DP_ASSERT( observer );
+
+      // slots freed during a notification are not reused before it ends, so an observer attached by an observer is not
+      // notified of the current event
+      ObserverHandle handle;
+      if ( m_firstFree != ObserverHandle(~0) && !m_notifyDepth )
+      {
+        handle = m_firstFree;
+        m_firstFree = m_observers[handle].nextFree;
+      }
+      else
+      {
+        handle = static_cast<ObserverHandle>( m_observers.size() );
+        m_observers.push_back( ObserverEntry() );
+      }
+      m_observers[handle].observer = observer;
+      m_observers[handle].payload = payload;
+      m_observerCount.store( m_observerCount.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+      return handle;
+    }
+
+    void Subject::detach( ObserverHandle handle )
+    {
+      DP_ASSERT( handle < m_observers.size() && m_observers[handle].observer );
+
+      uint32_t count = m_observerCount.load( std::memory_order_relaxed ) - 1;
+      m_observerCount.store( count, std::memory_order_relaxed );
+      if ( !count && !m_notifyDepth )
+      {
+        // drop the free slots with the last observer, so that notify has nothing to walk
+        m_observers.clear();
+        m_firstFree = ~0;
+      }
+      else
+      {
+        m_observers[handle].observer = nullptr;
+        m_observers[handle].nextFree = m_firstFree;
+        m_firstFree = handle;
+      }
     }
 
     void Subject::detach( Observer *observer, Payload *payload )
     {
-      Observers::iterator it = std::find(m_observers.begin(), m_observers.end(), std::make_pair(observer, payload) );
-      if ( it != m_observers.end() )
+      for ( size_t i = 0; i < m_observers.size(); ++i )
       {
-        if (m_inNotify)
-        {
-          // mark this entry as invalid instead of deleting it
-          it->first = nullptr;
-        }
-        else
+        if ( m_observers[i].observer == observer && m_observers[i].payload == payload )
         {
-          *it = m_observers.back();
-          m_observers.pop_back();
+          detach( static_cast<ObserverHandle>( i ) );
+          return;
         }
       }
     }
 
     bool Subject::isAttached( Observer * observer, Payload * payload ) const
     {
-      return( std::find( m_observers.begin(), m_observers.end(), std::make_pair(observer, payload) ) != m_observers.end() );
+      for ( size_t i = 0; i < m_observers.size(); ++i )
+      {
+        if ( m_observers[i].observer == observer && m_observers[i].payload == payload )
+        {
+          return true;
+        }
+      }
+      return false;
     }
 
     void Subject::notify( const Event &event )
     {
-      // notify the list ob observers, cleaning the list of observers set to nullptr on the way
-      // don't clean the list first and notify then, this would mean iterating the list of observers twice
-      if( !m_observers.empty() )
+      if ( m_observerCount.load( std::memory_order_relaxed ) )
       {
-        size_t idx;
-        size_t last = m_observers.size() - 1;
-        size_t deletedElements = 0;
-
-        m_inNotify = true;
-        for (idx = 0; idx <= last; ++idx)
+        NotificationQueue * queue = currentNotificationQueue;
+        if ( queue )
+        {
+          queue->push( this, event );
+        }
+        else
         {
-          if( !m_observers[idx].first )
-          {
-            // observer at idx was detached, find a valid observer beginning at the end of the vector
-            while( !m_observers[last].first && last > idx )
-            {
-              --last;
-              ++deletedElements;
-            }
-
-            if( last != idx )
-            {
-              // move the last valid observer to position idx
-              m_observers[idx] = m_observers[last];
-
-              // abandon the last observer
-              --last;
-              ++deletedElements;
-            }
-            else
-            {
-              ++deletedElements;
-              // no valid observers left, leave the for loop
-              break;
-            }
-          }
-
-          m_observers[idx].first->onNotify( event, m_observers[idx].second );
+          deliver( event );
         }
+      }
+    }
 
-        if( deletedElements )
+    void Subject::deliver( const Event &event )
+    {
+      // observers attached while notifying are not notified of this event, detached ones leave a free slot
+      size_t count = m_observers.size();
+      ++m_notifyDepth;
+      for ( size_t idx = 0; idx < count; ++idx )
+      {
+        if ( m_observers[idx].observer )
         {
-          m_observers.resize( m_observers.size() - deletedElements );
+          m_observers[idx].observer->onNotify( event, m_observers[idx].payload );
         }
+      }
+      --m_notifyDepth;
 
-        m_inNotify = false;
+      if ( !m_notifyDepth && !m_observerCount.load( std::memory_order_relaxed ) )
+      {
+        m_observers.clear();
+        m_firstFree = ~0;
       }
     }
 
+    /************************************************************************/
+    /* NotificationQueue                                                    */
+    /************************************************************************/
+
+    NotificationQueue::NotificationQueue()
+      : m_head( nullptr )
+    {
+    }
+
+    NotificationQueue::~NotificationQueue()
+    {
+      deliver();
+    }
+
+    NotificationQueue::Scope::Scope( NotificationQueue & queue )
+      : m_previous( currentNotificationQueue )
+    {
+      currentNotificationQueue = &queue;
+    }
+
+    NotificationQueue::Scope::~Scope()
+    {
+      currentNotificationQueue = m_previous;
+    }
+
+    void NotificationQueue::push( Subject * subject, Event const & event )
+    {
+      // delivering the event right away would call the observers on this thread
+      std::unique_ptr<Event> copy = event.clone();
+      if ( !copy )
+      {
+        DP_ASSERT( !"NotificationQueue: the event does not implement clone" );
+        throw std::runtime_error( "NotificationQueue: an event which does not implement clone cannot be queued" );
+      }
+
+      Notification * notification = new Notification;
+      notification->subject = subject;
+      notification->event = std::move( copy );
+      notification->next = m_head.load( std::memory_order_relaxed );
+      while ( !m_head.compare_exchange_weak( notification->next, notification, std::memory_order_release, std::memory_order_relaxed ) )
+      {
+      }
+    }
+
+    size_t NotificationQueue::deliver()
+    {
+      // take all queued notifications at once and reverse them into the order they have been queued
+      Notification * notification = m_head.exchange( nullptr, std::memory_order_acquire );
+      Notification * first = nullptr;
+      while ( notification )
+      {
+        Notification * next = notification->next;
+        notification->next = first;
+        first = notification;
+        notification = next;
+      }
+
+      size_t count = 0;
+      while ( first )
+      {
+        Notification * next = first->next;
+        first->subject->deliver( *first->event );
+        delete first;
+        first = next;
+        ++count;
+      }
+      return count;
+    }
+
+    bool NotificationQueue::empty() const
+    {
+      return !m_head.load( std::memory_order_acquire );
+    }
+
     /************************************************************************/
     /* SubjectTrackingObserver                                              */
     /************************************************************************/
@@ -0,0 +1,150 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <dp/util/WorkerPool.h>
+#include <dp/Types.h>
+#include <algorithm>
+
+namespace dp
+{
+  namespace util
+  {
+
+    WorkerPoolSharedPtr WorkerPool::create( unsigned int threadCount )
+    {
+      return( std::shared_ptr<WorkerPool>( new WorkerPool( threadCount ) ) );
+    }
+
+    WorkerPool::WorkerPool( unsigned int threadCount )
+      : m_task( nullptr )
+      , m_taskCount( 0 )
+      , m_nextTask( 0 )
+      , m_busyThreads( 0 )
+      , m_generation( 0 )
+      , m_terminate( false )
+    {
+      if ( !threadCount )
+      {
+        threadCount = std::max( 1u, std::thread::hardware_concurrency() );
+      }
+
+      // the thread calling execute is the first worker
+      for ( unsigned int index = 1; index < threadCount; ++index )
+      {
+        m_threads.push_back( std::thread( &WorkerPool::workerFunction, this ) );
+      }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_terminate = true;
+      }
+      m_startCondition.notify_all();
+
+      for ( std::vector<std::thread>::iterator it = m_threads.begin(); it != m_threads.end(); ++it )
+      {
+        it->join();
+      }
+    }
+
+    unsigned int WorkerPool::getThreadCount() const
+    {
+      return dp::checked_cast<unsigned int>( m_threads.size() + 1 );
+    }
+
+    void WorkerPool::execute( size_t taskCount, std::function<void( size_t )> const & task )
+    {
+      if ( m_threads.empty() || taskCount < 2 )
+      {
+        for ( size_t index = 0; index < taskCount; ++index )
+        {
+          task( index );
+        }
+        return;
+      }
+
+      std::lock_guard<std::mutex> executeLock( m_executeMutex );
+      {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_task = &task;
+        m_taskCount = taskCount;
+        m_nextTask = 0;
+        m_busyThreads = m_threads.size();
+        ++m_generation;
+      }
+      m_startCondition.notify_all();
+
+      executeTasks();
+
+      // each worker has to acknowledge the generation before the next one can be started
+      std::unique_lock<std::mutex> lock( m_mutex );
+      m_finishCondition.wait( lock, [this]() { return m_busyThreads == 0; } );
+      m_task = nullptr;
+    }
+
+    void WorkerPool::executeTasks()
+    {
+      size_t index;
+      while ( ( index = m_nextTask++ ) < m_taskCount )
+      {
+        (*m_task)( index );
+      }
+    }
+
+    void WorkerPool::workerFunction()
+    {
+      size_t generation = 0;
+      while ( true )
+      {
+        {
+          std::unique_lock<std::mutex> lock( m_mutex );
+          m_startCondition.wait( lock, [this, generation]() { return m_terminate || m_generation != generation; } );
+          if ( m_terminate )
+          {
+            return;
+          }
+          generation = m_generation;
+        }
+
+        executeTasks();
+
+        bool finished;
+        {
+          std::lock_guard<std::mutex> lock( m_mutex );
+          DP_ASSERT( m_busyThreads );
+          finished = ( --m_busyThreads == 0 );
+        }
+        if ( finished )
+        {
+          m_finishCondition.notify_one();
+        }
+      }
+    }
+
+  } // namespace util
+} // namespace dp
@@ -0,0 +1,259 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include <test/testfw/manager/Manager.h>
+#include "benchmark_bounding_kernels.h"
+
+#include <dp/math/Bounds.h>
+#include <dp/util/StridedIterator.h>
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("benchmark_bounding_kernels", "tests the vectorized bounding box and sphere kernels against the scalar loops", create_benchmark_bounding_kernels);
+
+// position, normal and texture coordinate of an interleaved vertex
+static const size_t interleavedFloats = 8;
+
+// every that many indices a primitive restart index is inserted
+static const size_t restartInterval = 64;
+
+
+Benchmark_bounding_kernels::Benchmark_bounding_kernels()
+  : m_repetitions(4)
+  , m_vertices(10000000)
+{
+}
+
+Benchmark_bounding_kernels::~Benchmark_bounding_kernels()
+{
+}
+
+bool Benchmark_bounding_kernels::onInit()
+{
+  std::mt19937 random( 1 );
+  std::uniform_real_distribution<float> coordinate( -100.0f, 100.0f );
+
+  m_contiguous.resize( 3 * size_t(m_vertices) );
+  m_interleaved.resize( interleavedFloats * size_t(m_vertices) );
+  for ( size_t v = 0; v < m_vertices; ++v )
+  {
+    for ( size_t c = 0; c < 3; ++c )
+    {
+      m_contiguous[3 * v + c] = coordinate( random );
+    }
+    std::copy( &m_contiguous[3 * v], &m_contiguous[3 * v] + 3, &m_interleaved[interleavedFloats * v] );
+  }
+
+  // a shuffled triangle list style index array with primitive restarts, and a short one on the first 65535 vertices
+  std::vector<unsigned int> order( m_vertices );
+  for ( unsigned int v = 0; v < m_vertices; ++v )
+  {
+    order[v] = v;
+  }
+  std::shuffle( order.begin(), order.end(), random );
+  for ( size_t v = 0; v < order.size(); ++v )
+  {
+    if ( v && ( v % restartInterval == 0 ) )
+    {
+      m_indices32.push_back( ~0 );
+    }
+    m_indices32.push_back( order[v] );
+  }
+
+  unsigned int shortCount = std::min( m_vertices, 65535u );
+  for ( size_t v = 0; v < order.size(); ++v )
+  {
+    if ( v && ( v % restartInterval == 0 ) )
+    {
+      m_indices16.push_back( 0xFFFF );
+    }
+    m_indices16.push_back( dp::checked_cast<unsigned short>( order[v] % shortCount ) );
+  }
+
+  addLayout( "contiguous", m_contiguous.data(), 3 * sizeof(float), m_vertices );
+  addLayout( "interleaved", m_interleaved.data(), interleavedFloats * sizeof(float), m_vertices );
+  addLayout( "indexed 32 bit", m_contiguous.data(), 3 * sizeof(float), m_vertices, m_indices32.data(), dp::DataType::UNSIGNED_INT_32, m_indices32.size() );
+  addLayout( "indexed 16 bit", m_interleaved.data(), interleavedFloats * sizeof(float), shortCount, m_indices16.data(), dp::DataType::UNSIGNED_INT_16, m_indices16.size() );
+  return true;
+}
+
+bool Benchmark_bounding_kernels::onRun( unsigned int i )
+{
+  for ( std::vector<Layout>::iterator it = m_layouts.begin(); it != m_layouts.end(); ++it )
+  {
+    dp::math::Box3f scalarBox, kernelBox;
+    dp::math::Sphere3f scalarSphere, kernelSphere;
+
+    dp::util::Timer timer;
+    timer.start();
+    scalarBoundingVolumes( *it, scalarBox, scalarSphere );
+    timer.stop();
+    it->scalarTime += timer.getTime();
+
+    timer.restart();
+    kernelBoundingVolumes( *it, kernelBox, kernelSphere );
+    timer.stop();
+    it->kernelTime += timer.getTime();
+
+    // the kernels evaluate the same operations, so the results have to be identical
+    if ( ( scalarBox.getLower() != kernelBox.getLower() ) || ( scalarBox.getUpper() != kernelBox.getUpper() )
+      || ( scalarSphere.getCenter() != kernelSphere.getCenter() ) || ( scalarSphere.getRadius() != kernelSphere.getRadius() ) )
+    {
+      std::cerr << "Error: the kernels calculated different bounding volumes for the " << it->name << " layout\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Benchmark_bounding_kernels::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Benchmark_bounding_kernels::onClear()
+{
+  double repetitions = std::max( 1u, m_repetitions );
+  std::cout << m_vertices << " vertices, box and sphere\n";
+  for ( std::vector<Layout>::const_iterator it = m_layouts.begin(); it != m_layouts.end(); ++it )
+  {
+    std::cout << it->name << ": scalar " << 1000.0 * it->scalarTime / repetitions << " ms, kernels " << 1000.0 * it->kernelTime / repetitions << " ms\n";
+  }
+
+  m_layouts.clear();
+  m_contiguous.clear();
+  m_interleaved.clear();
+  m_indices32.clear();
+  m_indices16.clear();
+  return true;
+}
+
+void Benchmark_bounding_kernels::addLayout( std::string const & name, float const* points, size_t stride, size_t count
+                                          , void const* indices, dp::DataType indexType, size_t indexCount )
+{
+  Layout layout;
+  layout.name = name;
+  layout.points = points;
+  layout.stride = stride;
+  layout.count = count;
+  layout.indices = indices;
+  layout.indexType = indexType;
+  layout.indexCount = indexCount;
+  layout.scalarTime = 0.0;
+  layout.kernelTime = 0.0;
+  m_layouts.push_back( layout );
+}
+
+void Benchmark_bounding_kernels::scalarBoundingVolumes( Layout const & layout, dp::math::Box3f & box, dp::math::Sphere3f & sphere ) const
+{
+  // what Primitive did before: one pass for the box, one more for the box of the sphere, and one for the radius
+  dp::util::StridedConstIterator<dp::math::Vec3f> points( reinterpret_cast<dp::math::Vec3f const*>( layout.points ), layout.stride );
+  unsigned int restart = ( layout.indexType == dp::DataType::UNSIGNED_INT_16 ) ? 0xFFFF : ~0;
+
+  for ( unsigned int pass = 0; pass < 2; ++pass )
+  {
+    box = dp::math::Box3f();
+    for ( size_t i = 0; i < ( layout.indices ? layout.indexCount : layout.count ); ++i )
+    {
+      unsigned int index = dp::checked_cast<unsigned int>( i );
+      if ( layout.indices )
+      {
+        index = ( layout.indexType == dp::DataType::UNSIGNED_INT_16 ) ? static_cast<unsigned short const*>( layout.indices )[i]
+                                                                      : static_cast<unsigned int const*>( layout.indices )[i];
+      }
+      if ( index != restart )
+      {
+        box.update( points[index] );
+      }
+    }
+  }
+
+  dp::math::Vec3f center = box.getCenter();
+  float radius = 0.0f;
+  for ( size_t i = 0; i < ( layout.indices ? layout.indexCount : layout.count ); ++i )
+  {
+    unsigned int index = dp::checked_cast<unsigned int>( i );
+    if ( layout.indices )
+    {
+      index = ( layout.indexType == dp::DataType::UNSIGNED_INT_16 ) ? static_cast<unsigned short const*>( layout.indices )[i]
+                                                                    : static_cast<unsigned int const*>( layout.indices )[i];
+    }
+    if ( index != restart )
+    {
+      radius = std::max( radius, dp::math::lengthSquared( points[index] - center ) );
+    }
+  }
+  sphere = dp::math::Sphere3f( center, sqrt( radius ) );
+}
+
+void Benchmark_bounding_kernels::kernelBoundingVolumes( Layout const & layout, dp::math::Box3f & box, dp::math::Sphere3f & sphere ) const
+{
+  unsigned int restart = ( layout.indexType == dp::DataType::UNSIGNED_INT_16 ) ? 0xFFFF : ~0;
+  if ( layout.indices )
+  {
+    dp::math::boundingBoxAndSphere( layout.points, layout.stride, layout.count, layout.indices, layout.indexType, layout.indexCount, box, sphere, restart );
+  }
+  else
+  {
+    dp::math::boundingBoxAndSphere( layout.points, layout.stride, layout.count, box, sphere );
+  }
+}
+
+bool Benchmark_bounding_kernels::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: benchmark_bounding_kernels");
+  od.add_options() ( "repetitions", options::value<unsigned int>()->default_value(4), "Number of repetitions" )
+                   ( "vertices", options::value<unsigned int>()->default_value(10000000), "Number of vertices per mesh" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_vertices = std::max( 1u, optsMap["vertices"].as<unsigned int>() );
+
+  return true;
+}
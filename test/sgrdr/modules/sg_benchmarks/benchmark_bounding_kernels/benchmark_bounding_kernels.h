@@ -0,0 +1,87 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#pragma once
+
+#include <test/testfw/core/Test.h>
+#include <dp/math/Boxnt.h>
+#include <dp/math/Spherent.h>
+#include <dp/Types.h>
+#include <string>
+#include <vector>
+
+class Benchmark_bounding_kernels : public dp::testfw::core::Test
+{
+public:
+  Benchmark_bounding_kernels();
+  ~Benchmark_bounding_kernels();
+
+  bool onInit( void );
+  bool onRun( unsigned int i );
+  bool onClear( void );
+
+  bool onRunCheck( unsigned int i );
+
+  bool option( const std::vector<std::string>& optionString );
+
+protected:
+  // one way the positions of a mesh are laid out and referenced
+  struct Layout
+  {
+    std::string     name;
+    float const*    points;
+    size_t          stride;
+    size_t          count;
+    void const*     indices;
+    dp::DataType    indexType;
+    size_t          indexCount;
+    double          scalarTime;
+    double          kernelTime;
+  };
+
+  void addLayout( std::string const & name, float const* points, size_t stride, size_t count
+                , void const* indices = nullptr, dp::DataType indexType = dp::DataType::UNKNOWN, size_t indexCount = 0 );
+  void scalarBoundingVolumes( Layout const & layout, dp::math::Box3f & box, dp::math::Sphere3f & sphere ) const;
+  void kernelBoundingVolumes( Layout const & layout, dp::math::Box3f & box, dp::math::Sphere3f & sphere ) const;
+
+protected:
+  std::vector<float>          m_contiguous;
+  std::vector<float>          m_interleaved;
+  std::vector<unsigned int>   m_indices32;
+  std::vector<unsigned short> m_indices16;
+  std::vector<Layout>         m_layouts;
+  unsigned int                m_repetitions;
+  unsigned int                m_vertices;
+};
+
+extern "C"
+{
+  DPTTEST_API dp::testfw::core::Test * create_benchmark_bounding_kernels()
+  {
+    return new Benchmark_bounding_kernels();
+  }
+}
@@ -0,0 +1,269 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <test/testfw/manager/Manager.h>
+#include "benchmark_bounding_spheres.h"
+
+#include <dp/math/Bounds.h>
+#include <dp/math/Quatt.h>
+#include <dp/sg/core/IndexSet.h>
+#include <dp/sg/core/Primitive.h>
+#include <dp/sg/core/VertexAttributeSet.h>
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("benchmark_bounding_spheres", "compares the size and speed of the bounding sphere algorithms", create_benchmark_bounding_spheres);
+
+static const dp::math::BoundingSphereMethod methods[3] = { dp::math::BoundingSphereMethod::BOX_CENTER
+                                                         , dp::math::BoundingSphereMethod::RITTER
+                                                         , dp::math::BoundingSphereMethod::RITTER_REFINED };
+static const char * methodNames[3] = { "box center", "Ritter", "Ritter refined" };
+
+
+Benchmark_bounding_spheres::Benchmark_bounding_spheres()
+  : m_repetitions(4)
+  , m_vertices(1000000)
+{
+}
+
+Benchmark_bounding_spheres::~Benchmark_bounding_spheres()
+{
+}
+
+bool Benchmark_bounding_spheres::onInit()
+{
+  std::mt19937 random( 1 );
+  std::uniform_real_distribution<float> unit( -1.0f, 1.0f );
+  std::normal_distribution<float> normal( 0.0f, 1.0f );
+
+  // rotates the shapes off the axes, where the bounding box fits worst
+  dp::math::Quatf rotation( dp::math::Vec3f( 1.0f, 2.0f, 3.0f ) / sqrt( 14.0f ), 0.7f );
+  std::vector<float> points( 3 * size_t(m_vertices) );
+
+  // points filling a cube, the best case for the box center
+  for ( size_t i = 0; i < points.size(); ++i )
+  {
+    points[i] = 10.0f * unit( random );
+  }
+  addShape( "cube", points );
+
+  // points on the surface of a rotated sphere, as of a tessellated sphere
+  for ( size_t v = 0; v < m_vertices; ++v )
+  {
+    dp::math::Vec3f p( normal( random ), normal( random ), normal( random ) );
+    p = 10.0f * p / std::max( length( p ), std::numeric_limits<float>::min() ) * rotation;
+    std::copy( p.getPtr(), p.getPtr() + 3, &points[3 * v] );
+  }
+  addShape( "sphere", points );
+
+  // a long, thin and rotated cylinder, like a pole or a cable
+  for ( size_t v = 0; v < m_vertices; ++v )
+  {
+    dp::math::Vec3f p( 50.0f * unit( random ), unit( random ), unit( random ) );
+    p = p * rotation;
+    std::copy( p.getPtr(), p.getPtr() + 3, &points[3 * v] );
+  }
+  addShape( "rotated cylinder", points );
+
+  // a dense cluster with a few outliers on one side, like a model with a small antenna
+  for ( size_t v = 0; v < m_vertices; ++v )
+  {
+    dp::math::Vec3f p( normal( random ), normal( random ), normal( random ) );
+    if ( v % 1000 == 0 )
+    {
+      p = dp::math::Vec3f( 20.0f, 20.0f, 20.0f ) + 0.1f * p;
+    }
+    std::copy( p.getPtr(), p.getPtr() + 3, &points[3 * v] );
+  }
+  addShape( "cluster with outliers", points );
+
+  return true;
+}
+
+bool Benchmark_bounding_spheres::onRun( unsigned int i )
+{
+  for ( std::vector<Shape>::iterator it = m_shapes.begin(); it != m_shapes.end(); ++it )
+  {
+    for ( unsigned int m = 0; m < 3; ++m )
+    {
+      dp::util::Timer timer;
+      timer.start();
+      dp::math::Sphere3f sphere = dp::math::boundingSphere( it->points.data(), 3 * sizeof(float), m_vertices, methods[m] );
+      timer.stop();
+      it->time[m] += timer.getTime();
+      it->radius[m] = sphere.getRadius();
+
+      if ( !encloses( sphere, it->points ) )
+      {
+        std::cerr << "Error: the " << methodNames[m] << " sphere does not enclose the " << it->name << "\n";
+        return false;
+      }
+    }
+    if ( ( i == 0 ) && !checkPrimitive( *it ) )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Benchmark_bounding_spheres::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Benchmark_bounding_spheres::onClear()
+{
+  // no bounding sphere can be smaller than half the distance of any two points, so the ratio of each radius to that
+  // lower bound is an upper bound of how far it is from the smallest bounding sphere
+  double repetitions = std::max( 1u, m_repetitions );
+  std::cout << m_vertices << " vertices, radius relative to the lower bound, volume relative to the box center sphere\n";
+  for ( std::vector<Shape>::const_iterator it = m_shapes.begin(); it != m_shapes.end(); ++it )
+  {
+    std::cout << it->name << ":\n";
+    for ( unsigned int m = 0; m < 3; ++m )
+    {
+      double volume = pow( it->radius[m] / it->radius[0], 3.0 );
+      std::cout << "  " << methodNames[m] << ": " << 1000.0 * it->time[m] / repetitions << " ms, radius " << it->radius[m]
+                << " (" << it->radius[m] / it->lowerBound << "), volume " << 100.0 * volume << " %\n";
+    }
+  }
+
+  m_shapes.clear();
+  return true;
+}
+
+void Benchmark_bounding_spheres::addShape( std::string const & name, std::vector<float> & points )
+{
+  Shape shape;
+  shape.name = name;
+  shape.points.swap( points );
+  points.resize( shape.points.size() );
+
+  // half the distance of the point farthest from the first one and the point farthest from that one
+  dp::math::Vec3f const* p = reinterpret_cast<dp::math::Vec3f const*>( shape.points.data() );
+  unsigned int a = dp::math::farthestPoint<3,float>( p, m_vertices, p[0] );
+  unsigned int b = dp::math::farthestPoint<3,float>( p, m_vertices, p[a] );
+  shape.lowerBound = 0.5f * distance( p[a], p[b] );
+
+  std::fill( shape.radius, shape.radius + 3, 0.0f );
+  std::fill( shape.time, shape.time + 3, 0.0 );
+  m_shapes.push_back( shape );
+}
+
+bool Benchmark_bounding_spheres::encloses( dp::math::Sphere3f const & sphere, std::vector<float> const & points ) const
+{
+  // allow for the rounding of the distances
+  float radius = sphere.getRadius() * ( 1.0f + 4.0f * std::numeric_limits<float>::epsilon() );
+  dp::math::Vec3f const* p = reinterpret_cast<dp::math::Vec3f const*>( points.data() );
+  for ( unsigned int v = 0; v < m_vertices; ++v )
+  {
+    if ( radius < distance( p[v], sphere.getCenter() ) )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Benchmark_bounding_spheres::checkPrimitive( Shape const & shape ) const
+{
+  // a Primitive uses the box center sphere unless told otherwise, and then the smaller of the two
+  dp::sg::core::VertexAttributeSetSharedPtr vas = dp::sg::core::VertexAttributeSet::create();
+  vas->setVertices( reinterpret_cast<dp::math::Vec3f const*>( shape.points.data() ), m_vertices );
+
+  // the same points through indices with primitive restarts in between
+  std::vector<unsigned int> indices;
+  for ( unsigned int v = 0; v < m_vertices; ++v )
+  {
+    if ( v % 64 == 0 )
+    {
+      indices.push_back( ~0 );
+    }
+    indices.push_back( v );
+  }
+  dp::sg::core::IndexSetSharedPtr indexSet = dp::sg::core::IndexSet::create();
+  indexSet->setData( indices.data(), dp::checked_cast<unsigned int>( indices.size() ) );
+
+  for ( unsigned int indexed = 0; indexed < 2; ++indexed )
+  {
+    dp::sg::core::PrimitiveSharedPtr primitive = dp::sg::core::Primitive::create( dp::sg::core::PrimitiveType::POINTS );
+    primitive->setVertexAttributeSet( vas );
+    if ( indexed )
+    {
+      primitive->setIndexSet( indexSet );
+    }
+
+    float const expected[2] = { shape.radius[0], std::min( shape.radius[0], shape.radius[1] ) };
+    for ( unsigned int m = 0; m < 2; ++m )
+    {
+      primitive->setBoundingSphereMethod( methods[m] );
+      float radius = primitive->getBoundingSphere().getRadius();
+      if ( std::abs( radius - expected[m] ) > 1e-5f * expected[m] )
+      {
+        std::cerr << "Error: the " << ( indexed ? "indexed " : "" ) << "Primitive of the " << shape.name << " has a " << methodNames[m]
+                  << " sphere of radius " << radius << ", expected " << expected[m] << "\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool Benchmark_bounding_spheres::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: benchmark_bounding_spheres");
+  od.add_options() ( "repetitions", options::value<unsigned int>()->default_value(4), "Number of repetitions" )
+                   ( "vertices", options::value<unsigned int>()->default_value(1000000), "Number of vertices per shape" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_vertices = std::max( 1u, optsMap["vertices"].as<unsigned int>() );
+
+  return true;
+}
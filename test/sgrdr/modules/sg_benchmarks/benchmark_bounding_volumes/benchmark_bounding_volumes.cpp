@@ -0,0 +1,366 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include <test/testfw/manager/Manager.h>
+#include "benchmark_bounding_volumes.h"
+
+#include <dp/sg/algorithm/BoundingVolumes.h>
+#include <dp/sg/core/BufferHost.h>
+#include <dp/sg/core/GeoNode.h>
+#include <dp/sg/core/IndexSet.h>
+#include <dp/sg/core/Primitive.h>
+#include <dp/sg/core/Transform.h>
+#include <dp/sg/core/VertexAttributeSet.h>
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <thread>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("benchmark_bounding_volumes", "tests the parallel calculation of bounding volumes against the lazy serial one", create_benchmark_bounding_volumes);
+
+// that many meshes share one VertexAttributeSet, using different ranges of it
+static const unsigned int meshesPerVertexAttributeSet = 8;
+
+// branching factor of the Transform hierarchy above the GeoNodes
+static const unsigned int childrenPerTransform = 8;
+
+namespace
+{
+  // reads the buffer from within its write notification, like an observer updating a copy of the data
+  class ReadingObserver : public dp::util::Observer
+  {
+  public:
+    ReadingObserver( dp::sg::core::BufferSharedPtr const & buffer )
+      : m_buffer( buffer )
+      , m_first( 0 )
+      , m_notifications( 0 )
+    {
+    }
+
+    void onNotify( dp::util::Event const & event, dp::util::Payload * payload )
+    {
+      m_buffer->getHashKey();
+      dp::sg::core::Buffer::DataReadLock lock( m_buffer );
+      m_first = *lock.getPtr<unsigned int>();
+      ++m_notifications;
+    }
+
+    void onDestroyed( dp::util::Subject const & subject, dp::util::Payload * payload )
+    {
+    }
+
+  public:
+    dp::sg::core::BufferSharedPtr m_buffer;
+    unsigned int                  m_first;
+    unsigned int                  m_notifications;
+  };
+}
+
+
+Benchmark_bounding_volumes::Benchmark_bounding_volumes()
+  : m_repetitions(4)
+  , m_meshes(1024)
+  , m_vertices(8192)
+  , m_threads(0)
+  , m_lazyTime(0.0)
+  , m_parallelTime(0.0)
+  , m_concurrentTime(0.0)
+{
+}
+
+Benchmark_bounding_volumes::~Benchmark_bounding_volumes()
+{
+}
+
+bool Benchmark_bounding_volumes::onInit()
+{
+  if ( !m_threads )
+  {
+    m_threads = std::max( 1u, std::thread::hardware_concurrency() );
+  }
+
+  std::mt19937 random( 1 );
+  std::uniform_real_distribution<float> coordinate( -1.0f, 1.0f );
+  std::vector<dp::math::Vec3f> vertices( meshesPerVertexAttributeSet * m_vertices );
+  std::vector<unsigned int> indices( m_vertices );
+  for ( unsigned int mesh = 0; mesh < m_meshes; mesh += meshesPerVertexAttributeSet )
+  {
+    for ( size_t v = 0; v < vertices.size(); ++v )
+    {
+      vertices[v] = dp::math::Vec3f( coordinate( random ), coordinate( random ), coordinate( random ) );
+    }
+    dp::sg::core::VertexAttributeSetSharedPtr vas = dp::sg::core::VertexAttributeSet::create();
+    vas->setVertices( vertices.data(), dp::checked_cast<unsigned int>( vertices.size() ) );
+    m_vertexAttributeSets.push_back( vas );
+
+    // every other mesh is indexed, referencing its range of vertices in a shuffled order
+    for ( unsigned int i = 1; i < meshesPerVertexAttributeSet; i += 2 )
+    {
+      for ( unsigned int v = 0; v < m_vertices; ++v )
+      {
+        indices[v] = i * m_vertices + v;
+      }
+      std::shuffle( indices.begin(), indices.end(), random );
+      dp::sg::core::IndexSetSharedPtr indexSet = dp::sg::core::IndexSet::create();
+      indexSet->setData( indices.data(), m_vertices );
+      m_indexSets.push_back( indexSet );
+    }
+  }
+
+  // the lazy serial evaluation of the first graph serves as the reference
+  dp::sg::core::NodeSharedPtr root = createGraph();
+  m_referenceBox = root->getBoundingBox();
+  m_referenceSphere = root->getBoundingSphere();
+  return checkReadInWriteNotification();
+}
+
+bool Benchmark_bounding_volumes::onRun( unsigned int i )
+{
+  // lazy evaluation on the first query of the root
+  {
+    dp::sg::core::NodeSharedPtr root = createGraph();
+    dp::util::Timer timer;
+    timer.start();
+    root->getBoundingBox();
+    root->getBoundingSphere();
+    timer.stop();
+    m_lazyTime += timer.getTime();
+    if ( !checkVolumes( root, "lazy" ) )
+    {
+      return false;
+    }
+  }
+
+  // precompute pass, level by level on a WorkerPool
+  {
+    dp::sg::core::NodeSharedPtr root = createGraph();
+    dp::util::Timer timer;
+    timer.start();
+    dp::sg::algorithm::computeBoundingVolumes( root, m_threads );
+    timer.stop();
+    m_parallelTime += timer.getTime();
+    if ( !checkVolumes( root, "parallel" ) )
+    {
+      return false;
+    }
+  }
+
+  // unsynchronized readers querying overlapping parts of a dirty graph at the same time
+  {
+    dp::sg::core::NodeSharedPtr root = createGraph();
+    std::vector<dp::sg::core::NodeSharedPtr> nodes( 1, root );
+    for ( size_t n = 0; n < nodes.size(); ++n )
+    {
+      if ( std::dynamic_pointer_cast<dp::sg::core::Group>( nodes[n] ) )
+      {
+        dp::sg::core::GroupSharedPtr group = std::static_pointer_cast<dp::sg::core::Group>( nodes[n] );
+        nodes.insert( nodes.end(), group->beginChildren(), group->endChildren() );
+      }
+    }
+
+    std::vector<char> correct( m_threads, 0 );
+    std::vector<std::thread> readers;
+    dp::util::Timer timer;
+    timer.start();
+    for ( unsigned int t = 0; t < m_threads; ++t )
+    {
+      readers.push_back( std::thread( [this, t, &nodes, &root, &correct]()
+      {
+        // each reader walks the nodes from a different start, then queries the root
+        size_t start = t * nodes.size() / m_threads;
+        for ( size_t n = 0; n < nodes.size(); ++n )
+        {
+          dp::sg::core::NodeSharedPtr const & node = nodes[( start + n ) % nodes.size()];
+          if ( t & 1 )
+          {
+            node->getBoundingSphere();
+          }
+          else
+          {
+            node->getBoundingBox();
+          }
+        }
+        correct[t] = ( root->getBoundingBox() == m_referenceBox ) && ( root->getBoundingSphere() == m_referenceSphere );
+      } ) );
+    }
+    for ( size_t t = 0; t < readers.size(); ++t )
+    {
+      readers[t].join();
+    }
+    timer.stop();
+    m_concurrentTime += timer.getTime();
+
+    if ( std::find( correct.begin(), correct.end(), 0 ) != correct.end() )
+    {
+      std::cerr << "Error: concurrent readers got different bounding volumes\n";
+      return false;
+    }
+    if ( !checkVolumes( root, "concurrent" ) )
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool Benchmark_bounding_volumes::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Benchmark_bounding_volumes::onClear()
+{
+  m_vertexAttributeSets.clear();
+  m_indexSets.clear();
+
+  double repetitions = std::max( 1u, m_repetitions );
+  std::cout << 2 * m_meshes << " GeoNodes on " << m_meshes << " meshes of " << m_vertices << " vertices, " << m_threads << " threads\n";
+  std::cout << "lazy serial: " << 1000.0 * m_lazyTime / repetitions << " ms\n";
+  std::cout << "computeBoundingVolumes: " << 1000.0 * m_parallelTime / repetitions << " ms\n";
+  std::cout << "concurrent readers: " << 1000.0 * m_concurrentTime / repetitions << " ms\n";
+  return true;
+}
+
+dp::sg::core::NodeSharedPtr Benchmark_bounding_volumes::createGraph() const
+{
+  // each Primitive is instanced by two GeoNodes in different places of the graph
+  std::vector<dp::sg::core::NodeSharedPtr> nodes( 2 * m_meshes );
+  for ( unsigned int mesh = 0; mesh < m_meshes; ++mesh )
+  {
+    unsigned int i = mesh % meshesPerVertexAttributeSet;
+    dp::sg::core::PrimitiveSharedPtr primitive = dp::sg::core::Primitive::create( dp::sg::core::PrimitiveType::POINTS );
+    primitive->setVertexAttributeSet( m_vertexAttributeSets[mesh / meshesPerVertexAttributeSet] );
+    if ( i & 1 )
+    {
+      primitive->setIndexSet( m_indexSets[mesh / 2] );
+    }
+    else
+    {
+      primitive->setElementRange( i * m_vertices, m_vertices );
+    }
+
+    for ( unsigned int instance = 0; instance < 2; ++instance )
+    {
+      dp::sg::core::GeoNodeSharedPtr geoNode = dp::sg::core::GeoNode::create();
+      geoNode->setPrimitive( primitive );
+      nodes[instance * m_meshes + mesh] = geoNode;
+    }
+  }
+
+  for ( unsigned int level = 0; nodes.size() > 1; ++level )
+  {
+    std::vector<dp::sg::core::NodeSharedPtr> parents;
+    for ( size_t n = 0; n < nodes.size(); n += childrenPerTransform )
+    {
+      dp::sg::core::TransformSharedPtr transform = dp::sg::core::Transform::create();
+      transform->setTranslation( dp::math::Vec3f( float( n ), float( level ), 0.0f ) );
+      for ( size_t c = n; c < std::min( nodes.size(), n + childrenPerTransform ); ++c )
+      {
+        transform->addChild( nodes[c] );
+      }
+      parents.push_back( transform );
+    }
+    nodes.swap( parents );
+  }
+  return nodes.front();
+}
+
+bool Benchmark_bounding_volumes::checkVolumes( dp::sg::core::NodeSharedPtr const & root, char const * what ) const
+{
+  if ( ( root->getBoundingBox() != m_referenceBox ) || ( root->getBoundingSphere() != m_referenceSphere ) )
+  {
+    std::cerr << "Error: the " << what << " bounding volumes differ from the reference\n";
+    return false;
+  }
+  return true;
+}
+
+bool Benchmark_bounding_volumes::checkReadInWriteNotification() const
+{
+  // the buffer must not be locked any more while its observers are notified about a write, or reading it deadlocks
+  dp::sg::core::BufferHostSharedPtr buffer = dp::sg::core::BufferHost::create();
+  buffer->setSize( 16 * sizeof(unsigned int) );
+  ReadingObserver observer( buffer );
+  buffer->attach( &observer );
+
+  {
+    dp::sg::core::Buffer::DataWriteLock lock( buffer, dp::sg::core::Buffer::MapMode::WRITE );
+    *lock.getPtr<unsigned int>() = 1;
+  }
+  unsigned int lockedFirst = observer.m_first;
+
+  unsigned int value = 2;
+  buffer->setData( 0, sizeof(value), &value );
+
+  buffer->detach( &observer );
+  if ( observer.m_notifications != 2 || lockedFirst != 1 || observer.m_first != 2 )
+  {
+    std::cerr << "Error: the write notifications read " << lockedFirst << " and " << observer.m_first << " in "
+              << observer.m_notifications << " notifications, expected 1 and 2 in 2\n";
+    return false;
+  }
+  return true;
+}
+
+bool Benchmark_bounding_volumes::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: benchmark_bounding_volumes");
+  od.add_options() ( "repetitions", options::value<unsigned int>()->default_value(4), "Number of repetitions" )
+                   ( "meshes", options::value<unsigned int>()->default_value(1024), "Number of meshes, each instanced twice" )
+                   ( "vertices", options::value<unsigned int>()->default_value(8192), "Number of vertices per mesh" )
+                   ( "threads", options::value<unsigned int>()->default_value(0), "Number of threads, 0 for the number of hardware threads" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_meshes = std::max( 1u, optsMap["meshes"].as<unsigned int>() + meshesPerVertexAttributeSet - 1 ) / meshesPerVertexAttributeSet * meshesPerVertexAttributeSet;
+  m_vertices = std::max( 1u, optsMap["vertices"].as<unsigned int>() );
+  m_threads = optsMap["threads"].as<unsigned int>();
+
+  return true;
+}
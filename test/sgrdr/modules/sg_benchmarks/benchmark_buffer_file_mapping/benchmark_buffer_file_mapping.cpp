@@ -0,0 +1,282 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <test/testfw/manager/Manager.h>
+#include "benchmark_buffer_file_mapping.h"
+
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("benchmark_buffer_file_mapping", "tests buffers referencing a file mapping against buffers copying the file", create_benchmark_buffer_file_mapping);
+
+namespace
+{
+  // returns true if creating a buffer for the range reports the failed mapping
+  bool failsToMap( std::shared_ptr<dp::util::ReadMapping> const & mapping, size_t offset, size_t size )
+  {
+    try
+    {
+      dp::sg::core::BufferFileMapping::create( mapping, offset, size );
+    }
+    catch ( std::runtime_error const & )
+    {
+      return true;
+    }
+    return false;
+  }
+}
+
+
+Benchmark_buffer_file_mapping::Benchmark_buffer_file_mapping()
+  : m_fileName("benchmark_buffer_file_mapping.bin")
+  , m_repetitions(4)
+  , m_bufferCount(1024)
+  , m_bufferSize(256 * 1024)
+  , m_copyTime(0.0)
+  , m_mapTime(0.0)
+{
+}
+
+Benchmark_buffer_file_mapping::~Benchmark_buffer_file_mapping()
+{
+}
+
+bool Benchmark_buffer_file_mapping::onInit()
+{
+  // the file holds the buffers one after the other, each word is its index in the file
+  std::ofstream file( m_fileName.c_str(), std::ios::binary | std::ios::trunc );
+  std::vector<unsigned int> data( m_bufferSize / sizeof(unsigned int) );
+  for ( unsigned int b = 0; b < m_bufferCount; ++b )
+  {
+    for ( size_t i = 0; i < data.size(); ++i )
+    {
+      data[i] = dp::checked_cast<unsigned int>(b * data.size() + i);
+    }
+    file.write( reinterpret_cast<const char *>(data.data()), m_bufferSize );
+  }
+  if ( !file )
+  {
+    std::cerr << "Error: cannot write " << m_fileName << "\n";
+    return false;
+  }
+  file.close();
+  return checkMappingErrors();
+}
+
+bool Benchmark_buffer_file_mapping::onRun( unsigned int i )
+{
+  std::shared_ptr<dp::util::ReadMapping> mapping = std::make_shared<dp::util::ReadMapping>( m_fileName );
+  if ( !mapping->isValid() )
+  {
+    std::cerr << "Error: cannot map " << m_fileName << "\n";
+    return false;
+  }
+
+  // what the loaders did before: copy the mapped bytes into BufferHosts
+  std::vector<dp::sg::core::BufferSharedPtr> copies( m_bufferCount );
+  dp::util::Timer timer;
+  timer.start();
+  for ( unsigned int b = 0; b < m_bufferCount; ++b )
+  {
+    dp::sg::core::BufferHostSharedPtr buffer = dp::sg::core::BufferHost::create();
+    buffer->setSize( m_bufferSize );
+    const void * data = mapping->mapIn( b * m_bufferSize, m_bufferSize );
+    buffer->setData( 0, m_bufferSize, data );
+    mapping->mapOut( data );
+    copies[b] = buffer;
+  }
+  timer.stop();
+  m_copyTime += timer.getTime();
+
+  std::vector<dp::sg::core::BufferSharedPtr> buffers( m_bufferCount );
+  timer.restart();
+  for ( unsigned int b = 0; b < m_bufferCount; ++b )
+  {
+    buffers[b] = dp::sg::core::BufferFileMapping::create( mapping, b * m_bufferSize, m_bufferSize );
+  }
+  timer.stop();
+  m_mapTime += timer.getTime();
+
+  bool ok = checkData( copies ) && checkData( buffers )
+         && checkCopyOnWrite( std::static_pointer_cast<dp::sg::core::BufferFileMapping>( buffers[i % m_bufferCount] ) );
+
+  // the buffers keep the mapping alive until the last one is gone
+  std::weak_ptr<dp::util::ReadMapping> weakMapping( mapping );
+  mapping.reset();
+  copies.clear();
+  if ( ok && weakMapping.expired() )
+  {
+    std::cerr << "Error: the mapping has been released while buffers reference it\n";
+    ok = false;
+  }
+  buffers.clear();
+  if ( ok && !weakMapping.expired() )
+  {
+    std::cerr << "Error: the mapping has not been released with the buffers\n";
+    ok = false;
+  }
+  return ok;
+}
+
+bool Benchmark_buffer_file_mapping::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Benchmark_buffer_file_mapping::onClear()
+{
+  std::remove( m_fileName.c_str() );
+
+  unsigned int repetitions = std::max( 1u, m_repetitions );
+  std::cout << m_bufferCount << " buffers of " << m_bufferSize / 1024 << " kB\n";
+  std::cout << "copied: " << 1000.0 * m_copyTime / repetitions << " ms, " << m_bufferCount * m_bufferSize / ( 1024 * 1024 ) << " MB on the heap\n";
+  std::cout << "mapped: " << 1000.0 * m_mapTime / repetitions << " ms, 0 MB on the heap\n";
+  return true;
+}
+
+bool Benchmark_buffer_file_mapping::checkData( std::vector<dp::sg::core::BufferSharedPtr> const & buffers ) const
+{
+  size_t words = m_bufferSize / sizeof(unsigned int);
+  for ( unsigned int b = 0; b < buffers.size(); ++b )
+  {
+    dp::sg::core::Buffer::DataReadLock lock( buffers[b] );
+    const unsigned int * data = lock.getPtr<unsigned int>();
+    for ( size_t i = 0; i < words; ++i )
+    {
+      if ( data[i] != b * words + i )
+      {
+        std::cerr << "Error: word " << i << " of buffer " << b << " is " << data[i] << "\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool Benchmark_buffer_file_mapping::checkCopyOnWrite( dp::sg::core::BufferFileMappingSharedPtr const & buffer ) const
+{
+  dp::sg::core::BufferFileMappingSharedPtr clone = std::static_pointer_cast<dp::sg::core::BufferFileMapping>( buffer->clone() );
+  if ( !buffer->isFileMapped() || !clone->isFileMapped() || ( buffer->getHashKey() != clone->getHashKey() ) )
+  {
+    std::cerr << "Error: the clone of a mapped buffer does not share the mapping\n";
+    return false;
+  }
+
+  // writing the clone copies it, the original and the file stay untouched
+  unsigned int first;
+  buffer->getData( 0, sizeof(first), &first );
+  unsigned int value = ~first;
+  clone->setData( 0, sizeof(value), &value );
+
+  unsigned int cloneFirst, bufferFirst;
+  clone->getData( 0, sizeof(cloneFirst), &cloneFirst );
+  buffer->getData( 0, sizeof(bufferFirst), &bufferFirst );
+  if ( clone->isFileMapped() || !buffer->isFileMapped() || ( cloneFirst != value ) || ( bufferFirst != first ) )
+  {
+    std::cerr << "Error: writing a mapped buffer did not copy it\n";
+    return false;
+  }
+
+  dp::util::ReadMapping file( m_fileName );
+  size_t words = m_bufferSize / sizeof(unsigned int);
+  for ( size_t b = 0; b < m_bufferCount; ++b )
+  {
+    const unsigned int * data = reinterpret_cast<const unsigned int *>( file.mapIn( b * m_bufferSize, sizeof(unsigned int) ) );
+    bool unchanged = ( *data == b * words );
+    file.mapOut( data );
+    if ( !unchanged )
+    {
+      std::cerr << "Error: writing a mapped buffer changed the file\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Benchmark_buffer_file_mapping::checkMappingErrors() const
+{
+  std::shared_ptr<dp::util::ReadMapping> mapping = std::make_shared<dp::util::ReadMapping>( m_fileName );
+  if ( !mapping->isValid() )
+  {
+    std::cerr << "Error: cannot map " << m_fileName << "\n";
+    return false;
+  }
+  if ( !failsToMap( mapping, m_bufferCount * m_bufferSize - sizeof(unsigned int), 2 * sizeof(unsigned int) ) )
+  {
+    std::cerr << "Error: mapping a range past the end of " << m_fileName << " has not been reported\n";
+    return false;
+  }
+
+  // a directory can be opened, but not be mapped
+  std::shared_ptr<dp::util::ReadMapping> directory = std::make_shared<dp::util::ReadMapping>( "." );
+  if ( directory->isValid() && !failsToMap( directory, 0, 1 ) )
+  {
+    std::cerr << "Error: mapping a directory has not been reported\n";
+    return false;
+  }
+  return true;
+}
+
+bool Benchmark_buffer_file_mapping::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: benchmark_buffer_file_mapping");
+  od.add_options() ( "repetitions", options::value<unsigned int>()->default_value(4), "Number of repetitions" )
+                   ( "buffers", options::value<unsigned int>()->default_value(1024), "Number of buffers in the file" )
+                   ( "size", options::value<unsigned int>()->default_value(256), "Size of each buffer in kB" )
+                   ( "file", options::value<std::string>()->default_value("benchmark_buffer_file_mapping.bin"), "Temporary file to map" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_bufferCount = std::max( 1u, optsMap["buffers"].as<unsigned int>() );
+  m_bufferSize = std::max( 1u, optsMap["size"].as<unsigned int>() ) * size_t(1024);
+  m_fileName = optsMap["file"].as<std::string>();
+
+  return true;
+}
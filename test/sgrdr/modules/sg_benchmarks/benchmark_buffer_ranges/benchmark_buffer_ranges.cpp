@@ -0,0 +1,258 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <test/testfw/manager/Manager.h>
+#include "benchmark_buffer_ranges.h"
+
+#include <dp/util/HashGeneratorMurMur.h>
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("benchmark_buffer_ranges", "tests the written ranges and the incremental hash key of partially written buffers", create_benchmark_buffer_ranges);
+
+
+Benchmark_buffer_ranges::RangeObserver::RangeObserver()
+  : m_eventCount(0)
+{
+}
+
+void Benchmark_buffer_ranges::RangeObserver::onNotify( dp::util::Event const & event, dp::util::Payload * payload )
+{
+  dp::sg::core::Buffer::Event const & bufferEvent = static_cast<dp::sg::core::Buffer::Event const &>(event);
+  m_ranges.add( bufferEvent.getOffset(), bufferEvent.getLength() );
+  ++m_eventCount;
+}
+
+void Benchmark_buffer_ranges::RangeObserver::onDestroyed( dp::util::Subject const & subject, dp::util::Payload * payload )
+{
+}
+
+
+Benchmark_buffer_ranges::Benchmark_buffer_ranges()
+  : m_repetitions(4)
+  , m_frames(16)
+  , m_size(256 * 1024 * 1024)
+  , m_writes(256)
+  , m_changedFraction(0.01)
+  , m_uploadBytes(0)
+  , m_eventCount(0)
+  , m_fullHashTime(0.0)
+  , m_hashTime(0.0)
+{
+}
+
+Benchmark_buffer_ranges::~Benchmark_buffer_ranges()
+{
+}
+
+bool Benchmark_buffer_ranges::onInit()
+{
+  m_buffer = dp::sg::core::BufferHost::create();
+  m_buffer->setSize( m_size );
+  {
+    dp::sg::core::Buffer::DataWriteLock lock( m_buffer, dp::sg::core::Buffer::MapMode::WRITE );
+    unsigned int * data = lock.getPtr<unsigned int>();
+    for ( size_t i = 0; i < m_size / sizeof(unsigned int); ++i )
+    {
+      data[i] = dp::checked_cast<unsigned int>(i);
+    }
+  }
+  m_buffer->getHashKey();
+  m_buffer->attach( &m_observer );
+  return true;
+}
+
+bool Benchmark_buffer_ranges::onRun( unsigned int i )
+{
+  // each frame writes m_changedFraction of the buffer in m_writes pieces, every other one through a write lock
+  std::mt19937 random( i );
+  size_t writeSize = std::max( size_t(1), size_t( m_changedFraction * m_size / m_writes ) );
+  std::uniform_int_distribution<size_t> offsetDistribution( 0, m_size - writeSize );
+  std::vector<char> values( writeSize );
+
+  for ( unsigned int frame = 0; frame < m_frames; ++frame )
+  {
+    std::vector<dp::sg::core::Buffer::Range> written;
+    for ( unsigned int w = 0; w < m_writes; ++w )
+    {
+      size_t offset = offsetDistribution( random );
+      std::fill( values.begin(), values.end(), char( frame + w ) );
+      if ( w & 1 )
+      {
+        dp::sg::core::Buffer::DataWriteLock lock( m_buffer, dp::sg::core::Buffer::MapMode::WRITE, offset, writeSize );
+        memcpy( lock.getPtr(), values.data(), writeSize );
+      }
+      else
+      {
+        m_buffer->setData( offset, writeSize, values.data() );
+      }
+      dp::sg::core::Buffer::Range range = { offset, writeSize };
+      written.push_back( range );
+    }
+
+    if ( !checkRanges( written ) )
+    {
+      return false;
+    }
+    m_uploadBytes += m_observer.m_ranges.getByteCount();
+    m_eventCount += m_observer.m_eventCount;
+    m_observer.m_ranges.clear();
+    m_observer.m_eventCount = 0;
+
+    dp::util::Timer timer;
+    timer.start();
+    m_buffer->getHashKey();
+    timer.stop();
+    m_hashTime += timer.getTime();
+  }
+
+  // what each frame did before: hashing the whole buffer
+  dp::util::Timer timer;
+  timer.start();
+  {
+    dp::sg::core::Buffer::DataReadLock lock( m_buffer );
+    dp::util::HashGeneratorMurMur hg;
+    hg.update( lock.getPtr<unsigned char>(), dp::checked_cast<unsigned int>(m_size) );
+    dp::util::HashKey key;
+    hg.finalize( &key );
+  }
+  timer.stop();
+  m_fullHashTime += m_frames * timer.getTime();
+
+  return checkHashKey();
+}
+
+bool Benchmark_buffer_ranges::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Benchmark_buffer_ranges::onClear()
+{
+  m_buffer->detach( &m_observer );
+  m_buffer.reset();
+
+  double frames = std::max( 1u, m_repetitions ) * double( m_frames );
+  std::cout << m_size / ( 1024 * 1024 ) << " MB buffer, " << m_writes << " writes of " << 100.0 * m_changedFraction << "% per frame, "
+            << m_eventCount / frames << " events\n";
+  std::cout << "upload: " << m_uploadBytes / ( 1024.0 * frames ) << " kB/frame instead of " << m_size / 1024 << " kB\n";
+  std::cout << "hash key: " << 1000.0 * m_hashTime / frames << " ms/frame instead of " << 1000.0 * m_fullHashTime / frames << " ms\n";
+  return true;
+}
+
+bool Benchmark_buffer_ranges::checkRanges( std::vector<dp::sg::core::Buffer::Range> written ) const
+{
+  // merge the written ranges the simple way and compare with what the observer collected
+  std::sort( written.begin(), written.end(), []( dp::sg::core::Buffer::Range const & lhs, dp::sg::core::Buffer::Range const & rhs ) { return lhs.offset < rhs.offset; } );
+  std::vector<dp::sg::core::Buffer::Range> merged;
+  for ( size_t i = 0; i < written.size(); ++i )
+  {
+    if ( !merged.empty() && written[i].offset <= merged.back().offset + merged.back().length )
+    {
+      merged.back().length = std::max( merged.back().offset + merged.back().length, written[i].offset + written[i].length ) - merged.back().offset;
+    }
+    else
+    {
+      merged.push_back( written[i] );
+    }
+  }
+
+  std::vector<dp::sg::core::Buffer::Range> const & ranges = m_observer.m_ranges.getRanges();
+  bool equal = ( ranges.size() == merged.size() );
+  for ( size_t i = 0; equal && i < merged.size(); ++i )
+  {
+    equal = ( ranges[i].offset == merged[i].offset ) && ( ranges[i].length == merged[i].length );
+  }
+  if ( !equal )
+  {
+    std::cerr << "Error: " << ranges.size() << " ranges collected, " << merged.size() << " ranges written\n";
+    return false;
+  }
+  if ( m_observer.m_eventCount != m_writes )
+  {
+    std::cerr << "Error: " << m_observer.m_eventCount << " events for " << m_writes << " writes\n";
+    return false;
+  }
+  return true;
+}
+
+bool Benchmark_buffer_ranges::checkHashKey() const
+{
+  // a new buffer with the same data has to get the same hash key
+  dp::sg::core::BufferHostSharedPtr buffer = dp::sg::core::BufferHost::create();
+  buffer->setSize( m_size );
+  {
+    dp::sg::core::Buffer::DataReadLock lock( m_buffer );
+    buffer->setData( 0, m_size, lock.getPtr() );
+  }
+  if ( buffer->getHashKey() != m_buffer->getHashKey() )
+  {
+    std::cerr << "Error: the incremental hash key differs from the hash key of the data\n";
+    return false;
+  }
+  return true;
+}
+
+bool Benchmark_buffer_ranges::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: benchmark_buffer_ranges");
+  od.add_options() ( "repetitions", options::value<unsigned int>()->default_value(4), "Number of repetitions" )
+                   ( "frames", options::value<unsigned int>()->default_value(16), "Number of frames per repetition" )
+                   ( "size", options::value<unsigned int>()->default_value(256), "Size of the buffer in MB" )
+                   ( "writes", options::value<unsigned int>()->default_value(256), "Number of writes per frame" )
+                   ( "changed", options::value<double>()->default_value(1.0), "Percentage of the buffer written per frame" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_frames = optsMap["frames"].as<unsigned int>();
+  m_size = std::max( 1u, optsMap["size"].as<unsigned int>() ) * size_t(1024 * 1024);
+  m_writes = std::max( 1u, optsMap["writes"].as<unsigned int>() );
+  m_changedFraction = std::min( 100.0, std::max( 0.0, optsMap["changed"].as<double>() ) ) / 100.0;
+
+  return true;
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <test/testfw/core/Test.h>
+#include <dp/sg/core/BufferHost.h>
+#include <dp/util/Observer.h>
+#include <string>
+#include <vector>
+
+class Benchmark_buffer_ranges : public dp::testfw::core::Test
+{
+public:
+  Benchmark_buffer_ranges();
+  ~Benchmark_buffer_ranges();
+
+  bool onInit( void );
+  bool onRun( unsigned int i );
+  bool onClear( void );
+
+  bool onRunCheck( unsigned int i );
+
+  bool option( const std::vector<std::string>& optionString );
+
+protected:
+  // collects the written ranges like a renderer resource does until its next update
+  class RangeObserver : public dp::util::Observer
+  {
+  public:
+    RangeObserver();
+
+    void onNotify( dp::util::Event const & event, dp::util::Payload * payload );
+    void onDestroyed( dp::util::Subject const & subject, dp::util::Payload * payload );
+
+  public:
+    dp::sg::core::Buffer::RangeList m_ranges;
+    size_t                          m_eventCount;
+  };
+
+  bool checkRanges( std::vector<dp::sg::core::Buffer::Range> written ) const;
+  bool checkHashKey() const;
+
+protected:
+  dp::sg::core::BufferHostSharedPtr m_buffer;
+  RangeObserver                     m_observer;
+  unsigned int                      m_repetitions;
+  unsigned int                      m_frames;
+  size_t                            m_size;
+  unsigned int                      m_writes;
+  double                            m_changedFraction;
+  size_t                            m_uploadBytes;
+  size_t                            m_eventCount;
+  double                            m_fullHashTime;
+  double                            m_hashTime;
+};
+
+extern "C"
+{
+  DPTTEST_API dp::testfw::core::Test * create_benchmark_buffer_ranges()
+  {
+    return new Benchmark_buffer_ranges();
+  }
+}
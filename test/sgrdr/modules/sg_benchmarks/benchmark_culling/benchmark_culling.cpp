@@ -0,0 +1,431 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <test/testfw/manager/Manager.h>
+#include "benchmark_culling.h"
+
+#include <dp/culling/cpu/Manager.h>
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("benchmark_culling", "tests performance of the cpu culling algorithms", create_benchmark_culling);
+
+
+Benchmark_culling::Benchmark_culling()
+  : m_repetitions(32)
+  , m_threadCount(0)
+  , m_animatedObjects(100)
+  , m_framesPerCircle(32)
+  , m_occluderCount(16)
+{
+}
+
+Benchmark_culling::~Benchmark_culling()
+{
+}
+
+bool Benchmark_culling::onInit()
+{
+  for ( size_t i = 0; i < m_objectCounts.size(); ++i )
+  {
+    createScene( m_objectCounts[i] );
+  }
+  return true;
+}
+
+bool Benchmark_culling::onRun( unsigned int i )
+{
+  bool success = true;
+  for ( size_t s = 0; s < m_scenes.size(); ++s )
+  {
+    Scene & scene = m_scenes[s];
+    dp::math::Mat44f viewProjection = getViewProjection( scene, i );
+    animateScene( scene );
+
+    for ( size_t c = 0; c < scene.configurations.size(); ++c )
+    {
+      Configuration & configuration = scene.configurations[c];
+
+      dp::util::Timer timer;
+      timer.start();
+      configuration.manager->cull( configuration.group, configuration.result, viewProjection );
+      timer.stop();
+      configuration.time += timer.getTime();
+    }
+
+    // all configurations have to agree with the first one, which is the reference implementation
+    Configuration const & reference = scene.configurations.front();
+    for ( size_t c = 1; c < scene.configurations.size(); ++c )
+    {
+      Configuration const & configuration = scene.configurations[c];
+      for ( size_t o = 0; o < scene.objectCount; ++o )
+      {
+        if (    reference.manager->resultObjectIsVisible( reference.result, reference.objects[o] )
+            !=  configuration.manager->resultObjectIsVisible( configuration.result, configuration.objects[o] ) )
+        {
+          std::cerr << "Error: " << configuration.name << " differs from " << reference.name << " for object " << o << " of " << scene.objectCount << " in frame " << i << "\n";
+          success = false;
+          break;
+        }
+      }
+    }
+
+    if ( m_occluderCount )
+    {
+      success &= runOcclusion( scene, viewProjection, i );
+    }
+  }
+  return success;
+}
+
+bool Benchmark_culling::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Benchmark_culling::onClear()
+{
+  for ( size_t s = 0; s < m_scenes.size(); ++s )
+  {
+    Scene const & scene = m_scenes[s];
+    for ( size_t c = 0; c < scene.configurations.size(); ++c )
+    {
+      Configuration const & configuration = scene.configurations[c];
+      std::cout << scene.objectCount << " objects, " << configuration.name << ": " << 1000.0 * configuration.time / m_repetitions << " ms/frame\n";
+    }
+
+    if ( m_occluderCount )
+    {
+      Occlusion const & occlusion = scene.occlusion;
+      std::cout << scene.objectCount << " objects, cpu flat + occlusion with " << scene.walls.size() << " walls: " << 1000.0 * occlusion.time / m_repetitions << " ms/frame, "
+                << 100.0 * occlusion.occludedObjects / std::max( size_t(1), occlusion.testedObjects ) << "% of the objects in the frustum occluded\n";
+    }
+  }
+  m_scenes.clear();
+
+  return true;
+}
+
+void Benchmark_culling::createScene( size_t objectCount )
+{
+  m_scenes.push_back( Scene() );
+  Scene & scene = m_scenes.back();
+  scene.objectCount = objectCount;
+
+  // distribute the objects in a cube around the origin with a constant density of one object per 1000 units^3
+  scene.extent = 10.0f * std::pow( float(objectCount), 1.0f / 3.0f );
+  scene.generator.seed( 1 );
+  std::uniform_real_distribution<float> distribution( -0.5f * scene.extent, 0.5f * scene.extent );
+
+  // the additional last matrix places the walls of the occlusion test
+  scene.matrices.resize( objectCount + 1 );
+  for ( size_t i = 0; i < objectCount; ++i )
+  {
+    scene.matrices[i] = dp::math::Mat44f( { 1.0f, 0.0f, 0.0f, 0.0f
+                                          , 0.0f, 1.0f, 0.0f, 0.0f
+                                          , 0.0f, 0.0f, 1.0f, 0.0f
+                                          , distribution( scene.generator ), distribution( scene.generator ), distribution( scene.generator ), 1.0f } );
+  }
+  scene.matrices[objectCount] = dp::math::cIdentity44f;
+
+  // the single threaded scalar flat culling is the reference for all other configurations
+  dp::culling::cpu::Manager * reference = dp::culling::cpu::Manager::create( dp::culling::cpu::Manager::Algorithm::FLAT );
+  reference->setThreadCount( 1 );
+  reference->setInstructionSet( dp::culling::cpu::Manager::InstructionSet::SCALAR );
+  addConfiguration( scene, "cpu flat scalar", reference );
+
+  struct
+  {
+    dp::culling::cpu::Manager::InstructionSet instructionSet;
+    char const*                               name;
+  } const instructionSets[] =
+  {
+      { dp::culling::cpu::Manager::InstructionSet::SSE4_1, "cpu flat sse4.1" }
+    , { dp::culling::cpu::Manager::InstructionSet::AVX2, "cpu flat avx2" }
+    , { dp::culling::cpu::Manager::InstructionSet::NEON, "cpu flat neon" }
+  };
+  for ( size_t i = 0; i < sizeof(instructionSets) / sizeof(instructionSets[0]); ++i )
+  {
+    if ( dp::culling::cpu::Manager::isInstructionSetSupported( instructionSets[i].instructionSet ) )
+    {
+      dp::culling::cpu::Manager * manager = dp::culling::cpu::Manager::create( dp::culling::cpu::Manager::Algorithm::FLAT );
+      manager->setThreadCount( 1 );
+      manager->setInstructionSet( instructionSets[i].instructionSet );
+      addConfiguration( scene, instructionSets[i].name, manager );
+    }
+  }
+
+  dp::culling::cpu::Manager * threaded = dp::culling::cpu::Manager::create( dp::culling::cpu::Manager::Algorithm::FLAT );
+  threaded->setThreadCount( m_threadCount );
+  addConfiguration( scene, "cpu flat multithreaded", threaded );
+
+  dp::culling::cpu::Manager * coherent = dp::culling::cpu::Manager::create( dp::culling::cpu::Manager::Algorithm::FLAT );
+  coherent->setThreadCount( 1 );
+  coherent->setTemporalCoherence( true );
+  addConfiguration( scene, "cpu flat coherent", coherent );
+
+  dp::culling::cpu::Manager * coherentThreaded = dp::culling::cpu::Manager::create( dp::culling::cpu::Manager::Algorithm::FLAT );
+  coherentThreaded->setThreadCount( m_threadCount );
+  coherentThreaded->setTemporalCoherence( true );
+  addConfiguration( scene, "cpu flat coherent multithreaded", coherentThreaded );
+
+  addConfiguration( scene, "cpu bvh", dp::culling::cpu::Manager::create( dp::culling::cpu::Manager::Algorithm::BVH ) );
+
+  if ( m_occluderCount )
+  {
+    createOcclusion( scene );
+  }
+}
+
+void Benchmark_culling::createOcclusion( Scene & scene )
+{
+  Occlusion & occlusion = scene.occlusion;
+  occlusion.manager.reset( dp::culling::cpu::Manager::create( dp::culling::cpu::Manager::Algorithm::FLAT ) );
+  occlusion.manager->setThreadCount( m_threadCount );
+  occlusion.group = occlusion.manager->groupCreate();
+  occlusion.time = 0.0;
+  occlusion.testedObjects = 0;
+  occlusion.occludedObjects = 0;
+
+  dp::math::Box3f box( dp::math::Vec3f( -1.0f, -1.0f, -1.0f ), dp::math::Vec3f( 1.0f, 1.0f, 1.0f ) );
+  occlusion.objects.reserve( scene.objectCount );
+  for ( size_t i = 0; i < scene.objectCount; ++i )
+  {
+    dp::culling::ObjectSharedPtr object = occlusion.manager->objectCreate( dp::culling::PayloadSharedPtr() );
+    occlusion.manager->objectSetTransformIndex( object, i );
+    occlusion.manager->objectSetBoundingBox( object, box );
+    occlusion.manager->groupAddObject( occlusion.group, object );
+    occlusion.objects.push_back( object );
+  }
+
+  // vertical walls through the whole height of the scene, each a fifth of the scene wide
+  float const halfExtent = 0.5f * scene.extent;
+  std::uniform_real_distribution<float> distribution( -halfExtent, halfExtent );
+  for ( unsigned int i = 0; i < m_occluderCount; ++i )
+  {
+    Wall wall;
+    wall.axis = ( i & 1 ) ? 2 : 0;
+    wall.position = distribution( scene.generator );
+    wall.lower = distribution( scene.generator ) - 0.1f * scene.extent;
+    wall.upper = wall.lower + 0.2f * scene.extent;
+    scene.walls.push_back( wall );
+
+    unsigned int const other = 2 - wall.axis;
+    dp::math::Vec3f vertices[4];
+    for ( unsigned int v = 0; v < 4; ++v )
+    {
+      vertices[v][wall.axis] = wall.position;
+      vertices[v][other] = ( v == 1 || v == 2 ) ? wall.upper : wall.lower;
+      vertices[v][1] = ( v < 2 ) ? -halfExtent : halfExtent;
+    }
+    uint32_t const indices[] = { 0, 1, 2, 0, 2, 3 };
+
+    dp::culling::cpu::OccluderSharedPtr occluder = occlusion.manager->occluderCreate( vertices, 4, indices, 6 );
+    occlusion.manager->occluderSetTransformIndex( occluder, scene.objectCount );
+    occlusion.manager->groupAddOccluder( occlusion.group, occluder );
+  }
+
+  occlusion.manager->groupSetMatrices( occlusion.group, scene.matrices.data(), scene.matrices.size(), sizeof(dp::math::Mat44f) );
+  occlusion.frustumResult = occlusion.manager->groupCreateResult( occlusion.group );
+  occlusion.occlusionResult = occlusion.manager->groupCreateResult( occlusion.group );
+}
+
+bool Benchmark_culling::runOcclusion( Scene & scene, dp::math::Mat44f const & viewProjection, unsigned int frame )
+{
+  Occlusion & occlusion = scene.occlusion;
+
+  dp::util::Timer timer;
+  timer.start();
+  occlusion.manager->cull( occlusion.group, occlusion.frustumResult, viewProjection );
+  occlusion.manager->cullOcclusion( occlusion.group, occlusion.frustumResult, occlusion.occlusionResult, viewProjection );
+  timer.stop();
+  occlusion.time += timer.getTime();
+
+  dp::culling::cpu::Manager::OcclusionStatistics const & statistics = occlusion.manager->getOcclusionStatistics();
+  occlusion.testedObjects += statistics.testedObjects;
+  occlusion.occludedObjects += statistics.occludedObjects;
+
+  // The center of an occluded object must be hidden behind a wall. The walls are enlarged by two pixels of the
+  // occlusion buffer, because occluders are sampled at the pixel centers.
+  dp::math::Vec3f const eye = getEye( scene, frame );
+  dp::math::Vec2ui const bufferSize = occlusion.manager->getOcclusionBufferSize();
+  float const pixelSize = 2.0f * std::tan( 0.5f * dp::math::degToRad( 45.0f ) ) / bufferSize[1];
+  float const halfExtent = 0.5f * scene.extent;
+
+  for ( size_t o = 0; o < scene.objectCount; ++o )
+  {
+    if ( occlusion.manager->resultObjectIsVisible( occlusion.occlusionResult, occlusion.objects[o] ) )
+    {
+      continue;
+    }
+
+    dp::math::Vec3f const center( scene.matrices[o][3][0], scene.matrices[o][3][1], scene.matrices[o][3][2] );
+    float const tolerance = 2.0f * pixelSize * dp::math::length( center - eye );
+
+    bool hidden = false;
+    for ( size_t w = 0; w < scene.walls.size() && !hidden; ++w )
+    {
+      Wall const & wall = scene.walls[w];
+      float const denominator = center[wall.axis] - eye[wall.axis];
+      float const t = ( denominator != 0.0f ) ? ( wall.position - eye[wall.axis] ) / denominator : -1.0f;
+      if ( 0.0f < t && t < 1.0f )
+      {
+        dp::math::Vec3f const hit = eye + t * ( center - eye );
+        unsigned int const other = 2 - wall.axis;
+        hidden =    wall.lower - tolerance <= hit[other] && hit[other] <= wall.upper + tolerance
+                 && -halfExtent - tolerance <= hit[1] && hit[1] <= halfExtent + tolerance;
+      }
+    }
+
+    if ( !hidden || !occlusion.manager->resultObjectIsVisible( occlusion.frustumResult, occlusion.objects[o] ) )
+    {
+      std::cerr << "Error: occlusion culling culled the visible object " << o << " of " << scene.objectCount << " in frame " << frame << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+void Benchmark_culling::addConfiguration( Scene & scene, std::string const & name, dp::culling::Manager * manager )
+{
+  scene.configurations.push_back( Configuration() );
+  Configuration & configuration = scene.configurations.back();
+  configuration.name = name;
+  configuration.manager.reset( manager );
+  configuration.group = manager->groupCreate();
+  configuration.time = 0.0;
+
+  dp::math::Box3f box( dp::math::Vec3f( -1.0f, -1.0f, -1.0f ), dp::math::Vec3f( 1.0f, 1.0f, 1.0f ) );
+  configuration.objects.reserve( scene.objectCount );
+  for ( size_t i = 0; i < scene.objectCount; ++i )
+  {
+    dp::culling::ObjectSharedPtr object = manager->objectCreate( dp::culling::PayloadSharedPtr() );
+    manager->objectSetTransformIndex( object, i );
+    manager->objectSetBoundingBox( object, box );
+    manager->groupAddObject( configuration.group, object );
+    configuration.objects.push_back( object );
+  }
+  manager->groupSetMatrices( configuration.group, scene.matrices.data(), scene.matrices.size(), sizeof(dp::math::Mat44f) );
+  configuration.result = manager->groupCreateResult( configuration.group );
+}
+
+void Benchmark_culling::animateScene( Scene & scene )
+{
+  // move a few random objects by up to one unit. The managers update only the OBBs of the changed matrices.
+  std::uniform_int_distribution<size_t> objectDistribution( 0, scene.objectCount - 1 );
+  std::uniform_real_distribution<float> distribution( -1.0f, 1.0f );
+  for ( unsigned int i = 0; i < m_animatedObjects && scene.objectCount; ++i )
+  {
+    size_t index = objectDistribution( scene.generator );
+    for ( unsigned int j = 0; j < 3; ++j )
+    {
+      scene.matrices[index][3][j] += distribution( scene.generator );
+    }
+
+    for ( size_t c = 0; c < scene.configurations.size(); ++c )
+    {
+      Configuration const & configuration = scene.configurations[c];
+      configuration.manager->groupMatrixChanged( configuration.group, index );
+    }
+    if ( scene.occlusion.manager )
+    {
+      scene.occlusion.manager->groupMatrixChanged( scene.occlusion.group, index );
+    }
+  }
+}
+
+dp::math::Vec3f Benchmark_culling::getEye( Scene const & scene, unsigned int frame ) const
+{
+  float radius = 0.25f * scene.extent;
+  float angle = 2.0f * dp::math::PI * frame / m_framesPerCircle;
+  return dp::math::Vec3f( radius * cos( angle ), 0.0f, radius * sin( angle ) );
+}
+
+dp::math::Mat44f Benchmark_culling::getViewProjection( Scene const & scene, unsigned int frame ) const
+{
+  // fly on a circle through the scene, looking tangential to the circle; the far plane scales with the scene,
+  // so that the fraction of visible objects is about the same for all object counts
+  float radius = 0.25f * scene.extent;
+  float angle = 2.0f * dp::math::PI * frame / m_framesPerCircle;
+  dp::math::Vec3f eye = getEye( scene, frame );
+  dp::math::Vec3f center( eye[0] - sin( angle ), 0.0f, eye[2] + cos( angle ) );
+
+  return dp::math::makeLookAt( eye, center, dp::math::Vec3f( 0.0f, 1.0f, 0.0f ) ) * dp::math::makePerspective( 45.0f, 16.0f / 9.0f, 0.1f, radius );
+}
+
+bool Benchmark_culling::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: benchmark_culling");
+  od.add_options() ( "objects", options::value<unsigned int>(), "Number of objects to cull. If not specified, 100000 and 1000000 objects are benchmarked." )
+                   ( "repetitions", options::value<unsigned int>()->default_value(32), "How many frames should be culled" )
+                   ( "threads", options::value<unsigned int>()->default_value(0), "Number of threads for multithreaded culling, 0 uses all hardware threads" )
+                   ( "animated", options::value<unsigned int>()->default_value(100), "Number of objects moved each frame" )
+                   ( "circle", options::value<unsigned int>()->default_value(32), "Number of frames for one flight around the circle" )
+                   ( "occluders", options::value<unsigned int>()->default_value(16), "Number of walls for the occlusion culling test, 0 disables it" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_objectCounts.clear();
+  if ( !optsMap["objects"].empty() )
+  {
+    m_objectCounts.push_back( optsMap["objects"].as<unsigned int>() );
+  }
+  else
+  {
+    m_objectCounts.push_back( 100000 );
+    m_objectCounts.push_back( 1000000 );
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_threadCount = optsMap["threads"].as<unsigned int>();
+  m_animatedObjects = optsMap["animated"].as<unsigned int>();
+  m_framesPerCircle = std::max( 1u, optsMap["circle"].as<unsigned int>() );
+  m_occluderCount = optsMap["occluders"].as<unsigned int>();
+
+  return true;
+}
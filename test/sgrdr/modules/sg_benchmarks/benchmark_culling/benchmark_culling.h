@@ -0,0 +1,121 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <test/testfw/core/Test.h>
+#include <dp/culling/Manager.h>
+#include <dp/culling/cpu/Manager.h>
+#include <dp/math/Matmnt.h>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+class Benchmark_culling : public dp::testfw::core::Test
+{
+public:
+  Benchmark_culling();
+  ~Benchmark_culling();
+
+  bool onInit( void );
+  bool onRun( unsigned int i );
+  bool onClear( void );
+
+  bool onRunCheck( unsigned int i );
+
+  bool option( const std::vector<std::string>& optionString );
+
+protected:
+  struct Configuration
+  {
+    std::string                               name;
+    std::shared_ptr<dp::culling::Manager>     manager;
+    dp::culling::GroupSharedPtr               group;
+    dp::culling::ResultSharedPtr              result;
+    std::vector<dp::culling::ObjectSharedPtr> objects;
+    double                                    time;
+  };
+
+  // vertical wall in the plane axis = position, the other horizontal axis spans [lower, upper]
+  struct Wall
+  {
+    unsigned int  axis;
+    float         position;
+    float         lower;
+    float         upper;
+  };
+
+  // frustum culling followed by occlusion culling against the walls of the scene
+  struct Occlusion
+  {
+    std::shared_ptr<dp::culling::cpu::Manager> manager;
+    dp::culling::GroupSharedPtr                 group;
+    dp::culling::ResultSharedPtr                frustumResult;
+    dp::culling::ResultSharedPtr                occlusionResult;
+    std::vector<dp::culling::ObjectSharedPtr>   objects;
+    double                                      time;
+    size_t                                      testedObjects;
+    size_t                                      occludedObjects;
+  };
+
+  struct Scene
+  {
+    size_t                          objectCount;
+    float                           extent;
+    std::vector<dp::math::Mat44f>   matrices;
+    std::vector<Configuration>      configurations;
+    std::vector<Wall>               walls;
+    Occlusion                       occlusion;
+    std::mt19937                    generator;
+  };
+
+protected:
+  void createScene( size_t objectCount );
+  void addConfiguration( Scene & scene, std::string const & name, dp::culling::Manager * manager );
+  void createOcclusion( Scene & scene );
+  bool runOcclusion( Scene & scene, dp::math::Mat44f const & viewProjection, unsigned int frame );
+  void animateScene( Scene & scene );
+  dp::math::Vec3f getEye( Scene const & scene, unsigned int frame ) const;
+  dp::math::Mat44f getViewProjection( Scene const & scene, unsigned int frame ) const;
+
+protected:
+  std::vector<size_t> m_objectCounts;
+  std::vector<Scene>  m_scenes;
+  unsigned int        m_repetitions;
+  unsigned int        m_threadCount;
+  unsigned int        m_animatedObjects;
+  unsigned int        m_framesPerCircle;
+  unsigned int        m_occluderCount;
+};
+
+extern "C"
+{
+  DPTTEST_API dp::testfw::core::Test * create_benchmark_culling()
+  {
+    return new Benchmark_culling();
+  }
+}
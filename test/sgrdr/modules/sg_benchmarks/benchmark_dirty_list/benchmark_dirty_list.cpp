@@ -0,0 +1,306 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <test/testfw/manager/Manager.h>
+#include "benchmark_dirty_list.h"
+
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("benchmark_dirty_list", "tests PreOrderTreeTraverser::processDirtyList on deep chains and with scattered dirty nodes", create_benchmark_dirty_list);
+
+
+Benchmark_dirty_list::Benchmark_dirty_list()
+  : m_repetitions(8)
+  , m_depth(100000)
+  , m_chainCount(4)
+  , m_nodeCount(262144)
+  , m_dirtyCount(1000)
+  , m_threadCount(0)
+{
+}
+
+Benchmark_dirty_list::~Benchmark_dirty_list()
+{
+}
+
+bool Benchmark_dirty_list::onInit()
+{
+  m_workerPool = dp::util::WorkerPool::create( m_threadCount );
+
+  createDeep();
+  createBushy();
+  return true;
+}
+
+bool Benchmark_dirty_list::onRun( unsigned int i )
+{
+  bool success = true;
+  for ( size_t h = 0; h < m_hierarchies.size(); ++h )
+  {
+    Hierarchy & hierarchy = m_hierarchies[h];
+    dp::sg::xbar::ObjectTree & tree = *hierarchy.tree;
+
+    // the same nodes are marked dirty for all configurations
+    std::mt19937 random( i );
+    std::vector<dp::sg::xbar::ObjectTreeIndex> dirty( m_dirtyCount );
+    for ( size_t d = 0; d < dirty.size(); ++d )
+    {
+      dirty[d] = hierarchy.scattered[random() % hierarchy.scattered.size()];
+    }
+    if ( i % 2 )
+    {
+      dirty.insert( dirty.end(), hierarchy.subtrees.begin(), hierarchy.subtrees.end() );
+    }
+
+    std::vector<bool> expected( tree.size(), false );
+    for ( size_t d = 0; d < dirty.size(); ++d )
+    {
+      expected[dirty[d]] = true;
+    }
+
+    // each node below a dirty node has to be visited exactly once
+    for ( size_t n = 0; n < hierarchy.nodes.size(); ++n )
+    {
+      dp::sg::xbar::ObjectTreeIndex parent = tree[hierarchy.nodes[n]].m_parentIndex;
+      if ( parent != ~0 && expected[parent] )
+      {
+        expected[hierarchy.nodes[n]] = true;
+      }
+    }
+
+    for ( size_t c = 0; c < hierarchy.configurations.size(); ++c )
+    {
+      Configuration & configuration = hierarchy.configurations[c];
+      for ( size_t d = 0; d < dirty.size(); ++d )
+      {
+        tree.markDirty( dirty[d], dp::sg::xbar::ObjectTreeNode::DEFAULT_DIRTY );
+      }
+      m_visits.assign( tree.size(), 0 );
+
+      dp::util::Timer timer;
+      timer.start();
+      processDirtyList( hierarchy, configuration.method );
+      timer.stop();
+      configuration.time += timer.getTime();
+      tree.m_dirtyObjects.clear();
+
+      for ( size_t n = 0; n < hierarchy.nodes.size(); ++n )
+      {
+        dp::sg::xbar::ObjectTreeIndex index = hierarchy.nodes[n];
+        if ( m_visits[index] != ( expected[index] ? 1u : 0u ) || tree[index].m_dirtyBits )
+        {
+          std::cerr << "Error: " << configuration.name << " visited node " << index << " of the " << hierarchy.name << " hierarchy "
+                    << m_visits[index] << " times in frame " << i << "\n";
+          success = false;
+          break;
+        }
+      }
+    }
+  }
+  return success;
+}
+
+bool Benchmark_dirty_list::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Benchmark_dirty_list::onClear()
+{
+  for ( size_t h = 0; h < m_hierarchies.size(); ++h )
+  {
+    Hierarchy const & hierarchy = m_hierarchies[h];
+    for ( size_t c = 0; c < hierarchy.configurations.size(); ++c )
+    {
+      Configuration const & configuration = hierarchy.configurations[c];
+      std::cout << hierarchy.name << ", " << configuration.name << ": " << 1000.0 * configuration.time / m_repetitions << " ms/frame\n";
+    }
+  }
+  m_hierarchies.clear();
+  m_workerPool.reset();
+
+  return true;
+}
+
+void Benchmark_dirty_list::createDeep()
+{
+  // a few chains with a leaf at each node. The leaves are marked dirty each frame, the whole chains every other frame,
+  // which overflows the call stack of a recursive traversal.
+  Hierarchy & hierarchy = addHierarchy( std::to_string( m_chainCount ) + " chains of " + std::to_string( m_depth ) + " nodes with leaves, "
+                                      + std::to_string( m_dirtyCount ) + " leaves dirty" );
+  dp::sg::xbar::ObjectTree & tree = *hierarchy.tree;
+
+  dp::sg::xbar::ObjectTreeIndex root = tree.insertNode( dp::sg::xbar::ObjectTreeNode(), ~0, ~0 );
+  hierarchy.nodes.push_back( root );
+  for ( unsigned int chain = 0; chain < m_chainCount; ++chain )
+  {
+    dp::sg::xbar::ObjectTreeIndex parent = root;
+    for ( unsigned int d = 0; d < m_depth; ++d )
+    {
+      parent = tree.insertNode( dp::sg::xbar::ObjectTreeNode(), parent, ~0 );
+      hierarchy.nodes.push_back( parent );
+      if ( d == 0 )
+      {
+        hierarchy.subtrees.push_back( parent );
+      }
+
+      dp::sg::xbar::ObjectTreeIndex leaf = tree.insertNode( dp::sg::xbar::ObjectTreeNode(), parent, ~0 );
+      hierarchy.nodes.push_back( leaf );
+      hierarchy.scattered.push_back( leaf );
+    }
+  }
+
+  // start each frame with a clean tree
+  for ( size_t n = 0; n < hierarchy.nodes.size(); ++n )
+  {
+    tree[hierarchy.nodes[n]].m_dirtyBits = 0;
+  }
+  tree.m_dirtyObjects.clear();
+}
+
+void Benchmark_dirty_list::createBushy()
+{
+  // a random tree, each node is added below one of the nodes added before. Any node might be marked dirty.
+  Hierarchy & hierarchy = addHierarchy( std::to_string( m_nodeCount ) + " nodes bushy, " + std::to_string( m_dirtyCount ) + " dirty" );
+  dp::sg::xbar::ObjectTree & tree = *hierarchy.tree;
+
+  std::mt19937 random( 1 );
+  hierarchy.nodes.push_back( tree.insertNode( dp::sg::xbar::ObjectTreeNode(), ~0, ~0 ) );
+  for ( unsigned int n = 1; n < m_nodeCount; ++n )
+  {
+    dp::sg::xbar::ObjectTreeIndex parent = hierarchy.nodes[random() % hierarchy.nodes.size()];
+    hierarchy.nodes.push_back( tree.insertNode( dp::sg::xbar::ObjectTreeNode(), parent, ~0 ) );
+  }
+  hierarchy.scattered = hierarchy.nodes;
+
+  for ( size_t n = 0; n < hierarchy.nodes.size(); ++n )
+  {
+    tree[hierarchy.nodes[n]].m_dirtyBits = 0;
+  }
+  tree.m_dirtyObjects.clear();
+}
+
+Benchmark_dirty_list::Hierarchy & Benchmark_dirty_list::addHierarchy( std::string const & name )
+{
+  m_hierarchies.push_back( Hierarchy() );
+  Hierarchy & hierarchy = m_hierarchies.back();
+  hierarchy.name = name;
+  hierarchy.tree.reset( new dp::sg::xbar::ObjectTree() );
+
+  hierarchy.configurations.resize( 3 );
+  hierarchy.configurations[0].name = "walk to root per dirty node";
+  hierarchy.configurations[0].method = Method::WALK_TO_ROOT;
+  hierarchy.configurations[1].name = "single threaded";
+  hierarchy.configurations[1].method = Method::SINGLE_THREADED;
+  hierarchy.configurations[2].name = "multithreaded";
+  hierarchy.configurations[2].method = Method::MULTITHREADED;
+  for ( size_t c = 0; c < hierarchy.configurations.size(); ++c )
+  {
+    hierarchy.configurations[c].time = 0.0;
+  }
+  return hierarchy;
+}
+
+void Benchmark_dirty_list::processDirtyList( Hierarchy & hierarchy, Method method )
+{
+  dp::sg::xbar::ObjectTree & tree = *hierarchy.tree;
+  Visitor visitor( tree, m_visits );
+  dp::sg::xbar::PreOrderTreeTraverser<dp::sg::xbar::ObjectTree, Visitor> traverser;
+
+  switch ( method )
+  {
+  case Method::WALK_TO_ROOT:
+    for ( size_t d = 0; d < tree.m_dirtyObjects.size(); ++d )
+    {
+      if ( !tree[tree.m_dirtyObjects[d]].m_dirtyBits )
+      {
+        continue;
+      }
+
+      // search the topmost dirty node
+      dp::sg::xbar::ObjectTreeIndex dirtyRoot = ~0;
+      for ( dp::sg::xbar::ObjectTreeIndex current = tree.m_dirtyObjects[d]; current != ~0; current = tree[current].m_parentIndex )
+      {
+        if ( tree[current].m_dirtyBits )
+        {
+          dirtyRoot = current;
+        }
+      }
+      traverser.traverse( tree, visitor, dirtyRoot );
+    }
+    break;
+  case Method::SINGLE_THREADED:
+    traverser.processDirtyList( tree, visitor, dp::sg::xbar::ObjectTreeNode::DEFAULT_DIRTY );
+    break;
+  case Method::MULTITHREADED:
+    traverser.setWorkerPool( m_workerPool );
+    traverser.processDirtyList( tree, visitor, dp::sg::xbar::ObjectTreeNode::DEFAULT_DIRTY );
+    break;
+  }
+}
+
+bool Benchmark_dirty_list::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: benchmark_dirty_list");
+  od.add_options() ( "repetitions", options::value<unsigned int>()->default_value(8), "How many frames should be processed" )
+                   ( "depth", options::value<unsigned int>()->default_value(100000), "Number of nodes of each chain of the deep hierarchy" )
+                   ( "chains", options::value<unsigned int>()->default_value(4), "Number of chains of the deep hierarchy" )
+                   ( "nodes", options::value<unsigned int>()->default_value(262144), "Number of nodes of the bushy hierarchy" )
+                   ( "dirty", options::value<unsigned int>()->default_value(1000), "Number of nodes marked dirty each frame" )
+                   ( "threads", options::value<unsigned int>()->default_value(0), "Number of threads for the multithreaded processing, 0 uses all hardware threads" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_depth = std::max( 1u, optsMap["depth"].as<unsigned int>() );
+  m_chainCount = std::max( 1u, optsMap["chains"].as<unsigned int>() );
+  m_nodeCount = std::max( 1u, optsMap["nodes"].as<unsigned int>() );
+  m_dirtyCount = optsMap["dirty"].as<unsigned int>();
+  m_threadCount = optsMap["threads"].as<unsigned int>();
+
+  return true;
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <test/testfw/core/Test.h>
+#include <dp/sg/xbar/ObjectTree.h>
+#include <dp/util/WorkerPool.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Benchmark_dirty_list : public dp::testfw::core::Test
+{
+public:
+  Benchmark_dirty_list();
+  ~Benchmark_dirty_list();
+
+  bool onInit( void );
+  bool onRun( unsigned int i );
+  bool onClear( void );
+
+  bool onRunCheck( unsigned int i );
+
+  bool option( const std::vector<std::string>& optionString );
+
+protected:
+  // counts the visits of each node and clears the dirty bits like the UpdateObjectVisitor of the SceneTree
+  class Visitor
+  {
+  public:
+    struct Data {};
+
+    Visitor( dp::sg::xbar::ObjectTree & objectTree, std::vector<unsigned int> & visits )
+      : m_objectTree( objectTree )
+      , m_visits( visits )
+    {
+    }
+
+    bool preTraverse( dp::sg::xbar::ObjectTreeIndex index, Data const & data )
+    {
+      ++m_visits[index];
+      return true;
+    }
+
+    void postTraverse( dp::sg::xbar::ObjectTreeIndex index, Data const & data )
+    {
+      m_objectTree[index].m_dirtyBits = 0;
+    }
+
+  private:
+    dp::sg::xbar::ObjectTree  & m_objectTree;
+    std::vector<unsigned int> & m_visits;
+  };
+
+  enum class Method
+  {
+      WALK_TO_ROOT    // the former search of the topmost dirty node per dirty node
+    , SINGLE_THREADED
+    , MULTITHREADED
+  };
+
+  struct Configuration
+  {
+    std::string name;
+    Method      method;
+    double      time;
+  };
+
+  struct Hierarchy
+  {
+    std::string                                 name;
+    std::unique_ptr<dp::sg::xbar::ObjectTree>   tree;
+    std::vector<dp::sg::xbar::ObjectTreeIndex>  nodes;      // all nodes, parents before their children
+    std::vector<dp::sg::xbar::ObjectTreeIndex>  scattered;  // nodes randomly marked dirty each frame
+    std::vector<dp::sg::xbar::ObjectTreeIndex>  subtrees;   // nodes marked dirty every other frame
+    std::vector<Configuration>                  configurations;
+  };
+
+protected:
+  void createDeep();
+  void createBushy();
+  Hierarchy & addHierarchy( std::string const & name );
+  void processDirtyList( Hierarchy & hierarchy, Method method );
+
+protected:
+  std::vector<Hierarchy>          m_hierarchies;
+  dp::util::WorkerPoolSharedPtr   m_workerPool;
+  std::vector<unsigned int>       m_visits;
+  unsigned int                    m_repetitions;
+  unsigned int                    m_depth;
+  unsigned int                    m_chainCount;
+  unsigned int                    m_nodeCount;
+  unsigned int                    m_dirtyCount;
+  unsigned int                    m_threadCount;
+};
+
+extern "C"
+{
+  DPTTEST_API dp::testfw::core::Test * create_benchmark_dirty_list()
+  {
+    return new Benchmark_dirty_list();
+  }
+}
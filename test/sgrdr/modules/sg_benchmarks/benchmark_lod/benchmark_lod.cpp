@@ -0,0 +1,244 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include <test/testfw/manager/Manager.h>
+#include "benchmark_lod.h"
+
+#include <dp/sg/core/GeoNode.h>
+#include <dp/sg/core/Group.h>
+#include <dp/sg/core/LOD.h>
+#include <dp/sg/core/Scene.h>
+#include <dp/sg/generator/MeshGenerator.h>
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("benchmark_lod", "tests performance of SceneTree updates of a city of LODs with a moving camera", create_benchmark_lod);
+
+
+Benchmark_lod::Benchmark_lod()
+  : m_repetitions(64)
+  , m_gridSize(256)
+  , m_blockSize(4.0f)
+  , m_hysteresis(0.0f)
+  , m_threadCount(1)
+  , m_check(true)
+  , m_activeChanges(0)
+  , m_levelChanges(0)
+  , m_time(0.0)
+  , m_objectTreeTime(0.0)
+{
+}
+
+Benchmark_lod::~Benchmark_lod()
+{
+}
+
+bool Benchmark_lod::onInit()
+{
+  createScene();
+  m_sceneTree->attach( this );
+
+  // without a previous level, the first selection has to be exact, whatever the hysteresis
+  return !m_check || checkLevels( 0.0f );
+}
+
+bool Benchmark_lod::onRun( unsigned int i )
+{
+  placeCamera( i );
+  size_t activeChanges = m_activeChanges;
+
+  dp::util::Timer timer;
+  timer.start();
+  m_sceneTree->update( m_camera, 1.0f );
+  timer.stop();
+  m_time += timer.getTime();
+
+  return checkStatistics( m_activeChanges - activeChanges ) && ( !m_check || checkLevels( m_hysteresis ) );
+}
+
+bool Benchmark_lod::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Benchmark_lod::onClear()
+{
+  std::cout << m_gridSize * m_gridSize << " LODs, " << m_activeChanges / std::max( 1u, m_repetitions ) << " active changes per update: "
+            << 1000.0 * m_time / std::max( 1u, m_repetitions ) << " ms/update\n";
+  std::cout << m_levelChanges / std::max( 1u, m_repetitions ) << " level changes per update, "
+            << 1000.0 * m_objectTreeTime / std::max( 1u, m_repetitions ) << " ms/update in the ObjectTree\n";
+
+  m_sceneTree->detach( this );
+  m_sceneTree.reset();
+  m_camera.reset();
+
+  return true;
+}
+
+void Benchmark_lod::onNotify( dp::util::Event const & event, dp::util::Payload * payload )
+{
+  dp::sg::xbar::SceneTree::Event::Changes const & changes = static_cast<dp::sg::xbar::SceneTree::Event const &>( event ).getChanges();
+  for ( size_t i = 0; i < changes.size(); ++i )
+  {
+    if ( changes[i].type == dp::sg::xbar::SceneTree::Event::Type::ACTIVE_CHANGED )
+    {
+      ++m_activeChanges;
+    }
+  }
+}
+
+void Benchmark_lod::onDestroyed( dp::util::Subject const & subject, dp::util::Payload * payload )
+{
+}
+
+void Benchmark_lod::createScene()
+{
+  // a building with three levels of detail, instanced on every block of the city
+  float const ranges[] = { 8.0f * m_blockSize, 32.0f * m_blockSize };
+  dp::sg::core::LODSharedPtr building = dp::sg::core::LOD::create();
+  building->addChild( dp::sg::generator::createGeoNode( dp::sg::generator::createSphere( 16, 8 ) ) );
+  building->addChild( dp::sg::generator::createGeoNode( dp::sg::generator::createSphere( 8, 4 ) ) );
+  building->addChild( dp::sg::generator::createGeoNode( dp::sg::generator::createCube() ) );
+  building->setRanges( ranges, 2 );
+
+  dp::sg::core::GroupSharedPtr root = dp::sg::core::Group::create();
+  root->addChild( dp::sg::generator::replicate( building, dp::math::Vec3ui( m_gridSize, m_gridSize, 1 ), dp::math::Vec3f( m_blockSize / 2.0f, m_blockSize / 2.0f, 1.0f ) ) );
+
+  dp::sg::core::SceneSharedPtr scene = dp::sg::core::Scene::create();
+  scene->setRootNode( root );
+
+  m_camera = dp::sg::core::PerspectiveCamera::create();
+  placeCamera( ~0 );
+
+  m_sceneTree = dp::sg::xbar::SceneTree::create( scene );
+  m_sceneTree->setLODHysteresis( m_hysteresis );
+  m_sceneTree->setLODThreadCount( m_threadCount );
+  m_sceneTree->update( m_camera, 1.0f );
+}
+
+bool Benchmark_lod::checkStatistics( size_t activeChanges )
+{
+  // the counters of the SceneTree have to agree with the changes its observers received
+  dp::sg::xbar::SceneTree::UpdateStatistics const & statistics = m_sceneTree->getUpdateStatistics();
+  m_levelChanges += statistics.changedLODs;
+  m_objectTreeTime += 1e-9 * statistics.objectTreeTime;
+
+  if ( statistics.evaluatedLODs != m_gridSize * m_gridSize || statistics.emittedChanges != activeChanges )
+  {
+    std::cerr << "Error: " << statistics.evaluatedLODs << " LODs evaluated and " << statistics.emittedChanges << " changes emitted, expected "
+              << m_gridSize * m_gridSize << " and " << activeChanges << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool Benchmark_lod::checkLevels( float hysteresis )
+{
+  // the active child of each LOD has to be between the levels LOD::getLODToUse picks for the ranges widened and
+  // narrowed by the hysteresis, with a small tolerance for LODs right at a range
+  float const tolerance = 1e-4f;
+  dp::math::Mat44f const & worldToView = m_camera->getWorldToViewMatrix();
+  dp::sg::xbar::ObjectTree & objectTree = m_sceneTree->getObjectTree();
+  for ( dp::sg::xbar::ObjectTree::LODMap::const_iterator it = objectTree.m_LODs.begin(); it != objectTree.m_LODs.end(); ++it )
+  {
+    dp::sg::core::LODSharedPtr lod = it->second.lock();
+    dp::math::Mat44f const modelToView = m_sceneTree->getTransformTree().getTree().getWorldMatrix( objectTree[it->first].m_transform ) * worldToView;
+    unsigned int fine = lod->getLODToUse( modelToView, 1.0f + hysteresis + tolerance );
+    unsigned int coarse = lod->getLODToUse( modelToView, 1.0f - hysteresis - tolerance );
+
+    unsigned int active = ~0;
+    unsigned int i = 0;
+    for ( dp::sg::xbar::ObjectTreeIndex child = objectTree[it->first].m_firstChild; child != ~0; child = objectTree[child].m_nextSibling, ++i )
+    {
+      if ( objectTree[child].m_localActive )
+      {
+        if ( active != ~0 )
+        {
+          std::cerr << "Error: LOD " << it->first << " has more than one active child\n";
+          return false;
+        }
+        active = i;
+      }
+    }
+    if ( active < fine || coarse < active )
+    {
+      std::cerr << "Error: LOD " << it->first << " uses level " << active << ", expected a level in [" << fine << "," << coarse << "]\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+void Benchmark_lod::placeCamera( unsigned int frame )
+{
+  // fly diagonally over the city, a few blocks per frame
+  float const step = 3.0f * m_blockSize;
+  float const position = ( frame + 1 ) * step;
+  float const extent = m_gridSize * m_blockSize;
+  m_camera->setPosition( dp::math::Vec3f( fmodf( position, extent ), fmodf( 0.5f * position, extent ), 2.0f * m_blockSize ) );
+}
+
+bool Benchmark_lod::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: benchmark_lod");
+  od.add_options() ( "repetitions", options::value<unsigned int>()->default_value(64), "Number of camera positions to update the SceneTree for" )
+                   ( "grid", options::value<unsigned int>()->default_value(256), "Number of blocks in each direction of the city" )
+                   ( "hysteresis", options::value<float>()->default_value(0.0f), "Hysteresis of the LOD selection as a fraction of the ranges" )
+                   ( "threads", options::value<unsigned int>()->default_value(1), "Number of threads selecting the LOD levels, 0 for all hardware threads" )
+                   ( "check", options::value<bool>()->default_value(true), "Check the selected levels against LOD::getLODToUse after each update" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_gridSize = std::max( 1u, optsMap["grid"].as<unsigned int>() );
+  m_hysteresis = std::min( std::max( 0.0f, optsMap["hysteresis"].as<float>() ), 0.9f );
+  m_threadCount = optsMap["threads"].as<unsigned int>();
+  m_check = optsMap["check"].as<bool>();
+
+  return true;
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#pragma once
+
+#include <test/testfw/core/Test.h>
+#include <dp/sg/core/PerspectiveCamera.h>
+#include <dp/sg/xbar/SceneTree.h>
+#include <dp/util/Observer.h>
+#include <string>
+#include <vector>
+
+class Benchmark_lod : public dp::testfw::core::Test, public dp::util::Observer
+{
+public:
+  Benchmark_lod();
+  ~Benchmark_lod();
+
+  bool onInit( void );
+  bool onRun( unsigned int i );
+  bool onClear( void );
+
+  bool onRunCheck( unsigned int i );
+
+  bool option( const std::vector<std::string>& optionString );
+
+  void onNotify( dp::util::Event const & event, dp::util::Payload * payload );
+  void onDestroyed( dp::util::Subject const & subject, dp::util::Payload * payload );
+
+protected:
+  void createScene();
+  void placeCamera( unsigned int frame );
+  bool checkLevels( float hysteresis );
+  bool checkStatistics( size_t activeChanges );
+
+protected:
+  dp::sg::xbar::SceneTreeSharedPtr          m_sceneTree;
+  dp::sg::core::PerspectiveCameraSharedPtr  m_camera;
+  unsigned int                              m_repetitions;
+  unsigned int                              m_gridSize;
+  float                                     m_blockSize;
+  float                                     m_hysteresis;
+  unsigned int                              m_threadCount;
+  bool                                      m_check;
+  size_t                                    m_activeChanges;
+  size_t                                    m_levelChanges;
+  double                                    m_time;
+  double                                    m_objectTreeTime;
+};
+
+extern "C"
+{
+  DPTTEST_API dp::testfw::core::Test * create_benchmark_lod()
+  {
+    return new Benchmark_lod();
+  }
+}
@@ -0,0 +1,377 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <test/testfw/manager/Manager.h>
+#include "benchmark_notification.h"
+
+#include <dp/Assert.h>
+#include <dp/sg/generator/MeshGenerator.h>
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("benchmark_notification", "tests notify throughput, detach cost and queued notifications from worker threads", create_benchmark_notification);
+
+namespace
+{
+  // a subject notifying on request
+  class NotifyingSubject : public dp::util::Subject
+  {
+  public:
+    void emit( dp::util::Event const & event )
+    {
+      notify( event );
+    }
+  };
+
+  unsigned int assertionCount = 0;
+
+  // counts the assertions instead of breaking, for the error paths of the test
+  int countAssertion( const char * message )
+  {
+    ++assertionCount;
+    return 0;
+  }
+}
+
+
+Benchmark_notification::CountingObserver::CountingObserver()
+  : m_count(0)
+  , m_thread( std::this_thread::get_id() )
+  , m_wrongThread(false)
+{
+}
+
+void Benchmark_notification::CountingObserver::onNotify( dp::util::Event const & event, dp::util::Payload * payload )
+{
+  ++m_count;
+  m_wrongThread |= ( std::this_thread::get_id() != m_thread );
+}
+
+void Benchmark_notification::CountingObserver::onDestroyed( dp::util::Subject const & subject, dp::util::Payload * payload )
+{
+}
+
+
+Benchmark_notification::Benchmark_notification()
+  : m_repetitions(4)
+  , m_observerCount(8)
+  , m_notificationCount(1000000)
+  , m_detachCount(10000)
+  , m_threadCount(4)
+  , m_objectCount(1024)
+  , m_changeCount(100000)
+  , m_notifyTime(0.0)
+  , m_handleDetachTime(0.0)
+  , m_searchDetachTime(0.0)
+  , m_queueTime(0.0)
+  , m_deliverTime(0.0)
+  , m_delivered(0)
+{
+}
+
+Benchmark_notification::~Benchmark_notification()
+{
+}
+
+bool Benchmark_notification::onInit()
+{
+  return true;
+}
+
+bool Benchmark_notification::onRun( unsigned int i )
+{
+  return runThroughput() && runDetach() && runQueued() && runRefused();
+}
+
+bool Benchmark_notification::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Benchmark_notification::onClear()
+{
+  unsigned int repetitions = std::max( 1u, m_repetitions );
+  std::cout << m_observerCount << " observers: " << 1e9 * m_notifyTime / ( repetitions * double( m_notificationCount ) ) << " ns/notify\n";
+  std::cout << m_detachCount << " observers detached by handle: " << 1000.0 * m_handleDetachTime / repetitions << " ms, by search: "
+            << 1000.0 * m_searchDetachTime / repetitions << " ms\n";
+  std::cout << m_threadCount << " threads queueing " << m_changeCount << " changes each: " << 1000.0 * m_queueTime / repetitions << " ms, "
+            << m_delivered / repetitions << " notifications delivered in " << 1000.0 * m_deliverTime / repetitions << " ms\n";
+  return true;
+}
+
+bool Benchmark_notification::runThroughput()
+{
+  NotifyingSubject subject;
+  std::vector<CountingObserver> observers( m_observerCount );
+  for ( size_t i = 0; i < observers.size(); ++i )
+  {
+    subject.attach( &observers[i] );
+  }
+
+  dp::util::Event event;
+  dp::util::Timer timer;
+  timer.start();
+  for ( unsigned int i = 0; i < m_notificationCount; ++i )
+  {
+    subject.emit( event );
+  }
+  timer.stop();
+  m_notifyTime += timer.getTime();
+
+  for ( size_t i = 0; i < observers.size(); ++i )
+  {
+    if ( observers[i].m_count != m_notificationCount )
+    {
+      std::cerr << "Error: observer " << i << " received " << observers[i].m_count << " of " << m_notificationCount << " notifications\n";
+      return false;
+    }
+    subject.detach( &observers[i] );
+  }
+  return true;
+}
+
+bool Benchmark_notification::runDetach()
+{
+  // detach many observers of one subject in random order, once with the handles and once by searching them
+  std::vector<CountingObserver> observers( m_detachCount );
+  std::vector<unsigned int> order( m_detachCount );
+  for ( unsigned int i = 0; i < m_detachCount; ++i )
+  {
+    order[i] = i;
+  }
+  std::shuffle( order.begin(), order.end(), std::mt19937( 1 ) );
+
+  NotifyingSubject subject;
+  std::vector<dp::util::Subject::ObserverHandle> handles( m_detachCount );
+  for ( unsigned int i = 0; i < m_detachCount; ++i )
+  {
+    handles[i] = subject.attach( &observers[i] );
+  }
+
+  dp::util::Timer timer;
+  timer.start();
+  for ( unsigned int i = 0; i < m_detachCount / 2; ++i )
+  {
+    subject.detach( handles[order[i]] );
+  }
+  timer.stop();
+  m_handleDetachTime += 2.0 * timer.getTime();
+
+  // the remaining half has to be notified exactly once
+  subject.emit( dp::util::Event() );
+  for ( unsigned int i = 0; i < m_detachCount; ++i )
+  {
+    if ( observers[order[i]].m_count != ( i < m_detachCount / 2 ? 0 : 1 ) )
+    {
+      std::cerr << "Error: observer " << order[i] << " received " << observers[order[i]].m_count << " notifications after detaching\n";
+      return false;
+    }
+  }
+
+  timer.restart();
+  for ( unsigned int i = m_detachCount / 2; i < m_detachCount; ++i )
+  {
+    subject.detach( &observers[order[i]] );
+  }
+  timer.stop();
+  m_searchDetachTime += 2.0 * timer.getTime();
+
+  for ( unsigned int i = 0; i < m_detachCount; ++i )
+  {
+    if ( subject.isAttached( &observers[i] ) )
+    {
+      std::cerr << "Error: observer " << i << " is still attached\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Benchmark_notification::runQueued()
+{
+  // worker threads change the traversal masks of their own objects while this thread delivers the notifications
+  dp::sg::core::PrimitiveSharedPtr cube = dp::sg::generator::createCube();
+  std::vector<dp::sg::core::GeoNodeSharedPtr> objects( m_threadCount * m_objectCount );
+  for ( size_t i = 0; i < objects.size(); ++i )
+  {
+    objects[i] = dp::sg::generator::createGeoNode( cube );
+  }
+
+  // half of the objects are observed, the notifications of the others must not be queued
+  CountingObserver observer;
+  for ( size_t i = 0; i < objects.size(); i += 2 )
+  {
+    objects[i]->attach( &observer );
+  }
+
+  dp::util::NotificationQueue queue;
+  std::atomic<unsigned int> running( m_threadCount );
+  std::vector<std::thread> threads;
+
+  dp::util::Timer timer;
+  timer.start();
+  for ( unsigned int t = 0; t < m_threadCount; ++t )
+  {
+    threads.push_back( std::thread( [&, t]()
+    {
+      dp::util::NotificationQueue::Scope scope( queue );
+      for ( unsigned int i = 0; i < m_changeCount; ++i )
+      {
+        objects[t * m_objectCount + i % m_objectCount]->setTraversalMask( i + 2 );
+      }
+      --running;
+    } ) );
+  }
+
+  size_t delivered = 0;
+  dp::util::Timer deliverTimer;
+  while ( running )
+  {
+    deliverTimer.start();
+    delivered += queue.deliver();
+    deliverTimer.stop();
+    std::this_thread::yield();
+  }
+  for ( size_t i = 0; i < threads.size(); ++i )
+  {
+    threads[i].join();
+  }
+  timer.stop();
+
+  deliverTimer.start();
+  delivered += queue.deliver();
+  deliverTimer.stop();
+
+  m_queueTime += timer.getTime();
+  m_deliverTime += deliverTimer.getTime();
+  m_delivered += delivered;
+
+  for ( size_t i = 0; i < objects.size(); i += 2 )
+  {
+    objects[i]->detach( &observer );
+  }
+
+  // the object count per thread is even, so the observed objects get every other change of each thread
+  size_t expected = size_t( m_threadCount ) * ( ( m_changeCount + 1 ) / 2 );
+  if ( observer.m_count != delivered || delivered != expected )
+  {
+    std::cerr << "Error: " << delivered << " notifications delivered, " << observer.m_count << " received, " << expected << " expected\n";
+    return false;
+  }
+  if ( observer.m_wrongThread )
+  {
+    std::cerr << "Error: a notification has been delivered on a worker thread\n";
+    return false;
+  }
+  return true;
+}
+
+bool Benchmark_notification::runRefused()
+{
+  // an event which cannot be cloned must neither be queued nor be delivered on the notifying thread
+  NotifyingSubject subject;
+  CountingObserver observer;
+  subject.attach( &observer );
+
+  dp::util::NotificationQueue queue;
+  bool thrown = false;
+  assertionCount = 0;
+  dp::UserAssertCallback previousCallback = dp::setUserAssertCallback( countAssertion );
+  {
+    dp::util::NotificationQueue::Scope scope( queue );
+    try
+    {
+      subject.emit( dp::util::Event() );
+    }
+    catch ( std::runtime_error const & )
+    {
+      thrown = true;
+    }
+  }
+  dp::setUserAssertCallback( previousCallback );
+  size_t delivered = queue.deliver();
+  subject.detach( &observer );
+
+  if ( !thrown || observer.m_count || delivered )
+  {
+    std::cerr << "Error: an event without clone has been " << ( thrown ? "" : "accepted and " ) << "delivered " << observer.m_count + delivered << " times\n";
+    return false;
+  }
+#if !defined(NDEBUG)
+  if ( assertionCount != 1 )
+  {
+    std::cerr << "Error: queueing an event without clone raised " << assertionCount << " assertions\n";
+    return false;
+  }
+#endif
+  return true;
+}
+
+bool Benchmark_notification::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: benchmark_notification");
+  od.add_options() ( "repetitions", options::value<unsigned int>()->default_value(4), "Number of repetitions" )
+                   ( "observers", options::value<unsigned int>()->default_value(8), "Number of observers of the notify throughput test" )
+                   ( "notifications", options::value<unsigned int>()->default_value(1000000), "Number of notifications of the notify throughput test" )
+                   ( "detach", options::value<unsigned int>()->default_value(10000), "Number of observers of the detach test" )
+                   ( "threads", options::value<unsigned int>()->default_value(4), "Number of threads queueing notifications" )
+                   ( "objects", options::value<unsigned int>()->default_value(1024), "Number of objects per thread" )
+                   ( "changes", options::value<unsigned int>()->default_value(100000), "Number of changes per thread" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_observerCount = std::max( 1u, optsMap["observers"].as<unsigned int>() );
+  m_notificationCount = optsMap["notifications"].as<unsigned int>();
+  m_detachCount = std::max( 2u, optsMap["detach"].as<unsigned int>() );
+  m_threadCount = std::max( 1u, optsMap["threads"].as<unsigned int>() );
+  m_objectCount = std::max( 2u, ( optsMap["objects"].as<unsigned int>() + 1 ) / 2 * 2 );
+  m_changeCount = optsMap["changes"].as<unsigned int>();
+
+  return true;
+}
@@ -0,0 +1,94 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#pragma once
+
+#include <test/testfw/core/Test.h>
+#include <dp/sg/core/GeoNode.h>
+#include <dp/util/Observer.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Benchmark_notification : public dp::testfw::core::Test
+{
+public:
+  Benchmark_notification();
+  ~Benchmark_notification();
+
+  bool onInit( void );
+  bool onRun( unsigned int i );
+  bool onClear( void );
+
+  bool onRunCheck( unsigned int i );
+
+  bool option( const std::vector<std::string>& optionString );
+
+protected:
+  // counts the notifications it receives and remembers if one arrived on another thread than the expected one
+  class CountingObserver : public dp::util::Observer
+  {
+  public:
+    CountingObserver();
+
+    void onNotify( dp::util::Event const & event, dp::util::Payload * payload );
+    void onDestroyed( dp::util::Subject const & subject, dp::util::Payload * payload );
+
+  public:
+    size_t          m_count;
+    std::thread::id m_thread;
+    bool            m_wrongThread;
+  };
+
+  bool runThroughput();
+  bool runDetach();
+  bool runQueued();
+  bool runRefused();
+
+protected:
+  unsigned int  m_repetitions;
+  unsigned int  m_observerCount;
+  unsigned int  m_notificationCount;
+  unsigned int  m_detachCount;
+  unsigned int  m_threadCount;
+  unsigned int  m_objectCount;
+  unsigned int  m_changeCount;
+  double        m_notifyTime;
+  double        m_handleDetachTime;
+  double        m_searchDetachTime;
+  double        m_queueTime;
+  double        m_deliverTime;
+  size_t        m_delivered;
+};
+
+extern "C"
+{
+  DPTTEST_API dp::testfw::core::Test * create_benchmark_notification()
+  {
+    return new Benchmark_notification();
+  }
+}
@@ -0,0 +1,209 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include <test/testfw/manager/Manager.h>
+#include "benchmark_scene_tree_build.h"
+
+#include <dp/sg/core/GeoNode.h>
+#include <dp/sg/core/Group.h>
+#include <dp/sg/core/Scene.h>
+#include <dp/sg/generator/MeshGenerator.h>
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("benchmark_scene_tree_build", "tests performance of the initial SceneTree generation of a huge assembly", create_benchmark_scene_tree_build);
+
+
+Benchmark_scene_tree_build::Benchmark_scene_tree_build()
+  : m_repetitions(4)
+  , m_assemblyGridSize(24)
+  , m_partGridSize(32)
+  , m_threadCount(1)
+  , m_streamingBudget(0)
+  , m_serialTime(0.0)
+  , m_buildTime(0.0)
+  , m_firstFrameTime(0.0)
+  , m_streamingFrames(0)
+{
+}
+
+Benchmark_scene_tree_build::~Benchmark_scene_tree_build()
+{
+}
+
+bool Benchmark_scene_tree_build::onInit()
+{
+  createScene();
+
+  dp::util::Timer timer;
+  timer.start();
+  m_reference = dp::sg::xbar::SceneTree::create( m_scene );
+  m_reference->update( m_camera, 1.0f );
+  timer.stop();
+  m_serialTime = timer.getTime();
+
+  return true;
+}
+
+bool Benchmark_scene_tree_build::onRun( unsigned int i )
+{
+  dp::util::Timer timer;
+  timer.start();
+  dp::sg::xbar::SceneTreeSharedPtr sceneTree = dp::sg::xbar::SceneTree::create( m_scene, m_threadCount, m_streamingBudget );
+  sceneTree->update( m_camera, 1.0f );
+  m_firstFrameTime += timer.getTime();
+  ++m_streamingFrames;
+
+  // a streamed scene is completed by the following updates
+  while ( sceneTree->isGenerating() )
+  {
+    sceneTree->update( m_camera, 1.0f );
+    ++m_streamingFrames;
+  }
+  timer.stop();
+  m_buildTime += timer.getTime();
+
+  return compareTrees( sceneTree );
+}
+
+bool Benchmark_scene_tree_build::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Benchmark_scene_tree_build::onClear()
+{
+  unsigned int repetitions = std::max( 1u, m_repetitions );
+  std::cout << m_reference->getObjectTree().size() << " ObjectTree nodes, serial build: " << 1000.0 * m_serialTime << " ms\n";
+  std::cout << m_threadCount << " threads, streaming budget " << m_streamingBudget << ": " << 1000.0 * m_firstFrameTime / repetitions << " ms to the first frame, "
+            << 1000.0 * m_buildTime / repetitions << " ms and " << m_streamingFrames / repetitions << " frames to the complete tree\n";
+
+  m_reference.reset();
+  m_scene.reset();
+  m_camera.reset();
+
+  return true;
+}
+
+void Benchmark_scene_tree_build::createScene()
+{
+  // an assembly of parts, each part a grid of transformed cubes
+  dp::sg::core::GeoNodeSharedPtr cube = dp::sg::generator::createGeoNode( dp::sg::generator::createCube() );
+  dp::sg::core::GroupSharedPtr part = dp::sg::generator::replicate( cube, dp::math::Vec3ui( m_partGridSize, m_partGridSize, 1 ), dp::math::Vec3f( 2.0f, 2.0f, 1.0f ) );
+  dp::sg::core::GroupSharedPtr assembly = dp::sg::generator::replicate( part, dp::math::Vec3ui( m_assemblyGridSize, m_assemblyGridSize, 1 ), dp::math::Vec3f( 2.0f * m_partGridSize, 2.0f * m_partGridSize, 1.0f ) );
+
+  dp::sg::core::GroupSharedPtr root = dp::sg::core::Group::create();
+  root->addChild( assembly );
+
+  m_scene = dp::sg::core::Scene::create();
+  m_scene->setRootNode( root );
+
+  m_camera = dp::sg::core::PerspectiveCamera::create();
+}
+
+bool Benchmark_scene_tree_build::compareTrees( dp::sg::xbar::SceneTreeSharedPtr const & sceneTree ) const
+{
+  // walk both trees in pre-order, the indices of the nodes may differ
+  dp::sg::xbar::ObjectTree & referenceTree = m_reference->getObjectTree();
+  dp::sg::xbar::ObjectTree & tree = sceneTree->getObjectTree();
+  dp::transform::Tree const & referenceTransforms = m_reference->getTransformTree().getTree();
+  dp::transform::Tree const & transforms = sceneTree->getTransformTree().getTree();
+
+  std::vector<std::pair<dp::sg::xbar::ObjectTreeIndex, dp::sg::xbar::ObjectTreeIndex>> stack( 1, std::make_pair( 0, 0 ) );
+  size_t count = 0;
+  while ( !stack.empty() )
+  {
+    dp::sg::xbar::ObjectTreeIndex lhsIndex = stack.back().first;
+    dp::sg::xbar::ObjectTreeIndex rhsIndex = stack.back().second;
+    stack.pop_back();
+    ++count;
+
+    if ( ( lhsIndex == ~0 ) != ( rhsIndex == ~0 ) )
+    {
+      std::cerr << "Error: the ObjectTrees differ in structure at node " << count << "\n";
+      return false;
+    }
+    if ( lhsIndex == ~0 )
+    {
+      continue;
+    }
+
+    dp::sg::xbar::ObjectTreeNode const & lhs = referenceTree[lhsIndex];
+    dp::sg::xbar::ObjectTreeNode const & rhs = tree[rhsIndex];
+    if ( lhs.m_object != rhs.m_object || lhs.m_isDrawable != rhs.m_isDrawable || lhs.m_isTransform != rhs.m_isTransform
+      || lhs.m_worldHints != rhs.m_worldHints || lhs.m_worldMask != rhs.m_worldMask || lhs.m_worldActive != rhs.m_worldActive
+      || referenceTransforms.getWorldMatrix( lhs.m_transform ) != transforms.getWorldMatrix( rhs.m_transform ) )
+    {
+      std::cerr << "Error: ObjectTree node " << count << " differs\n";
+      return false;
+    }
+
+    stack.push_back( std::make_pair( lhs.m_nextSibling, rhs.m_nextSibling ) );
+    stack.push_back( std::make_pair( lhs.m_firstChild, rhs.m_firstChild ) );
+  }
+  return true;
+}
+
+bool Benchmark_scene_tree_build::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: benchmark_scene_tree_build");
+  od.add_options() ( "repetitions", options::value<unsigned int>()->default_value(4), "Number of SceneTrees to generate" )
+                   ( "assembly", options::value<unsigned int>()->default_value(24), "Size of the grid of parts in the assembly" )
+                   ( "part", options::value<unsigned int>()->default_value(32), "Size of the grid of cubes in a part" )
+                   ( "threads", options::value<unsigned int>()->default_value(1), "Number of generator threads, 0 for one per hardware thread" )
+                   ( "streaming", options::value<unsigned int>()->default_value(0), "Number of ObjectTree nodes generated per frame, 0 to generate the whole tree on creation" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_assemblyGridSize = std::max( 1u, optsMap["assembly"].as<unsigned int>() );
+  m_partGridSize = std::max( 1u, optsMap["part"].as<unsigned int>() );
+  m_threadCount = optsMap["threads"].as<unsigned int>();
+  m_streamingBudget = optsMap["streaming"].as<unsigned int>();
+
+  return true;
+}
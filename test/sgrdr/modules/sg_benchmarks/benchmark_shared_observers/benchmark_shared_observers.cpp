@@ -0,0 +1,249 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <test/testfw/manager/Manager.h>
+#include "benchmark_shared_observers.h"
+
+#include <dp/sg/core/Group.h>
+#include <dp/sg/core/Scene.h>
+#include <dp/sg/generator/MeshGenerator.h>
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("benchmark_shared_observers", "tests observer attach, notify and detach cost of a SceneTree on heavily shared objects", create_benchmark_shared_observers);
+
+
+Benchmark_shared_observers::Benchmark_shared_observers()
+  : m_repetitions(4)
+  , m_assemblyGridSize(32)
+  , m_partGridSize(8)
+  , m_objectTreeSize(0)
+  , m_attachTime(0.0)
+  , m_notifyTime(0.0)
+  , m_groupNotifyTime(0.0)
+  , m_updateTime(0.0)
+  , m_detachTime(0.0)
+{
+}
+
+Benchmark_shared_observers::~Benchmark_shared_observers()
+{
+}
+
+bool Benchmark_shared_observers::onInit()
+{
+  createScene();
+  return true;
+}
+
+bool Benchmark_shared_observers::onRun( unsigned int i )
+{
+  dp::util::Timer timer;
+
+  // attach: every ObjectTree node observes its object
+  timer.start();
+  dp::sg::xbar::SceneTreeSharedPtr sceneTree = dp::sg::xbar::SceneTree::create( m_scene );
+  sceneTree->update( m_camera, 1.0f );
+  timer.stop();
+  m_attachTime += timer.getTime();
+  m_objectTreeSize = countNodes( sceneTree );
+
+  // notify: a property change of the cube reaches every reference of it
+  unsigned int mask = i + 2;
+  timer.restart();
+  m_cube->setTraversalMask( mask );
+  timer.stop();
+  m_notifyTime += timer.getTime();
+
+  timer.restart();
+  m_part->setTraversalMask( mask );
+  timer.stop();
+  m_groupNotifyTime += timer.getTime();
+
+  timer.restart();
+  sceneTree->update( m_camera, 1.0f );
+  timer.stop();
+  m_updateTime += timer.getTime();
+
+  bool ok = checkMasks( sceneTree, mask );
+
+  // detach: removing the assembly detaches all its ObjectTree nodes
+  timer.restart();
+  m_root->removeChild( m_assembly );
+  sceneTree->update( m_camera, 1.0f );
+  timer.stop();
+  m_detachTime += timer.getTime();
+
+  if ( countNodes( sceneTree ) + m_assemblyGridSize * m_assemblyGridSize * ( 2 + 2 * m_partGridSize * m_partGridSize ) + 1 != m_objectTreeSize )
+  {
+    std::cerr << "Error: the assembly was not removed from the ObjectTree\n";
+    ok = false;
+  }
+
+  // the re-added assembly is observed again
+  m_root->addChild( m_assembly );
+  sceneTree->update( m_camera, 1.0f );
+  m_cube->setTraversalMask( ~0 );
+  m_part->setTraversalMask( ~0 );
+  sceneTree->update( m_camera, 1.0f );
+
+  return ok && checkMasks( sceneTree, ~0 );
+}
+
+bool Benchmark_shared_observers::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Benchmark_shared_observers::onClear()
+{
+  unsigned int repetitions = std::max( 1u, m_repetitions );
+  unsigned int references = m_assemblyGridSize * m_assemblyGridSize;
+  std::cout << m_objectTreeSize << " ObjectTree nodes, " << references * m_partGridSize * m_partGridSize << " references to the cube, "
+            << references << " references to the part\n";
+  std::cout << "attach:        " << 1000.0 * m_attachTime / repetitions << " ms\n";
+  std::cout << "notify cube:   " << 1000.0 * m_notifyTime / repetitions << " ms\n";
+  std::cout << "notify part:   " << 1000.0 * m_groupNotifyTime / repetitions << " ms\n";
+  std::cout << "update:        " << 1000.0 * m_updateTime / repetitions << " ms\n";
+  std::cout << "detach:        " << 1000.0 * m_detachTime / repetitions << " ms\n";
+
+  m_cube.reset();
+  m_part.reset();
+  m_assembly.reset();
+  m_root.reset();
+  m_scene.reset();
+  m_camera.reset();
+
+  return true;
+}
+
+void Benchmark_shared_observers::createScene()
+{
+  // an assembly of references to a single part, the part a grid of references to a single cube
+  m_cube = dp::sg::generator::createGeoNode( dp::sg::generator::createCube() );
+  m_part = dp::sg::generator::replicate( m_cube, dp::math::Vec3ui( m_partGridSize, m_partGridSize, 1 ), dp::math::Vec3f( 2.0f, 2.0f, 1.0f ), false );
+  m_assembly = dp::sg::generator::replicate( m_part, dp::math::Vec3ui( m_assemblyGridSize, m_assemblyGridSize, 1 ), dp::math::Vec3f( 2.0f * m_partGridSize, 2.0f * m_partGridSize, 1.0f ), false );
+
+  m_root = dp::sg::core::Group::create();
+  m_root->addChild( m_assembly );
+
+  m_scene = dp::sg::core::Scene::create();
+  m_scene->setRootNode( m_root );
+
+  m_camera = dp::sg::core::PerspectiveCamera::create();
+}
+
+bool Benchmark_shared_observers::checkMasks( dp::sg::xbar::SceneTreeSharedPtr const & sceneTree, unsigned int mask ) const
+{
+  // every ObjectTree node of the cube and the part has to carry the new mask
+  dp::sg::xbar::ObjectTree & tree = sceneTree->getObjectTree();
+  size_t cubes = 0;
+  size_t parts = 0;
+  std::vector<dp::sg::xbar::ObjectTreeIndex> stack( 1, 0 );
+  while ( !stack.empty() )
+  {
+    dp::sg::xbar::ObjectTreeIndex index = stack.back();
+    stack.pop_back();
+
+    dp::sg::xbar::ObjectTreeNode const & node = tree[index];
+    if ( node.m_object == m_cube || node.m_object == m_part )
+    {
+      if ( node.m_localMask != mask )
+      {
+        std::cerr << "Error: ObjectTree node " << index << " missed a traversal mask change\n";
+        return false;
+      }
+      ++( node.m_object == m_cube ? cubes : parts );
+    }
+    for ( dp::sg::xbar::ObjectTreeIndex child = node.m_firstChild; child != ~0; child = tree[child].m_nextSibling )
+    {
+      stack.push_back( child );
+    }
+  }
+
+  unsigned int references = m_assemblyGridSize * m_assemblyGridSize;
+  if ( cubes != references * m_partGridSize * m_partGridSize || parts != references )
+  {
+    std::cerr << "Error: " << cubes << " cube and " << parts << " part nodes in the ObjectTree\n";
+    return false;
+  }
+  return true;
+}
+
+size_t Benchmark_shared_observers::countNodes( dp::sg::xbar::SceneTreeSharedPtr const & sceneTree ) const
+{
+  // the ObjectTree keeps removed nodes for reuse, count the ones reachable from the root
+  dp::sg::xbar::ObjectTree & tree = sceneTree->getObjectTree();
+  size_t count = 0;
+  std::vector<dp::sg::xbar::ObjectTreeIndex> stack( 1, 0 );
+  while ( !stack.empty() )
+  {
+    dp::sg::xbar::ObjectTreeIndex index = stack.back();
+    stack.pop_back();
+    ++count;
+    for ( dp::sg::xbar::ObjectTreeIndex child = tree[index].m_firstChild; child != ~0; child = tree[child].m_nextSibling )
+    {
+      stack.push_back( child );
+    }
+  }
+  return count;
+}
+
+bool Benchmark_shared_observers::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: benchmark_shared_observers");
+  od.add_options() ( "repetitions", options::value<unsigned int>()->default_value(4), "Number of SceneTrees to generate" )
+                   ( "assembly", options::value<unsigned int>()->default_value(32), "Size of the grid of part references in the assembly" )
+                   ( "part", options::value<unsigned int>()->default_value(8), "Size of the grid of cube references in the part" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_assemblyGridSize = std::max( 1u, optsMap["assembly"].as<unsigned int>() );
+  m_partGridSize = std::max( 1u, optsMap["part"].as<unsigned int>() );
+
+  return true;
+}
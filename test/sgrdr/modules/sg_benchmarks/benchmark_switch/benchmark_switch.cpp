@@ -0,0 +1,208 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <test/testfw/manager/Manager.h>
+#include "benchmark_switch.h"
+
+#include <dp/sg/core/GeoNode.h>
+#include <dp/sg/core/Group.h>
+#include <dp/sg/core/Scene.h>
+#include <dp/sg/generator/MeshGenerator.h>
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("benchmark_switch", "tests performance of SceneTree updates toggling a Switch above large assemblies", create_benchmark_switch);
+
+
+Benchmark_switch::DrawableManager::DrawableManager()
+  : m_drawableCount(0)
+  , m_activated(0)
+  , m_deactivated(0)
+{
+}
+
+std::map<dp::fx::Domain,std::string> Benchmark_switch::DrawableManager::getShaderSources( const dp::sg::core::GeoNodeSharedPtr & geoNode, bool depthPass ) const
+{
+  return std::map<dp::fx::Domain,std::string>();
+}
+
+Benchmark_switch::DrawableManager::Handle Benchmark_switch::DrawableManager::addDrawableInstance( dp::sg::core::GeoNodeWeakPtr geoNode, dp::sg::xbar::ObjectTreeIndex objectTreeIndex )
+{
+  ++m_drawableCount;
+  return HandleData::create();
+}
+
+void Benchmark_switch::DrawableManager::removeDrawableInstance( Handle handle )
+{
+  --m_drawableCount;
+}
+
+void Benchmark_switch::DrawableManager::setDrawableInstanceActive( Handle handle, bool visible )
+{
+  ++( visible ? m_activated : m_deactivated );
+}
+
+
+Benchmark_switch::Benchmark_switch()
+  : m_repetitions(16)
+  , m_gridSize(448)
+  , m_events(0)
+  , m_changes(0)
+  , m_time(0.0)
+{
+}
+
+Benchmark_switch::~Benchmark_switch()
+{
+}
+
+bool Benchmark_switch::onInit()
+{
+  createScene();
+
+  m_drawableManager.reset( new DrawableManager() );
+  m_drawableManager->setSceneTree( m_sceneTree );
+  m_sceneTree->attach( this );
+
+  // the initial activation of the drawables is not counted
+  m_drawableManager->m_activated = 0;
+  m_drawableManager->m_deactivated = 0;
+  return true;
+}
+
+bool Benchmark_switch::onRun( unsigned int i )
+{
+  // show the other assembly each frame
+  m_switch->setInactive( i % 2 );
+  m_switch->setActive( ( i + 1 ) % 2 );
+
+  size_t const events = m_events;
+  m_drawableManager->m_activated = 0;
+  m_drawableManager->m_deactivated = 0;
+
+  dp::util::Timer timer;
+  timer.start();
+  m_sceneTree->update( m_camera, 1.0f );
+  timer.stop();
+  m_time += timer.getTime();
+
+  // all changes of one update have to arrive in a single event
+  size_t const assemblySize = size_t(m_gridSize) * m_gridSize;
+  if ( m_events != events + 1 || m_drawableManager->m_activated != assemblySize || m_drawableManager->m_deactivated != assemblySize )
+  {
+    std::cerr << "Error: expected one event activating and deactivating " << assemblySize << " drawables each, got " << m_events - events
+              << " events activating " << m_drawableManager->m_activated << " and deactivating " << m_drawableManager->m_deactivated
+              << " drawables in frame " << i << "\n";
+    return false;
+  }
+  return true;
+}
+
+bool Benchmark_switch::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Benchmark_switch::onClear()
+{
+  std::cout << "2 assemblies with " << m_gridSize * m_gridSize << " drawables each, " << m_changes / std::max( size_t(1), m_events )
+            << " changes per event: " << 1000.0 * m_time / m_repetitions << " ms/update\n";
+
+  m_sceneTree->detach( this );
+  m_drawableManager.reset();
+  m_sceneTree.reset();
+  m_switch.reset();
+  m_camera.reset();
+
+  return true;
+}
+
+void Benchmark_switch::onNotify( dp::util::Event const & event, dp::util::Payload * payload )
+{
+  ++m_events;
+  m_changes += static_cast<dp::sg::xbar::SceneTree::Event const &>( event ).getChanges().size();
+}
+
+void Benchmark_switch::onDestroyed( dp::util::Subject const & subject, dp::util::Payload * payload )
+{
+}
+
+void Benchmark_switch::createScene()
+{
+  dp::sg::core::GeoNodeSharedPtr cube = dp::sg::generator::createGeoNode( dp::sg::generator::createCube() );
+
+  // a dynamic Switch above two assemblies of the same size, only the first one is active
+  m_switch = dp::sg::core::Switch::create();
+  m_switch->addHints( dp::sg::core::Object::DP_SG_HINT_DYNAMIC );
+  m_switch->addChild( dp::sg::generator::replicate( cube, dp::math::Vec3ui( m_gridSize, m_gridSize, 1 ), dp::math::Vec3f( 2.0f, 2.0f, 1.0f ) ) );
+  m_switch->addChild( dp::sg::generator::replicate( cube, dp::math::Vec3ui( m_gridSize, m_gridSize, 1 ), dp::math::Vec3f( 2.0f, 2.0f, 1.0f ) ) );
+  m_switch->setInactive();
+  m_switch->setActive( 0 );
+
+  dp::sg::core::GroupSharedPtr root = dp::sg::core::Group::create();
+  root->addChild( m_switch );
+
+  dp::sg::core::SceneSharedPtr scene = dp::sg::core::Scene::create();
+  scene->setRootNode( root );
+
+  m_camera = dp::sg::core::PerspectiveCamera::create();
+
+  m_sceneTree = dp::sg::xbar::SceneTree::create( scene );
+  m_sceneTree->update( m_camera, 1.0f );
+}
+
+bool Benchmark_switch::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: benchmark_switch");
+  od.add_options() ( "repetitions", options::value<unsigned int>()->default_value(16), "How often the Switch should be toggled" )
+                   ( "grid", options::value<unsigned int>()->default_value(448), "Size of the grid of drawables of each assembly" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_gridSize = std::max( 1u, optsMap["grid"].as<unsigned int>() );
+
+  return true;
+}
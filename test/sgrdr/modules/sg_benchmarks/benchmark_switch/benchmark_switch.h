@@ -0,0 +1,107 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <test/testfw/core/Test.h>
+#include <dp/sg/core/PerspectiveCamera.h>
+#include <dp/sg/core/Switch.h>
+#include <dp/sg/xbar/DrawableManager.h>
+#include <dp/sg/xbar/SceneTree.h>
+#include <dp/util/Observer.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Benchmark_switch : public dp::testfw::core::Test, public dp::util::Observer
+{
+public:
+  Benchmark_switch();
+  ~Benchmark_switch();
+
+  bool onInit( void );
+  bool onRun( unsigned int i );
+  bool onClear( void );
+
+  bool onRunCheck( unsigned int i );
+
+  bool option( const std::vector<std::string>& optionString );
+
+  void onNotify( dp::util::Event const & event, dp::util::Payload * payload );
+  void onDestroyed( dp::util::Subject const & subject, dp::util::Payload * payload );
+
+protected:
+  // counts the changes of the drawable instances passed from the SceneTree
+  class DrawableManager : public dp::sg::xbar::DrawableManager
+  {
+  public:
+    DrawableManager();
+
+    void update( dp::sg::ui::ViewStateSharedPtr const& viewState, std::vector<dp::sg::core::CameraSharedPtr> const & cameras ) {}
+    void update( dp::math::Vec2ui const & viewportSize ) {}
+
+    void setEnvironmentSampler( const dp::sg::core::SamplerSharedPtr & sampler ) { m_environmentSampler = sampler; }
+    const dp::sg::core::SamplerSharedPtr & getEnvironmentSampler() const { return m_environmentSampler; }
+
+    std::map<dp::fx::Domain,std::string> getShaderSources( const dp::sg::core::GeoNodeSharedPtr & geoNode, bool depthPass ) const;
+
+    size_t  m_drawableCount;
+    size_t  m_activated;
+    size_t  m_deactivated;
+
+  protected:
+    Handle addDrawableInstance( dp::sg::core::GeoNodeWeakPtr geoNode, dp::sg::xbar::ObjectTreeIndex objectTreeIndex );
+    void removeDrawableInstance( Handle handle );
+    void updateDrawableInstance( Handle handle ) {}
+    void setDrawableInstanceActive( Handle handle, bool visible );
+    void setDrawableInstanceTraversalMask( Handle handle, uint32_t traversalMask ) {}
+    void onSceneTreeChanged() {}
+
+  private:
+    dp::sg::core::SamplerSharedPtr  m_environmentSampler;
+  };
+
+protected:
+  void createScene();
+
+protected:
+  dp::sg::core::SwitchSharedPtr             m_switch;
+  dp::sg::xbar::SceneTreeSharedPtr          m_sceneTree;
+  dp::sg::core::PerspectiveCameraSharedPtr  m_camera;
+  std::unique_ptr<DrawableManager>          m_drawableManager;
+  unsigned int                              m_repetitions;
+  unsigned int                              m_gridSize;
+  size_t                                    m_events;
+  size_t                                    m_changes;
+  double                                    m_time;
+};
+
+extern "C"
+{
+  DPTTEST_API dp::testfw::core::Test * create_benchmark_switch()
+  {
+    return new Benchmark_switch();
+  }
+}
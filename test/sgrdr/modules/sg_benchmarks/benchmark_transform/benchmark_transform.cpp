@@ -0,0 +1,443 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include <test/testfw/manager/Manager.h>
+#include "benchmark_transform.h"
+
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("benchmark_transform", "tests performance of the world matrix computation of dp::transform::Tree", create_benchmark_transform);
+
+
+Benchmark_transform::Benchmark_transform()
+  : m_repetitions(32)
+  , m_threadCount(0)
+  , m_chainCount(64)
+  , m_animatedCount(16)
+  , m_removeAddCount(1024)
+  , m_compactInterval(8)
+  , m_compactCount(0)
+{
+}
+
+Benchmark_transform::~Benchmark_transform()
+{
+}
+
+bool Benchmark_transform::onInit()
+{
+  for ( size_t i = 0; i < m_transformCounts.size(); ++i )
+  {
+    createWide( m_transformCounts[i], false );
+    createWide( m_transformCounts[i], true );
+    createDeep( m_transformCounts[i] );
+  }
+
+  // the first computation after building the hierarchies updates all world matrices and is not measured
+  for ( size_t h = 0; h < m_hierarchies.size(); ++h )
+  {
+    for ( size_t c = 0; c < m_hierarchies[h].configurations.size(); ++c )
+    {
+      m_hierarchies[h].configurations[c].tree->compute( dp::math::cIdentity44f );
+    }
+  }
+  return checkOrphans();
+}
+
+bool Benchmark_transform::onRun( unsigned int i )
+{
+  bool success = true;
+  for ( size_t h = 0; h < m_hierarchies.size(); ++h )
+  {
+    Hierarchy & hierarchy = m_hierarchies[h];
+    if ( hierarchy.instanceCount && m_removeAddCount )
+    {
+      success &= removeAddParts( hierarchy, i );
+    }
+    if ( m_compactInterval && ( i + 1 ) % m_compactInterval == 0 )
+    {
+      success &= compact( hierarchy );
+    }
+
+    for ( size_t c = 0; c < hierarchy.configurations.size(); ++c )
+    {
+      Configuration & configuration = hierarchy.configurations[c];
+      for ( size_t a = 0; a < hierarchy.animated.size(); ++a )
+      {
+        configuration.tree->updateLocalMatrix( hierarchy.animated[a], getAnimationMatrix( i, a ) );
+      }
+
+      dp::util::Timer timer;
+      timer.start();
+      configuration.tree->compute( dp::math::cIdentity44f );
+      timer.stop();
+      configuration.time += timer.getTime();
+    }
+
+    // the matrices are computed with the same operations, so all configurations have to match the first one exactly
+    Configuration const & reference = hierarchy.configurations.front();
+    for ( size_t c = 1; c < hierarchy.configurations.size(); ++c )
+    {
+      Configuration const & configuration = hierarchy.configurations[c];
+      for ( size_t t = 0; t < hierarchy.transforms.size(); ++t )
+      {
+        dp::transform::Index index = hierarchy.transforms[t];
+        if ( memcmp( &reference.tree->getWorldMatrix( index ), &configuration.tree->getWorldMatrix( index ), sizeof(dp::math::Mat44f) ) != 0 )
+        {
+          std::cerr << "Error: " << configuration.name << " differs from " << reference.name << " for transform " << index << " of the "
+                    << hierarchy.name << " hierarchy in frame " << i << "\n";
+          success = false;
+          break;
+        }
+      }
+    }
+  }
+  return success;
+}
+
+bool Benchmark_transform::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Benchmark_transform::onClear()
+{
+  for ( size_t h = 0; h < m_hierarchies.size(); ++h )
+  {
+    Hierarchy const & hierarchy = m_hierarchies[h];
+    for ( size_t c = 0; c < hierarchy.configurations.size(); ++c )
+    {
+      Configuration const & configuration = hierarchy.configurations[c];
+      std::cout << hierarchy.name << ", " << configuration.name << ": " << 1000.0 * configuration.time / m_repetitions << " ms/frame\n";
+      if ( hierarchy.instanceCount && m_removeAddCount )
+      {
+        std::cout << hierarchy.name << ", " << configuration.name << ": removing and adding " << m_removeAddCount << " transforms: "
+                  << 1000.0 * configuration.removeAddTime / m_repetitions << " ms/frame\n";
+      }
+      if ( m_compactCount )
+      {
+        std::cout << hierarchy.name << ", " << configuration.name << ": compaction: " << 1000.0 * configuration.compactTime / m_compactCount << " ms\n";
+      }
+    }
+  }
+  m_hierarchies.clear();
+
+  return true;
+}
+
+void Benchmark_transform::createWide( size_t transformCount, bool sparse )
+{
+  m_hierarchies.push_back( Hierarchy() );
+  Hierarchy & hierarchy = m_hierarchies.back();
+  hierarchy.name = std::to_string( transformCount ) + ( sparse ? " transforms wide, " + std::to_string( m_animatedCount ) + " instances animated" : " transforms wide" );
+  addConfigurations( hierarchy );
+
+  // one assembly with many instances, each instance has one part. Moving the assembly changes all world matrices,
+  // the sparse variant moves only a few instances spread over the whole tree.
+  size_t const instanceCount = std::max( size_t(1), ( transformCount - 1 ) / 2 );
+  hierarchy.instanceCount = instanceCount;
+  for ( size_t c = 0; c < hierarchy.configurations.size(); ++c )
+  {
+    dp::transform::Tree & tree = *hierarchy.configurations[c].tree;
+    std::vector<dp::transform::Index> & transforms = hierarchy.transforms;
+    transforms.clear();
+
+    dp::transform::Index assembly = tree.addTransform( tree.getRoot(), dp::math::cIdentity44f );
+    transforms.push_back( assembly );
+    hierarchy.animated.assign( 1, assembly );
+
+    size_t const animatedStride = std::max( size_t(1), instanceCount / std::max( 1u, m_animatedCount ) );
+    if ( sparse )
+    {
+      hierarchy.animated.clear();
+    }
+    for ( size_t i = 0; i < instanceCount; ++i )
+    {
+      dp::transform::Index instance = tree.addTransform( assembly, getAnimationMatrix( 0, i ) );
+      transforms.push_back( instance );
+      transforms.push_back( tree.addTransform( instance, getAnimationMatrix( 1, i ) ) );
+      if ( sparse && i % animatedStride == 0 && hierarchy.animated.size() < m_animatedCount )
+      {
+        hierarchy.animated.push_back( instance );
+      }
+    }
+  }
+}
+
+void Benchmark_transform::createDeep( size_t transformCount )
+{
+  m_hierarchies.push_back( Hierarchy() );
+  Hierarchy & hierarchy = m_hierarchies.back();
+  hierarchy.name = std::to_string( transformCount ) + " transforms deep";
+  hierarchy.instanceCount = 0;
+  addConfigurations( hierarchy );
+
+  // a few long chains, each level holds one transform per chain. Moving the first transforms changes all world matrices.
+  size_t const chainLength = std::max( size_t(1), transformCount / m_chainCount );
+  for ( size_t c = 0; c < hierarchy.configurations.size(); ++c )
+  {
+    dp::transform::Tree & tree = *hierarchy.configurations[c].tree;
+    hierarchy.transforms.clear();
+    hierarchy.animated.clear();
+
+    for ( unsigned int chain = 0; chain < m_chainCount; ++chain )
+    {
+      dp::transform::Index parent = tree.getRoot();
+      for ( size_t i = 0; i < chainLength; ++i )
+      {
+        parent = tree.addTransform( parent, getAnimationMatrix( 0, i ) );
+        hierarchy.transforms.push_back( parent );
+        if ( i == 0 )
+        {
+          hierarchy.animated.push_back( parent );
+        }
+      }
+    }
+  }
+}
+
+void Benchmark_transform::addConfigurations( Hierarchy & hierarchy )
+{
+  hierarchy.configurations.resize( 3 );
+
+  // the single threaded sweep over all levels is the reference for the other configurations
+  hierarchy.configurations[0].name = "single threaded sweep";
+  hierarchy.configurations[0].tree.reset( new dp::transform::Tree() );
+  hierarchy.configurations[0].tree->setSparseFraction( 0.0f );
+  hierarchy.configurations[0].time = 0.0;
+
+  hierarchy.configurations[1].name = "single threaded";
+  hierarchy.configurations[1].tree.reset( new dp::transform::Tree() );
+  hierarchy.configurations[1].time = 0.0;
+
+  hierarchy.configurations[2].name = "multithreaded";
+  hierarchy.configurations[2].tree.reset( new dp::transform::Tree() );
+  hierarchy.configurations[2].tree->setThreadCount( m_threadCount );
+  hierarchy.configurations[2].time = 0.0;
+
+  for ( size_t c = 0; c < hierarchy.configurations.size(); ++c )
+  {
+    hierarchy.configurations[c].removeAddTime = 0.0;
+    hierarchy.configurations[c].compactTime = 0.0;
+    hierarchy.configurations[c].tree->attach( this );
+  }
+}
+
+bool Benchmark_transform::removeAddParts( Hierarchy & hierarchy, unsigned int frame )
+{
+  // the parts are leaves and never animated. Remove parts spread over the whole hierarchy and add them again with the same local matrix.
+  size_t const count = std::min( size_t(m_removeAddCount), hierarchy.instanceCount );
+  size_t const stride = hierarchy.instanceCount / count;
+  size_t const offset = frame % stride;
+
+  std::vector<dp::transform::Index> parts( count );
+  bool success = true;
+  for ( size_t c = 0; c < hierarchy.configurations.size(); ++c )
+  {
+    Configuration & configuration = hierarchy.configurations[c];
+    dp::transform::Tree & tree = *configuration.tree;
+
+    dp::util::Timer timer;
+    timer.start();
+    for ( size_t p = 0; p < count; ++p )
+    {
+      tree.removeTransform( hierarchy.transforms[2 + 2 * ( offset + p * stride )] );
+    }
+    for ( size_t p = 0; p < count; ++p )
+    {
+      size_t const i = offset + p * stride;
+      dp::transform::Index part = tree.addTransform( hierarchy.transforms[1 + 2 * i], getAnimationMatrix( 1, i ) );
+
+      // all trees execute the same operations and have to reuse the same indices
+      if ( c == 0 )
+      {
+        parts[p] = part;
+      }
+      else if ( parts[p] != part )
+      {
+        success = false;
+      }
+    }
+    timer.stop();
+    configuration.removeAddTime += timer.getTime();
+  }
+
+  if ( !success )
+  {
+    std::cerr << "Error: the configurations allocated different indices in the " << hierarchy.name << " hierarchy in frame " << frame << "\n";
+  }
+  for ( size_t p = 0; p < count; ++p )
+  {
+    hierarchy.transforms[2 + 2 * ( offset + p * stride )] = parts[p];
+  }
+  return success;
+}
+
+bool Benchmark_transform::compact( Hierarchy & hierarchy )
+{
+  std::vector<dp::transform::Index> remap;
+  bool success = true;
+  for ( size_t c = 0; c < hierarchy.configurations.size(); ++c )
+  {
+    Configuration & configuration = hierarchy.configurations[c];
+
+    dp::util::Timer timer;
+    timer.start();
+    configuration.tree->compact();
+    timer.stop();
+    configuration.compactTime += timer.getTime();
+
+    if ( c == 0 )
+    {
+      remap.swap( m_remap );
+    }
+    else if ( remap != m_remap )
+    {
+      std::cerr << "Error: " << configuration.name << " remapped the transforms differently than " << hierarchy.configurations.front().name
+                << " in the " << hierarchy.name << " hierarchy\n";
+      success = false;
+    }
+  }
+
+  for ( size_t t = 0; t < hierarchy.transforms.size(); ++t )
+  {
+    hierarchy.transforms[t] = remap[hierarchy.transforms[t]];
+  }
+  for ( size_t a = 0; a < hierarchy.animated.size(); ++a )
+  {
+    hierarchy.animated[a] = remap[hierarchy.animated[a]];
+  }
+  if ( &hierarchy == &m_hierarchies.back() )
+  {
+    ++m_compactCount;
+  }
+  return success;
+}
+
+bool Benchmark_transform::checkOrphans()
+{
+  // removing the middle of a chain orphans its end, which the compaction drops instead of moving it below the root
+  dp::transform::Tree tree;
+  tree.attach( this );
+  dp::transform::Index top = tree.addTransform( tree.getRoot(), getAnimationMatrix( 0, 0 ) );
+  dp::transform::Index middle = tree.addTransform( top, getAnimationMatrix( 0, 1 ) );
+  dp::transform::Index bottom = tree.addTransform( middle, getAnimationMatrix( 0, 2 ) );
+  tree.compute( dp::math::cIdentity44f );
+
+  tree.removeTransform( middle );
+  size_t const usedCount = tree.getUsedTransformCount();
+  tree.compact();
+
+  if ( m_remap[top] == dp::transform::InvalidIndex || m_remap[bottom] != dp::transform::InvalidIndex || tree.getUsedTransformCount() != usedCount - 1 )
+  {
+    std::cerr << "Error: the compaction kept an orphaned transform\n";
+    return false;
+  }
+  return true;
+}
+
+void Benchmark_transform::onNotify( dp::util::Event const & event, dp::util::Payload * payload )
+{
+  dp::transform::Tree::Event const & treeEvent = static_cast<dp::transform::Tree::Event const &>( event );
+  if ( treeEvent.getType() == dp::transform::Tree::Event::Type::TRANSFORMS_REMAPPED )
+  {
+    m_remap = static_cast<dp::transform::Tree::EventTransformsRemapped const &>( treeEvent ).getRemap();
+  }
+}
+
+void Benchmark_transform::onDestroyed( dp::util::Subject const & subject, dp::util::Payload * payload )
+{
+}
+
+dp::math::Mat44f Benchmark_transform::getAnimationMatrix( unsigned int frame, size_t index ) const
+{
+  // a small rotation around the z axis combined with a translation, different per frame and transform
+  float const angle = 0.01f * float( frame ) + 0.001f * float( index % 1000 );
+  float const c = std::cos( angle );
+  float const s = std::sin( angle );
+  return dp::math::Mat44f( {    c,    s, 0.0f, 0.0f
+                           ,   -s,    c, 0.0f, 0.0f
+                           , 0.0f, 0.0f, 1.0f, 0.0f
+                           , 0.1f * float( index % 7 ), 0.1f, 0.0f, 1.0f } );
+}
+
+bool Benchmark_transform::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: benchmark_transform");
+  od.add_options() ( "transforms", options::value<unsigned int>(), "Number of transforms per hierarchy. If not specified, 100000 and 1000000 transforms are benchmarked." )
+                   ( "repetitions", options::value<unsigned int>()->default_value(32), "How many frames should be computed" )
+                   ( "threads", options::value<unsigned int>()->default_value(0), "Number of threads for the multithreaded computation, 0 uses all hardware threads" )
+                   ( "chains", options::value<unsigned int>()->default_value(64), "Number of chains of the deep hierarchy" )
+                   ( "animated", options::value<unsigned int>()->default_value(16), "Number of instances animated in the sparse variant of the wide hierarchy" )
+                   ( "removeAdd", options::value<unsigned int>()->default_value(1024), "Number of transforms removed and added again each frame in the wide hierarchies" )
+                   ( "compactInterval", options::value<unsigned int>()->default_value(8), "Compact the trees every n frames, 0 disables the compaction" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_transformCounts.clear();
+  if ( !optsMap["transforms"].empty() )
+  {
+    m_transformCounts.push_back( optsMap["transforms"].as<unsigned int>() );
+  }
+  else
+  {
+    m_transformCounts.push_back( 100000 );
+    m_transformCounts.push_back( 1000000 );
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_threadCount = optsMap["threads"].as<unsigned int>();
+  m_chainCount = std::max( 1u, optsMap["chains"].as<unsigned int>() );
+  m_animatedCount = optsMap["animated"].as<unsigned int>();
+  m_removeAddCount = optsMap["removeAdd"].as<unsigned int>();
+  m_compactInterval = optsMap["compactInterval"].as<unsigned int>();
+
+  return true;
+}
@@ -0,0 +1,104 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#pragma once
+
+#include <test/testfw/core/Test.h>
+#include <dp/transform/Tree.h>
+#include <dp/util/Observer.h>
+#include <dp/math/Matmnt.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Benchmark_transform : public dp::testfw::core::Test, public dp::util::Observer
+{
+public:
+  Benchmark_transform();
+  ~Benchmark_transform();
+
+  bool onInit( void );
+  bool onRun( unsigned int i );
+  bool onClear( void );
+
+  bool onRunCheck( unsigned int i );
+
+  bool option( const std::vector<std::string>& optionString );
+
+  void onNotify( dp::util::Event const & event, dp::util::Payload * payload );
+  void onDestroyed( dp::util::Subject const & subject, dp::util::Payload * payload );
+
+protected:
+  struct Configuration
+  {
+    std::string                             name;
+    std::unique_ptr<dp::transform::Tree>    tree;
+    double                                  time;
+    double                                  removeAddTime;
+    double                                  compactTime;
+  };
+
+  // the same hierarchy is built in each configuration, so the transform indices are equal in all trees
+  struct Hierarchy
+  {
+    std::string                         name;
+    std::vector<dp::transform::Index>   animated;   // transforms changed each frame
+    std::vector<dp::transform::Index>   transforms; // all transforms
+    size_t                              instanceCount;  // instances with one part of the wide hierarchy, the parts are removed and added again each frame
+    std::vector<Configuration>          configurations;
+  };
+
+protected:
+  void createWide( size_t transformCount, bool sparse );
+  void createDeep( size_t transformCount );
+  void addConfigurations( Hierarchy & hierarchy );
+  bool removeAddParts( Hierarchy & hierarchy, unsigned int frame );
+  bool compact( Hierarchy & hierarchy );
+  bool checkOrphans();
+  dp::math::Mat44f getAnimationMatrix( unsigned int frame, size_t index ) const;
+
+protected:
+  std::vector<size_t>     m_transformCounts;
+  std::vector<Hierarchy>  m_hierarchies;
+  unsigned int            m_repetitions;
+  unsigned int            m_threadCount;
+  unsigned int            m_chainCount;
+  unsigned int            m_animatedCount;
+  unsigned int            m_removeAddCount;
+  unsigned int            m_compactInterval;
+  unsigned int            m_compactCount;
+
+  std::vector<dp::transform::Index> m_remap;  // remap of the last compacted tree
+};
+
+extern "C"
+{
+  DPTTEST_API dp::testfw::core::Test * create_benchmark_transform()
+  {
+    return new Benchmark_transform();
+  }
+}
@@ -0,0 +1,287 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include <test/testfw/manager/Manager.h>
+#include "culling_small_features.h"
+
+#include <dp/sg/core/GeoNode.h>
+#include <dp/sg/core/Group.h>
+#include <dp/sg/core/Scene.h>
+#include <dp/sg/core/Transform.h>
+#include <dp/sg/generator/MeshGenerator.h>
+#include <dp/sg/xbar/Tree.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <iostream>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("culling_small_features", "tests small feature culling of the cpu culling modes", create_culling_small_features);
+
+
+Culling_small_features::Culling_small_features()
+  : m_repetitions(8)
+  , m_gridSize(32)
+  , m_smallScale(0.05f)
+  , m_minimumPixelArea(16.0f)
+  , m_viewportSize(1024, 1024)
+  , m_frustumObjects(0)
+  , m_culledObjects(0)
+{
+}
+
+Culling_small_features::~Culling_small_features()
+{
+}
+
+bool Culling_small_features::onInit()
+{
+  createScene();
+
+  struct
+  {
+    dp::culling::Mode mode;
+    char const*       name;
+  } const modes[] =
+  {
+      { dp::culling::Mode::CPU, "cpu flat" }
+    , { dp::culling::Mode::CPU_BVH, "cpu bvh" }
+  };
+  for ( size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i )
+  {
+    Configuration configuration;
+    configuration.name = modes[i].name;
+    configuration.culling = dp::sg::xbar::culling::Culling::create( m_sceneTree, modes[i].mode );
+    configuration.frustumResult = configuration.culling->resultCreate();
+    configuration.smallFeatureResult = configuration.culling->resultCreate();
+    m_configurations.push_back( configuration );
+  }
+
+  collectDrawables();
+  return true;
+}
+
+bool Culling_small_features::onRun( unsigned int i )
+{
+  placeCamera( i );
+  m_sceneTree->update( m_camera, 1.0f );
+  dp::math::Mat44f const viewProjection = m_camera->getWorldToViewMatrix() * m_camera->getProjection();
+
+  bool success = true;
+  for ( size_t c = 0; c < m_configurations.size(); ++c )
+  {
+    Configuration const & configuration = m_configurations[c];
+    configuration.culling->cull( configuration.frustumResult, viewProjection );
+    configuration.culling->cull( configuration.smallFeatureResult, viewProjection, m_viewportSize, m_minimumPixelArea );
+
+    // objects clearly below or above the minimum area have to be culled or kept, the area of the others depends on rounding
+    for ( size_t d = 0; d < m_drawables.size(); ++d )
+    {
+      Drawable const & drawable = m_drawables[d];
+      bool const inFrustum = configuration.culling->resultIsVisible( configuration.frustumResult, drawable.objectTreeIndex );
+      bool const visible = configuration.culling->resultIsVisible( configuration.smallFeatureResult, drawable.objectTreeIndex );
+      float const area = getPixelArea( drawable, viewProjection );
+
+      if ( ( visible && !inFrustum )
+        || ( visible && area < 0.5f * m_minimumPixelArea )
+        || ( !visible && inFrustum && 2.0f * m_minimumPixelArea < area ) )
+      {
+        std::cerr << "Error: " << configuration.name << " has wrong visibility " << visible << " for object " << drawable.objectTreeIndex
+                  << " with an area of " << area << " pixels in frame " << i << "\n";
+        success = false;
+        break;
+      }
+
+      if ( c == 0 )
+      {
+        m_frustumObjects += inFrustum;
+        m_culledObjects += inFrustum && !visible;
+      }
+    }
+  }
+  return success;
+}
+
+bool Culling_small_features::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Culling_small_features::onClear()
+{
+  std::cout << 2 * m_gridSize * m_gridSize << " objects, " << 100.0 * m_culledObjects / std::max( size_t(1), m_frustumObjects )
+            << "% of the objects in the frustum culled as small features with a minimum area of " << m_minimumPixelArea << " pixels\n";
+
+  m_configurations.clear();
+  m_drawables.clear();
+  m_sceneTree.reset();
+  m_camera.reset();
+
+  return true;
+}
+
+void Culling_small_features::createScene()
+{
+  dp::sg::core::GeoNodeSharedPtr cube = dp::sg::generator::createGeoNode( dp::sg::generator::createCube() );
+
+  // a grid of large cubes with a distance of 4 units and a grid of small cubes placed in the gaps of the large one
+  dp::sg::core::GroupSharedPtr largeGrid = dp::sg::generator::replicate( cube, dp::math::Vec3ui( m_gridSize, m_gridSize, 1 ), dp::math::Vec3f( 2.0f, 2.0f, 1.0f ) );
+
+  dp::sg::core::TransformSharedPtr smallCube = dp::sg::generator::createTransform( cube, dp::math::Vec3f( 0.0f, 0.0f, 0.0f )
+                                                                                 , dp::math::Quatf( dp::math::Vec3f( 0.0f, 1.0f, 0.0f ), 0.0f )
+                                                                                 , dp::math::Vec3f( m_smallScale, m_smallScale, m_smallScale ) );
+  dp::sg::core::GroupSharedPtr smallGrid = dp::sg::generator::replicate( smallCube, dp::math::Vec3ui( m_gridSize, m_gridSize, 1 )
+                                                                       , dp::math::Vec3f( 2.0f / m_smallScale, 2.0f / m_smallScale, 1.0f ) );
+
+  dp::sg::core::GroupSharedPtr root = dp::sg::core::Group::create();
+  root->addChild( largeGrid );
+  root->addChild( dp::sg::generator::createTransform( smallGrid, dp::math::Vec3f( 2.0f, 2.0f, 0.0f ) ) );
+
+  dp::sg::core::SceneSharedPtr scene = dp::sg::core::Scene::create();
+  scene->setRootNode( root );
+
+  m_camera = dp::sg::core::PerspectiveCamera::create();
+  m_camera->setAspectRatio( float(m_viewportSize[0]) / float(m_viewportSize[1]) );
+  m_camera->setFieldOfView( dp::math::PI_QUARTER );
+  m_camera->setDirection( dp::math::Vec3f( 0.0f, 0.0f, -1.0f ) );
+  m_camera->setUpVector( dp::math::Vec3f( 0.0f, 1.0f, 0.0f ) );
+  placeCamera( 0 );
+
+  m_sceneTree = dp::sg::xbar::SceneTree::create( scene );
+  m_sceneTree->update( m_camera, 1.0f );
+}
+
+void Culling_small_features::collectDrawables()
+{
+  class Visitor
+  {
+  public:
+    struct Data {};
+
+    Visitor( dp::sg::xbar::ObjectTree const & objectTree, std::vector<Drawable> & drawables )
+      : m_objectTree( objectTree )
+      , m_drawables( drawables )
+    {
+    }
+
+    bool preTraverse( dp::sg::xbar::ObjectTreeIndex index, Data const & data )
+    {
+      dp::sg::xbar::ObjectTreeNode const & node = m_objectTree[index];
+      if ( node.m_isDrawable )
+      {
+        Drawable drawable;
+        drawable.objectTreeIndex = index;
+        drawable.transformIndex = node.m_transform;
+        drawable.boundingBox = std::static_pointer_cast<dp::sg::core::GeoNode>( node.m_object )->getBoundingBox();
+        m_drawables.push_back( drawable );
+      }
+      return true;
+    }
+
+    void postTraverse( dp::sg::xbar::ObjectTreeIndex index, Data const & data )
+    {
+    }
+
+  private:
+    dp::sg::xbar::ObjectTree const & m_objectTree;
+    std::vector<Drawable>          & m_drawables;
+  };
+
+  dp::sg::xbar::PreOrderTreeTraverser<dp::sg::xbar::ObjectTree, Visitor> traverser;
+  Visitor visitor( m_sceneTree->getObjectTree(), m_drawables );
+  traverser.traverse( m_sceneTree->getObjectTree(), visitor );
+}
+
+void Culling_small_features::placeCamera( unsigned int frame )
+{
+  // start far enough away to see most of the grid and move closer each frame, so that more and more small cubes become visible
+  float const center = 2.0f * ( m_gridSize - 1 );
+  float const distance = 4.0f * m_gridSize / ( 1.0f + frame );
+  m_camera->setPosition( dp::math::Vec3f( center, center, distance ) );
+  m_camera->setNearDistance( 0.1f );
+  m_camera->setFarDistance( 2.0f * distance );
+}
+
+float Culling_small_features::getPixelArea( Drawable const & drawable, dp::math::Mat44f const & viewProjection ) const
+{
+  dp::math::Mat44f const modelViewProjection = m_sceneTree->getTransformTree().getTree().getWorldMatrix( drawable.transformIndex ) * viewProjection;
+  dp::math::Vec3f const & lower = drawable.boundingBox.getLower();
+  dp::math::Vec3f const & upper = drawable.boundingBox.getUpper();
+
+  dp::math::Vec2f minimum( FLT_MAX, FLT_MAX );
+  dp::math::Vec2f maximum( -FLT_MAX, -FLT_MAX );
+  for ( unsigned int corner = 0; corner < 8; ++corner )
+  {
+    dp::math::Vec4f const position = dp::math::Vec4f( ( corner & 1 ) ? upper[0] : lower[0]
+                                                    , ( corner & 2 ) ? upper[1] : lower[1]
+                                                    , ( corner & 4 ) ? upper[2] : lower[2]
+                                                    , 1.0f ) * modelViewProjection;
+    if ( position[3] <= 0.0f )
+    {
+      return FLT_MAX;
+    }
+    for ( unsigned int i = 0; i < 2; ++i )
+    {
+      minimum[i] = std::min( minimum[i], position[i] / position[3] );
+      maximum[i] = std::max( maximum[i], position[i] / position[3] );
+    }
+  }
+  return ( maximum[0] - minimum[0] ) * 0.5f * m_viewportSize[0] * ( maximum[1] - minimum[1] ) * 0.5f * m_viewportSize[1];
+}
+
+bool Culling_small_features::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: culling_small_features");
+  od.add_options() ( "repetitions", options::value<unsigned int>()->default_value(8), "How many frames should be culled, the camera moves closer each frame" )
+                   ( "grid", options::value<unsigned int>()->default_value(32), "Size of the grids of large and small cubes" )
+                   ( "area", options::value<float>()->default_value(16.0f), "Minimum area in pixels of visible objects" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_gridSize = std::max( 1u, optsMap["grid"].as<unsigned int>() );
+  m_minimumPixelArea = optsMap["area"].as<float>();
+
+  return true;
+}
@@ -0,0 +1,96 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#pragma once
+
+#include <test/testfw/core/Test.h>
+#include <dp/sg/core/PerspectiveCamera.h>
+#include <dp/sg/xbar/SceneTree.h>
+#include <dp/sg/xbar/culling/Culling.h>
+#include <dp/math/Boxnt.h>
+#include <dp/math/Matmnt.h>
+#include <string>
+#include <vector>
+
+class Culling_small_features : public dp::testfw::core::Test
+{
+public:
+  Culling_small_features();
+  ~Culling_small_features();
+
+  bool onInit( void );
+  bool onRun( unsigned int i );
+  bool onClear( void );
+
+  bool onRunCheck( unsigned int i );
+
+  bool option( const std::vector<std::string>& optionString );
+
+protected:
+  // a culling mode with one result culled without and one culled with small feature culling
+  struct Configuration
+  {
+    std::string                                 name;
+    dp::sg::xbar::culling::CullingSharedPtr     culling;
+    dp::sg::xbar::culling::ResultSharedPtr      frustumResult;
+    dp::sg::xbar::culling::ResultSharedPtr      smallFeatureResult;
+  };
+
+  struct Drawable
+  {
+    dp::sg::xbar::ObjectTreeIndex objectTreeIndex;
+    dp::sg::xbar::TransformIndex  transformIndex;
+    dp::math::Box3f               boundingBox;
+  };
+
+protected:
+  void createScene();
+  void collectDrawables();
+  void placeCamera( unsigned int frame );
+  float getPixelArea( Drawable const & drawable, dp::math::Mat44f const & viewProjection ) const;
+
+protected:
+  dp::sg::xbar::SceneTreeSharedPtr          m_sceneTree;
+  dp::sg::core::PerspectiveCameraSharedPtr  m_camera;
+  std::vector<Configuration>                m_configurations;
+  std::vector<Drawable>                     m_drawables;
+  unsigned int                              m_repetitions;
+  unsigned int                              m_gridSize;
+  float                                     m_smallScale;
+  float                                     m_minimumPixelArea;
+  dp::math::Vec2ui                          m_viewportSize;
+  size_t                                    m_frustumObjects;
+  size_t                                    m_culledObjects;
+};
+
+extern "C"
+{
+  DPTTEST_API dp::testfw::core::Test * create_culling_small_features()
+  {
+    return new Culling_small_features();
+  }
+}
@@ -0,0 +1,302 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <test/testfw/manager/Manager.h>
+#include "scene_tree_compaction.h"
+
+#include <dp/sg/core/GeoNode.h>
+#include <dp/sg/core/Scene.h>
+#include <dp/sg/generator/MeshGenerator.h>
+#include <dp/transform/Tree.h>
+#include <dp/util/Timer.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+
+namespace options = boost::program_options;
+
+//Automatically add the test to the module's global test list
+REGISTER_TEST("scene_tree_compaction", "tests the SceneTree and the culling across compactions of the transform tree", create_scene_tree_compaction);
+
+
+static bool isSimilar( dp::math::Mat44f const & lhs, dp::math::Mat44f const & rhs )
+{
+  for ( unsigned int i = 0; i < 4; ++i )
+  {
+    for ( unsigned int j = 0; j < 4; ++j )
+    {
+      if ( 1e-4f * std::max( 1.0f, std::abs( rhs[i][j] ) ) < std::abs( lhs[i][j] - rhs[i][j] ) )
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+Scene_tree_compaction::Scene_tree_compaction()
+  : m_repetitions(8)
+  , m_partCount(64)
+  , m_compactTime(0.0)
+{
+}
+
+Scene_tree_compaction::~Scene_tree_compaction()
+{
+}
+
+bool Scene_tree_compaction::onInit()
+{
+  createScene();
+  m_culling = dp::sg::xbar::culling::Culling::create( m_sceneTree, dp::culling::Mode::CPU );
+  return check( "initialization", 0 );
+}
+
+bool Scene_tree_compaction::onRun( unsigned int i )
+{
+  dp::sg::core::GroupSharedPtr root = std::static_pointer_cast<dp::sg::core::Group>( m_scene->getRootNode() );
+
+  // remove a third of the parts to leave holes in the transform tree
+  std::vector<dp::sg::core::TransformSharedPtr> removed;
+  for ( unsigned int p = 0; p < m_partCount; ++p )
+  {
+    if ( ( p + i ) % 3 == 0 )
+    {
+      root->removeChild( m_parts[p] );
+      removed.push_back( m_parts[p] );
+    }
+  }
+  update();
+
+  dp::util::Timer timer;
+  timer.start();
+  m_sceneTree->getTransformTree().getTree().compact();
+  timer.stop();
+  m_compactTime += timer.getTime();
+
+  bool success = check( "compaction", i );
+
+  // moving a part after the compaction requires the dirty transforms to follow the remap
+  unsigned int moved = m_partCount - 1;
+  while ( ( moved + i ) % 3 == 0 )
+  {
+    --moved;
+  }
+  dp::math::Trafo trafo = m_parts[moved]->getTrafo();
+  trafo.setTranslation( trafo.getTranslation() + dp::math::Vec3f( 0.0f, 1.0f, 0.0f ) );
+  m_parts[moved]->setTrafo( trafo );
+  update();
+  success = check( "update", i ) && success;
+
+  // the new parts reuse the compacted indices
+  for ( size_t p = 0; p < removed.size(); ++p )
+  {
+    root->addChild( removed[p] );
+  }
+  update();
+  return check( "insertion", i ) && success;
+}
+
+bool Scene_tree_compaction::onRunCheck( unsigned int i )
+{
+  return i < m_repetitions;
+}
+
+bool Scene_tree_compaction::onClear()
+{
+  std::cout << m_partCount << " parts, compaction of the transform tree took " << 1000.0 * m_compactTime / std::max( 1u, m_repetitions ) << " ms per frame\n";
+
+  m_culling.reset();
+  m_sceneTree.reset();
+  m_parts.clear();
+  m_camera.reset();
+  m_scene.reset();
+
+  return true;
+}
+
+void Scene_tree_compaction::createScene()
+{
+  dp::sg::core::GeoNodeSharedPtr cube = dp::sg::generator::createGeoNode( dp::sg::generator::createCube() );
+
+  // a row of parts, each a transformed grid of transformed cubes
+  dp::sg::core::GroupSharedPtr root = dp::sg::core::Group::create();
+  for ( unsigned int p = 0; p < m_partCount; ++p )
+  {
+    dp::sg::core::GroupSharedPtr grid = dp::sg::generator::replicate( cube, dp::math::Vec3ui( 4, 4, 1 ), dp::math::Vec3f( 2.0f, 2.0f, 1.0f ) );
+    m_parts.push_back( dp::sg::generator::createTransform( grid, dp::math::Vec3f( 10.0f * p, 0.0f, 0.0f ) ) );
+    root->addChild( m_parts.back() );
+  }
+
+  m_scene = dp::sg::core::Scene::create();
+  m_scene->setRootNode( root );
+
+  m_camera = dp::sg::core::PerspectiveCamera::create();
+  m_camera->setPosition( dp::math::Vec3f( 5.0f * m_partCount, 4.0f, 10.0f * m_partCount ) );
+  m_camera->setDirection( dp::math::Vec3f( 0.0f, 0.0f, -1.0f ) );
+  m_camera->setUpVector( dp::math::Vec3f( 0.0f, 1.0f, 0.0f ) );
+
+  m_sceneTree = dp::sg::xbar::SceneTree::create( m_scene );
+  update();
+}
+
+void Scene_tree_compaction::update()
+{
+  m_sceneTree->update( m_camera, 1.0f );
+}
+
+bool Scene_tree_compaction::check( char const * step, unsigned int frame )
+{
+  dp::sg::xbar::ObjectTree & tree = m_sceneTree->getObjectTree();
+  dp::transform::Tree const & transforms = m_sceneTree->getTransformTree().getTree();
+
+  // a parallel projection of the left half of the scene
+  dp::math::Box3f const sceneBox = m_scene->getRootNode()->getBoundingBox();
+  dp::math::Vec3f const lower = sceneBox.getLower();
+  dp::math::Vec3f const upper = sceneBox.getUpper();
+  float const split = 0.5f * ( lower[0] + upper[0] );
+  dp::math::Vec3f const scale( 2.0f / ( split - lower[0] ), 2.0f / ( upper[1] - lower[1] ), 2.0f / ( upper[2] - lower[2] + 1.0f ) );
+  dp::math::Mat44f const world2ViewProjection( { scale[0], 0.0f, 0.0f, 0.0f
+                                               , 0.0f, scale[1], 0.0f, 0.0f
+                                               , 0.0f, 0.0f, scale[2], 0.0f
+                                               , -1.0f - scale[0] * lower[0], -1.0f - scale[1] * lower[1], -1.0f - scale[2] * ( lower[2] - 0.5f ), 1.0f } );
+
+  dp::sg::xbar::culling::ResultSharedPtr result = m_culling->resultCreate();
+  m_culling->cull( result, world2ViewProjection );
+
+  size_t drawables = 0;
+  size_t visible = 0;
+  std::vector<dp::sg::xbar::ObjectTreeIndex> stack( 1, 0 );
+  while ( !stack.empty() )
+  {
+    dp::sg::xbar::ObjectTreeIndex index = stack.back();
+    stack.pop_back();
+    dp::sg::xbar::ObjectTreeNode const & node = tree[index];
+
+    // transforms start a new transform below the one of their parent, all other nodes share the transform of their parent
+    if ( node.m_parentIndex != ~0 )
+    {
+      dp::sg::xbar::ObjectTreeNode const & parent = tree[node.m_parentIndex];
+      if ( node.m_isTransform ? ( node.m_transformParent != parent.m_transform || node.m_transform == parent.m_transform )
+                              : ( node.m_transformParent != parent.m_transformParent || node.m_transform != parent.m_transform ) )
+      {
+        std::cerr << "Error: inconsistent transform " << node.m_transform << " of object " << index << " after " << step << " in frame " << frame << "\n";
+        return false;
+      }
+    }
+
+    if ( node.m_isTransform || node.m_isDrawable )
+    {
+      dp::math::Mat44f const reference = getReferenceMatrix( index );
+      if ( !isSimilar( transforms.getWorldMatrix( node.m_transform ), reference ) )
+      {
+        std::cerr << "Error: wrong world matrix of transform " << node.m_transform << " of object " << index << " after " << step << " in frame " << frame << "\n";
+        return false;
+      }
+
+      // drawables crossing the split may go either way
+      if ( node.m_isDrawable )
+      {
+        dp::math::Box3f const box = std::static_pointer_cast<dp::sg::core::GeoNode>( node.m_object )->getBoundingBox();
+        float minX = FLT_MAX;
+        float maxX = -FLT_MAX;
+        for ( unsigned int corner = 0; corner < 8; ++corner )
+        {
+          dp::math::Vec4f const position = dp::math::Vec4f( ( corner & 1 ) ? box.getUpper()[0] : box.getLower()[0]
+                                                          , ( corner & 2 ) ? box.getUpper()[1] : box.getLower()[1]
+                                                          , ( corner & 4 ) ? box.getUpper()[2] : box.getLower()[2], 1.0f ) * reference;
+          minX = std::min( minX, position[0] );
+          maxX = std::max( maxX, position[0] );
+        }
+
+        bool const isVisible = m_culling->resultIsVisible( result, index );
+        if ( ( isVisible && split < minX ) || ( !isVisible && maxX < split ) )
+        {
+          std::cerr << "Error: wrong visibility " << isVisible << " of object " << index << " after " << step << " in frame " << frame << "\n";
+          return false;
+        }
+        ++drawables;
+        visible += isVisible;
+      }
+    }
+
+    for ( dp::sg::xbar::ObjectTreeIndex child = node.m_firstChild; child != ~0; child = tree[child].m_nextSibling )
+    {
+      stack.push_back( child );
+    }
+  }
+
+  if ( !visible || visible == drawables )
+  {
+    std::cerr << "Error: " << visible << " of " << drawables << " objects visible after " << step << " in frame " << frame << "\n";
+    return false;
+  }
+  return true;
+}
+
+dp::math::Mat44f Scene_tree_compaction::getReferenceMatrix( dp::sg::xbar::ObjectTreeIndex index ) const
+{
+  // concatenate the matrices of the scene graph from the object up to the root
+  dp::sg::xbar::ObjectTree & tree = m_sceneTree->getObjectTree();
+  dp::math::Mat44f matrix = dp::math::cIdentity44f;
+  for ( ; index != ~0; index = tree[index].m_parentIndex )
+  {
+    if ( tree[index].m_isTransform )
+    {
+      matrix = matrix * std::static_pointer_cast<dp::sg::core::Transform>( tree[index].m_object )->getMatrix();
+    }
+  }
+  return matrix;
+}
+
+bool Scene_tree_compaction::option( const std::vector<std::string>& optionString )
+{
+  options::options_description od("Usage: scene_tree_compaction");
+  od.add_options() ( "repetitions", options::value<unsigned int>()->default_value(8), "How often a third of the parts is removed, the transforms are compacted and the parts are added again" )
+                   ( "parts", options::value<unsigned int>()->default_value(64), "Number of parts in the scene" )
+    ;
+
+  options::basic_parsed_options<char> parsedOpts = options::basic_command_line_parser<char>(optionString).options( od ).allow_unregistered().run();
+
+  options::variables_map optsMap;
+
+  try
+  {
+    options::store( parsedOpts, optsMap );
+  }
+  catch( options::invalid_option_value e )
+  {
+    std::cerr << "Error: Invalid values specified. Exiting program.\n";
+    return false;
+  }
+
+  m_repetitions = optsMap["repetitions"].as<unsigned int>();
+  m_partCount = std::max( 3u, optsMap["parts"].as<unsigned int>() );
+
+  return true;
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2016, NVIDIA CORPORATION. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#pragma once
+
+#include <test/testfw/core/Test.h>
+#include <dp/sg/core/Group.h>
+#include <dp/sg/core/PerspectiveCamera.h>
+#include <dp/sg/core/Transform.h>
+#include <dp/sg/xbar/SceneTree.h>
+#include <dp/sg/xbar/culling/Culling.h>
+#include <dp/math/Matmnt.h>
+#include <string>
+#include <vector>
+
+class Scene_tree_compaction : public dp::testfw::core::Test
+{
+public:
+  Scene_tree_compaction();
+  ~Scene_tree_compaction();
+
+  bool onInit( void );
+  bool onRun( unsigned int i );
+  bool onClear( void );
+
+  bool onRunCheck( unsigned int i );
+
+  bool option( const std::vector<std::string>& optionString );
+
+protected:
+  void createScene();
+  void update();
+
+  // checks the transform indices of the ObjectTree, the world matrices and the culling against the scene graph
+  bool check( char const * step, unsigned int frame );
+  dp::math::Mat44f getReferenceMatrix( dp::sg::xbar::ObjectTreeIndex index ) const;
+
+protected:
+  dp::sg::core::SceneSharedPtr              m_scene;
+  dp::sg::core::PerspectiveCameraSharedPtr  m_camera;
+  dp::sg::xbar::SceneTreeSharedPtr          m_sceneTree;
+  dp::sg::xbar::culling::CullingSharedPtr   m_culling;
+  std::vector<dp::sg::core::TransformSharedPtr> m_parts;
+  unsigned int                              m_repetitions;
+  unsigned int                              m_partCount;
+  double                                    m_compactTime;
+};
+
+extern "C"
+{
+  DPTTEST_API dp::testfw::core::Test * create_scene_tree_compaction()
+  {
+    return new Scene_tree_compaction();
+  }
+}